@@ -0,0 +1,61 @@
+// AllocationCounter.cpp
+//
+// Replaces the global allocation functions to count calls per thread. The
+// bench target links libstdc++ statically with -Bsymbolic on Linux, so
+// allocations made inside std::string and friends bind to these definitions
+// too. Elsewhere only allocations from this addon's own code are seen.
+
+#include "AllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+static thread_local uint64_t allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    allocationCount++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) std::abort();
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    allocationCount++;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) std::abort();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocationCount++;
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    allocationCount++;
+    return std::malloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+uint64_t AllocationCount() {
+    return allocationCount;
+}
+
+// A string too long for the small-string buffer is allocated inside the
+// runtime's out-of-line std::string code
+static bool ProbeAllocationCounting() {
+    static std::string probe;
+    uint64_t before = allocationCount;
+    probe.assign(64, 'x');
+    return allocationCount != before;
+}
+
+bool AllocationCountingAvailable() {
+    static const bool available = ProbeAllocationCounting();
+    return available;
+}
@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+// Number of operator new calls made on the current thread. The bench target
+// replaces the global operator new; see AllocationCounter.cpp.
+uint64_t AllocationCount();
+
+// False where the replacement does not cover allocations made inside the
+// C++ runtime, in which case per-stage counts are not reported.
+bool AllocationCountingAvailable();
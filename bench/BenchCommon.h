@@ -0,0 +1,97 @@
+#pragma once
+#include <napi.h>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fstream>
+#endif
+
+// Helpers shared by the bench addon's harnesses. Each harness file covers
+// one area; bench.cpp exports the entry points declared at the end.
+
+inline double NumberOption(Napi::Object options, const char* name, double fallback) {
+  Napi::Value value = options.Get(name);
+  return value.IsNumber() ? value.As<Napi::Number>().DoubleValue() : fallback;
+}
+
+inline std::string StringOption(Napi::Object options, const char* name, const char* fallback) {
+  Napi::Value value = options.Get(name);
+  return value.IsString() ? value.As<Napi::String>().Utf8Value() : fallback;
+}
+
+// Sorts samples and summarizes them as { meanUs, p50Us, p99Us }, all 0 when empty
+inline Napi::Object SummarizeSamples(Napi::Env env, std::vector<double>& samples) {
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double sample : samples) sum += sample;
+
+  Napi::Object summary = Napi::Object::New(env);
+  summary.Set("meanUs", Napi::Number::New(env, samples.empty() ? 0 : sum / samples.size()));
+  summary.Set("p50Us", Napi::Number::New(env, samples.empty() ? 0 : samples[samples.size() / 2]));
+  summary.Set("p99Us", Napi::Number::New(env, samples.empty() ? 0 : samples[(samples.size() * 99) / 100]));
+  return summary;
+}
+
+// Runs fn `iterations` times and returns { meanUs, p50Us, p99Us }
+template <typename Fn>
+Napi::Object TimeIterations(Napi::Env env, size_t iterations, Fn fn) {
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  for (size_t i = 0; i < iterations; i++) {
+    Napi::HandleScope scope(env);
+    auto begin = std::chrono::steady_clock::now();
+    fn();
+    samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+  }
+  return SummarizeSamples(env, samples);
+}
+
+inline double MicrosSince(std::chrono::steady_clock::time_point begin) {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+#ifdef __linux__
+inline void WriteTextFile(const std::string& path, const std::string& text) {
+  std::ofstream file(path);
+  file << text;
+}
+#endif
+
+// PipelineBench.cpp
+Napi::Value Configure(const Napi::CallbackInfo& info);
+Napi::Value Run(const Napi::CallbackInfo& info);
+Napi::Value StatsOverhead(const Napi::CallbackInfo& info);
+Napi::Value CombinedSnapshotBench(const Napi::CallbackInfo& info);
+
+// MonitorBench.cpp
+Napi::Value HubFanout(const Napi::CallbackInfo& info);
+Napi::Value QueueStress(const Napi::CallbackInfo& info);
+Napi::Value TieredProbeBench(const Napi::CallbackInfo& info);
+
+// ContextBench.cpp
+Napi::Value AudioContextBench(const Napi::CallbackInfo& info);
+
+// LevelBench.cpp
+Napi::Value LevelKernelsBench(const Napi::CallbackInfo& info);
+
+#ifdef __linux__
+// DeviceBench.cpp
+Napi::Value ProbeCaptureDevicesBench(const Napi::CallbackInfo& info);
+Napi::Value HotplugBench(const Napi::CallbackInfo& info);
+
+// ProcBench.cpp
+Napi::Value ProcessTreeBench(const Napi::CallbackInfo& info);
+Napi::Value FdScanBench(const Napi::CallbackInfo& info);
+Napi::Value ColdStartBench(const Napi::CallbackInfo& info);
+
+// UsageLogBench.cpp
+Napi::Value UsageLogBench(const Napi::CallbackInfo& info);
+
+// PulseBench.cpp
+Napi::Value PulseLatencyBench(const Napi::CallbackInfo& info);
+Napi::Value PulseSessionBench(const Napi::CallbackInfo& info);
+#endif
@@ -0,0 +1,157 @@
+// ChurnAudioBackend.cpp
+//
+
+#include "ChurnAudioBackend.h"
+
+#include <errno.h>
+
+static const uint32_t kFirstProcessId = 100000;
+
+ChurnAudioBackend::ChurnAudioBackend()
+    : nextDeviceKey_(1), nextProcessId_(kFirstProcessId), failEvery_(0), enumerateCalls_(0), nextListenerId_(1) {}
+
+uint32_t ChurnAudioBackend::PlugDevice(AudioDirection direction) {
+    uint32_t key;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        key = nextDeviceKey_++;
+        devices_[key].direction = direction;
+    }
+    Notify();
+    return key;
+}
+
+void ChurnAudioBackend::UnplugDevice(uint32_t key) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto device = devices_.find(key);
+        if (device == devices_.end()) return;
+        for (uint32_t processId : device->second.sessions) sessionDevices_.erase(processId);
+        devices_.erase(device);
+    }
+    Notify();
+}
+
+uint32_t ChurnAudioBackend::StartSession(uint32_t deviceKey) {
+    uint32_t processId;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto device = devices_.find(deviceKey);
+        if (device == devices_.end()) return 0;
+        processId = nextProcessId_++;
+        device->second.sessions.insert(processId);
+        sessionDevices_[processId] = deviceKey;
+    }
+    Notify();
+    return processId;
+}
+
+void ChurnAudioBackend::StopSession(uint32_t processId) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto session = sessionDevices_.find(processId);
+        if (session == sessionDevices_.end()) return;
+        devices_[session->second].sessions.erase(processId);
+        sessionDevices_.erase(session);
+    }
+    Notify();
+}
+
+void ChurnAudioBackend::FailEvery(uint64_t every) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    failEvery_ = every;
+}
+
+bool ChurnAudioBackend::Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                                  long& errorCode, std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enumerateCalls_++;
+    if (failEvery_ != 0 && enumerateCalls_ % failEvery_ == 0) {
+        errorCode = EIO;
+        errorMessage = "Injected enumeration failure";
+        return false;
+    }
+
+    for (const auto& entry : devices_) {
+        AudioDevice device;
+        device.id = "churn:" + std::to_string(entry.first);
+        device.name = "Churn device " + std::to_string(entry.first);
+        device.direction = entry.second.direction;
+        devices.push_back(device);
+
+        for (uint32_t processId : entry.second.sessions) {
+            AudioSession session;
+            session.processId = processId;
+            session.deviceIndex = devices.size() - 1;
+            session.isActive = true;
+            session.isMuted = false;
+            sessions.push_back(session);
+        }
+    }
+    return true;
+}
+
+std::string ChurnAudioBackend::ResolveProcessPath(uint32_t processId) {
+    return "/usr/bin/churn" + std::to_string(processId);
+}
+
+bool ChurnAudioBackend::ProbeCaptureDevices(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                                            long& errorCode, std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& entry : devices_) {
+        if (entry.second.direction != AudioDirection::Capture) continue;
+        std::string id = "churn:" + std::to_string(entry.first);
+        if (deviceId != "*" && deviceId != id) continue;
+        devices.push_back(DeviceActivity{ id, "Churn device " + std::to_string(entry.first),
+                                          !entry.second.sessions.empty() });
+    }
+    if (devices.empty() && deviceId != "*") {
+        errorCode = ENODEV;
+        errorMessage = "Unknown capture device: " + deviceId;
+        return false;
+    }
+    return true;
+}
+
+ChurnAudioBackend::ListenerId ChurnAudioBackend::AddListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    ListenerId id = nextListenerId_++;
+    listeners_.emplace(id, listener);
+    return id;
+}
+
+void ChurnAudioBackend::RemoveListener(ListenerId id) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    listeners_.erase(id);
+}
+
+size_t ChurnAudioBackend::ListenerCount() {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    return listeners_.size();
+}
+
+void ChurnAudioBackend::Notify() {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    for (auto& entry : listeners_) entry.second();
+}
+
+std::vector<std::pair<uint32_t, AudioDirection>> ChurnAudioBackend::LiveSessions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::pair<uint32_t, AudioDirection>> live;
+    for (const auto& session : sessionDevices_) live.emplace_back(session.first, devices_[session.second].direction);
+    return live;
+}
+
+std::vector<uint32_t> ChurnAudioBackend::DeviceKeys(AudioDirection direction) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<uint32_t> keys;
+    for (const auto& entry : devices_) {
+        if (entry.second.direction == direction) keys.push_back(entry.first);
+    }
+    return keys;
+}
+
+uint64_t ChurnAudioBackend::EnumerateCalls() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enumerateCalls_;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "../common/AudioBackend.h"
+#include "../common/PollingMonitorSource.h"
+
+// Scriptable in-memory backend for stress runs: a driver thread plugs and
+// unplugs devices and starts and stops sessions while the code under test
+// enumerates it from other threads. Every change is pushed to listeners on
+// the driver's thread, as a backend with change notifications would.
+// Safe to share between threads.
+class ChurnAudioBackend : public AudioBackend {
+public:
+    typedef std::function<void()> Listener;
+    typedef uint64_t ListenerId;
+
+    ChurnAudioBackend();
+
+    // Returns the new device's key
+    uint32_t PlugDevice(AudioDirection direction);
+    // Ends every session on the device
+    void UnplugDevice(uint32_t key);
+
+    // Returns the session's PID, unique for the life of the backend, or 0
+    // when the device is gone
+    uint32_t StartSession(uint32_t deviceKey);
+    void StopSession(uint32_t processId);
+
+    // Every Enumerate() call numbered a multiple of every fails; 0 never
+    void FailEvery(uint64_t every);
+
+    bool Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                   long& errorCode, std::string& errorMessage) override;
+
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+    // ProbeFunction for PollingMonitorSource over the capture devices: "*"
+    // lists each, any other ID that one device; active while it has a session
+    bool ProbeCaptureDevices(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                             long& errorCode, std::string& errorMessage);
+
+    // Called on the mutating thread after every change; the listener is not
+    // called after RemoveListener returns
+    ListenerId AddListener(Listener listener);
+    void RemoveListener(ListenerId id);
+    size_t ListenerCount();
+
+    // Live sessions as (PID, direction)
+    std::vector<std::pair<uint32_t, AudioDirection>> LiveSessions();
+    std::vector<uint32_t> DeviceKeys(AudioDirection direction);
+    uint64_t EnumerateCalls();
+
+private:
+    struct Device {
+        AudioDirection direction;
+        std::set<uint32_t> sessions;  // PIDs
+    };
+
+    void Notify();
+
+    std::mutex mutex_;
+    std::map<uint32_t, Device> devices_;
+    std::map<uint32_t, uint32_t> sessionDevices_;  // PID to device key
+    uint32_t nextDeviceKey_;
+    uint32_t nextProcessId_;
+    uint64_t failEvery_;
+    uint64_t enumerateCalls_;
+
+    std::mutex listenersMutex_;  // Held while listeners are called
+    std::map<ListenerId, Listener> listeners_;
+    ListenerId nextListenerId_;
+};
@@ -0,0 +1,143 @@
+// ContextBench.cpp
+//
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "../common/AudioContext.h"
+#include "AllocationCounter.h"
+#include "BenchCommon.h"
+#include "FakeContextBackend.h"
+
+#ifdef __linux__
+#include "../linux/ProcAudioBackend.h"
+#include "../linux/ProcContextBackend.h"
+#include "../linux/PulseContextBackend.h"
+#include "../linux/PulseSessionBackend.h"
+#endif
+
+// audioContext({ backend: "fake" | "proc" | "pulse", devices,
+// sessionsPerDevice, iterations, replugEvery }): times a query that builds
+// and tears down its whole world (a new backend and AudioContext per call, as
+// the one-shot calls do) against repeated queries of one long-lived
+// AudioContext. The reused context is replugged (fake) or invalidated
+// (others) every replugEvery queries, 0 never, to show what a topology change
+// costs. Allocations are those made on this thread, so the proc scanner's
+// pool threads are not counted. "proc" scans the real /proc, "pulse" needs a
+// running sound server; both are Linux only.
+Napi::Value AudioContextBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string backendName = StringOption(options, "backend", "fake");
+  size_t devices = static_cast<size_t>(NumberOption(options, "devices", 8));
+  size_t sessionsPerDevice = static_cast<size_t>(NumberOption(options, "sessionsPerDevice", 16));
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 1000));
+  size_t replugEvery = static_cast<size_t>(NumberOption(options, "replugEvery", 0));
+
+  if (iterations == 0) {
+    Napi::RangeError::New(env, "iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Declared before the contexts that read through them
+#ifdef __linux__
+  std::unique_ptr<ProcAudioBackend> procBackend;
+  std::unique_ptr<PulseSessionBackend> pulseBackend;
+#endif
+  std::function<ContextBackend*()> create;
+  if (backendName == "fake") {
+    create = [devices, sessionsPerDevice]() { return new FakeContextBackend(devices, sessionsPerDevice); };
+#ifdef __linux__
+  } else if (backendName == "proc") {
+    create = [&procBackend]() {
+      procBackend.reset(new ProcAudioBackend());
+      return new ProcContextBackend(*procBackend);
+    };
+  } else if (backendName == "pulse") {
+    create = [&pulseBackend]() {
+      pulseBackend.reset(new PulseSessionBackend());
+      return new PulseContextBackend(*pulseBackend);
+    };
+#endif
+  } else {
+    Napi::RangeError::New(env, "Unknown backend: " + backendName).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  long errorCode = 0;
+  std::string errorMessage;
+  bool countAllocations = AllocationCountingAvailable();
+
+  std::vector<double> oneShot;
+  oneShot.reserve(iterations);
+  uint64_t oneShotAllocations = 0;
+  size_t oneShotProcesses = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t allocationsBegin = AllocationCount();
+    AudioContext context{std::unique_ptr<ContextBackend>(create())};
+    if (!context.Query(errorCode, errorMessage)) {
+      Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    oneShotProcesses = context.Capture().size() + context.Render().size();
+    oneShotAllocations += AllocationCount() - allocationsBegin;
+    oneShot.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+  }
+
+  ContextBackend* backend = create();
+  FakeContextBackend* fake = backendName == "fake" ? static_cast<FakeContextBackend*>(backend) : nullptr;
+  AudioContext context{std::unique_ptr<ContextBackend>(backend)};
+  context.Query(errorCode, errorMessage);  // Opens the devices and settles buffer capacity
+
+  std::vector<double> reused;
+  reused.reserve(iterations);
+  uint64_t reusedAllocations = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    if (replugEvery != 0 && i % replugEvery == replugEvery - 1) {
+      if (fake) {
+        fake->Replug();
+      } else {
+        context.Invalidate();
+      }
+    }
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t allocationsBegin = AllocationCount();
+    if (!context.Query(errorCode, errorMessage)) {
+      Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    reusedAllocations += AllocationCount() - allocationsBegin;
+    reused.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+  }
+
+  AudioContextStats stats = context.Stats();
+  size_t reusedProcesses = context.Capture().size() + context.Render().size();
+
+  Napi::Object oneShotObj = SummarizeSamples(env, oneShot);
+  Napi::Object reusedObj = SummarizeSamples(env, reused);
+  if (countAllocations) {
+    oneShotObj.Set("allocsPerQuery", Napi::Number::New(env, static_cast<double>(oneShotAllocations) / iterations));
+    reusedObj.Set("allocsPerQuery", Napi::Number::New(env, static_cast<double>(reusedAllocations) / iterations));
+  } else {
+    oneShotObj.Set("allocsPerQuery", env.Null());
+    reusedObj.Set("allocsPerQuery", env.Null());
+  }
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("backend", Napi::String::New(env, backendName));
+  report.Set("devices", Napi::Number::New(env, static_cast<double>(context.Devices().size())));
+  report.Set("processes", Napi::Number::New(env, static_cast<double>(reusedProcesses)));
+  report.Set("resultsMatch", Napi::Boolean::New(env, reusedProcesses == oneShotProcesses));
+  report.Set("oneShot", oneShotObj);
+  report.Set("reused", reusedObj);
+  report.Set("refreshes", Napi::Number::New(env, static_cast<double>(stats.refreshes)));
+  report.Set("resolves", Napi::Number::New(env, static_cast<double>(stats.resolves)));
+  if (fake) {
+    report.Set("backendOpens", Napi::Number::New(env, static_cast<double>(fake->opens)));
+    report.Set("backendResolves", Napi::Number::New(env, static_cast<double>(fake->resolves)));
+  }
+  return report;
+}
@@ -0,0 +1,228 @@
+// DeviceBench.cpp
+//
+// Linux only: capture device probing and hot-plug latency over fake
+// /proc/asound and /dev/snd trees.
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common/PollingMonitorSource.h"
+#include "../linux/CaptureDeviceProbe.h"
+#include "../linux/SoundDeviceWatcher.h"
+#include "BenchCommon.h"
+
+// probeCaptureDevices({ procRoot, threads, iterations }): probes every capture
+// PCM under procRoot/asound `iterations` times and reports the devices found
+// by the last probe with the latency per probe
+Napi::Value ProbeCaptureDevicesBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string procRoot = StringOption(options, "procRoot", "/proc");
+  size_t threads = static_cast<size_t>(NumberOption(options, "threads", 0));
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 100));
+
+  if (iterations == 0) {
+    Napi::RangeError::New(env, "iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  CaptureDeviceProbe probe(procRoot, threads);
+  std::vector<CaptureDeviceState> devices;
+  std::vector<double> samples;
+  samples.reserve(iterations);
+
+  for (size_t i = 0; i < iterations; i++) {
+    int errorCode = 0;
+    std::string errorMessage;
+    auto begin = std::chrono::steady_clock::now();
+    bool ok = probe.Probe(devices, errorCode, errorMessage);
+    samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+
+    if (!ok) {
+      Napi::Error err = Napi::Error::New(env, errorMessage);
+      err.Set("code", Napi::Number::New(env, errorCode));
+      err.ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (double sample : samples) sum += sample;
+
+  Napi::Array deviceArray = Napi::Array::New(env, devices.size());
+  for (size_t i = 0; i < devices.size(); i++) {
+    Napi::Object deviceObj = Napi::Object::New(env);
+    deviceObj.Set("id", Napi::String::New(env, devices[i].id));
+    deviceObj.Set("name", Napi::String::New(env, devices[i].name));
+    deviceObj.Set("active", Napi::Boolean::New(env, devices[i].active));
+    deviceObj.Set("ownerPid", Napi::Number::New(env, devices[i].ownerPid));
+    deviceArray.Set(i, deviceObj);
+  }
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("threads", Napi::Number::New(env, static_cast<double>(probe.Threads())));
+  report.Set("devices", deviceArray);
+  report.Set("meanUs", Napi::Number::New(env, sum / samples.size()));
+  report.Set("p50Us", Napi::Number::New(env, samples[samples.size() / 2]));
+  report.Set("p99Us", Napi::Number::New(env, samples[(samples.size() * 99) / 100]));
+  return report;
+}
+
+// hotplug({ root, cycles, intervalMs, watch }): plugs and unplugs a fake
+// capture card under root (root/asound for /proc, root/dev/snd for /dev)
+// `cycles` times and reports how long each change took to reach a "*"
+// PollingMonitorSource. With watch, the source is woken by a
+// SoundDeviceWatcher; without, only the intervalMs poll finds the change.
+Napi::Value HotplugBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string root = StringOption(options, "root", "");
+  size_t cycles = static_cast<size_t>(NumberOption(options, "cycles", 20));
+  int intervalMs = static_cast<int>(NumberOption(options, "intervalMs", 3000));
+  Napi::Value watchOption = options.Get("watch");
+  bool watch = watchOption.IsBoolean() ? watchOption.As<Napi::Boolean>().Value() : true;
+
+  if (root.empty() || cycles == 0 || intervalMs <= 0) {
+    Napi::RangeError::New(env, "root, a positive cycles and a positive intervalMs are required").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string asound = root + "/asound";
+  std::string dev = root + "/dev";
+  mkdir(asound.c_str(), 0755);
+  mkdir(dev.c_str(), 0755);
+  mkdir((dev + "/snd").c_str(), 0755);
+
+  CaptureDeviceProbe probe(root, 1);
+  PollingMonitorSource source(
+    [&probe](const std::string&, std::vector<DeviceActivity>& devices, long& errorCode, std::string& errorMessage) {
+      std::vector<CaptureDeviceState> states;
+      int probeError = 0;
+      if (!probe.Probe(states, probeError, errorMessage)) {
+        errorCode = probeError;
+        return false;
+      }
+      for (const CaptureDeviceState& state : states) {
+        devices.push_back(DeviceActivity{state.id, state.name, state.active});
+      }
+      return true;
+    },
+    "HotplugBench", std::chrono::milliseconds(intervalMs));
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::map<std::string, bool> present;
+  std::vector<double> rearmSamples;
+
+  MonitorEvent error;
+  bool started = source.Start("*", [&](const MonitorEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (event.hasError) {
+      if (event.rearmMs >= 0) rearmSamples.push_back(event.rearmMs);
+    } else {
+      present[event.deviceId] = true;
+    }
+    changed.notify_all();
+  }, error);
+  if (!started) {
+    Napi::Error::New(env, error.errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  SoundDeviceWatcher watcher(dev);
+  SoundDeviceWatcher::ListenerId listener = 0;
+  if (watch) {
+    listener = watcher.AddListener([&source](std::chrono::steady_clock::time_point detectedAt) {
+      source.Wake(detectedAt);
+    });
+  }
+
+  // Waits for the device's first report, bounded by two poll intervals
+  std::chrono::milliseconds timeout(intervalMs * 2 + 1000);
+  std::vector<double> samples;
+  size_t missed = 0;
+  const int card = 7;
+  std::string cardPath = asound + "/card" + std::to_string(card);
+  std::string pcmPath = cardPath + "/pcm0c";
+  std::string node = dev + "/snd/pcmC" + std::to_string(card) + "D0c";
+  std::string id = "hw:" + std::to_string(card) + ",0";
+
+  for (size_t i = 0; i < cycles; i++) {
+    size_t reports = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      present.erase(id);
+      reports = rearmSamples.size();
+    }
+
+    // Plug: the card shows up in /proc before its /dev node, as with udev
+    mkdir(cardPath.c_str(), 0755);
+    mkdir(pcmPath.c_str(), 0755);
+    mkdir((pcmPath + "/sub0").c_str(), 0755);
+    WriteTextFile(pcmPath + "/info", "name: Hotplug Mic\n");
+    WriteTextFile(pcmPath + "/sub0/status", "closed\n");
+    auto begin = std::chrono::steady_clock::now();
+    WriteTextFile(node, "");
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      if (changed.wait_for(lock, timeout, [&] { return present.count(id) > 0; })) {
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+      } else {
+        missed++;
+      }
+
+      // The plug's re-arm report follows the device report
+      if (watch) {
+        changed.wait_for(lock, timeout, [&] { return rearmSamples.size() > reports; });
+        reports = rearmSamples.size();
+      }
+    }
+
+    // Unplug, and let the source see the card gone before the next cycle
+    unlink(node.c_str());
+    unlink((pcmPath + "/sub0/status").c_str());
+    rmdir((pcmPath + "/sub0").c_str());
+    unlink((pcmPath + "/info").c_str());
+    rmdir(pcmPath.c_str());
+    rmdir(cardPath.c_str());
+
+    if (watch) {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait_for(lock, timeout, [&] { return rearmSamples.size() > reports; });
+    } else {
+      std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+  }
+
+  if (listener != 0) watcher.RemoveListener(listener);
+  source.Stop();
+  rmdir((dev + "/snd").c_str());
+  rmdir(dev.c_str());
+  rmdir(asound.c_str());
+
+  std::sort(samples.begin(), samples.end());
+  std::sort(rearmSamples.begin(), rearmSamples.end());
+  auto percentile = [](const std::vector<double>& values, size_t pct) {
+    return values.empty() ? 0.0 : values[(values.size() * pct) / 100];
+  };
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("cycles", Napi::Number::New(env, static_cast<double>(cycles)));
+  report.Set("missed", Napi::Number::New(env, static_cast<double>(missed)));
+  report.Set("p50Ms", Napi::Number::New(env, percentile(samples, 50)));
+  report.Set("p99Ms", Napi::Number::New(env, percentile(samples, 99)));
+  report.Set("rearmReports", Napi::Number::New(env, static_cast<double>(rearmSamples.size())));
+  report.Set("rearmP50Ms", Napi::Number::New(env, percentile(rearmSamples, 50)));
+  report.Set("rearmP99Ms", Napi::Number::New(env, percentile(rearmSamples, 99)));
+  return report;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <errno.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../common/AudioContext.h"
+
+// ContextBackend with a fixed set of devices and sessions, every other
+// session active and every fourth render session muted. Counts what an
+// AudioContext asks of it, so reuse and invalidation can be checked, and can
+// be made to replug its devices or fail a read. Replug() is safe from any
+// thread, as a hot-plug listener would call it; the rest is for the
+// context's thread.
+class FakeContextBackend : public ContextBackend {
+public:
+    FakeContextBackend(size_t devices, size_t sessionsPerDevice)
+        : opens(0), reads(0), resolves(0), devices_(devices), version_(0), failNextRead_(false) {
+        for (size_t device = 0; device < devices; device++) {
+            for (size_t i = 0; i < sessionsPerDevice; i++) {
+                AudioSession session;
+                session.processId = static_cast<uint32_t>(1000 + (device * sessionsPerDevice + i) % 97);
+                session.deviceIndex = device;
+                session.isActive = i % 2 == 0;
+                session.isMuted = i % 4 == 2;
+                sessions_.push_back(session);
+            }
+        }
+    }
+
+    uint64_t opens;
+    uint64_t reads;
+    uint64_t resolves;
+
+    void Replug() { version_++; }
+    void FailNextRead() { failNextRead_ = true; }
+
+    uint64_t TopologyVersion() override { return version_.load(); }
+
+    bool OpenDevices(std::vector<AudioDevice>& devices, long&, std::string&) override {
+        opens++;
+        for (size_t i = 0; i < devices_; i++) {
+            AudioDevice device;
+            device.id = "fake:" + std::to_string(i);
+            device.name = "Fake Device " + std::to_string(i);
+            device.direction = i % 2 == 0 ? AudioDirection::Capture : AudioDirection::Render;
+            devices.push_back(device);
+        }
+        return true;
+    }
+
+    bool ReadSessions(std::vector<AudioSession>& sessions, long& errorCode, std::string& errorMessage) override {
+        reads++;
+        if (failNextRead_) {
+            failNextRead_ = false;
+            errorCode = EIO;
+            errorMessage = "Injected read failure";
+            return false;
+        }
+        sessions.insert(sessions.end(), sessions_.begin(), sessions_.end());
+        return true;
+    }
+
+    std::string ResolveProcessPath(uint32_t processId) override {
+        resolves++;
+        return "/usr/bin/fake" + std::to_string(processId);
+    }
+
+private:
+    size_t devices_;
+    std::vector<AudioSession> sessions_;
+    std::atomic<uint64_t> version_;
+    bool failNextRead_;
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "../common/MonitorHub.h"
+
+// Counts how many fake listeners were started and stopped, and keeps the live
+// ones so a test can emit events on them from its own threads.
+class FakeMonitorRegistry {
+public:
+    FakeMonitorRegistry() : starts(0), stops(0) {}
+
+    std::atomic<uint64_t> starts;
+    std::atomic<uint64_t> stops;
+
+    void Add(const std::string& deviceId, MonitorSource::EventSink sink) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sinks_.push_back(Entry{deviceId, sink});
+    }
+
+    void Remove(const std::string& deviceId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < sinks_.size(); i++) {
+            if (sinks_[i].deviceId == deviceId) {
+                sinks_.erase(sinks_.begin() + i);
+                return;
+            }
+        }
+    }
+
+    MonitorSource::EventSink Sink(const std::string& deviceId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const Entry& entry : sinks_) {
+            if (entry.deviceId == deviceId) return entry.sink;
+        }
+        return MonitorSource::EventSink();
+    }
+
+private:
+    struct Entry {
+        std::string deviceId;
+        MonitorSource::EventSink sink;
+    };
+
+    std::mutex mutex_;
+    std::vector<Entry> sinks_;
+};
+
+// MonitorSource that only emits what the test pushes through the registry
+class FakeMonitorSource : public MonitorSource {
+public:
+    explicit FakeMonitorSource(FakeMonitorRegistry& registry) : registry_(registry), started_(false) {}
+    ~FakeMonitorSource() override { Stop(); }
+
+    bool Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) override {
+        if (deviceId == "missing") {
+            error.deviceId = deviceId;
+            error.hasError = true;
+            error.errorCode = 2;
+            error.errorDomain = "FakeMonitorSource";
+            error.errorMessage = "No such device";
+            return false;
+        }
+
+        deviceId_ = deviceId;
+        started_ = true;
+        registry_.starts++;
+        registry_.Add(deviceId, sink);
+        return true;
+    }
+
+    void Stop() override {
+        if (!started_) return;
+        started_ = false;
+        registry_.Remove(deviceId_);
+        registry_.stops++;
+    }
+
+private:
+    FakeMonitorRegistry& registry_;
+    std::string deviceId_;
+    bool started_;
+};
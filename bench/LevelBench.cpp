@@ -0,0 +1,79 @@
+// LevelBench.cpp
+//
+
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "../common/LevelKernels.h"
+#include "BenchCommon.h"
+
+// levelKernels({ samples, iterations }): times every level kernel this CPU
+// runs over one block of int16 and one of float32 noise, as a 48 kHz stereo
+// meter would see a second of audio by default, and checks each against the
+// scalar kernel: int16 must match exactly, float32 within 1e-6 relative.
+Napi::Value LevelKernelsBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  size_t samples = static_cast<size_t>(NumberOption(options, "samples", 96000));
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 200));
+  if (samples == 0 || iterations == 0) {
+    Napi::RangeError::New(env, "samples and iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Full-range noise, with one full-scale negative sample to exercise the peak
+  std::vector<int16_t> int16Samples(samples);
+  std::vector<float> float32Samples(samples);
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < samples; i++) {
+    seed = seed * 1103515245u + 12345u;
+    int16Samples[i] = static_cast<int16_t>(seed >> 16);
+    float32Samples[i] = int16Samples[i] / 32768.0f;
+  }
+  int16Samples[samples / 2] = -32768;
+  float32Samples[samples / 2] = -1.0f;
+
+  std::vector<const LevelKernels*> kernels = SupportedLevelKernels();
+  Int16Levels int16Expected;
+  Float32Levels float32Expected;
+  kernels.front()->int16(int16Samples.data(), samples, int16Expected);
+  kernels.front()->float32(float32Samples.data(), samples, float32Expected);
+
+  Napi::Object runs = Napi::Object::New(env);
+  for (const LevelKernels* kernel : kernels) {
+    Int16Levels int16Levels;
+    Float32Levels float32Levels;
+    kernel->int16(int16Samples.data(), samples, int16Levels);
+    kernel->float32(float32Samples.data(), samples, float32Levels);
+    bool matches = int16Levels.peak == int16Expected.peak && int16Levels.sumSquares == int16Expected.sumSquares &&
+                   float32Levels.peak == float32Expected.peak &&
+                   std::fabs(float32Levels.sumSquares - float32Expected.sumSquares) <= 1e-6 * float32Expected.sumSquares;
+
+    Napi::Object run = Napi::Object::New(env);
+    Napi::Object int16Timing = TimeIterations(env, iterations, [&]() {
+      Int16Levels levels;
+      kernel->int16(int16Samples.data(), samples, levels);
+      int16Levels = levels;
+    });
+    int16Timing.Set("msamplesPerSecond",
+                    Napi::Number::New(env, samples / int16Timing.Get("meanUs").As<Napi::Number>().DoubleValue()));
+    Napi::Object float32Timing = TimeIterations(env, iterations, [&]() {
+      Float32Levels levels;
+      kernel->float32(float32Samples.data(), samples, levels);
+      float32Levels = levels;
+    });
+    float32Timing.Set("msamplesPerSecond",
+                      Napi::Number::New(env, samples / float32Timing.Get("meanUs").As<Napi::Number>().DoubleValue()));
+    run.Set("int16", int16Timing);
+    run.Set("float32", float32Timing);
+    run.Set("matchesScalar", Napi::Boolean::New(env, matches));
+    runs.Set(kernel->name, run);
+  }
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("selected", Napi::String::New(env, SelectedLevelKernels().name));
+  report.Set("samples", Napi::Number::New(env, static_cast<double>(samples)));
+  report.Set("kernels", runs);
+  return report;
+}
@@ -0,0 +1,309 @@
+// MonitorBench.cpp
+//
+// Harnesses for the monitor side: MonitorHub fan-out, the event queue under
+// a slow consumer, and AudioProcessWatcher with the tiered probe.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../common/AudioProcessWatcher.h"
+#include "../common/MonitorEventQueue.h"
+#include "../common/MonitorHub.h"
+#include "../common/TieredProbeScheduler.h"
+#include "BenchCommon.h"
+#include "FakeMonitorSource.h"
+
+// hubFanout({ devices, subscribers, events }): subscribes `subscribers` plain
+// and one changesOnly subscriber to each of `devices` fake listeners, emits
+// `events` states (each repeated twice) per device from its own thread, and
+// reports how many listeners were started and how many events were delivered.
+Napi::Value HubFanout(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  size_t devices = static_cast<size_t>(NumberOption(options, "devices", 1));
+  size_t subscribers = static_cast<size_t>(NumberOption(options, "subscribers", 20));
+  size_t events = static_cast<size_t>(NumberOption(options, "events", 10000));
+
+  if (devices == 0 || subscribers == 0) {
+    Napi::RangeError::New(env, "devices and subscribers must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  FakeMonitorRegistry registry;
+  MonitorHub hub([&registry]() { return std::unique_ptr<MonitorSource>(new FakeMonitorSource(registry)); });
+
+  std::atomic<uint64_t> delivered(0);
+  std::atomic<uint64_t> changesDelivered(0);
+  std::vector<MonitorHub::SubscriptionId> ids;
+
+  MonitorFilter changesOnly;
+  changesOnly.changesOnly = true;
+
+  for (size_t d = 0; d < devices; d++) {
+    std::string deviceId = "fake:" + std::to_string(d);
+    MonitorEvent error;
+    for (size_t i = 0; i < subscribers; i++) {
+      ids.push_back(hub.Subscribe(deviceId, MonitorFilter(), [&delivered](const MonitorEvent&) { delivered++; }, error));
+    }
+    ids.push_back(hub.Subscribe(deviceId, changesOnly, [&changesDelivered](const MonitorEvent&) { changesDelivered++; }, error));
+  }
+  size_t listenersWhileSubscribed = hub.ListenerCount();
+
+  // A listener that fails to start must not leave a subscription behind
+  MonitorEvent error;
+  bool rejectedMissing = hub.Subscribe("missing", MonitorFilter(), [](const MonitorEvent&) {}, error) == 0 &&
+                         hub.ListenerCount() == listenersWhileSubscribed;
+
+  auto begin = std::chrono::steady_clock::now();
+  std::vector<std::thread> emitters;
+  for (size_t d = 0; d < devices; d++) {
+    MonitorSource::EventSink sink = registry.Sink("fake:" + std::to_string(d));
+    emitters.emplace_back([sink, events, d]() {
+      MonitorEvent event;
+      event.deviceId = "fake:" + std::to_string(d);
+      for (size_t i = 0; i < events; i++) {
+        event.active = (i / 2) % 2 == 1;
+        sink(event);
+      }
+    });
+  }
+  for (std::thread& emitter : emitters) emitter.join();
+  double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+  for (MonitorHub::SubscriptionId id : ids) hub.Unsubscribe(id);
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("devices", Napi::Number::New(env, static_cast<double>(devices)));
+  report.Set("subscribers", Napi::Number::New(env, static_cast<double>(subscribers)));
+  report.Set("events", Napi::Number::New(env, static_cast<double>(events)));
+  report.Set("listenerStarts", Napi::Number::New(env, static_cast<double>(registry.starts)));
+  report.Set("listenerStops", Napi::Number::New(env, static_cast<double>(registry.stops)));
+  report.Set("listenersWhileSubscribed", Napi::Number::New(env, static_cast<double>(listenersWhileSubscribed)));
+  report.Set("listenersAfterUnsubscribe", Napi::Number::New(env, static_cast<double>(hub.ListenerCount())));
+  report.Set("delivered", Napi::Number::New(env, static_cast<double>(delivered)));
+  report.Set("expectedDelivered", Napi::Number::New(env, static_cast<double>(devices * subscribers * events)));
+  report.Set("changesOnlyDelivered", Napi::Number::New(env, static_cast<double>(changesDelivered)));
+  report.Set("expectedChangesOnlyDelivered", Napi::Number::New(env, static_cast<double>(devices * ((events + 1) / 2))));
+  report.Set("rejectedMissingDevice", Napi::Boolean::New(env, rejectedMissing));
+  report.Set("elapsedUs", Napi::Number::New(env, elapsedUs));
+  return report;
+}
+
+// queueStress({ events, devices, capacity, errorEvery, consumerDelayNs }):
+// one thread pushes `events` state changes round-robin over `devices` (an
+// error every `errorEvery` events, 0 for none) while another drains the queue,
+// spinning `consumerDelayNs` per event to imitate a busy JS thread.
+Napi::Value QueueStress(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  size_t events = static_cast<size_t>(NumberOption(options, "events", 1000000));
+  size_t devices = static_cast<size_t>(NumberOption(options, "devices", 1));
+  size_t capacity = static_cast<size_t>(NumberOption(options, "capacity", 64));
+  size_t errorEvery = static_cast<size_t>(NumberOption(options, "errorEvery", 0));
+  double consumerDelayNs = NumberOption(options, "consumerDelayNs", 0);
+
+  if (devices == 0 || capacity == 0) {
+    Napi::RangeError::New(env, "devices and capacity must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  MonitorEventQueue queue(capacity);
+  std::vector<std::string> deviceIds;
+  for (size_t d = 0; d < devices; d++) deviceIds.push_back("fake:" + std::to_string(d));
+
+  std::vector<int> lastPushed(devices, -1);
+  std::vector<int> lastSeen(devices, -1);
+  std::atomic<bool> producerDone(false);
+  double maxPushNs = 0;
+
+  auto begin = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    MonitorEvent event;
+    for (size_t i = 0; i < events; i++) {
+      size_t device = i % devices;
+      event.deviceId = deviceIds[device];
+      event.hasError = errorEvery != 0 && i % errorEvery == errorEvery - 1;
+      event.errorMessage = event.hasError ? "Waiting to restart monitoring..." : "";
+      event.active = (i / devices) % 2 == 1;
+
+      auto pushBegin = std::chrono::steady_clock::now();
+      queue.Push(event);
+      double pushNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - pushBegin).count();
+      if (pushNs > maxPushNs) maxPushNs = pushNs;
+
+      // Whether or not the queue kept the event, its state is the one the
+      // consumer has to end up with
+      if (!event.hasError) lastPushed[device] = event.active ? 1 : 0;
+    }
+    producerDone = true;
+  });
+
+  std::thread consumer([&]() {
+    for (;;) {
+      bool done = producerDone;
+      const MonitorEvent* event = queue.Front();
+      if (!event) {
+        if (done) return;
+        std::this_thread::yield();
+        continue;
+      }
+
+      if (!event->hasError) {
+        size_t device = static_cast<size_t>(std::stoul(event->deviceId.substr(5)));
+        lastSeen[device] = event->active ? 1 : 0;
+      }
+      if (consumerDelayNs > 0) {
+        auto spinBegin = std::chrono::steady_clock::now();
+        while (std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - spinBegin).count() <
+               consumerDelayNs) {
+        }
+      }
+      queue.PopFront();
+    }
+  });
+
+  producer.join();
+  consumer.join();
+  double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+  MonitorQueueStats stats = queue.Stats();
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("events", Napi::Number::New(env, static_cast<double>(events)));
+  report.Set("devices", Napi::Number::New(env, static_cast<double>(devices)));
+  report.Set("capacity", Napi::Number::New(env, static_cast<double>(queue.Capacity())));
+  report.Set("pushed", Napi::Number::New(env, static_cast<double>(stats.pushed)));
+  report.Set("delivered", Napi::Number::New(env, static_cast<double>(stats.delivered)));
+  report.Set("merged", Napi::Number::New(env, static_cast<double>(stats.merged)));
+  report.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+  report.Set("finalStateMatches", Napi::Boolean::New(env, lastSeen == lastPushed));
+  report.Set("maxPushNs", Napi::Number::New(env, maxPushNs));
+  report.Set("elapsedUs", Napi::Number::New(env, elapsedUs));
+  return report;
+}
+
+// tieredProbe({ adaptive, intervalMs, idleMs, cycles, holdMs, scanCostUs }):
+// runs an AudioProcessWatcher over a fake stream that opens and closes
+// `cycles` times. The scan costs scanCostUs of busy work; with adaptive, a
+// free activity probe gates it. Reports scans per second while idle and
+// the latency from a stream opening or closing to its delta.
+Napi::Value TieredProbeBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  Napi::Value adaptiveOption = options.Get("adaptive");
+  bool adaptive = adaptiveOption.IsBoolean() ? adaptiveOption.As<Napi::Boolean>().Value() : true;
+  int intervalMs = static_cast<int>(NumberOption(options, "intervalMs", 1000));
+  int idleMs = static_cast<int>(NumberOption(options, "idleMs", 2000));
+  size_t cycles = static_cast<size_t>(NumberOption(options, "cycles", 10));
+  int holdMs = static_cast<int>(NumberOption(options, "holdMs", 300));
+  double scanCostUs = NumberOption(options, "scanCostUs", 2000);
+
+  if (intervalMs < 10 || idleMs < 0 || holdMs < 0 || scanCostUs < 0) {
+    Napi::RangeError::New(env, "intervalMs must be at least 10 and the other options non-negative").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  bool streamOpen = false;
+  size_t added = 0;
+  size_t removed = 0;
+  std::atomic<uint64_t> scans(0);
+
+  AudioProcessWatcher watcher(
+    [&](WatchedSnapshot& snapshot, long&, std::string&) {
+      scans++;
+      auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::micro>(scanCostUs);
+      while (std::chrono::steady_clock::now() < until) {}
+
+      std::lock_guard<std::mutex> lock(mutex);
+      if (streamOpen) {
+        snapshot.capture.push_back(WatchedProcess{4242, "/usr/bin/bench", "Bench Microphone"});
+      }
+      return true;
+    },
+    [&](AudioProcessDelta* delta) {
+      std::unique_ptr<AudioProcessDelta> owned(delta);
+      std::lock_guard<std::mutex> lock(mutex);
+      added += delta->capture.added.size();
+      removed += delta->capture.removed.size();
+      changed.notify_all();
+    },
+    std::chrono::milliseconds(intervalMs));
+
+  TieredProbeScheduler* scheduler = nullptr;
+  if (adaptive) {
+    ProbeSchedule schedule;
+    schedule.refreshInterval = std::chrono::milliseconds(intervalMs);
+    schedule.idleInterval = std::min(schedule.idleInterval, schedule.refreshInterval);
+    schedule.fastInterval = std::min(schedule.fastInterval, schedule.idleInterval);
+    scheduler = new TieredProbeScheduler([&](ActivitySample& sample, long&, std::string&) {
+      std::lock_guard<std::mutex> lock(mutex);
+      sample.signature = streamOpen ? "open" : "";
+      sample.active = streamOpen;
+      return true;
+    }, schedule);
+    watcher.UseScheduler(std::unique_ptr<TieredProbeScheduler>(scheduler));
+  }
+  watcher.Start();
+
+  // Idle: nothing is open, so every scan is wasted
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  uint64_t idleStart = scans;
+  std::this_thread::sleep_for(std::chrono::milliseconds(idleMs));
+  double idleScansPerSec = idleMs > 0 ? (scans - idleStart) * 1000.0 / idleMs : 0;
+
+  std::vector<double> samples;
+  size_t missed = 0;
+  // A fixed interval may need a full interval per change, plus a scan
+  std::chrono::milliseconds timeout(intervalMs * 2 + 1000);
+  for (size_t cycle = 0; cycle < cycles * 2; cycle++) {
+    bool open = cycle % 2 == 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    size_t& counter = open ? added : removed;
+    size_t before = counter;
+    streamOpen = open;
+    auto begin = std::chrono::steady_clock::now();
+    if (changed.wait_for(lock, timeout, [&] { return counter != before; })) {
+      samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+    } else {
+      missed++;
+    }
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(holdMs));
+  }
+
+  watcher.Stop();
+
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [](const std::vector<double>& values, size_t pct) {
+    return values.empty() ? 0.0 : values[(values.size() * pct) / 100];
+  };
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("adaptive", Napi::Boolean::New(env, adaptive));
+  report.Set("idleScansPerSec", Napi::Number::New(env, idleScansPerSec));
+  report.Set("scans", Napi::Number::New(env, static_cast<double>(scans)));
+  report.Set("changes", Napi::Number::New(env, static_cast<double>(samples.size())));
+  report.Set("missed", Napi::Number::New(env, static_cast<double>(missed)));
+  report.Set("p50Ms", Napi::Number::New(env, percentile(samples, 50)));
+  report.Set("p99Ms", Napi::Number::New(env, percentile(samples, 99)));
+  report.Set("maxMs", Napi::Number::New(env, samples.empty() ? 0.0 : samples.back()));
+  if (scheduler) {
+    TieredProbeStats stats = scheduler->Stats();
+    Napi::Object tiers = Napi::Object::New(env);
+    tiers.Set("ticks", Napi::Number::New(env, static_cast<double>(stats.ticks)));
+    tiers.Set("unchanged", Napi::Number::New(env, static_cast<double>(stats.unchanged)));
+    tiers.Set("idle", Napi::Number::New(env, static_cast<double>(stats.idle)));
+    tiers.Set("full", Napi::Number::New(env, static_cast<double>(stats.full)));
+    report.Set("tiers", tiers);
+  }
+  return report;
+}
@@ -0,0 +1,308 @@
+// PipelineBench.cpp
+//
+// Harnesses for the portable enumeration pipeline, run against a synthetic
+// backend that configure() shapes.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "../common/ColumnarResult.h"
+#include "../common/NativeStats.h"
+#include "../common/ResultMarshal.h"
+#include "../common/SessionPipeline.h"
+#include "AllocationCounter.h"
+#include "BenchCommon.h"
+#include "SyntheticAudioBackend.h"
+
+#ifdef __linux__
+#include "../linux/ProcAudioBackend.h"
+#endif
+
+static SyntheticAudioBackend backend;
+static StringTable benchStringTable;
+
+// Collects the duration and allocation count of every stage
+class StageRecorder : public PipelineObserver {
+public:
+  void StageBegin(PipelineStage stage) override {
+    int index = static_cast<int>(stage);
+    begin_[index] = std::chrono::steady_clock::now();
+    allocationsBegin_[index] = AllocationCount();
+  }
+
+  void StageEnd(PipelineStage stage) override {
+    int index = static_cast<int>(stage);
+    durations_[index].push_back(Elapsed(begin_[index]));
+    allocations_[index] += AllocationCount() - allocationsBegin_[index];
+  }
+
+  void Reserve(size_t iterations) {
+    for (int i = 0; i < kPipelineStageCount; i++) {
+      durations_[i].reserve(iterations);
+    }
+    totals_.reserve(iterations);
+  }
+
+  void RecordTotal(std::chrono::steady_clock::time_point begin, uint64_t allocationsBegin) {
+    totals_.push_back(Elapsed(begin));
+    totalAllocations_ += AllocationCount() - allocationsBegin;
+  }
+
+  Napi::Object ToObject(Napi::Env env, bool countAllocations) {
+    Napi::Object stages = Napi::Object::New(env);
+    for (int i = 0; i < kPipelineStageCount; i++) {
+      stages.Set(PipelineStageName(static_cast<PipelineStage>(i)),
+                 Summarize(env, durations_[i], allocations_[i], countAllocations));
+    }
+    stages.Set("total", Summarize(env, totals_, totalAllocations_, countAllocations));
+    return stages;
+  }
+
+private:
+  static double Elapsed(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+  }
+
+  static Napi::Object Summarize(Napi::Env env, std::vector<double>& samples, uint64_t allocations,
+                                bool countAllocations) {
+    Napi::Object summary = Napi::Object::New(env);
+    if (samples.empty()) return summary;
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double sample : samples) sum += sample;
+
+    summary.Set("meanUs", Napi::Number::New(env, sum / samples.size()));
+    summary.Set("p50Us", Napi::Number::New(env, samples[samples.size() / 2]));
+    summary.Set("p99Us", Napi::Number::New(env, samples[(samples.size() * 99) / 100]));
+    summary.Set("maxUs", Napi::Number::New(env, samples.back()));
+    if (countAllocations) {
+      summary.Set("allocsPerCall", Napi::Number::New(env, static_cast<double>(allocations) / samples.size()));
+    } else {
+      summary.Set("allocsPerCall", env.Null());
+    }
+    return summary;
+  }
+
+  std::chrono::steady_clock::time_point begin_[kPipelineStageCount];
+  uint64_t allocationsBegin_[kPipelineStageCount] = {};
+  std::vector<double> durations_[kPipelineStageCount];
+  uint64_t allocations_[kPipelineStageCount] = {};
+  std::vector<double> totals_;
+  uint64_t totalAllocations_ = 0;
+};
+
+// configure({ devices, sessionsPerDevice, processes, activeRatio, mutedRatio,
+//             enumerateCostUs, resolveCostUs })
+Napi::Value Configure(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsObject()) {
+    Napi::TypeError::New(env, "Expected an options object").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  SyntheticConfig config;
+  config.devices = static_cast<size_t>(NumberOption(options, "devices", config.devices));
+  config.sessionsPerDevice = static_cast<size_t>(NumberOption(options, "sessionsPerDevice", config.sessionsPerDevice));
+  config.processes = static_cast<size_t>(NumberOption(options, "processes", config.processes));
+  config.activeRatio = NumberOption(options, "activeRatio", config.activeRatio);
+  config.mutedRatio = NumberOption(options, "mutedRatio", config.mutedRatio);
+  config.enumerateCostUs = NumberOption(options, "enumerateCostUs", config.enumerateCostUs);
+  config.resolveCostUs = NumberOption(options, "resolveCostUs", config.resolveCostUs);
+  backend.Configure(config);
+
+  return env.Undefined();
+}
+
+// run({ iterations, direction: "capture" | "render", marshal: "objects" | "columnar" })
+Napi::Value Run(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 1000));
+  bool capture = StringOption(options, "direction", "render") == "capture";
+  bool columnar = StringOption(options, "marshal", "objects") == "columnar";
+
+  if (iterations == 0) {
+    Napi::RangeError::New(env, "iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  StageRecorder recorder;
+  recorder.Reserve(iterations);
+  size_t processCount = 0;
+
+  for (size_t i = 0; i < iterations; i++) {
+    Napi::HandleScope scope(env);
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t allocationsBegin = AllocationCount();
+
+    if (capture) {
+      AudioProcessResult result = CollectCaptureProcesses(backend, &recorder);
+      PipelineStageScope stage(&recorder, PipelineStage::Marshal);
+      AudioProcessResultToObject(env, result);
+      processCount = result.processes.size();
+    } else {
+      RenderProcessResult result = CollectRenderProcesses(backend, &recorder);
+      PipelineStageScope stage(&recorder, PipelineStage::Marshal);
+      if (columnar) {
+        RenderProcessResultToColumns(env, result, benchStringTable, benchStringTable.Version());
+      } else {
+        RenderProcessResultToObject(env, result);
+      }
+      processCount = result.processes.size();
+    }
+
+    recorder.RecordTotal(begin, allocationsBegin);
+  }
+
+  const SyntheticConfig& config = backend.Config();
+  bool countAllocations = AllocationCountingAvailable();
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("devices", Napi::Number::New(env, static_cast<double>(config.devices)));
+  report.Set("sessions", Napi::Number::New(env, static_cast<double>(config.devices * config.sessionsPerDevice)));
+  report.Set("processes", Napi::Number::New(env, static_cast<double>(processCount)));
+  report.Set("iterations", Napi::Number::New(env, static_cast<double>(iterations)));
+  report.Set("allocationCounting", Napi::Boolean::New(env, countAllocations));
+  report.Set("stages", recorder.ToObject(env, countAllocations));
+  return report;
+}
+
+// statsOverhead({ iterations, direction }): runs the pipeline against the
+// synthetic backend with and without the getStats() observer, interleaved
+// in blocks so drift affects both alike, and times a bare stage scope
+Napi::Value StatsOverhead(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 1000));
+  bool capture = StringOption(options, "direction", "render") == "capture";
+
+  if (iterations == 0) {
+    Napi::RangeError::New(env, "iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  const size_t kBlock = 50;
+  double plainUs = 0;
+  double observedUs = 0;
+  size_t runs = 0;
+
+  for (size_t done = 0; done < iterations; done += kBlock) {
+    size_t count = std::min(kBlock, iterations - done);
+    for (int observed = 0; observed < 2; observed++) {
+      PipelineObserver* observer = observed ? StatsPipelineObserver() : nullptr;
+      auto begin = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < count; i++) {
+        if (capture) {
+          CollectCaptureProcesses(backend, observer);
+        } else {
+          CollectRenderProcesses(backend, observer);
+        }
+      }
+      double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+      (observed ? observedUs : plainUs) += elapsed;
+    }
+    runs += count;
+  }
+
+  const size_t kScopes = 1000000;
+  auto scopesBegin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kScopes; i++) {
+    StatsStageScope stage(PipelineStage::Filter);
+  }
+  double scopeNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - scopesBegin).count() / kScopes;
+  ResetNativeStats();
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("enabled", Napi::Boolean::New(env, NativeStatsEnabled()));
+  report.Set("iterations", Napi::Number::New(env, static_cast<double>(runs)));
+  report.Set("plainMeanUs", Napi::Number::New(env, plainUs / runs));
+  report.Set("observedMeanUs", Napi::Number::New(env, observedUs / runs));
+  report.Set("overheadPct", Napi::Number::New(env, (observedUs - plainUs) / plainUs * 100));
+  report.Set("scopeNs", Napi::Number::New(env, scopeNs));
+  return report;
+}
+
+// combinedSnapshot({ iterations, backend: "synthetic" | "proc", procRoot }):
+// times what a caller pays for the full picture through the three separate
+// calls (input list, microphone and speakers, each enumerating and
+// marshaling on its own) against one CollectProcessAudioSnapshot. The
+// synthetic backend also reports enumerations and path resolutions per
+// iteration, and splitMatches, whether SplitProcessAudioSnapshot gives the
+// separate calls' results in their order. "proc" scans the real /proc and is
+// Linux only.
+Napi::Value CombinedSnapshotBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 1000));
+  std::string backendName = StringOption(options, "backend", "synthetic");
+
+  if (iterations == 0) {
+    Napi::RangeError::New(env, "iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  AudioBackend* selected = &backend;
+#ifdef __linux__
+  std::unique_ptr<ProcAudioBackend> procBackend;
+  if (backendName == "proc") {
+    procBackend.reset(new ProcAudioBackend(StringOption(options, "procRoot", "/proc")));
+    selected = procBackend.get();
+  }
+#endif
+  if (backendName != "synthetic" && selected == &backend) {
+    Napi::Error::New(env, "Unsupported backend: " + backendName).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t records = 0;
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("backend", Napi::String::New(env, backendName));
+
+  backend.ResetCounters();
+  report.Set("separate", TimeIterations(env, iterations, [&]() {
+    ProcessListToArray(env, CollectCaptureProcesses(*selected).processes);
+    AudioProcessResultToObject(env, CollectCaptureProcesses(*selected));
+    RenderProcessResultToObject(env, CollectRenderProcesses(*selected));
+  }));
+  double separateEnumerations = static_cast<double>(backend.EnumerateCalls()) / iterations;
+  double separateResolves = static_cast<double>(backend.ResolveCalls()) / iterations;
+
+  backend.ResetCounters();
+  report.Set("combined", TimeIterations(env, iterations, [&]() {
+    ProcessAudioSnapshot snapshot = CollectProcessAudioSnapshot(*selected);
+    ProcessAudioSnapshotToObject(env, snapshot);
+    records = snapshot.processes.size();
+  }));
+
+  if (selected == &backend) {
+    Napi::Object calls = Napi::Object::New(env);
+    calls.Set("separateEnumerations", Napi::Number::New(env, separateEnumerations));
+    calls.Set("separateResolves", Napi::Number::New(env, separateResolves));
+    calls.Set("combinedEnumerations", Napi::Number::New(env, static_cast<double>(backend.EnumerateCalls()) / iterations));
+    calls.Set("combinedResolves", Napi::Number::New(env, static_cast<double>(backend.ResolveCalls()) / iterations));
+    report.Set("calls", calls);
+
+    // The split of one snapshot has to be what the separate calls report,
+    // in the same order; only the synthetic system holds still between them
+    AudioProcessResult splitCapture;
+    RenderProcessResult splitRender;
+    SplitProcessAudioSnapshot(CollectProcessAudioSnapshot(*selected), splitCapture, splitRender);
+    AudioProcessResult capture = CollectCaptureProcesses(*selected);
+    RenderProcessResult render = CollectRenderProcesses(*selected);
+    bool renderMatches = splitRender.processes.size() == render.processes.size();
+    for (size_t i = 0; renderMatches && i < render.processes.size(); i++) {
+      renderMatches = splitRender.processes[i].processId == render.processes[i].processId &&
+                      splitRender.processes[i].deviceName == render.processes[i].deviceName;
+    }
+    report.Set("splitMatches", Napi::Boolean::New(env, splitCapture.processes == capture.processes && renderMatches));
+  }
+  report.Set("records", Napi::Number::New(env, static_cast<double>(records)));
+  return report;
+}
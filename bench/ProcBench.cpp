@@ -0,0 +1,345 @@
+// ProcBench.cpp
+//
+// Linux only: /proc walks, i.e. process tree upkeep, fd table scans and the
+// cost of the first enumeration after startup.
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../common/BackendWarmup.h"
+#include "../common/ProcessPathCache.h"
+#include "../common/SessionPipeline.h"
+#include "../linux/ProcAudioBackend.h"
+#include "../linux/ProcAudioScanner.h"
+#include "../linux/ProcessTree.h"
+#include "BenchCommon.h"
+
+static void WriteFakeProcess(const std::string& root, pid_t pid, const std::string& comm, pid_t ppid,
+                             uint64_t startTime) {
+  std::string dir = root + "/" + std::to_string(pid);
+  mkdir(dir.c_str(), 0755);
+  WriteTextFile(dir + "/stat", std::to_string(pid) + " (" + comm + ") S " + std::to_string(ppid) +
+                " 0 0 0 -1 0 0 0 0 0 0 0 0 0 20 0 1 0 " + std::to_string(startTime) + " 0 0\n");
+}
+
+static void RemoveFakeProcess(const std::string& root, pid_t pid) {
+  std::string dir = root + "/" + std::to_string(pid);
+  unlink((dir + "/stat").c_str());
+  rmdir(dir.c_str());
+}
+
+// processTree({ root, processes, rounds, churn, sessions }): writes a fake
+// /proc of `processes` entries under root, as applications started by a user
+// service manager, each with a chain of helpers below it. Every round
+// replaces `churn` renderer helpers with new PIDs and then attributes the
+// audio helper of `sessions` applications, once through a ProcessTree kept
+// in sync incrementally and once through one rebuilt by a full scan.
+// Reports the latency and stat reads per round of both, and how many
+// sessions were attributed to the wrong application.
+Napi::Value ProcessTreeBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string root = StringOption(options, "root", "");
+  size_t processes = static_cast<size_t>(NumberOption(options, "processes", 10000));
+  size_t rounds = static_cast<size_t>(NumberOption(options, "rounds", 50));
+  size_t churn = static_cast<size_t>(NumberOption(options, "churn", 20));
+  size_t sessions = static_cast<size_t>(NumberOption(options, "sessions", 32));
+
+  // app -> zygote -> utility -> audio, with a renderer below the zygote
+  const size_t kGroupSize = 5;
+  size_t groups = processes / kGroupSize;
+  if (root.empty() || rounds == 0 || groups == 0) {
+    Napi::RangeError::New(env, "root, a positive rounds and at least 5 processes are required").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  sessions = std::min(sessions, groups);
+  churn = std::min(churn, groups);
+
+  uint64_t startTime = 100;
+  WriteFakeProcess(root, 1, "systemd", 0, startTime++);
+  WriteFakeProcess(root, 2, "systemd", 1, startTime++);
+  pid_t nextPid = 100;
+  std::vector<pid_t> apps(groups), zygotes(groups), audio(groups), renderers(groups);
+  for (size_t group = 0; group < groups; group++) {
+    std::string name = "app" + std::to_string(group);
+    apps[group] = nextPid++;
+    zygotes[group] = nextPid++;
+    pid_t utility = nextPid++;
+    audio[group] = nextPid++;
+    renderers[group] = nextPid++;
+    WriteFakeProcess(root, apps[group], name, 2, startTime++);
+    WriteFakeProcess(root, zygotes[group], name + "-zygote", apps[group], startTime++);
+    WriteFakeProcess(root, utility, name + "-utility", zygotes[group], startTime++);
+    WriteFakeProcess(root, audio[group], name + "-audio", utility, startTime++);
+    WriteFakeProcess(root, renderers[group], name + "-render", zygotes[group], startTime++);
+  }
+
+  ProcessTree incremental(root);
+  int errorCode = 0;
+  std::string errorMessage;
+  auto begin = std::chrono::steady_clock::now();
+  if (!incremental.Sync(errorCode, errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  double initialSyncUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+  std::vector<double> incrementalSamples;
+  std::vector<double> rebuildSamples;
+  uint64_t incrementalReads = 0;
+  uint64_t rebuildReads = 0;
+  size_t misattributed = 0;
+  size_t churnCursor = 0;
+
+  auto attributeAll = [&](ProcessTree& tree) {
+    for (size_t group = 0; group < sessions; group++) {
+      ProcessAttribution attribution;
+      if (!tree.Attribute(audio[group], attribution) || attribution.processId != static_cast<uint32_t>(apps[group])) {
+        misattributed++;
+      }
+    }
+  };
+
+  for (size_t round = 0; round < rounds; round++) {
+    for (size_t i = 0; i < churn; i++) {
+      size_t group = churnCursor++ % groups;
+      RemoveFakeProcess(root, renderers[group]);
+      renderers[group] = nextPid++;
+      WriteFakeProcess(root, renderers[group], "app" + std::to_string(group) + "-render", zygotes[group], startTime++);
+    }
+
+    uint64_t readsBefore = incremental.Stats().statReads;
+    begin = std::chrono::steady_clock::now();
+    incremental.Sync(errorCode, errorMessage);
+    attributeAll(incremental);
+    incrementalSamples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+    incrementalReads += incremental.Stats().statReads - readsBefore;
+
+    begin = std::chrono::steady_clock::now();
+    ProcessTree rebuilt(root);
+    rebuilt.Sync(errorCode, errorMessage);
+    attributeAll(rebuilt);
+    rebuildSamples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+    rebuildReads += rebuilt.Stats().statReads;
+  }
+
+  RemoveFakeProcess(root, 1);
+  RemoveFakeProcess(root, 2);
+  for (size_t group = 0; group < groups; group++) {
+    for (pid_t pid = apps[group]; pid < apps[group] + static_cast<pid_t>(kGroupSize) - 1; pid++) RemoveFakeProcess(root, pid);
+    RemoveFakeProcess(root, renderers[group]);
+  }
+
+  auto summarize = [&](std::vector<double>& samples, uint64_t reads) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double sample : samples) sum += sample;
+    Napi::Object summary = Napi::Object::New(env);
+    summary.Set("meanUs", Napi::Number::New(env, sum / samples.size()));
+    summary.Set("p50Us", Napi::Number::New(env, samples[samples.size() / 2]));
+    summary.Set("p99Us", Napi::Number::New(env, samples[(samples.size() * 99) / 100]));
+    summary.Set("statReadsPerRound", Napi::Number::New(env, static_cast<double>(reads) / rounds));
+    return summary;
+  };
+
+  ProcessTreeStats stats = incremental.Stats();
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("processes", Napi::Number::New(env, static_cast<double>(groups * kGroupSize + 2)));
+  report.Set("initialSyncUs", Napi::Number::New(env, initialSyncUs));
+  report.Set("incremental", summarize(incrementalSamples, incrementalReads));
+  report.Set("rebuild", summarize(rebuildSamples, rebuildReads));
+  report.Set("added", Napi::Number::New(env, static_cast<double>(stats.added)));
+  report.Set("removed", Napi::Number::New(env, static_cast<double>(stats.removed)));
+  report.Set("misattributed", Napi::Number::New(env, static_cast<double>(misattributed)));
+  return report;
+}
+
+// Fake host for fdScan under root: root/proc/<pid>/fd with fdsPerProcess
+// links each, pointing at a plain file or, for every holderEvery-th PID, at
+// the PCM node root/dev/snd/pcmC0D0p, which has a running substream
+static size_t WriteFakeFdHost(const std::string& root, size_t processes, size_t fdsPerProcess, size_t holderEvery) {
+  std::string proc = root + "/proc";
+  std::string pcm = proc + "/asound/card0/pcm0p";
+  mkdir(proc.c_str(), 0755);
+  mkdir((proc + "/asound").c_str(), 0755);
+  mkdir((proc + "/asound/card0").c_str(), 0755);
+  mkdir(pcm.c_str(), 0755);
+  mkdir((pcm + "/sub0").c_str(), 0755);
+  WriteTextFile(pcm + "/info", "name: Fake Speaker\n");
+  WriteTextFile(pcm + "/sub0/status", "state: RUNNING\nowner_pid   : 100\n");
+
+  mkdir((root + "/dev").c_str(), 0755);
+  mkdir((root + "/dev/snd").c_str(), 0755);
+  std::string node = root + "/dev/snd/pcmC0D0p";
+  std::string plain = root + "/dev/plain";
+  WriteTextFile(node, "");
+  WriteTextFile(plain, "");
+
+  size_t holders = 0;
+  for (size_t i = 0; i < processes; i++) {
+    std::string pidPath = proc + "/" + std::to_string(100 + i);
+    mkdir(pidPath.c_str(), 0755);
+    mkdir((pidPath + "/fd").c_str(), 0755);
+    bool holder = holderEvery > 0 && i % holderEvery == 0;
+    for (size_t fd = 0; fd < fdsPerProcess; fd++) {
+      std::string target = holder && fd == fdsPerProcess - 1 ? node : plain;
+      if (symlink(target.c_str(), (pidPath + "/fd/" + std::to_string(fd)).c_str()) != 0) break;
+    }
+    if (holder) holders++;
+  }
+  return holders;
+}
+
+// fdScan({ root, processes, fdsPerProcess, holderEvery, threads: [...],
+// iterations } | { procRoot, threads, iterations }): times full
+// ProcAudioScanner walks, every PID's fd table included, with each thread
+// count in turn. Without procRoot a fake host is written under root first;
+// with procRoot ("/proc") the real host is scanned.
+Napi::Value FdScanBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string root = StringOption(options, "root", "");
+  std::string procRoot = StringOption(options, "procRoot", "");
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 20));
+
+  std::vector<size_t> threadCounts;
+  Napi::Value threadsOption = options.Get("threads");
+  if (threadsOption.IsArray()) {
+    Napi::Array array = threadsOption.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      threadCounts.push_back(static_cast<size_t>(array.Get(i).ToNumber().Int64Value()));
+    }
+  }
+  if (threadCounts.empty()) threadCounts.push_back(1);
+
+  if ((root.empty() && procRoot.empty()) || iterations == 0) {
+    Napi::RangeError::New(env, "root or procRoot, and a positive iterations, are required").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string devSnd = "/dev/snd";
+  double holders = -1;
+  if (procRoot.empty()) {
+    size_t processes = static_cast<size_t>(NumberOption(options, "processes", 10000));
+    size_t fdsPerProcess = static_cast<size_t>(NumberOption(options, "fdsPerProcess", 16));
+    size_t holderEvery = static_cast<size_t>(NumberOption(options, "holderEvery", 1000));
+    holders = static_cast<double>(WriteFakeFdHost(root, processes, fdsPerProcess, holderEvery));
+    procRoot = root + "/proc";
+    devSnd = root + "/dev/snd";
+  }
+
+  Napi::Array runs = Napi::Array::New(env, threadCounts.size());
+  for (size_t run = 0; run < threadCounts.size(); run++) {
+    ProcAudioScanner scanner(procRoot, threadCounts[run], devSnd);
+    std::vector<PcmSession> sessions;
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    for (size_t i = 0; i < iterations; i++) {
+      int errorCode = 0;
+      std::string errorMessage;
+      scanner.Invalidate();
+      auto begin = std::chrono::steady_clock::now();
+      bool ok = scanner.Scan(sessions, errorCode, errorMessage);
+      samples.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+      if (!ok) {
+        Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+        return env.Null();
+      }
+    }
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double sample : samples) sum += sample;
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("threads", Napi::Number::New(env, static_cast<double>(scanner.Threads())));
+    result.Set("meanUs", Napi::Number::New(env, sum / samples.size()));
+    result.Set("p50Us", Napi::Number::New(env, samples[samples.size() / 2]));
+    result.Set("p99Us", Napi::Number::New(env, samples[(samples.size() * 99) / 100]));
+    result.Set("walkedPids", Napi::Number::New(env, static_cast<double>(scanner.LastWalkedPidCount())));
+    result.Set("sessions", Napi::Number::New(env, static_cast<double>(sessions.size())));
+    runs.Set(run, result);
+  }
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("procRoot", Napi::String::New(env, procRoot));
+  if (holders >= 0) {
+    report.Set("expectedSessions", Napi::Number::New(env, holders));
+  } else {
+    report.Set("expectedSessions", env.Null());
+  }
+  report.Set("runs", runs);
+  return report;
+}
+
+// coldStart({ procRoot, iterations }): what the first enumeration after
+// startup costs against the ones after it, and what a prewarm buys back.
+// Each iteration starts from a new ProcAudioBackend and an empty resolver
+// cache and times:
+//   cold       constructing the backend plus its first snapshot
+//   warm       the snapshot right after
+//   prewarm    WarmAudioBackend on a background thread, as prewarm() runs it
+//   prewarmed  the first snapshot once that thread is done
+// Scans the real /proc, so any Linux host can run it, with or without sound.
+Napi::Value ColdStartBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string procRoot = StringOption(options, "procRoot", "/proc");
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 20));
+
+  if (iterations == 0) {
+    Napi::RangeError::New(env, "iterations must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::vector<double> cold, warm, prewarm, prewarmed;
+  size_t sessions = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    SharedProcessPathCache().Clear();
+    auto begin = std::chrono::steady_clock::now();
+    std::unique_ptr<ProcAudioBackend> procBackend(new ProcAudioBackend(procRoot));
+    ProcessAudioSnapshot snapshot = CollectProcessAudioSnapshot(*procBackend);
+    cold.push_back(MicrosSince(begin));
+    if (!snapshot.success) {
+      Napi::Error::New(env, snapshot.errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    sessions = snapshot.processes.size();
+
+    begin = std::chrono::steady_clock::now();
+    CollectProcessAudioSnapshot(*procBackend);
+    warm.push_back(MicrosSince(begin));
+
+    SharedProcessPathCache().Clear();
+    procBackend.reset();
+    std::thread warmer([&]() {
+      auto warmBegin = std::chrono::steady_clock::now();
+      procBackend.reset(new ProcAudioBackend(procRoot));
+      BackendWarmup warmup;
+      WarmAudioBackend(*procBackend, warmup);
+      prewarm.push_back(MicrosSince(warmBegin));
+    });
+    warmer.join();
+
+    begin = std::chrono::steady_clock::now();
+    CollectProcessAudioSnapshot(*procBackend);
+    prewarmed.push_back(MicrosSince(begin));
+  }
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("procRoot", Napi::String::New(env, procRoot));
+  report.Set("processes", Napi::Number::New(env, static_cast<double>(sessions)));
+  report.Set("cold", SummarizeSamples(env, cold));
+  report.Set("warm", SummarizeSamples(env, warm));
+  report.Set("prewarm", SummarizeSamples(env, prewarm));
+  report.Set("prewarmed", SummarizeSamples(env, prewarmed));
+  return report;
+}
@@ -0,0 +1,188 @@
+// PulseBench.cpp
+//
+// Linux only: harnesses that need a running PulseAudio or PipeWire server.
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../linux/ProcAudioBackend.h"
+#include "../linux/PulseCaptureSource.h"
+#include "../linux/PulseSessionBackend.h"
+#include "BenchCommon.h"
+
+// pulseLatency({ source, iterations, timeoutMs, polls }): against a running
+// PulseAudio or PipeWire server, opens and closes a record stream on source
+// `iterations` times and reports how long after each open and close the
+// subscribed session backend published a session list that reflects it,
+// measured from the open call and from its return. Also times one
+// Enumerate() of the cached list against one /proc scan, the cost every
+// poll of the previous backend paid. Throws when no server is reachable.
+Napi::Value PulseLatencyBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string source = StringOption(options, "source", "default");
+  size_t iterations = static_cast<size_t>(NumberOption(options, "iterations", 50));
+  auto timeout = std::chrono::milliseconds(static_cast<int64_t>(NumberOption(options, "timeoutMs", 2000)));
+  size_t polls = static_cast<size_t>(NumberOption(options, "polls", 200));
+  if (iterations == 0 || polls == 0) {
+    Napi::RangeError::New(env, "iterations and polls must be positive").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  PulseSessionBackend backend;
+  long errorCode = 0;
+  std::string errorMessage;
+  if (!backend.Connect(errorCode, errorMessage)) {
+    Napi::Error err = Napi::Error::New(env, errorMessage);
+    err.Set("code", Napi::Number::New(env, errorCode));
+    err.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::mutex mutex;
+  std::condition_variable published;
+  std::chrono::steady_clock::time_point publishedAt;
+  PulseSessionBackend::ListenerId listener = backend.AddListener([&](std::chrono::steady_clock::time_point) {
+    std::lock_guard<std::mutex> lock(mutex);
+    publishedAt = std::chrono::steady_clock::now();
+    published.notify_all();
+  });
+
+  // Waits for a published list in which this process does or does not have
+  // a capture stream; false on timeout
+  const uint32_t self = static_cast<uint32_t>(getpid());
+  auto hasOwnStream = [&]() {
+    std::vector<SoundServerStream> streams;
+    long code = 0;
+    std::string message;
+    backend.Streams(streams, code, message);
+    for (const SoundServerStream& stream : streams) {
+      if (stream.processId == self && stream.direction == AudioDirection::Capture) return true;
+    }
+    return false;
+  };
+  auto waitFor = [&](bool present, std::chrono::steady_clock::time_point& at) {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      lock.unlock();
+      bool matches = hasOwnStream() == present;
+      lock.lock();
+      if (matches) {
+        at = publishedAt;
+        return true;
+      }
+      if (published.wait_until(lock, deadline) == std::cv_status::timeout) return false;
+    }
+  };
+
+  PcmFormat format;
+  format.sampleFormat = SampleFormat::Int16;
+  format.sampleRate = 48000;
+  format.channels = 1;
+  std::vector<double> fromOpen;
+  std::vector<double> fromOpened;
+  std::vector<double> fromClose;
+  size_t timeouts = 0;
+  for (size_t i = 0; i < iterations; i++) {
+    auto openAt = std::chrono::steady_clock::now();
+    std::unique_ptr<PcmSource> stream = PulseCaptureSource::Open(source, format, 10, errorCode, errorMessage);
+    auto openedAt = std::chrono::steady_clock::now();
+    if (!stream) {
+      backend.RemoveListener(listener);
+      Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+
+    std::chrono::steady_clock::time_point seenAt;
+    if (waitFor(true, seenAt)) {
+      // A list published before the open returned counts from the return
+      fromOpen.push_back(std::chrono::duration<double, std::micro>(seenAt - openAt).count());
+      fromOpened.push_back(std::max(0.0, std::chrono::duration<double, std::micro>(seenAt - openedAt).count()));
+    } else {
+      timeouts++;
+    }
+
+    auto closeAt = std::chrono::steady_clock::now();
+    stream.reset();
+    if (waitFor(false, seenAt)) {
+      fromClose.push_back(std::chrono::duration<double, std::micro>(seenAt - closeAt).count());
+    } else {
+      timeouts++;
+    }
+  }
+  backend.RemoveListener(listener);
+
+  ProcAudioBackend procBackend;
+  std::vector<AudioDevice> devices;
+  std::vector<AudioSession> sessions;
+  Napi::Object pollCost = Napi::Object::New(env);
+  pollCost.Set("cached", TimeIterations(env, polls, [&]() {
+    devices.clear();
+    sessions.clear();
+    backend.Enumerate(devices, sessions, errorCode, errorMessage);
+  }));
+  pollCost.Set("proc", TimeIterations(env, polls, [&]() {
+    devices.clear();
+    sessions.clear();
+    procBackend.Enumerate(devices, sessions, errorCode, errorMessage);
+  }));
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("source", Napi::String::New(env, source));
+  report.Set("openToEvent", SummarizeSamples(env, fromOpen));
+  report.Set("openedToEvent", SummarizeSamples(env, fromOpened));
+  report.Set("closeToEvent", SummarizeSamples(env, fromClose));
+  report.Set("timeouts", Napi::Number::New(env, static_cast<double>(timeouts)));
+  report.Set("refreshes", Napi::Number::New(env, static_cast<double>(backend.Generation())));
+  report.Set("pollCost", pollCost);
+  return report;
+}
+
+// pulseSession(): a PulseSessionBackend of its own, for checks that need to
+// act on the server between calls, e.g. drop the connection with pactl.
+// Returns { readActivity(), connected(), close() }; readActivity() returns
+// { success, signature, active } or { success, code, error } as the first
+// probe tier sees it.
+Napi::Value PulseSessionBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<std::unique_ptr<PulseSessionBackend>> backend =
+    std::make_shared<std::unique_ptr<PulseSessionBackend>>(new PulseSessionBackend());
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("readActivity", Napi::Function::New(env, [backend](const Napi::CallbackInfo& info) -> Napi::Value {
+    Napi::Env env = info.Env();
+    if (!*backend) {
+      Napi::Error::New(env, "The session is closed").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    ActivitySample sample;
+    long errorCode = 0;
+    std::string errorMessage;
+    Napi::Object result = Napi::Object::New(env);
+    bool success = (*backend)->ReadActivity(sample, errorCode, errorMessage);
+    result.Set("success", Napi::Boolean::New(env, success));
+    if (success) {
+      result.Set("signature", Napi::String::New(env, sample.signature));
+      result.Set("active", Napi::Boolean::New(env, sample.active));
+    } else {
+      result.Set("code", Napi::Number::New(env, errorCode));
+      result.Set("error", Napi::String::New(env, errorMessage));
+    }
+    return result;
+  }, "readActivity"));
+  handle.Set("connected", Napi::Function::New(env, [backend](const Napi::CallbackInfo& info) -> Napi::Value {
+    return Napi::Boolean::New(info.Env(), *backend && (*backend)->Connected());
+  }, "connected"));
+  handle.Set("close", Napi::Function::New(env, [backend](const Napi::CallbackInfo& info) -> Napi::Value {
+    backend->reset();
+    return info.Env().Undefined();
+  }, "close"));
+  return handle;
+}
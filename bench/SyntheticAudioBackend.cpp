@@ -0,0 +1,80 @@
+// SyntheticAudioBackend.cpp
+//
+
+#include "SyntheticAudioBackend.h"
+
+#include <chrono>
+#include <cstdio>
+
+static const uint32_t kFirstProcessId = 1000;
+
+SyntheticAudioBackend::SyntheticAudioBackend(const SyntheticConfig& config)
+    : enumerateCalls_(0), resolveCalls_(0) {
+    Configure(config);
+}
+
+void SyntheticAudioBackend::ResetCounters() {
+    enumerateCalls_ = 0;
+    resolveCalls_ = 0;
+}
+
+static void BusyWait(double costUs) {
+    if (costUs <= 0) return;
+    auto until = std::chrono::steady_clock::now() + std::chrono::duration<double, std::micro>(costUs);
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+void SyntheticAudioBackend::Configure(const SyntheticConfig& config) {
+    config_ = config;
+    if (config_.processes == 0) config_.processes = 1;
+}
+
+// Spreads a ratio evenly over session indices without needing an RNG
+static bool Selected(size_t index, double ratio) {
+    size_t bucket = (index * 37) % 100;
+    return bucket < static_cast<size_t>(ratio * 100.0);
+}
+
+bool SyntheticAudioBackend::Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                                      long& errorCode, std::string& errorMessage) {
+    (void)errorCode;
+    (void)errorMessage;
+    enumerateCalls_++;
+    BusyWait(config_.enumerateCostUs);
+
+    for (size_t d = 0; d < config_.devices; d++) {
+        char id[32];
+        char name[64];
+        bool capture = d % 2 == 0;
+        snprintf(id, sizeof(id), "synthetic:%zu", d);
+        snprintf(name, sizeof(name), "%s %zu (Synthetic)", capture ? "Microphone" : "Speakers", d / 2);
+
+        AudioDevice device;
+        device.id = id;
+        device.name = name;
+        device.direction = capture ? AudioDirection::Capture : AudioDirection::Render;
+        devices.push_back(device);
+
+        for (size_t s = 0; s < config_.sessionsPerDevice; s++) {
+            size_t index = d * config_.sessionsPerDevice + s;
+
+            AudioSession session;
+            session.processId = kFirstProcessId + static_cast<uint32_t>(index % config_.processes);
+            session.deviceIndex = d;
+            session.isActive = Selected(index, config_.activeRatio);
+            session.isMuted = !capture && Selected(index + 50, config_.mutedRatio);
+            sessions.push_back(session);
+        }
+    }
+
+    return true;
+}
+
+std::string SyntheticAudioBackend::ResolveProcessPath(uint32_t processId) {
+    resolveCalls_++;
+    BusyWait(config_.resolveCostUs);
+    char path[128];
+    uint32_t app = (processId - kFirstProcessId) % 64;
+    snprintf(path, sizeof(path), "/opt/synthetic/app%u/bin/app%u-helper-%u", app, app, processId);
+    return path;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "../common/AudioBackend.h"
+
+// Shape of the simulated audio system: `devices` endpoints alternating
+// capture/render, `sessionsPerDevice` sessions on each, spread round-robin
+// over `processes` distinct PIDs.
+struct SyntheticConfig {
+    size_t devices;
+    size_t sessionsPerDevice;
+    size_t processes;
+    double activeRatio;  // Fraction of sessions in the active state
+    double mutedRatio;   // Fraction of render sessions that are muted
+    double enumerateCostUs;  // Busy work per Enumerate(), standing in for a real backend's walk
+    double resolveCostUs;    // Busy work per ResolveProcessPath()
+
+    SyntheticConfig()
+        : devices(4), sessionsPerDevice(16), processes(32), activeRatio(0.5), mutedRatio(0.1),
+          enumerateCostUs(0), resolveCostUs(0) {}
+};
+
+// Deterministic in-memory backend for benchmarks; needs no audio hardware
+class SyntheticAudioBackend : public AudioBackend {
+public:
+    explicit SyntheticAudioBackend(const SyntheticConfig& config = SyntheticConfig());
+
+    void Configure(const SyntheticConfig& config);
+    const SyntheticConfig& Config() const { return config_; }
+
+    bool Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                   long& errorCode, std::string& errorMessage) override;
+
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+    // Calls since construction or the last ResetCounters()
+    size_t EnumerateCalls() const { return enumerateCalls_; }
+    size_t ResolveCalls() const { return resolveCalls_; }
+    void ResetCounters();
+
+private:
+    SyntheticConfig config_;
+    size_t enumerateCalls_;
+    size_t resolveCalls_;
+};
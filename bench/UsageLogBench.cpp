@@ -0,0 +1,121 @@
+// UsageLogBench.cpp
+//
+
+#include <chrono>
+#include <vector>
+#include "../linux/UsageLog.h"
+#include "BenchCommon.h"
+
+// usageLog({ path, transitions, apps, devices, stepMs, batch, maxBytes,
+// maxFiles, queries }): appends a synthetic history of apps toggling devices
+// to a UsageLog at path, flushing every batch edges as the watcher does per
+// delta, then times queryUsage over the whole history, over its last tenth,
+// and for a single app. Times are synthetic, stepMs apart.
+Napi::Value UsageLogBench(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  Napi::Object options = info.Length() > 0 && info[0].IsObject() ? info[0].As<Napi::Object>() : Napi::Object::New(env);
+  std::string path = StringOption(options, "path", "");
+  size_t transitions = static_cast<size_t>(NumberOption(options, "transitions", 200000));
+  size_t apps = static_cast<size_t>(NumberOption(options, "apps", 40));
+  size_t devices = static_cast<size_t>(NumberOption(options, "devices", 4));
+  uint64_t stepMs = static_cast<uint64_t>(NumberOption(options, "stepMs", 1000));
+  size_t batch = static_cast<size_t>(NumberOption(options, "batch", 4));
+  size_t queries = static_cast<size_t>(NumberOption(options, "queries", 20));
+  UsageLogOptions logOptions;
+  logOptions.maxBytes = static_cast<size_t>(NumberOption(options, "maxBytes", static_cast<double>(logOptions.maxBytes)));
+  logOptions.maxFiles = static_cast<size_t>(NumberOption(options, "maxFiles", static_cast<double>(logOptions.maxFiles)));
+
+  if (path.empty() || transitions == 0 || apps == 0 || devices == 0 || batch == 0 || queries == 0) {
+    Napi::RangeError::New(env, "path, and positive transitions, apps, devices, batch and queries, are required")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::vector<std::string> appNames;
+  std::vector<std::string> deviceNames;
+  for (size_t i = 0; i < apps; i++) appNames.push_back("/usr/lib/app" + std::to_string(i) + "/bin/app" + std::to_string(i));
+  for (size_t i = 0; i < devices; i++) deviceNames.push_back("Device " + std::to_string(i));
+
+  UsageLogWriter writer;
+  const uint64_t startMs = 1700000000000ULL;
+  int errorCode = 0;
+  std::string errorMessage;
+  if (!writer.Open(path, logOptions, startMs, errorCode, errorMessage)) {
+    Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Each step toggles one (app, device, direction), so every call is an edge
+  std::vector<bool> active(apps * devices * 2, false);
+  uint32_t seed = 12345;
+  uint64_t timeMs = startMs;
+  size_t activeCount = 0;
+  double activeSum = 0;
+  auto begin = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < transitions; i++) {
+    seed = seed * 1103515245u + 12345u;
+    size_t slot = (seed >> 8) % active.size();
+    active[slot] = !active[slot];
+    if (active[slot]) {
+      activeCount++;
+    } else {
+      activeCount--;
+    }
+    activeSum += static_cast<double>(activeCount);
+    writer.Record(timeMs, appNames[slot / (devices * 2)], deviceNames[(slot / 2) % devices],
+                  slot % 2 ? AudioDirection::Render : AudioDirection::Capture, active[slot]);
+    if ((i + 1) % batch == 0) writer.Flush();
+    timeMs += stepMs;
+  }
+  writer.Flush();
+  double appendMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+  UsageLogStats stats = writer.Stats();
+
+  Napi::Object append = Napi::Object::New(env);
+  append.Set("transitions", Napi::Number::New(env, static_cast<double>(stats.transitions)));
+  append.Set("totalMs", Napi::Number::New(env, appendMs));
+  append.Set("nsPerTransition", Napi::Number::New(env, appendMs * 1e6 / transitions));
+  append.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytesWritten)));
+  append.Set("bytesPerTransition", Napi::Number::New(env, static_cast<double>(stats.bytesWritten) / stats.transitions));
+  append.Set("rotations", Napi::Number::New(env, static_cast<double>(stats.rotations)));
+  append.Set("meanActive", Napi::Number::New(env, activeSum / transitions));
+
+  // Queries run while the writer is still open, as they would in production
+  struct Window {
+    const char* name;
+    uint64_t fromMs;
+    std::string process;
+  };
+  std::vector<Window> windows = {
+    { "all", 0, "" },
+    { "lastTenth", timeMs - (timeMs - startMs) / 10, "" },
+    { "oneApp", 0, "app0" },
+  };
+
+  Napi::Object queryReport = Napi::Object::New(env);
+  for (const Window& window : windows) {
+    std::vector<AppUsage> usage;
+    UsageQueryStats queryStats;
+    bool ok = true;
+    Napi::Object timing = TimeIterations(env, queries, [&]() {
+      ok = QueryUsageLog(path, window.fromMs, timeMs, window.process, timeMs, usage, queryStats,
+                         errorCode, errorMessage) && ok;
+    });
+    if (!ok) {
+      Napi::Error::New(env, errorMessage).ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    timing.Set("apps", Napi::Number::New(env, static_cast<double>(usage.size())));
+    timing.Set("filesRead", Napi::Number::New(env, static_cast<double>(queryStats.filesRead)));
+    timing.Set("filesSkipped", Napi::Number::New(env, static_cast<double>(queryStats.filesSkipped)));
+    timing.Set("bytesScanned", Napi::Number::New(env, static_cast<double>(queryStats.bytesScanned)));
+    timing.Set("records", Napi::Number::New(env, static_cast<double>(queryStats.records)));
+    queryReport.Set(window.name, timing);
+  }
+
+  Napi::Object report = Napi::Object::New(env);
+  report.Set("append", append);
+  report.Set("query", queryReport);
+  return report;
+}
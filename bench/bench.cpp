@@ -0,0 +1,34 @@
+// bench.cpp
+//
+// Benchmark addon: drives the portable enumeration pipeline against a
+// synthetic backend, and the monitor, context, level and Linux backend code
+// against fakes or the live system, reporting latency and allocations. The
+// harnesses live in one file per area; see BenchCommon.h.
+
+#include <napi.h>
+#include "BenchCommon.h"
+
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  exports.Set("configure", Napi::Function::New(env, Configure));
+  exports.Set("run", Napi::Function::New(env, Run));
+  exports.Set("hubFanout", Napi::Function::New(env, HubFanout));
+  exports.Set("queueStress", Napi::Function::New(env, QueueStress));
+  exports.Set("statsOverhead", Napi::Function::New(env, StatsOverhead));
+  exports.Set("tieredProbe", Napi::Function::New(env, TieredProbeBench));
+  exports.Set("combinedSnapshot", Napi::Function::New(env, CombinedSnapshotBench));
+  exports.Set("levelKernels", Napi::Function::New(env, LevelKernelsBench));
+  exports.Set("audioContext", Napi::Function::New(env, AudioContextBench));
+#ifdef __linux__
+  exports.Set("probeCaptureDevices", Napi::Function::New(env, ProbeCaptureDevicesBench));
+  exports.Set("hotplug", Napi::Function::New(env, HotplugBench));
+  exports.Set("processTree", Napi::Function::New(env, ProcessTreeBench));
+  exports.Set("fdScan", Napi::Function::New(env, FdScanBench));
+  exports.Set("usageLog", Napi::Function::New(env, UsageLogBench));
+  exports.Set("pulseLatency", Napi::Function::New(env, PulseLatencyBench));
+  exports.Set("pulseSession", Napi::Function::New(env, PulseSessionBench));
+  exports.Set("coldStart", Napi::Function::New(env, ColdStartBench));
+#endif
+  return exports;
+}
+
+NODE_API_MODULE(bench, Init)
@@ -0,0 +1,115 @@
+/**
+ * Reports what the first enumeration after startup costs against the calls
+ * after it, and what prewarm() buys back. Each run forks a fresh process
+ * that times require() of the package (the native module now loads on first
+ * use), then either calls getAudioSnapshot() straight away (cold) or awaits
+ * prewarm() first (prewarmed), and times a second call as well (warm).
+ *
+ * On Linux it also runs the `bench` addon's coldStart, which times the same
+ * steps natively against a fresh /proc backend and an empty resolver cache,
+ * without the module load; any Linux host can run both, with or without a
+ * sound server.
+ *
+ * Usage: node bench/coldstart.js [--runs N] [--iterations I]
+ */
+
+const { fork } = require('child_process');
+const path = require('path');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = argv[i + 1];
+  }
+  return args;
+}
+
+function elapsedMs(start) {
+  return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+async function child(mode) {
+  let start = process.hrtime.bigint();
+  const utils = require(path.join(__dirname, '..', 'index.js'));
+  const report = { requireMs: elapsedMs(start), prewarmMs: null, warmup: null };
+
+  if (mode === 'prewarmed') {
+    start = process.hrtime.bigint();
+    report.warmup = await utils.prewarm();
+    report.prewarmMs = elapsedMs(start);
+  }
+
+  start = process.hrtime.bigint();
+  const first = utils.getAudioSnapshot();
+  report.firstMs = elapsedMs(start);
+  start = process.hrtime.bigint();
+  utils.getAudioSnapshot();
+  report.warmMs = elapsedMs(start);
+  report.success = first.success;
+  process.send(report);
+}
+
+function runChild(mode) {
+  return new Promise((resolve, reject) => {
+    const worker = fork(__filename, ['--child', mode]);
+    let report = null;
+    worker.on('message', (message) => (report = message));
+    worker.on('error', reject);
+    worker.on('exit', (code) => (report ? resolve(report) : reject(new Error(`${mode} run exited with ${code}`))));
+  });
+}
+
+function median(values) {
+  const sorted = values.filter((value) => value !== null).sort((a, b) => a - b);
+  return sorted.length ? sorted[Math.floor(sorted.length / 2)] : null;
+}
+
+function format(ms) {
+  return ms === null ? '       -' : ms.toFixed(2).padStart(8);
+}
+
+async function main() {
+  const args = parseArgs(process.argv.slice(2));
+  if (args.child) return child(args.child);
+
+  const runs = Number(args.runs) || 10;
+  console.log(`End to end, median of ${runs} fresh processes per mode (ms):`);
+  console.log('  mode        require   prewarm     first      warm');
+  for (const mode of ['cold', 'prewarmed']) {
+    const reports = [];
+    for (let i = 0; i < runs; i++) reports.push(await runChild(mode));
+    console.log(
+      `  ${mode.padEnd(10)} ${format(median(reports.map((r) => r.requireMs)))}  ` +
+      `${format(median(reports.map((r) => r.prewarmMs)))}  ${format(median(reports.map((r) => r.firstMs)))}  ` +
+      `${format(median(reports.map((r) => r.warmMs)))}`
+    );
+    if (mode === 'prewarmed') console.log('  last warm-up:', reports[reports.length - 1].warmup);
+  }
+
+  let bench = null;
+  try {
+    bench = require('bindings')('bench.node');
+  } catch (error) {
+    console.log('\nbench addon not built; skipping the native comparison');
+    return;
+  }
+  if (!bench.coldStart) {
+    console.log('\ncoldStart is only built on Linux');
+    return;
+  }
+
+  const report = bench.coldStart({ iterations: Number(args.iterations) || 20 });
+  console.log(`\nNative, fresh backend over ${report.procRoot} (${report.processes} processes with audio, us):`);
+  for (const name of ['cold', 'warm', 'prewarm', 'prewarmed']) {
+    const stage = report[name];
+    console.log(
+      `  ${name.padEnd(10)} mean ${stage.meanUs.toFixed(1).padStart(10)}   p50 ${stage.p50Us.toFixed(1).padStart(10)}   ` +
+      `p99 ${stage.p99Us.toFixed(1).padStart(10)}`
+    );
+  }
+}
+
+main().catch((error) => {
+  console.error(error);
+  process.exit(1);
+});
@@ -0,0 +1,72 @@
+/**
+ * Compares getAudioSnapshot()'s single pass with the three separate calls a
+ * caller needed before (input list, microphone and speakers). Runs the
+ * portable pipeline in the `bench` addon against the synthetic backend, with
+ * busy work standing in for a real enumeration and path lookup, and on Linux
+ * against the real /proc backend as well. Fails when splitting the snapshot
+ * does not give the separate calls' results, in their order.
+ *
+ * Usage: node bench/combined.js [--iterations N] [--enumerate-cost-us US] [--resolve-cost-us US]
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const iterations = args.iterations || 500;
+let failed = false;
+
+function printReport(title, report) {
+  console.log(`\n${title}: ${report.records} process records`);
+  for (const name of ['separate', 'combined']) {
+    const timing = report[name];
+    console.log(
+      `  ${name.padEnd(9)} mean ${timing.meanUs.toFixed(1).padStart(9)} us   ` +
+      `p50 ${timing.p50Us.toFixed(1).padStart(9)} us   p99 ${timing.p99Us.toFixed(1).padStart(9)} us`
+    );
+  }
+  if (report.calls) {
+    const calls = report.calls;
+    console.log(
+      `  per iteration: ${calls.separateEnumerations} enumerations and ${calls.separateResolves} path lookups ` +
+      `separately, ${calls.combinedEnumerations} and ${calls.combinedResolves} combined`
+    );
+  }
+  console.log(`  speedup ${(report.separate.meanUs / report.combined.meanUs).toFixed(2)}x`);
+  if (report.splitMatches === false) {
+    console.error('  FAIL: the split snapshot does not match the separate calls');
+    failed = true;
+  }
+}
+
+const systems = [
+  { devices: 2, sessionsPerDevice: 8, processes: 8 },
+  { devices: 8, sessionsPerDevice: 64, processes: 64 },
+];
+
+for (const system of systems) {
+  bench.configure(Object.assign({
+    enumerateCostUs: args['enumerate-cost-us'] !== undefined ? args['enumerate-cost-us'] : 200,
+    resolveCostUs: args['resolve-cost-us'] !== undefined ? args['resolve-cost-us'] : 5,
+  }, system));
+  printReport(
+    `synthetic, ${system.devices} devices x ${system.sessionsPerDevice} sessions x ${system.processes} processes`,
+    bench.combinedSnapshot({ iterations })
+  );
+}
+
+if (process.platform === 'linux') {
+  printReport('/proc backend', bench.combinedSnapshot({ iterations, backend: 'proc' }));
+}
+
+// Leave the shared synthetic backend as other benches expect it
+bench.configure({});
+
+process.exit(failed ? 1 : 0);
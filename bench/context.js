@@ -0,0 +1,66 @@
+/**
+ * Compares one-shot queries, each building and tearing down its backend,
+ * with repeated queries of one long-lived AudioContext in the `bench` addon.
+ * The fake backend runs anywhere; on Linux the /proc backend is run too, and
+ * the sound server backend when a server is reachable.
+ * Reports time and allocations per query, how often the reused context
+ * refreshed its devices and resolved paths. On the fake backend it fails if
+ * the reused context allocates in steady state or reports different
+ * results; a real host may change between the two runs.
+ *
+ * Usage: node bench/context.js [--iterations N] [--devices D] [--sessions-per-device S] [--replug-every R]
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const backends = process.platform === 'linux' ? ['fake', 'proc', 'pulse'] : ['fake'];
+let failed = false;
+
+for (const backend of backends) {
+  let report;
+  try {
+    report = bench.audioContext({
+      backend,
+      // Every one-shot pulse query connects to the server anew
+      iterations: backend === 'pulse' ? Math.min(args.iterations || 100, 100) : args.iterations || 1000,
+      devices: args.devices || 8,
+      sessionsPerDevice: args['sessions-per-device'] || 16,
+      replugEvery: args['replug-every'] || 0,
+    });
+  } catch (error) {
+    if (backend !== 'pulse') throw error;
+    console.log(`\npulse: skipped, ${error.message}`);
+    continue;
+  }
+
+  console.log(`\n${backend}: ${report.devices} devices, ${report.processes} processes reported`);
+  for (const mode of ['oneShot', 'reused']) {
+    const stage = report[mode];
+    const allocs = stage.allocsPerQuery === null ? 'n/a' : stage.allocsPerQuery.toFixed(2);
+    console.log(
+      `  ${mode.padEnd(8)} mean ${stage.meanUs.toFixed(2).padStart(10)} us   p50 ${stage.p50Us.toFixed(2).padStart(10)} us   ` +
+      `p99 ${stage.p99Us.toFixed(2).padStart(10)} us   ${allocs} allocs/query`
+    );
+  }
+  console.log(`  reused context: ${report.refreshes} device refreshes, ${report.resolves} path resolves`);
+
+  if (backend === 'fake' && !report.resultsMatch) {
+    console.error('✗ fake: the reused context reported different results');
+    failed = true;
+  }
+  if (backend === 'fake' && !args['replug-every'] && report.reused.allocsPerQuery) {
+    console.error(`✗ fake: ${report.reused.allocsPerQuery} allocations per steady-state query, expected none`);
+    failed = true;
+  }
+}
+
+process.exit(failed ? 1 : 0);
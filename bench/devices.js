@@ -0,0 +1,86 @@
+/**
+ * Checks CaptureDeviceProbe against a fake /proc/asound tree in the `bench`
+ * addon (Linux only): every capture PCM is reported with its name, only
+ * RUNNING ones are active, playback PCMs are ignored, and probe latency is
+ * compared across worker counts.
+ *
+ * Usage: node bench/devices.js [--cards N] [--pcms M] [--iterations I]
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const bench = require('bindings')('bench.node');
+
+if (!bench.probeCaptureDevices) {
+  console.log('probeCaptureDevices is only built on Linux');
+  process.exit(0);
+}
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const cards = args.cards || 4;
+const pcms = args.pcms || 4;
+const iterations = args.iterations || 200;
+
+// card<c>/pcm<d>c with two substreams each; every third PCM is running
+function buildTree(root) {
+  const expected = [];
+  for (let card = 0; card < cards; card++) {
+    for (let device = 0; device < pcms; device++) {
+      const running = (card * pcms + device) % 3 === 0;
+      const pcmPath = path.join(root, 'asound', `card${card}`, `pcm${device}c`);
+      fs.mkdirSync(path.join(pcmPath, 'sub0'), { recursive: true });
+      fs.mkdirSync(path.join(pcmPath, 'sub1'), { recursive: true });
+      fs.writeFileSync(path.join(pcmPath, 'info'), `card: ${card}\ndevice: ${device}\nname: Mic ${card}-${device}\n`);
+      fs.writeFileSync(path.join(pcmPath, 'sub0', 'status'), 'closed\n');
+      fs.writeFileSync(
+        path.join(pcmPath, 'sub1', 'status'),
+        running ? `state: RUNNING\nowner_pid   : ${1000 + device}\n` : 'closed\n'
+      );
+
+      const playbackPath = path.join(root, 'asound', `card${card}`, `pcm${device}p`, 'sub0');
+      fs.mkdirSync(playbackPath, { recursive: true });
+      fs.writeFileSync(path.join(playbackPath, 'status'), 'state: RUNNING\nowner_pid   : 42\n');
+
+      expected.push({ id: `hw:${card},${device}`, name: `Mic ${card}-${device}`, active: running });
+    }
+  }
+  return expected;
+}
+
+const root = fs.mkdtempSync(path.join(os.tmpdir(), 'asound-'));
+let failed = false;
+
+try {
+  const expected = buildTree(root);
+  const byId = (a, b) => a.id.localeCompare(b.id);
+  expected.sort(byId);
+
+  for (const threads of [1, 2, 4]) {
+    const report = bench.probeCaptureDevices({ procRoot: root, threads, iterations });
+    const devices = report.devices.map(({ id, name, active }) => ({ id, name, active })).sort(byId);
+
+    console.log(
+      `${devices.length} capture PCMs, ${report.threads} threads: ` +
+      `mean ${report.meanUs.toFixed(1)} us, p50 ${report.p50Us.toFixed(1)} us, p99 ${report.p99Us.toFixed(1)} us`
+    );
+    if (JSON.stringify(devices) !== JSON.stringify(expected)) {
+      console.error('  FAIL: reported devices do not match the fake tree');
+      console.error('  expected', JSON.stringify(expected));
+      console.error('  got     ', JSON.stringify(devices));
+      failed = true;
+    }
+  }
+} finally {
+  fs.rmSync(root, { recursive: true, force: true });
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,68 @@
+/**
+ * Reports how the parallel /proc fd scan scales with threads in the `bench`
+ * addon (Linux only). Every iteration walks every PID's fd table, as the
+ * first scan after startup or a substream change does. By default a fake
+ * host of 10k processes is written to a temp directory; pass --real to scan
+ * this machine's /proc instead.
+ *
+ * Usage: node bench/fdscan.js [--processes N] [--fds-per-process F] [--iterations I] [--max-threads T] [--real 1]
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const bench = require('bindings')('bench.node');
+
+if (!bench.fdScan) {
+  console.log('fdScan is only built on Linux');
+  process.exit(0);
+}
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const maxThreads = args['max-threads'] || os.cpus().length;
+const threads = [];
+for (let count = 1; count < maxThreads; count *= 2) threads.push(count);
+threads.push(maxThreads);
+
+const options = { threads, iterations: args.iterations || 20 };
+let root = null;
+if (args.real) {
+  options.procRoot = '/proc';
+} else {
+  root = fs.mkdtempSync(path.join(os.tmpdir(), 'fdscan-'));
+  Object.assign(options, {
+    root,
+    processes: args.processes || 10000,
+    fdsPerProcess: args['fds-per-process'] || 16,
+  });
+}
+
+let failed = false;
+try {
+  const report = bench.fdScan(options);
+  console.log(`Full fd scans of ${report.procRoot}, ${options.iterations} iterations per thread count`);
+  const baseline = report.runs[0].meanUs;
+  for (const run of report.runs) {
+    console.log(
+      `  ${String(run.threads).padStart(2)} threads: mean ${(run.meanUs / 1000).toFixed(2).padStart(8)} ms   ` +
+      `p99 ${(run.p99Us / 1000).toFixed(2).padStart(8)} ms   ${run.walkedPids} PIDs walked, ` +
+      `${run.sessions} sessions   speedup ${(baseline / run.meanUs).toFixed(2)}x`
+    );
+    if (report.expectedSessions !== null && run.sessions !== report.expectedSessions) {
+      console.error(`✗ ${run.sessions} sessions found with ${run.threads} threads, expected ${report.expectedSessions}`);
+      failed = true;
+    }
+  }
+} finally {
+  if (root) fs.rmSync(root, { recursive: true, force: true });
+}
+
+process.exit(failed ? 1 : 0);
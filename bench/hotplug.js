@@ -0,0 +1,56 @@
+/**
+ * Plugs and unplugs a fake capture card in the `bench` addon (Linux only)
+ * and reports how long the monitor takes to see it, first with the
+ * /dev/snd watcher waking the poller and then with polling alone.
+ *
+ * Usage: node bench/hotplug.js [--cycles N] [--interval-ms MS]
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const bench = require('bindings')('bench.node');
+
+if (!bench.hotplug) {
+  console.log('hotplug is only built on Linux');
+  process.exit(0);
+}
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const cycles = args.cycles || 20;
+const intervalMs = args['interval-ms'] || 3000;
+
+const root = fs.mkdtempSync(path.join(os.tmpdir(), 'hotplug-'));
+let failed = false;
+
+try {
+  const watched = bench.hotplug({ root, cycles, intervalMs, watch: true });
+  console.log(
+    `watched: ${cycles} plugs, p50 ${watched.p50Ms.toFixed(2)} ms, p99 ${watched.p99Ms.toFixed(2)} ms, ` +
+    `re-arm p50 ${watched.rearmP50Ms.toFixed(2)} ms (${watched.rearmReports} reports), missed ${watched.missed}`
+  );
+
+  // Polling alone waits up to a full interval per plug, so only a few cycles
+  const pollCycles = Math.min(cycles, 3);
+  const polled = bench.hotplug({ root, cycles: pollCycles, intervalMs, watch: false });
+  console.log(
+    `polled:  ${pollCycles} plugs, p50 ${polled.p50Ms.toFixed(2)} ms, p99 ${polled.p99Ms.toFixed(2)} ms, missed ${polled.missed}`
+  );
+
+  if (watched.missed > 0 || watched.p99Ms >= intervalMs) {
+    console.error('  FAIL: the watcher did not pick up every plug before the next poll');
+    failed = true;
+  }
+} finally {
+  fs.rmSync(root, { recursive: true, force: true });
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,59 @@
+/**
+ * Checks MonitorHub fan-out against fake listeners in the `bench` addon:
+ * one listener per device however many subscribers it has, every event
+ * delivered to every subscriber, and listeners stopped once the last
+ * subscriber leaves. Needs no audio hardware.
+ *
+ * Usage: node bench/hub.js [--devices N] [--subscribers M] [--events E]
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const scenarios = args.devices || args.subscribers || args.events
+  ? [{ devices: args.devices || 1, subscribers: args.subscribers || 20, events: args.events || 10000 }]
+  : [
+      { devices: 1, subscribers: 1, events: 10000 },
+      { devices: 1, subscribers: 20, events: 10000 },
+      { devices: 4, subscribers: 20, events: 10000 },
+    ];
+
+let failed = false;
+
+function check(condition, message) {
+  if (!condition) {
+    console.error(`  FAIL: ${message}`);
+    failed = true;
+  }
+}
+
+for (const scenario of scenarios) {
+  const report = bench.hubFanout(scenario);
+  const deliveries = report.delivered + report.changesOnlyDelivered;
+  console.log(
+    `${report.devices} devices x ${report.subscribers} subscribers x ${report.events} events: ` +
+    `${report.listenerStarts} listeners, ${deliveries} deliveries in ${(report.elapsedUs / 1000).toFixed(1)} ms ` +
+    `(${((report.elapsedUs * 1000) / deliveries).toFixed(1)} ns/delivery)`
+  );
+
+  check(report.listenerStarts === report.devices, `started ${report.listenerStarts} listeners for ${report.devices} devices`);
+  check(report.listenersWhileSubscribed === report.devices, `${report.listenersWhileSubscribed} listeners while subscribed`);
+  check(report.delivered === report.expectedDelivered, `delivered ${report.delivered} of ${report.expectedDelivered}`);
+  check(
+    report.changesOnlyDelivered === report.expectedChangesOnlyDelivered,
+    `changesOnly delivered ${report.changesOnlyDelivered}, expected ${report.expectedChangesOnlyDelivered}`
+  );
+  check(report.rejectedMissingDevice, 'failed listener start left a subscription behind');
+  check(report.listenerStops === report.devices, `stopped ${report.listenerStops} of ${report.devices} listeners`);
+  check(report.listenersAfterUnsubscribe === 0, `${report.listenersAfterUnsubscribe} listeners left after unsubscribe`);
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,35 @@
+/**
+ * Reports the throughput of each input level kernel in the `bench` addon
+ * (scalar, and SSE2, AVX2 or NEON where the CPU runs them) over int16 and
+ * float32 PCM, and whether each matches the scalar result. For scale, one
+ * second of 48 kHz stereo audio is 96000 samples.
+ *
+ * Usage: node bench/level.js [--samples N] [--iterations I]
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const report = bench.levelKernels({
+  samples: args.samples || 96000,
+  iterations: args.iterations || 200,
+});
+
+console.log(`${report.samples} samples per block, selected kernel: ${report.selected}`);
+const scalar = report.kernels.scalar;
+for (const [name, run] of Object.entries(report.kernels)) {
+  const line = ['int16', 'float32'].map((format) => {
+    const speedup = run[format].msamplesPerSecond / scalar[format].msamplesPerSecond;
+    return `${format} ${run[format].msamplesPerSecond.toFixed(0).padStart(6)} Msamples/s (${speedup.toFixed(1)}x)`;
+  });
+  console.log(`  ${name.padEnd(7)} ${line.join('   ')}   ${run.matchesScalar ? 'matches scalar' : 'MISMATCH'}`);
+  if (!run.matchesScalar) process.exitCode = 1;
+}
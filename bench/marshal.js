@@ -0,0 +1,66 @@
+/**
+ * Compares the two marshaling paths of getProcessesAccessingSpeakersWithResult:
+ * one object per process versus typed-array columns plus a string table.
+ *
+ * Usage: node --expose-gc bench/marshal.js [iterations]
+ */
+
+const { PerformanceObserver } = require('perf_hooks');
+const { getProcessesAccessingSpeakersWithResult } = require('../index');
+
+const iterations = parseInt(process.argv[2], 10) || 2000;
+
+function measure(label, call) {
+  let gcCount = 0;
+  let gcMs = 0;
+  const observer = new PerformanceObserver((list) => {
+    for (const entry of list.getEntries()) {
+      gcCount++;
+      gcMs += entry.duration;
+    }
+  });
+  observer.observe({ entryTypes: ['gc'] });
+
+  if (global.gc) global.gc();
+  const heapBefore = process.memoryUsage().heapUsed;
+  const start = process.hrtime.bigint();
+
+  let processes = 0;
+  for (let i = 0; i < iterations; i++) {
+    processes = call();
+  }
+
+  const elapsedMs = Number(process.hrtime.bigint() - start) / 1e6;
+  const heapAfter = process.memoryUsage().heapUsed;
+
+  // Let pending GC entries arrive before reporting
+  return new Promise((resolve) => setImmediate(() => {
+    observer.disconnect();
+    console.log(
+      `${label.padEnd(10)} ${(elapsedMs * 1000 / iterations).toFixed(1).padStart(8)} us/call  ` +
+      `processes=${processes}  gc=${gcCount} (${gcMs.toFixed(1)} ms)  ` +
+      `heap delta=${((heapAfter - heapBefore) / 1024).toFixed(0)} KiB`
+    );
+    resolve();
+  }));
+}
+
+async function run() {
+  console.log(`Marshaling ${iterations} render results per mode`);
+
+  await measure('objects', () => {
+    const result = getProcessesAccessingSpeakersWithResult();
+    return result.processes.length;
+  });
+
+  let stringTableVersion = 0;
+  await measure('columnar', () => {
+    const result = getProcessesAccessingSpeakersWithResult({ columnar: true, stringTableVersion });
+    if (result.strings) {
+      stringTableVersion = result.stringTableVersion;
+    }
+    return result.processIds.length;
+  });
+}
+
+run();
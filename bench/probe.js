@@ -0,0 +1,50 @@
+/**
+ * Compares the process watcher with a fixed interval against the tiered
+ * probe scheduler, using a fake stream in the `bench` addon that opens and
+ * closes repeatedly. Reports how many expensive scans run while nothing is
+ * open and how long a change takes to reach the callback.
+ *
+ * Usage: node bench/probe.js [--cycles N] [--interval-ms MS] [--scan-cost-us US] [--max-latency-ms MS]
+ *
+ * With --max-latency-ms the run exits non-zero when the adaptive watcher's
+ * slowest change took longer than MS.
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const options = {
+  cycles: args.cycles || 10,
+  intervalMs: args['interval-ms'] || 1000,
+  scanCostUs: args['scan-cost-us'] !== undefined ? args['scan-cost-us'] : 2000,
+};
+const maxLatencyMs = args['max-latency-ms'];
+
+let failed = false;
+for (const adaptive of [false, true]) {
+  const report = bench.tieredProbe(Object.assign({ adaptive }, options));
+  console.log(
+    `${adaptive ? 'adaptive' : 'fixed   '}: idle ${report.idleScansPerSec.toFixed(2)} scans/s, ` +
+    `${report.scans} scans total, change p50 ${report.p50Ms.toFixed(1)} ms, ` +
+    `p99 ${report.p99Ms.toFixed(1)} ms, max ${report.maxMs.toFixed(1)} ms, missed ${report.missed}`
+  );
+  if (report.tiers) {
+    const { ticks, unchanged, idle, full } = report.tiers;
+    console.log(`          ${ticks} ticks: ${unchanged} unchanged, ${idle} idle, ${full} full`);
+  }
+
+  if (adaptive && maxLatencyMs !== undefined && (report.missed > 0 || report.maxMs > maxLatencyMs)) {
+    console.error(`  FAIL: a change took longer than ${maxLatencyMs} ms`);
+    failed = true;
+  }
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,103 @@
+/**
+ * Reports how quickly the PulseAudio / PipeWire session backend in the
+ * `bench` addon (Linux only) sees a stream open and close: the server pushes
+ * a subscription event, the backend refreshes its cached session list, and
+ * listeners are told. For comparison it also times one poll of the cached
+ * list against one /proc scan.
+ *
+ * Needs a running server. On a headless box, either of these will do:
+ *   pulseaudio --daemonize=no --exit-idle-time=-1 &
+ *   pipewire & pipewire-pulse & wireplumber &
+ * then add a silent sink whose monitor the bench records from:
+ *   pactl load-module module-null-sink sink_name=bench_sink
+ *
+ * Then it drops the backend's connection with `pactl kill-client` and checks
+ * that the first probe tier reconnects, or reports an error, instead of
+ * reading an idle, empty signature from then on.
+ *
+ * Usage: node bench/pulse.js [--source NAME] [--iterations N] [--polls P]
+ */
+
+const { execFileSync } = require('child_process');
+const bench = require('bindings')('bench.node');
+
+if (!bench.pulseLatency) {
+  console.log('pulseLatency is only built on Linux');
+  process.exit(0);
+}
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = argv[i + 1];
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+let report;
+try {
+  report = bench.pulseLatency({
+    source: args.source || 'bench_sink.monitor',
+    iterations: Number(args.iterations) || 50,
+    polls: Number(args.polls) || 200,
+  });
+} catch (error) {
+  console.log(`Skipped: ${error.message}. See the header of bench/pulse.js for a headless setup.`);
+  process.exit(0);
+}
+
+const format = (run) =>
+  `mean ${(run.meanUs / 1000).toFixed(2).padStart(7)} ms   p50 ${(run.p50Us / 1000).toFixed(2).padStart(7)} ms   ` +
+  `p99 ${(run.p99Us / 1000).toFixed(2).padStart(7)} ms`;
+
+console.log(`Recording from ${report.source}, ${report.refreshes} session list refreshes, ${report.timeouts} timeouts`);
+console.log(`  open call to event   ${format(report.openToEvent)}`);
+console.log(`  open return to event ${format(report.openedToEvent)}`);
+console.log(`  close to event       ${format(report.closeToEvent)}`);
+console.log('Cost of one poll:');
+console.log(`  cached session list  ${format(report.pollCost.cached)}`);
+console.log(`  /proc scan           ${format(report.pollCost.proc)}`);
+if (report.timeouts > 0) process.exitCode = 1;
+
+// Server-side indices of the clients this process has open
+function ownClients() {
+  const clients = [];
+  let index = null;
+  for (const line of execFileSync('pactl', ['list', 'clients'], { encoding: 'utf8' }).split('\n')) {
+    const header = line.match(/^Client #(\d+)/);
+    if (header) index = header[1];
+    if (index !== null && line.includes(`application.process.id = "${process.pid}"`)) clients.push(index);
+  }
+  return clients;
+}
+
+function sleep(ms) {
+  Atomics.wait(new Int32Array(new SharedArrayBuffer(4)), 0, 0, ms);
+}
+
+const session = bench.pulseSession();
+const before = session.readActivity();
+try {
+  if (!before.success) throw new Error(before.error);
+  for (const client of ownClients()) execFileSync('pactl', ['kill-client', client]);
+} catch (error) {
+  console.log(`Reconnect check skipped: ${error.message}`);
+  session.close();
+  process.exit(process.exitCode || 0);
+}
+
+for (let waited = 0; session.connected() && waited < 2000; waited += 10) sleep(10);
+const dropped = !session.connected();
+const after = session.readActivity();
+session.close();
+
+if (!dropped) {
+  console.error('Reconnect: FAIL, the connection did not drop');
+  process.exitCode = 1;
+} else if (after.success ? after.signature === '' || after.signature === before.signature : !after.code) {
+  console.error('Reconnect: FAIL, the first tier neither reconnected nor reported an error', after);
+  process.exitCode = 1;
+} else {
+  console.log(`Reconnect: ${after.success ? 'reconnected, new signature ' + after.signature : 'error ' + after.code + ': ' + after.error}`);
+}
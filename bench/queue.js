@@ -0,0 +1,53 @@
+/**
+ * Stress test for MonitorEventQueue in the `bench` addon: a producer thread
+ * floods the queue while a consumer drains it, optionally slowed down to
+ * imitate a busy JS thread. Checks that every event is accounted for as
+ * delivered, merged or dropped, and that the consumer ends up with the last
+ * pushed state of every device. Needs no audio hardware.
+ *
+ * Usage: node bench/queue.js [--events N] [--devices D] [--capacity C]
+ *                            [--errorEvery E] [--consumerDelayNs X]
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const scenarios = Object.keys(args).length
+  ? [args]
+  : [
+      { events: 1000000, devices: 1, capacity: 64 },
+      { events: 1000000, devices: 1, capacity: 64, errorEvery: 7 },
+      { events: 200000, devices: 4, capacity: 16, errorEvery: 5, consumerDelayNs: 2000 },
+      { events: 200000, devices: 2, capacity: 4, errorEvery: 3, consumerDelayNs: 10000 },
+    ];
+
+let failed = false;
+
+for (const scenario of scenarios) {
+  const report = bench.queueStress(scenario);
+  console.log(
+    `${report.events} events, ${report.devices} devices, capacity ${report.capacity}, ` +
+    `consumer delay ${scenario.consumerDelayNs || 0} ns: delivered ${report.delivered}, ` +
+    `merged ${report.merged}, dropped ${report.dropped}, max push ${report.maxPushNs.toFixed(0)} ns, ` +
+    `${((report.events / report.elapsedUs) * 1e6).toFixed(0)} events/s`
+  );
+
+  if (report.pushed !== report.delivered + report.merged + report.dropped) {
+    console.error('  FAIL: pushed events are not all accounted for');
+    failed = true;
+  }
+  if (!report.finalStateMatches) {
+    console.error('  FAIL: consumer did not see the last pushed state of every device');
+    failed = true;
+  }
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,91 @@
+/**
+ * Runs the session-enumeration pipeline against the synthetic backend in the
+ * `bench` addon and prints per-stage latency and allocation counts. Needs no
+ * audio hardware, so it can run on a headless build machine. The addon is
+ * only built on request: npm run build:bench (node-gyp rebuild --bench=1).
+ *
+ * Usage: node bench/run.js [--devices N] [--sessions M] [--processes K]
+ *                          [--iterations I] [--json] [--max-total-us X]
+ *
+ * Without --devices/--sessions/--processes a small, medium and large system
+ * are measured. With --max-total-us the run exits non-zero when the mean
+ * total latency of any scenario exceeds the limit.
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i++) {
+    const name = argv[i].replace(/^--/, '');
+    if (name === 'json') {
+      args.json = true;
+    } else {
+      args[name] = Number(argv[++i]);
+    }
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const iterations = args.iterations || 1000;
+
+const systems = args.devices || args.sessions || args.processes
+  ? [{ devices: args.devices || 4, sessionsPerDevice: args.sessions || 16, processes: args.processes || 32 }]
+  : [
+      { devices: 2, sessionsPerDevice: 8, processes: 8 },
+      { devices: 8, sessionsPerDevice: 64, processes: 64 },
+      { devices: 16, sessionsPerDevice: 256, processes: 512 },
+    ];
+
+const modes = [
+  { direction: 'capture', marshal: 'objects' },
+  { direction: 'render', marshal: 'objects' },
+  { direction: 'render', marshal: 'columnar' },
+];
+
+const stageNames = ['enumerate', 'filter', 'resolvePath', 'dedupe', 'marshal', 'total'];
+
+function printReport(system, mode, report) {
+  console.log(
+    `\n${system.devices} devices x ${system.sessionsPerDevice} sessions x ${system.processes} processes, ` +
+    `${mode.direction}/${mode.marshal}: ${report.processes} processes reported`
+  );
+  console.log('  stage           mean us     p50 us     p99 us   allocs/call');
+  for (const name of stageNames) {
+    const stage = report.stages[name];
+    const allocs = stage.allocsPerCall === null ? 'n/a' : stage.allocsPerCall.toFixed(1);
+    console.log(
+      `  ${name.padEnd(12)} ${stage.meanUs.toFixed(2).padStart(10)} ${stage.p50Us.toFixed(2).padStart(10)} ` +
+      `${stage.p99Us.toFixed(2).padStart(10)} ${allocs.padStart(13)}`
+    );
+  }
+}
+
+const results = [];
+let failed = false;
+
+for (const system of systems) {
+  bench.configure(system);
+  for (const mode of modes) {
+    // Warm up caches and the JIT before measuring
+    bench.run({ ...mode, iterations: Math.min(iterations, 100) });
+    const report = bench.run({ ...mode, iterations });
+    results.push({ system, mode, report });
+
+    if (!args.json) printReport(system, mode, report);
+    if (args['max-total-us'] && report.stages.total.meanUs > args['max-total-us']) {
+      console.error(
+        `Regression: ${mode.direction}/${mode.marshal} took ${report.stages.total.meanUs.toFixed(2)} us ` +
+        `(limit ${args['max-total-us']} us)`
+      );
+      failed = true;
+    }
+  }
+}
+
+if (args.json) {
+  console.log(JSON.stringify(results, null, 2));
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,106 @@
+/**
+ * Compares reading the shared snapshot segment with scanning directly, on
+ * Linux. A publisher is started at a scratch path; then direct capture and
+ * render scans, full snapshot reads and unchanged (header-only) reads are
+ * timed, in this process and in a forked reader process.
+ *
+ * Usage: node bench/snapshot.js [--iterations N] [--interval-ms MS]
+ */
+
+const { fork } = require('child_process');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = argv[i + 1];
+  }
+  return args;
+}
+
+function time(iterations, fn) {
+  const samples = new Float64Array(iterations);
+  for (let i = 0; i < iterations; i++) {
+    const start = process.hrtime.bigint();
+    fn();
+    samples[i] = Number(process.hrtime.bigint() - start) / 1e3;
+  }
+  samples.sort();
+  return {
+    p50Us: samples[Math.floor((iterations * 50) / 100)],
+    p99Us: samples[Math.floor((iterations * 99) / 100)],
+  };
+}
+
+function measureReads(utils, snapshotPath, iterations) {
+  const first = utils.readSharedSnapshot({ path: snapshotPath });
+  if (!first.success) throw new Error(first.error);
+  return {
+    full: time(iterations, () => utils.readSharedSnapshot({ path: snapshotPath })),
+    unchanged: time(iterations, () =>
+      utils.readSharedSnapshot({ path: snapshotPath, sinceGeneration: first.generation })),
+  };
+}
+
+function format(name, result) {
+  return `${name.padEnd(28)} p50 ${result.p50Us.toFixed(1).padStart(9)} us   p99 ${result.p99Us.toFixed(1).padStart(9)} us`;
+}
+
+if (process.argv[2] === '--reader') {
+  const utils = require('../index.js');
+  process.send(measureReads(utils, process.argv[3], Number(process.argv[4])));
+  process.exit(0);
+}
+
+if (process.platform !== 'linux') {
+  console.log('Shared snapshots are only implemented on Linux');
+  process.exit(0);
+}
+
+const utils = require('../index.js');
+const args = parseArgs(process.argv.slice(2));
+const iterations = Number(args.iterations) || 2000;
+const intervalMs = Number(args['interval-ms']) || 1000;
+
+const dir = fs.existsSync('/dev/shm') ? '/dev/shm' : os.tmpdir();
+const snapshotPath = path.join(dir, `node-mac-utils-bench-${process.pid}`);
+
+const publisher = utils.startSnapshotPublisher({ path: snapshotPath, intervalMs });
+
+async function run() {
+  // Wait for the first scan to land
+  while (publisher.generation() === 0) {
+    await new Promise((resolve) => setTimeout(resolve, 10));
+  }
+
+  const directIterations = Math.max(1, Math.floor(iterations / 20));
+  console.log(`Publisher at ${snapshotPath}, generation ${publisher.generation()}`);
+  console.log(format('direct capture + render', time(directIterations, () => {
+    utils.getProcessesAccessingMicrophoneWithResult();
+    utils.getProcessesAccessingSpeakersWithResult();
+  })));
+
+  const local = measureReads(utils, snapshotPath, iterations);
+  console.log(format('shared read (full)', local.full));
+  console.log(format('shared read (unchanged)', local.unchanged));
+
+  const remote = await new Promise((resolve, reject) => {
+    const child = fork(__filename, ['--reader', snapshotPath, String(iterations)]);
+    child.once('message', resolve);
+    child.once('error', reject);
+  });
+  console.log(format('other process (full)', remote.full));
+  console.log(format('other process (unchanged)', remote.unchanged));
+}
+
+run()
+  .catch((error) => {
+    console.error('Bench failed:', error);
+    process.exitCode = 1;
+  })
+  .finally(() => {
+    publisher.stop();
+    fs.rmSync(snapshotPath, { force: true });
+  });
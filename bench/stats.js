@@ -0,0 +1,52 @@
+/**
+ * Measures what the getStats() instrumentation costs, using the synthetic
+ * backend in the `bench` addon: the pipeline is run with and without the
+ * stats observer on a small and a large system, and a bare stage scope is
+ * timed. Build with `node-gyp rebuild --bench=1 --native_stats=0` to confirm
+ * the scopes compile to nothing (enabled: false, scope cost near zero).
+ *
+ * Usage: node bench/stats.js [--iterations I] [--max-overhead-pct P]
+ *
+ * With --max-overhead-pct the run exits non-zero when the observed pipeline
+ * is slower than the plain one by more than P percent.
+ */
+
+const bench = require('bindings')('bench.node');
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const iterations = args.iterations || 2000;
+const maxOverheadPct = args['max-overhead-pct'];
+
+const systems = [
+  { devices: 2, sessionsPerDevice: 8, processes: 8 },
+  { devices: 16, sessionsPerDevice: 256, processes: 512 },
+];
+
+let failed = false;
+
+for (const system of systems) {
+  bench.configure(system);
+  for (const direction of ['capture', 'render']) {
+    const report = bench.statsOverhead({ iterations, direction });
+    console.log(
+      `${system.devices} x ${system.sessionsPerDevice} sessions, ${direction}: ` +
+      `plain ${report.plainMeanUs.toFixed(2)} us, with stats ${report.observedMeanUs.toFixed(2)} us ` +
+      `(${report.overheadPct >= 0 ? '+' : ''}${report.overheadPct.toFixed(2)}%), ` +
+      `scope ${report.scopeNs.toFixed(1)} ns, stats ${report.enabled ? 'enabled' : 'compiled out'}`
+    );
+    if (maxOverheadPct !== undefined && report.overheadPct > maxOverheadPct) {
+      console.error(`  FAIL: overhead above ${maxOverheadPct}%`);
+      failed = true;
+    }
+  }
+}
+
+process.exit(failed ? 1 : 0);
@@ -0,0 +1,561 @@
+// stress.cpp
+//
+// Churn stress harness for the monitor and enumeration lifecycles, built as
+// a standalone executable so it runs under ASan and TSan without Node:
+//
+//   node-gyp rebuild --sanitize=thread && build/Release/stress
+//
+// Every scenario drives a ChurnAudioBackend from its own threads while the
+// production classes consume it:
+//
+//   sessionChurn    thousands of sessions a second start and stop while an
+//                   AudioProcessWatcher, woken by every change, diffs them
+//                   and other threads run the enumeration pipeline
+//   hotplugStorm    capture devices come and go while MonitorHub fans a
+//                   PollingMonitorSource per device out to subscribers
+//   subscribeChurn  many threads subscribe and unsubscribe as fast as they
+//                   can, starting and stopping listeners under them
+//
+// It reports event throughput, change-to-delta latency percentiles and RSS
+// growth across rounds, checks that no listener, subscription, source or
+// backend listener outlives its round, and exits 1 on any failed check.
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../common/AudioProcessWatcher.h"
+#include "../common/MonitorHub.h"
+#include "../common/PollingMonitorSource.h"
+#include "../common/SessionPipeline.h"
+#include "ChurnAudioBackend.h"
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define STRESS_SANITIZED 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define STRESS_SANITIZED 1
+#endif
+#endif
+
+#ifdef STRESS_SANITIZED
+static const bool kSanitized = true;
+#else
+static const bool kSanitized = false;
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+struct StressOptions {
+    double durationMs;
+    double sessionRate;      // Session starts per second in sessionChurn
+    size_t devices;          // Devices plugged at the start of sessionChurn
+    size_t enumerators;      // Threads running the pipeline during sessionChurn
+    double plugRate;         // Plug or unplug events per second in hotplugStorm
+    size_t subscribers;      // Subscriptions in hotplugStorm, threads in subscribeChurn
+    size_t rounds;           // The first is a warm-up for the RSS check
+    uint64_t failEvery;      // Injected enumeration failure every N calls
+    double maxP99Ms;         // Latency gate
+    double maxRssGrowthMb;   // RSS gate between the first and last round
+
+    StressOptions()
+        : durationMs(2000), sessionRate(5000), devices(4), enumerators(2), plugRate(500), subscribers(16),
+          rounds(3), failEvery(50), maxP99Ms(kSanitized ? 500 : 50), maxRssGrowthMb(kSanitized ? 0 : 16) {}
+};
+
+static std::vector<std::string> failures;
+
+static void Check(bool condition, const std::string& message) {
+    if (!condition) failures.push_back(message);
+}
+
+static double Percentile(std::vector<double>& samples, double percentile) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * percentile / 100.0))];
+}
+
+static double ResidentMb() {
+    std::ifstream statm("/proc/self/statm");
+    uint64_t size = 0;
+    uint64_t resident = 0;
+    statm >> size >> resident;
+    return static_cast<double>(resident) * sysconf(_SC_PAGESIZE) / (1024.0 * 1024.0);
+}
+
+static double MsSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Pairs each session start and stop with the delta that reported it
+class LatencyTracker {
+public:
+    LatencyTracker() : coalesced(0) {}
+
+    void Started(uint32_t processId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        started_[processId] = Clock::now();
+    }
+
+    void Stopped(uint32_t processId) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (seen_.count(processId)) {
+            stopped_[processId] = Clock::now();
+        } else if (started_.erase(processId)) {
+            // Started and stopped between two scans, so never reported
+            coalesced++;
+        }
+    }
+
+    void Reported(const AudioProcessDelta& delta) {
+        auto now = Clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const ProcessSetDelta* set : { &delta.capture, &delta.render }) {
+            for (const WatchedProcess& process : set->added) {
+                auto started = started_.find(process.processId);
+                if (started == started_.end()) continue;
+                added.push_back(std::chrono::duration<double, std::milli>(now - started->second).count());
+                started_.erase(started);
+                seen_.insert(process.processId);
+            }
+            for (const WatchedProcess& process : set->removed) {
+                seen_.erase(process.processId);
+                auto stopped = stopped_.find(process.processId);
+                if (stopped == stopped_.end()) continue;
+                removed.push_back(std::chrono::duration<double, std::milli>(now - stopped->second).count());
+                stopped_.erase(stopped);
+            }
+        }
+    }
+
+    std::vector<double> added;    // ms from StartSession to the delta
+    std::vector<double> removed;  // ms from StopSession to the delta
+    uint64_t coalesced;
+
+private:
+    std::mutex mutex_;
+    std::unordered_map<uint32_t, Clock::time_point> started_;
+    std::unordered_map<uint32_t, Clock::time_point> stopped_;
+    std::set<uint32_t> seen_;
+};
+
+// The watcher's view, rebuilt from its deltas alone
+class DeltaView {
+public:
+    DeltaView() : deltas(0), events(0), errors(0) {}
+
+    void Apply(const AudioProcessDelta& delta) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        deltas++;
+        if (!delta.errorMessage.empty()) {
+            errors++;
+            return;
+        }
+        for (const WatchedProcess& process : delta.capture.added) capture_.insert(process.processId);
+        for (const WatchedProcess& process : delta.capture.removed) capture_.erase(process.processId);
+        for (const WatchedProcess& process : delta.render.added) render_.insert(process.processId);
+        for (const WatchedProcess& process : delta.render.removed) render_.erase(process.processId);
+        events += delta.capture.added.size() + delta.capture.removed.size() + delta.render.added.size() +
+                  delta.render.removed.size();
+    }
+
+    bool Matches(ChurnAudioBackend& backend) {
+        std::set<uint32_t> capture;
+        std::set<uint32_t> render;
+        for (const auto& session : backend.LiveSessions()) {
+            (session.second == AudioDirection::Capture ? capture : render).insert(session.first);
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        return capture == capture_ && render == render_;
+    }
+
+    uint64_t deltas;
+    uint64_t events;
+    uint64_t errors;
+
+private:
+    std::mutex mutex_;
+    std::set<uint32_t> capture_;
+    std::set<uint32_t> render_;
+};
+
+// What GetWatchedProcesses does on the platforms, over the churn backend
+static bool ScanChurnBackend(ChurnAudioBackend& backend, WatchedSnapshot& snapshot, long& errorCode,
+                             std::string& errorMessage) {
+    std::vector<AudioDevice> devices;
+    std::vector<AudioSession> sessions;
+    if (!backend.Enumerate(devices, sessions, errorCode, errorMessage)) return false;
+    for (const AudioSession& session : sessions) {
+        if (!session.isActive) continue;
+        WatchedProcess process = { session.processId, backend.ResolveProcessPath(session.processId),
+                                   devices[session.deviceIndex].name };
+        (devices[session.deviceIndex].direction == AudioDirection::Capture ? snapshot.capture : snapshot.render)
+            .push_back(process);
+    }
+    return true;
+}
+
+static void SessionChurn(const StressOptions& options, size_t round) {
+    ChurnAudioBackend backend;
+    for (size_t i = 0; i < options.devices; i++) {
+        backend.PlugDevice(i % 2 == 0 ? AudioDirection::Capture : AudioDirection::Render);
+    }
+    std::vector<uint32_t> deviceKeys = backend.DeviceKeys(AudioDirection::Capture);
+    std::vector<uint32_t> renderKeys = backend.DeviceKeys(AudioDirection::Render);
+    deviceKeys.insert(deviceKeys.end(), renderKeys.begin(), renderKeys.end());
+    backend.FailEvery(options.failEvery);
+
+    LatencyTracker tracker;
+    DeltaView view;
+    AudioProcessWatcher watcher(
+        [&backend](WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage) {
+            return ScanChurnBackend(backend, snapshot, errorCode, errorMessage);
+        },
+        [&](AudioProcessDelta* delta) {
+            std::unique_ptr<AudioProcessDelta> owned(delta);
+            tracker.Reported(*delta);
+            view.Apply(*delta);
+        },
+        std::chrono::milliseconds(100));
+    watcher.Start();
+    ChurnAudioBackend::ListenerId listener = backend.AddListener([&watcher]() { watcher.Wake(); });
+
+    std::atomic<bool> stopping(false);
+    std::atomic<uint64_t> pipelineCalls(0);
+    std::vector<std::thread> enumerators;
+    for (size_t i = 0; i < options.enumerators; i++) {
+        enumerators.emplace_back([&backend, &stopping, &pipelineCalls]() {
+            while (!stopping) {
+                CollectCaptureProcesses(backend);
+                CollectRenderProcesses(backend);
+                pipelineCalls += 2;
+            }
+        });
+    }
+
+    // Sessions live 5 to 100 ms, started at sessionRate
+    std::mt19937 random(static_cast<uint32_t>(round + 1));
+    std::uniform_int_distribution<int> lifetimeMs(5, 100);
+    typedef std::pair<Clock::time_point, uint32_t> Deadline;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines;
+    uint64_t started = 0;
+    auto begin = Clock::now();
+    while (MsSince(begin) < options.durationMs) {
+        uint64_t due = static_cast<uint64_t>(MsSince(begin) * options.sessionRate / 1000.0);
+        for (; started < due; started++) {
+            uint32_t processId = backend.StartSession(deviceKeys[random() % deviceKeys.size()]);
+            tracker.Started(processId);
+            deadlines.push(Deadline(Clock::now() + std::chrono::milliseconds(lifetimeMs(random)), processId));
+        }
+        while (!deadlines.empty() && deadlines.top().first <= Clock::now()) {
+            tracker.Stopped(deadlines.top().second);
+            backend.StopSession(deadlines.top().second);
+            deadlines.pop();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double elapsedMs = MsSince(begin);
+    stopping = true;
+    for (std::thread& enumerator : enumerators) enumerator.join();
+
+    // Sessions still running stay; the watcher must converge on them
+    auto settleBegin = Clock::now();
+    bool consistent = false;
+    while (!(consistent = view.Matches(backend)) && MsSince(settleBegin) < 2000) {
+        watcher.Wake();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    backend.RemoveListener(listener);
+    watcher.Stop();
+
+    double addedP50 = Percentile(tracker.added, 50);
+    double addedP99 = Percentile(tracker.added, 99);
+    double removedP50 = Percentile(tracker.removed, 50);
+    double removedP99 = Percentile(tracker.removed, 99);
+    printf("  sessionChurn    %7llu starts  %7llu events (%.0f/s)  added p50 %.2f p99 %.2f ms  "
+           "removed p50 %.2f p99 %.2f ms  %llu coalesced  %llu scan errors  %llu pipeline calls\n",
+           static_cast<unsigned long long>(started), static_cast<unsigned long long>(view.events),
+           view.events * 1000.0 / elapsedMs, addedP50, addedP99, removedP50, removedP99,
+           static_cast<unsigned long long>(tracker.coalesced), static_cast<unsigned long long>(view.errors),
+           static_cast<unsigned long long>(pipelineCalls.load()));
+
+    Check(consistent, "sessionChurn: the watcher's deltas do not add up to the backend's sessions");
+    Check(!tracker.added.empty(), "sessionChurn: no session start was reported");
+    Check(addedP99 <= options.maxP99Ms && removedP99 <= options.maxP99Ms,
+          "sessionChurn: p99 latency above " + std::to_string(options.maxP99Ms) + " ms");
+    Check(backend.ListenerCount() == 0, "sessionChurn: backend listener left behind");
+}
+
+// PollingMonitorSource over the churn backend, woken by its changes, as the
+// Linux capture source is by /dev/snd
+class ChurnMonitorSource : public PollingMonitorSource {
+public:
+    static std::atomic<int64_t> live;
+
+    explicit ChurnMonitorSource(ChurnAudioBackend& backend)
+        : PollingMonitorSource(
+              [&backend](const std::string& deviceId, std::vector<DeviceActivity>& devices, long& errorCode,
+                         std::string& errorMessage) {
+                  return backend.ProbeCaptureDevices(deviceId, devices, errorCode, errorMessage);
+              },
+              "ChurnMonitor", std::chrono::milliseconds(50)),
+          backend_(backend),
+          listener_(0) {
+        live++;
+    }
+
+    ~ChurnMonitorSource() override {
+        Stop();
+        live--;
+    }
+
+    bool Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) override {
+        if (!PollingMonitorSource::Start(deviceId, sink, error)) return false;
+        listener_ = backend_.AddListener([this]() { Wake(Clock::now()); });
+        return true;
+    }
+
+    void Stop() override {
+        if (listener_ != 0) {
+            backend_.RemoveListener(listener_);
+            listener_ = 0;
+        }
+        PollingMonitorSource::Stop();
+    }
+
+private:
+    ChurnAudioBackend& backend_;
+    ChurnAudioBackend::ListenerId listener_;
+};
+
+std::atomic<int64_t> ChurnMonitorSource::live(0);
+
+static MonitorSourceFactory ChurnSourceFactory(ChurnAudioBackend& backend) {
+    return [&backend]() { return std::unique_ptr<MonitorSource>(new ChurnMonitorSource(backend)); };
+}
+
+static void CheckHubDrained(const char* scenario, MonitorHub& hub, ChurnAudioBackend& backend) {
+    std::string name = scenario;
+    Check(hub.ListenerCount() == 0, name + ": " + std::to_string(hub.ListenerCount()) + " hub listeners left");
+    Check(hub.SubscriberCount() == 0, name + ": " + std::to_string(hub.SubscriberCount()) + " subscribers left");
+    Check(ChurnMonitorSource::live == 0, name + ": " + std::to_string(ChurnMonitorSource::live) + " sources alive");
+    Check(backend.ListenerCount() == 0, name + ": " + std::to_string(backend.ListenerCount()) +
+                                        " backend listeners left");
+}
+
+static void HotplugStorm(const StressOptions& options, size_t round) {
+    ChurnAudioBackend backend;
+    backend.PlugDevice(AudioDirection::Capture);
+    std::unique_ptr<MonitorHub> hub(new MonitorHub(ChurnSourceFactory(backend)));
+
+    std::atomic<uint64_t> states(0);
+    std::atomic<uint64_t> infos(0);
+    std::vector<MonitorHub::SubscriptionId> ids;
+    for (size_t i = 0; i < options.subscribers; i++) {
+        MonitorEvent error;
+        ids.push_back(hub->Subscribe("*", MonitorFilter(), [&](const MonitorEvent& event) {
+            (event.hasError ? infos : states)++;
+        }, error));
+    }
+    Check(hub->ListenerCount() == 1, "hotplugStorm: subscribers to one device share one listener");
+
+    // Plugs while there are few devices, unplugs while there are many; a
+    // session runs on every other new device
+    std::mt19937 random(static_cast<uint32_t>(round + 1));
+    std::vector<uint32_t> plugged = backend.DeviceKeys(AudioDirection::Capture);
+    uint64_t changes = 0;
+    auto begin = Clock::now();
+    while (MsSince(begin) < options.durationMs) {
+        uint64_t due = static_cast<uint64_t>(MsSince(begin) * options.plugRate / 1000.0);
+        for (; changes < due; changes++) {
+            if (plugged.size() < 2 || (plugged.size() < 16 && random() % 2 == 0)) {
+                uint32_t key = backend.PlugDevice(AudioDirection::Capture);
+                if (changes % 2 == 0) backend.StartSession(key);
+                plugged.push_back(key);
+            } else {
+                size_t index = random() % plugged.size();
+                backend.UnplugDevice(plugged[index]);
+                plugged.erase(plugged.begin() + index);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double elapsedMs = MsSince(begin);
+
+    for (MonitorHub::SubscriptionId id : ids) hub->Unsubscribe(id);
+    printf("  hotplugStorm    %7llu changes %7llu events (%.0f/s) to %zu subscribers, %llu topology reports\n",
+           static_cast<unsigned long long>(changes), static_cast<unsigned long long>(states.load()),
+           states * 1000.0 / elapsedMs, options.subscribers, static_cast<unsigned long long>(infos.load()));
+
+    Check(states > 0, "hotplugStorm: no device state reached a subscriber");
+    CheckHubDrained("hotplugStorm", *hub, backend);
+    hub.reset();
+}
+
+static void SubscribeChurn(const StressOptions& options, size_t round) {
+    ChurnAudioBackend backend;
+    std::vector<uint32_t> devices;
+    for (size_t i = 0; i < 4; i++) devices.push_back(backend.PlugDevice(AudioDirection::Capture));
+    std::unique_ptr<MonitorHub> hub(new MonitorHub(ChurnSourceFactory(backend)));
+
+    std::atomic<bool> stopping(false);
+    std::atomic<uint64_t> subscribes(0);
+    std::atomic<uint64_t> rejected(0);
+    std::atomic<uint64_t> delivered(0);
+    std::atomic<uint64_t> lateCalls(0);
+
+    // Keeps events flowing: sessions toggle on every device
+    std::thread flipper([&]() {
+        std::vector<uint32_t> sessions(devices.size(), 0);
+        for (size_t i = 0; !stopping; i++) {
+            size_t device = i % devices.size();
+            if (sessions[device] != 0) {
+                backend.StopSession(sessions[device]);
+                sessions[device] = 0;
+            } else {
+                sessions[device] = backend.StartSession(devices[device]);
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    std::vector<std::thread> callers;
+    for (size_t t = 0; t < options.subscribers; t++) {
+        callers.emplace_back([&, t]() {
+            std::mt19937 random(static_cast<uint32_t>(round * 1000 + t));
+            while (!stopping) {
+                // "*", a live device, or one that was never plugged
+                size_t pick = random() % (devices.size() + 2);
+                std::string deviceId = pick == 0 ? "*" : pick <= devices.size()
+                                                             ? "churn:" + std::to_string(devices[pick - 1])
+                                                             : "churn:missing";
+                std::shared_ptr<std::atomic<bool>> closed = std::make_shared<std::atomic<bool>>(false);
+                MonitorFilter filter;
+                filter.changesOnly = random() % 2 == 0;
+                MonitorEvent error;
+                MonitorHub::SubscriptionId id = hub->Subscribe(deviceId, filter, [&, closed](const MonitorEvent&) {
+                    if (*closed) lateCalls++;
+                    delivered++;
+                }, error);
+                if (id == 0) {
+                    rejected++;
+                    continue;
+                }
+                subscribes++;
+                std::this_thread::sleep_for(std::chrono::microseconds(random() % 500));
+                hub->Unsubscribe(id);
+                *closed = true;
+            }
+        });
+    }
+
+    auto begin = Clock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int64_t>(options.durationMs)));
+    stopping = true;
+    for (std::thread& caller : callers) caller.join();
+    flipper.join();
+    double elapsedMs = MsSince(begin);
+
+    printf("  subscribeChurn  %7llu subscribes (%.0f/s) from %zu threads, %llu rejected, %llu events\n",
+           static_cast<unsigned long long>(subscribes.load()), subscribes * 1000.0 / elapsedMs, options.subscribers,
+           static_cast<unsigned long long>(rejected.load()), static_cast<unsigned long long>(delivered.load()));
+
+    Check(subscribes > 0, "subscribeChurn: no subscription succeeded");
+    Check(rejected > 0, "subscribeChurn: subscribing to a missing device never failed");
+    Check(lateCalls == 0, "subscribeChurn: " + std::to_string(lateCalls) + " callbacks after Unsubscribe returned");
+    CheckHubDrained("subscribeChurn", *hub, backend);
+    hub.reset();
+}
+
+static bool ParseOptions(int argc, char** argv, StressOptions& options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string name = argv[i];
+        double value = strtod(argv[i + 1], nullptr);
+        if (name == "--duration-ms") {
+            options.durationMs = value;
+        } else if (name == "--session-rate") {
+            options.sessionRate = value;
+        } else if (name == "--devices") {
+            options.devices = static_cast<size_t>(value);
+        } else if (name == "--enumerators") {
+            options.enumerators = static_cast<size_t>(value);
+        } else if (name == "--plug-rate") {
+            options.plugRate = value;
+        } else if (name == "--subscribers") {
+            options.subscribers = static_cast<size_t>(value);
+        } else if (name == "--rounds") {
+            options.rounds = static_cast<size_t>(value);
+        } else if (name == "--fail-every") {
+            options.failEvery = static_cast<uint64_t>(value);
+        } else if (name == "--max-p99-ms") {
+            options.maxP99Ms = value;
+        } else if (name == "--max-rss-growth-mb") {
+            options.maxRssGrowthMb = value;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", name.c_str());
+            return false;
+        }
+    }
+    if (argc % 2 == 0) {
+        fprintf(stderr, "Missing value for %s\n", argv[argc - 1]);
+        return false;
+    }
+    if (options.durationMs <= 0 || options.devices == 0 || options.subscribers == 0 || options.rounds == 0) {
+        fprintf(stderr, "duration, devices, subscribers and rounds must be positive\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    StressOptions options;
+    if (!ParseOptions(argc, argv, options)) {
+        fprintf(stderr,
+                "Usage: stress [--duration-ms MS] [--session-rate N] [--devices N] [--enumerators N] "
+                "[--plug-rate N] [--subscribers N] [--rounds N] [--fail-every N] [--max-p99-ms MS] "
+                "[--max-rss-growth-mb MB]\n");
+        return 2;
+    }
+
+    printf("Stress: %zu rounds of %.0f ms per scenario%s\n", options.rounds, options.durationMs,
+           kSanitized ? " (sanitized build)" : "");
+    double baselineMb = 0;
+    for (size_t round = 0; round < options.rounds; round++) {
+        printf("Round %zu:\n", round + 1);
+        SessionChurn(options, round);
+        HotplugStorm(options, round);
+        SubscribeChurn(options, round);
+        // The first round warms allocator pools and thread stacks
+        if (round == 0) baselineMb = ResidentMb();
+    }
+
+    double growthMb = ResidentMb() - baselineMb;
+    if (options.rounds < 2) {
+        printf("RSS check skipped: it compares the first round with the last\n");
+    } else if (options.maxRssGrowthMb <= 0) {
+        printf("RSS %+.1f MB after the first round (not gated: sanitizers hold on to freed memory)\n", growthMb);
+    } else {
+        printf("RSS %+.1f MB after the first round (limit %.1f MB)\n", growthMb, options.maxRssGrowthMb);
+        Check(growthMb <= options.maxRssGrowthMb, "RSS grew " + std::to_string(growthMb) + " MB");
+    }
+
+    if (failures.empty()) {
+        printf("PASS\n");
+        return 0;
+    }
+    for (const std::string& failure : failures) printf("FAIL: %s\n", failure.c_str());
+    return 1;
+}
@@ -0,0 +1,36 @@
+/**
+ * Runs the native churn stress harness (bench/stress.cpp, Linux only) and
+ * exits with its status, so a regression fails the script. The harness is a
+ * plain executable; build it with a sanitizer to run the same churn under
+ * ASan or TSan:
+ *   node-gyp rebuild --sanitize=thread
+ *   node-gyp rebuild --sanitize=address
+ *
+ * Usage: node bench/stress.js [--duration-ms MS] [--session-rate N] [--rounds N] ...
+ * (every option is passed through; see bench/stress.cpp)
+ */
+
+const { spawnSync } = require('child_process');
+const fs = require('fs');
+const path = require('path');
+
+if (process.platform !== 'linux') {
+  console.log('The stress harness is only built on Linux');
+  process.exit(0);
+}
+
+const binary = ['Release', 'Debug']
+  .map((config) => path.join(__dirname, '..', 'build', config, 'stress'))
+  .find((candidate) => fs.existsSync(candidate));
+
+if (!binary) {
+  console.error('build/Release/stress not found; run node-gyp rebuild first');
+  process.exit(1);
+}
+
+const result = spawnSync(binary, process.argv.slice(2), { stdio: 'inherit' });
+if (result.error) {
+  console.error('Failed to run the stress harness:', result.error.message);
+  process.exit(1);
+}
+process.exit(result.status === null ? 1 : result.status);
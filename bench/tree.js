@@ -0,0 +1,65 @@
+/**
+ * Attributes audio helpers to their applications over a fake /proc of 10k
+ * processes in the `bench` addon (Linux only), with a ProcessTree kept in
+ * sync incrementally against one rebuilt from a full scan every round.
+ * Some renderer helpers exit and are replaced each round, as on a busy
+ * desktop.
+ *
+ * Usage: node bench/tree.js [--processes N] [--rounds R] [--churn C] [--sessions S]
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const bench = require('bindings')('bench.node');
+
+if (!bench.processTree) {
+  console.log('processTree is only built on Linux');
+  process.exit(0);
+}
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const options = {
+  processes: args.processes || 10000,
+  rounds: args.rounds || 50,
+  churn: args.churn !== undefined ? args.churn : 20,
+  sessions: args.sessions || 32,
+};
+
+const root = fs.mkdtempSync(path.join(os.tmpdir(), 'proctree-'));
+let failed = false;
+
+try {
+  const report = bench.processTree(Object.assign({ root }, options));
+  console.log(
+    `${report.processes} processes, ${options.sessions} sessions, ${options.churn} exits per round; ` +
+    `initial sync ${(report.initialSyncUs / 1000).toFixed(2)} ms`
+  );
+  for (const name of ['incremental', 'rebuild']) {
+    const timing = report[name];
+    console.log(
+      `  ${name.padEnd(11)} mean ${timing.meanUs.toFixed(1).padStart(9)} us   ` +
+      `p50 ${timing.p50Us.toFixed(1).padStart(9)} us   p99 ${timing.p99Us.toFixed(1).padStart(9)} us   ` +
+      `${timing.statReadsPerRound.toFixed(0)} stat reads per round`
+    );
+  }
+  console.log(`  speedup ${(report.rebuild.meanUs / report.incremental.meanUs).toFixed(2)}x, ` +
+    `${report.added} PIDs added and ${report.removed} removed incrementally`);
+
+  if (report.misattributed !== 0) {
+    console.error(`✗ ${report.misattributed} sessions attributed to the wrong application`);
+    failed = true;
+  }
+} finally {
+  fs.rmSync(root, { recursive: true, force: true });
+}
+
+process.exit(failed ? 1 : 0);
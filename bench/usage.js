@@ -0,0 +1,72 @@
+/**
+ * Reports append and query throughput of the binary usage-history log in
+ * the `bench` addon (Linux only). A synthetic history of apps starting and
+ * stopping on devices is appended with size-bounded rotation, then queried
+ * over the whole history, its last tenth, and for a single app. For scale,
+ * the size of one JSON snapshot of the average active set is printed too:
+ * that is what persisting a snapshot per poll costs, per poll.
+ *
+ * Usage: node bench/usage.js [--transitions N] [--apps A] [--devices D] [--max-bytes B] [--max-files F] [--queries Q]
+ */
+
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const bench = require('bindings')('bench.node');
+
+if (!bench.usageLog) {
+  console.log('usageLog is only built on Linux');
+  process.exit(0);
+}
+
+function parseArgs(argv) {
+  const args = {};
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  return args;
+}
+
+const args = parseArgs(process.argv.slice(2));
+const dir = fs.mkdtempSync(path.join(os.tmpdir(), 'usage-'));
+const options = {
+  path: path.join(dir, 'usage.log'),
+  transitions: args.transitions || 200000,
+  apps: args.apps || 40,
+  devices: args.devices || 4,
+  maxBytes: args['max-bytes'] || 256 * 1024,
+  maxFiles: args['max-files'] || 8,
+  queries: args.queries || 20,
+};
+
+try {
+  const report = bench.usageLog(options);
+  const { append, query } = report;
+  console.log(`Append: ${append.transitions} transitions in ${append.totalMs.toFixed(1)} ms ` +
+    `(${append.nsPerTransition.toFixed(0)} ns each), ${append.bytesPerTransition.toFixed(2)} bytes each, ` +
+    `${append.rotations} rotations`);
+
+  const active = Math.round(append.meanActive);
+  const snapshot = JSON.stringify({
+    timestamp: Date.now(),
+    processes: Array.from({ length: active }, (_, i) => ({
+      processId: 10000 + i,
+      processName: `/usr/lib/app${i}/bin/app${i}`,
+      deviceName: `Device ${i % options.devices}`,
+      direction: i % 2 ? 'render' : 'capture',
+    })),
+  });
+  console.log(`JSON snapshot of ${active} active sessions: ${snapshot.length} bytes per poll`);
+
+  console.log(`Query (${options.queries} runs each, files kept: ${options.maxFiles} x ${options.maxBytes} bytes):`);
+  for (const [name, run] of Object.entries(query)) {
+    const mbPerSecond = run.bytesScanned / run.meanUs;
+    console.log(
+      `  ${name.padEnd(10)} mean ${(run.meanUs / 1000).toFixed(2).padStart(7)} ms   ` +
+      `p99 ${(run.p99Us / 1000).toFixed(2).padStart(7)} ms   ${run.apps} apps, ${run.records} records, ` +
+      `${run.filesRead} files read, ${run.filesSkipped} skipped, ${mbPerSecond.toFixed(0)} MB/s`
+    );
+  }
+} finally {
+  fs.rmSync(dir, { recursive: true, force: true });
+}
@@ -1,4 +1,20 @@
 {
+  # node-gyp rebuild --native_stats=0 compiles getStats() instrumentation out
+  # node-gyp rebuild --sanitize=thread (or address) builds the stress harness
+  # with that sanitizer
+  # node-gyp rebuild --bench=1 also builds the micro-benchmark addon
+  "variables": {
+    "bench%": 0,
+    "native_stats%": 1,
+    "sanitize%": ""
+  },
+  "target_defaults": {
+    "conditions": [
+      ['native_stats==0', {
+        "defines": [ "NATIVE_STATS_DISABLED" ]
+      }]
+    ]
+  },
   "targets": [{
     "target_name": "mac_utils",
     "sources": [ ],
@@ -8,6 +24,18 @@
           "macOS/mac_utils.mm",
           "macOS/AudioProcessMonitor.m",
           "macOS/MicrophoneUsageMonitor.m",
+          "macOS/CoreAudioContextBackend.cpp",
+          "common/AudioContext.cpp",
+          "common/AudioProcessWatcher.cpp",
+          "common/TieredProbeScheduler.cpp",
+          "common/MonitorHub.cpp",
+          "common/MonitorEventQueue.cpp",
+          "common/NativeStats.cpp",
+          "common/LevelKernels.cpp",
+          "common/LevelMeter.cpp",
+          "common/ProcessFilter.cpp",
+          "common/SessionPipeline.cpp",
+          "common/StringTable.cpp",
         ],
         "xcode_settings": {
           "OTHER_CFLAGS": ["-fobjc-arc"]
@@ -25,11 +53,13 @@
     "xcode_settings": {
       "MACOSX_DEPLOYMENT_TARGET": "10.13",
       "SYSTEM_VERSION_COMPAT": 1,
+      "GCC_ENABLE_CPP_EXCEPTIONS": "YES",
       "OTHER_CPLUSPLUSFLAGS": ["-std=c++14", "-stdlib=libc++"],
       "OTHER_LDFLAGS": [
         "-framework CoreFoundation",
         "-framework AppKit",
         "-framework AudioToolbox",
+        "-framework CoreAudio",
         "-framework AVFoundation"
       ]
     }
@@ -40,7 +70,21 @@
       ['OS=="win"', {
         "sources": [
           "windows/win_utils.cpp",
-          "windows/AudioProcessMonitor.cpp"
+          "windows/AudioProcessMonitor.cpp",
+          "common/ProcessPathCache.cpp",
+          "common/AudioProcessWatcher.cpp",
+          "common/TieredProbeScheduler.cpp",
+          "common/MonitorHub.cpp",
+          "common/MonitorEventQueue.cpp",
+          "common/NativeStats.cpp",
+          "common/LevelKernels.cpp",
+          "common/LevelMeter.cpp",
+          "common/PollingMonitorSource.cpp",
+          "common/ProcessFilter.cpp",
+          "common/BackendWarmup.cpp",
+          "common/SessionPipeline.cpp",
+          "common/StringTable.cpp",
+          "common/AudioContext.cpp"
         ]
       }]
     ],
@@ -52,5 +96,157 @@
       "<!(node -p \"require('node-addon-api').gyp\")"
     ],
     'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS' ]
-  }]
+  }, {
+    "target_name": "linux_utils",
+    "sources": [ ],
+    "conditions": [
+      ['OS=="linux"', {
+        "sources": [
+          "linux/linux_utils.cpp",
+          "linux/AudioProcessMonitor.cpp",
+          "linux/CaptureDeviceProbe.cpp",
+          "linux/ProcAudioBackend.cpp",
+          "linux/PcmFdWalker.cpp",
+          "linux/ProcAudioScanner.cpp",
+          "linux/ProcContextBackend.cpp",
+          "linux/ProcFiles.cpp",
+          "linux/ProcStat.cpp",
+          "linux/ProcessTree.cpp",
+          "linux/PulseCaptureSource.cpp",
+          "linux/PulseContextBackend.cpp",
+          "linux/PulseSessionBackend.cpp",
+          "linux/SnapshotPublisher.cpp",
+          "linux/SnapshotSegment.cpp",
+          "linux/SoundDeviceWatcher.cpp",
+          "linux/UsageLog.cpp",
+          "common/ProbeWorkerPool.cpp",
+          "common/WorkStealingPool.cpp",
+          "common/ProcessPathCache.cpp",
+          "common/ProcessFilter.cpp",
+          "common/BackendWarmup.cpp",
+          "common/SessionPipeline.cpp",
+          "common/AudioContext.cpp",
+          "common/AudioProcessWatcher.cpp",
+          "common/TieredProbeScheduler.cpp",
+          "common/MonitorHub.cpp",
+          "common/MonitorEventQueue.cpp",
+          "common/NativeStats.cpp",
+          "common/LevelKernels.cpp",
+          "common/LevelMeter.cpp",
+          "common/PollingMonitorSource.cpp",
+          "common/SnapshotCodec.cpp",
+          "common/StringTable.cpp"
+        ],
+        # libpulse and libpulse-simple are loaded with dlopen, so they stay optional
+        "libraries": [ "-ldl" ]
+      }]
+    ],
+    'include_dirs': [
+      "<!@(node -p \"require('node-addon-api').include\")"
+    ],
+    'libraries': [],
+    'dependencies': [
+      "<!(node -p \"require('node-addon-api').gyp\")"
+    ],
+    'cflags!': [ '-fno-exceptions' ],
+    'cflags_cc!': [ '-fno-exceptions' ],
+    'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS' ]
+  }],
+  "conditions": [
+    ['bench==1', {
+      "targets": [{
+        # Micro-benchmark addon for bench/*.js: build/Release/bench.node
+        "target_name": "bench",
+        "sources": [
+          "bench/bench.cpp",
+          "bench/ContextBench.cpp",
+          "bench/LevelBench.cpp",
+          "bench/MonitorBench.cpp",
+          "bench/PipelineBench.cpp",
+          "bench/AllocationCounter.cpp",
+          "bench/SyntheticAudioBackend.cpp",
+          "common/AudioContext.cpp",
+          "common/AudioProcessWatcher.cpp",
+          "common/BackendWarmup.cpp",
+          "common/LevelKernels.cpp",
+          "common/MonitorHub.cpp",
+          "common/MonitorEventQueue.cpp",
+          "common/NativeStats.cpp",
+          "common/ProcessFilter.cpp",
+          "common/SessionPipeline.cpp",
+          "common/StringTable.cpp",
+          "common/TieredProbeScheduler.cpp"
+        ],
+        "conditions": [
+          ['OS=="linux"', {
+            "sources": [
+              "bench/DeviceBench.cpp",
+              "bench/ProcBench.cpp",
+              "bench/PulseBench.cpp",
+              "bench/UsageLogBench.cpp",
+              "linux/CaptureDeviceProbe.cpp",
+              "linux/ProcAudioBackend.cpp",
+              "linux/PcmFdWalker.cpp",
+              "linux/ProcAudioScanner.cpp",
+              "linux/ProcContextBackend.cpp",
+              "linux/ProcFiles.cpp",
+              "linux/ProcStat.cpp",
+              "linux/ProcessTree.cpp",
+              "linux/PulseCaptureSource.cpp",
+              "linux/PulseContextBackend.cpp",
+              "linux/PulseSessionBackend.cpp",
+              "linux/SoundDeviceWatcher.cpp",
+              "linux/UsageLog.cpp",
+              "common/PollingMonitorSource.cpp",
+              "common/ProbeWorkerPool.cpp",
+              "common/WorkStealingPool.cpp",
+              "common/ProcessPathCache.cpp"
+            ],
+            # Static libstdc++ plus -Bsymbolic binds the runtime's own
+            # allocations to the counting operator new in AllocationCounter.cpp
+            "ldflags": [ "-static-libstdc++", "-Wl,-Bsymbolic" ],
+            "libraries": [ "-ldl" ]
+          }]
+        ],
+        'include_dirs': [
+          "<!@(node -p \"require('node-addon-api').include\")"
+        ],
+        'libraries': [],
+        'dependencies': [
+          "<!(node -p \"require('node-addon-api').gyp\")"
+        ],
+        'defines': [ 'NAPI_DISABLE_CPP_EXCEPTIONS' ],
+        "xcode_settings": {
+          "MACOSX_DEPLOYMENT_TARGET": "10.13",
+          "OTHER_CPLUSPLUSFLAGS": ["-std=c++14", "-stdlib=libc++"]
+        }
+      }]
+    }],
+    ['OS=="linux"', {
+      "targets": [{
+        # Standalone churn harness, no Node needed: build/Release/stress
+        "target_name": "stress",
+        "type": "executable",
+        "sources": [
+          "bench/stress.cpp",
+          "bench/ChurnAudioBackend.cpp",
+          "common/AudioProcessWatcher.cpp",
+          "common/MonitorHub.cpp",
+          "common/NativeStats.cpp",
+          "common/PollingMonitorSource.cpp",
+          "common/ProcessFilter.cpp",
+          "common/SessionPipeline.cpp",
+          "common/StringTable.cpp",
+          "common/TieredProbeScheduler.cpp"
+        ],
+        "libraries": [ "-lpthread" ],
+        "conditions": [
+          ['sanitize!=""', {
+            "cflags": [ "-fsanitize=<(sanitize)", "-fno-omit-frame-pointer", "-g" ],
+            "ldflags": [ "-fsanitize=<(sanitize)" ]
+          }]
+        ]
+      }]
+    }]
+  ]
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#include <napi.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include "MonitorHub.h"
+
+// Per-env state of a platform addon. Each env that loads the addon (the main
+// thread, a worker_thread, an Electron renderer) gets its own instance as
+// napi instance data, so promises, string tables and subscriptions never
+// cross envs. Backend listeners stay process-wide: the instance only holds a
+// reference to the shared MonitorHub.
+//
+// Handles that own a thread-safe function or a native listener register a
+// close function; the env cleanup hook runs whichever are still open when
+// the env exits, so a terminated worker leaves no listener or thread behind.
+// Handles are only tracked and untracked on the env's own JS thread.
+class AddonInstance {
+public:
+  typedef uint64_t HandleId;
+
+  explicit AddonInstance(std::shared_ptr<MonitorHub> hub) : hub_(hub), nextHandle_(1) {
+    LiveCount()++;
+  }
+
+  virtual ~AddonInstance() {
+    LiveCount()--;
+  }
+
+  // Envs that currently have the addon loaded
+  static std::atomic<int>& LiveCount() {
+    static std::atomic<int> count(0);
+    return count;
+  }
+
+  // Installs instance as env's instance data and hooks its cleanup. Call
+  // once from the module's Init.
+  static void Install(Napi::Env env, AddonInstance* instance) {
+    env.SetInstanceData<AddonInstance>(instance);
+    env.AddCleanupHook([instance]() { instance->CloseHandles(); });
+  }
+
+  static AddonInstance& Of(Napi::Env env) {
+    return *env.GetInstanceData<AddonInstance>();
+  }
+
+  const std::shared_ptr<MonitorHub>& Hub() const { return hub_; }
+
+  HandleId TrackHandle(std::function<void()> close) {
+    HandleId id = nextHandle_++;
+    handles_[id] = close;
+    return id;
+  }
+
+  // For a handle closed from JS; its close function is not run
+  void UntrackHandle(HandleId id) {
+    handles_.erase(id);
+  }
+
+  size_t OpenHandleCount() const {
+    return handles_.size();
+  }
+
+private:
+  void CloseHandles() {
+    std::map<HandleId, std::function<void()>> handles;
+    handles.swap(handles_);
+    for (auto& entry : handles) {
+      entry.second();
+    }
+  }
+
+  std::shared_ptr<MonitorHub> hub_;
+  std::map<HandleId, std::function<void()>> handles_;
+  HandleId nextHandle_;
+};
+
+// getInstanceStats(): { instances, openHandles, hubListeners, hubSubscribers },
+// where openHandles counts this env's open watches and subscriptions and the
+// hub counts are process-wide
+static Napi::Value GetInstanceStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  AddonInstance& addon = AddonInstance::Of(env);
+
+  Napi::Object statsObj = Napi::Object::New(env);
+  statsObj.Set("instances", Napi::Number::New(env, AddonInstance::LiveCount()));
+  statsObj.Set("openHandles", Napi::Number::New(env, static_cast<double>(addon.OpenHandleCount())));
+  statsObj.Set("hubListeners", Napi::Number::New(env, static_cast<double>(addon.Hub()->ListenerCount())));
+  statsObj.Set("hubSubscribers", Napi::Number::New(env, static_cast<double>(addon.Hub()->SubscriberCount())));
+  return statsObj;
+}
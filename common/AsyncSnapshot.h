@@ -0,0 +1,109 @@
+#pragma once
+#include <napi.h>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "NativeStats.h"
+#include "ProcessFilter.h"
+
+// Runs a snapshot function off the JS thread and settles a Promise with the
+// marshaled result. Requests that arrive while a scan with the same filter
+// is already in flight join it instead of starting another one, so without
+// filters at most one scan per snapshot kind occupies the libuv worker pool.
+// "The same filter" means the same compiled createProcessFilter() handle; a
+// plain spec is compiled per call and so always gets a scan of its own.
+//
+// Waiters are promises of one env, so each env's AddonInstance owns its
+// snapshots; envs on different threads each run their own scan.
+template <typename Result>
+class AsyncSnapshot {
+public:
+  // The filter is null when the caller gave none
+  typedef Result (*ScanFunction)(const ProcessFilter* filter);
+  typedef Napi::Value (*MarshalFunction)(Napi::Env env, const Result& result);
+
+  AsyncSnapshot(const char* name, ScanFunction scan, MarshalFunction marshal)
+      : name_(name), scan_(scan), marshal_(marshal) {}
+
+  Napi::Value Request(Napi::Env env, std::shared_ptr<const ProcessFilter> filter = nullptr) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+
+    bool startScan = false;
+    {
+      // The in-flight scan holds its filter, so the key is not reused
+      // while waiters are queued on it
+      std::lock_guard<std::mutex> lock(mutex_);
+      std::vector<Napi::Promise::Deferred>& waiters = waiters_[filter.get()];
+      waiters.push_back(deferred);
+      startScan = waiters.size() == 1;
+    }
+
+    if (startScan) {
+      (new Worker(env, this, filter))->Queue();
+    }
+
+    return deferred.Promise();
+  }
+
+private:
+  class Worker : public Napi::AsyncWorker {
+  public:
+    Worker(Napi::Env env, AsyncSnapshot* owner, std::shared_ptr<const ProcessFilter> filter)
+        : Napi::AsyncWorker(env, owner->name_), owner_(owner), scan_(owner->scan_), filter_(filter) {}
+
+    // Only this runs off the env's thread, so it does not touch owner_; a
+    // ProcessFilter is immutable and safe to read here. An exception here
+    // (bad_alloc, system_error from a pool) would otherwise end the
+    // process; it rejects the waiters instead.
+    void Execute() override {
+      try {
+        result_ = scan_(filter_.get());
+      } catch (const std::exception& e) {
+        SetError(e.what());
+      }
+    }
+
+    void OnOK() override {
+      Napi::Env env = Env();
+      Napi::HandleScope scope(env);
+      for (Napi::Promise::Deferred& deferred : owner_->TakeWaiters(filter_.get())) {
+        StatsStageScope marshal(PipelineStage::Marshal);
+        deferred.Resolve(owner_->marshal_(env, result_));
+      }
+    }
+
+    void OnError(const Napi::Error& error) override {
+      for (Napi::Promise::Deferred& deferred : owner_->TakeWaiters(filter_.get())) {
+        deferred.Reject(error.Value());
+      }
+    }
+
+  private:
+    AsyncSnapshot* owner_;
+    ScanFunction scan_;
+    std::shared_ptr<const ProcessFilter> filter_;
+    Result result_;
+  };
+
+  // Ends the in-flight scan for filter and hands back everyone who was
+  // waiting on it
+  std::vector<Napi::Promise::Deferred> TakeWaiters(const ProcessFilter* filter) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Napi::Promise::Deferred> waiters;
+    auto entry = waiters_.find(filter);
+    if (entry != waiters_.end()) {
+      waiters.swap(entry->second);
+      waiters_.erase(entry);
+    }
+    return waiters;
+  }
+
+  const char* name_;
+  ScanFunction scan_;
+  MarshalFunction marshal_;
+  std::mutex mutex_;
+  // Waiters per in-flight scan, keyed by its filter (null for none)
+  std::map<const ProcessFilter*, std::vector<Napi::Promise::Deferred>> waiters_;
+};
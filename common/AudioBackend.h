@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Platform-neutral view of audio endpoints and the sessions on them. The
+// enumeration pipeline in SessionPipeline.h runs against this interface, so
+// it can be driven by a real backend or by a synthetic one in benchmarks.
+
+enum class AudioDirection {
+    Capture,
+    Render
+};
+
+struct AudioDevice {
+    std::string id;
+    std::string name;
+    AudioDirection direction;
+};
+
+struct AudioSession {
+    uint32_t processId;
+    size_t deviceIndex;  // Index into the device list from the same Enumerate()
+    bool isActive;
+    bool isMuted;
+};
+
+class AudioBackend {
+public:
+    virtual ~AudioBackend() {}
+
+    // Lists every endpoint and every session on it. Returns false and sets
+    // errorCode / errorMessage when the backend cannot be queried.
+    virtual bool Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                           long& errorCode, std::string& errorMessage) = 0;
+
+    // Full executable path for a PID, or "Unknown"
+    virtual std::string ResolveProcessPath(uint32_t processId) = 0;
+};
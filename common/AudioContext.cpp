@@ -0,0 +1,99 @@
+// AudioContext.cpp
+//
+
+#include "AudioContext.h"
+
+#include <algorithm>
+
+AudioContext::AudioContext(std::unique_ptr<ContextBackend> backend)
+    : backend_(std::move(backend)), open_(false), openVersion_(0), stats_() {}
+
+bool AudioContext::Query(long& errorCode, std::string& errorMessage) {
+    stats_.queries++;
+
+    bool succeeded = (open_ && backend_->TopologyVersion() == openVersion_) || Refresh(errorCode, errorMessage);
+    succeeded = succeeded && ReadSessions(errorCode, errorMessage);
+
+    // A device came or went while the sessions were read; some of them may
+    // have been skipped, so read once more against the new device list
+    if (succeeded && backend_->TopologyVersion() != openVersion_) {
+        succeeded = Refresh(errorCode, errorMessage) && ReadSessions(errorCode, errorMessage);
+    }
+
+    if (!succeeded) {
+        // Whatever the backend had open may be what failed
+        stats_.failures++;
+        open_ = false;
+        capture_.clear();
+        render_.clear();
+        return false;
+    }
+
+    Collect();
+    PrunePaths();
+    return true;
+}
+
+void AudioContext::Invalidate() {
+    open_ = false;
+}
+
+bool AudioContext::Refresh(long& errorCode, std::string& errorMessage) {
+    // Read first, so a change during OpenDevices() is caught by the next query
+    openVersion_ = backend_->TopologyVersion();
+    devices_.clear();
+    stats_.refreshes++;
+    open_ = backend_->OpenDevices(devices_, errorCode, errorMessage);
+    return open_;
+}
+
+bool AudioContext::ReadSessions(long& errorCode, std::string& errorMessage) {
+    sessions_.clear();
+    return backend_->ReadSessions(sessions_, errorCode, errorMessage);
+}
+
+void AudioContext::Collect() {
+    capture_.clear();
+    render_.clear();
+
+    // Sessions of one process on one device end up next to each other
+    std::sort(sessions_.begin(), sessions_.end(), [](const AudioSession& a, const AudioSession& b) {
+        return a.deviceIndex != b.deviceIndex ? a.deviceIndex < b.deviceIndex : a.processId < b.processId;
+    });
+
+    for (const AudioSession& session : sessions_) {
+        if (!session.isActive || session.deviceIndex >= devices_.size()) continue;
+
+        bool capture = devices_[session.deviceIndex].direction == AudioDirection::Capture;
+        if (!capture && session.isMuted) continue;
+
+        std::vector<ContextProcess>& processes = capture ? capture_ : render_;
+        if (!processes.empty() && processes.back().deviceIndex == session.deviceIndex &&
+            processes.back().processId == session.processId) {
+            continue;
+        }
+        processes.push_back(ContextProcess{ session.processId, session.deviceIndex, PathOf(session.processId) });
+    }
+}
+
+const std::string* AudioContext::PathOf(uint32_t processId) {
+    auto entry = paths_.find(processId);
+    if (entry == paths_.end()) {
+        stats_.resolves++;
+        entry = paths_.emplace(processId, PathEntry{ backend_->ResolveProcessPath(processId), 0 }).first;
+    }
+    entry->second.lastQuery = stats_.queries;
+    return &entry->second.path;
+}
+
+// A PID that went a query without a session may be reused by the time it
+// has one again, so its path is not kept
+void AudioContext::PrunePaths() {
+    for (auto entry = paths_.begin(); entry != paths_.end();) {
+        if (entry->second.lastQuery != stats_.queries) {
+            entry = paths_.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "AudioBackend.h"
+
+// Backend resources an AudioContext keeps open between queries: whatever is
+// costly to set up per call (a COM apartment and device enumerator, endpoint
+// activations and session managers, scan pools and their buffers). They are
+// built in OpenDevices() and only rebuilt when the topology moves.
+class ContextBackend {
+public:
+    virtual ~ContextBackend() {}
+
+    // Changes whenever the device set may have changed. Read on every query,
+    // so it has to be cheap, e.g. a counter a hot-plug listener bumps.
+    virtual uint64_t TopologyVersion() = 0;
+
+    // Replaces devices with every endpoint and (re)opens what ReadSessions()
+    // needs for them. Returns false and sets errorCode / errorMessage when
+    // the backend cannot be queried.
+    virtual bool OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) = 0;
+
+    // Appends the current sessions on the devices from the last
+    // OpenDevices(). A session on a device that was not opened is skipped,
+    // and TopologyVersion() moved, so the context refreshes and reads again.
+    virtual bool ReadSessions(std::vector<AudioSession>& sessions, long& errorCode, std::string& errorMessage) = 0;
+
+    // Full executable path for a PID, or "Unknown"
+    virtual std::string ResolveProcessPath(uint32_t processId) = 0;
+};
+
+// One process with an active session on one device. Capture entries cover
+// every active capture session, render entries every active, unmuted render
+// session, as CollectCaptureProcesses / CollectRenderProcesses count them.
+struct ContextProcess {
+    uint32_t processId;
+    size_t deviceIndex;       // Into AudioContext::Devices()
+    const std::string* path;  // Owned by the context; valid until the next Query()
+};
+
+struct AudioContextStats {
+    uint64_t queries;
+    uint64_t refreshes;  // OpenDevices() calls, the first one included
+    uint64_t resolves;   // Paths resolved; a PID keeps its path while it has a session
+    uint64_t failures;
+};
+
+// Long-lived enumeration state for callers that query repeatedly. The device
+// list and the backend's open resources survive between queries and are
+// refreshed only when ContextBackend::TopologyVersion() moves, after a failed
+// read, or on Invalidate(). Session and result buffers are reused and paths
+// are kept per PID, so once their capacity has settled, a query of an
+// unchanged system does no allocation of its own.
+//
+// Not safe to share between threads; results are read through the accessors
+// between queries.
+class AudioContext {
+public:
+    explicit AudioContext(std::unique_ptr<ContextBackend> backend);
+
+    // Reads the current sessions, refreshing the devices first when needed
+    bool Query(long& errorCode, std::string& errorMessage);
+
+    // Drops the open devices, so the next Query() refreshes them
+    void Invalidate();
+
+    const std::vector<AudioDevice>& Devices() const { return devices_; }
+    const std::vector<ContextProcess>& Capture() const { return capture_; }
+    const std::vector<ContextProcess>& Render() const { return render_; }
+    AudioContextStats Stats() const { return stats_; }
+
+private:
+    struct PathEntry {
+        std::string path;
+        uint64_t lastQuery;  // Last query that reported the PID
+    };
+
+    bool Refresh(long& errorCode, std::string& errorMessage);
+    bool ReadSessions(long& errorCode, std::string& errorMessage);
+    void Collect();
+    const std::string* PathOf(uint32_t processId);
+    void PrunePaths();
+
+    std::unique_ptr<ContextBackend> backend_;
+    bool open_;
+    uint64_t openVersion_;
+    std::vector<AudioDevice> devices_;
+    std::vector<AudioSession> sessions_;
+    std::vector<ContextProcess> capture_;
+    std::vector<ContextProcess> render_;
+    std::unordered_map<uint32_t, PathEntry> paths_;
+    AudioContextStats stats_;
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <napi.h>
+#include <memory>
+#include <string>
+#include "AddonInstance.h"
+#include "AudioContext.h"
+
+// N-API side of AudioContext, shared by the platform addons. Each platform
+// supplies the factory for its ContextBackend.
+//
+// createAudioContext() returns { query(), invalidate(), stats(), close() }.
+// The handle owns the backend's open devices until close(), or until its env
+// exits; every query in between reuses them. query() returns { success,
+// error, capture, render } with one { processId, path, deviceId,
+// deviceName } per process and device, plus code and domain on failure.
+
+typedef std::unique_ptr<ContextBackend> (*ContextBackendFactory)();
+
+struct AudioContextHandle {
+  std::unique_ptr<AudioContext> context;
+  AddonInstance* addon;
+  AddonInstance::HandleId handle;
+
+  AudioContextHandle() : addon(nullptr), handle(0) {}
+
+  // On the env's JS thread
+  void Close() {
+    if (!context) return;
+    addon->UntrackHandle(handle);
+    context.reset();
+  }
+};
+
+static Napi::Array ContextProcessesToArray(Napi::Env env, const AudioContext& context,
+                                           const std::vector<ContextProcess>& processes) {
+  Napi::Array array = Napi::Array::New(env, processes.size());
+  for (size_t i = 0; i < processes.size(); i++) {
+    const AudioDevice& device = context.Devices()[processes[i].deviceIndex];
+    Napi::Object processObj = Napi::Object::New(env);
+    processObj.Set("processId", Napi::Number::New(env, processes[i].processId));
+    processObj.Set("path", Napi::String::New(env, *processes[i].path));
+    processObj.Set("deviceId", Napi::String::New(env, device.id));
+    processObj.Set("deviceName", Napi::String::New(env, device.name));
+    array.Set(i, processObj);
+  }
+  return array;
+}
+
+static Napi::Value ClosedAudioContextError(Napi::Env env) {
+  Napi::Error::New(env, "The audio context is closed").ThrowAsJavaScriptException();
+  return env.Null();
+}
+
+static Napi::Value CreateAudioContext(const Napi::CallbackInfo& info, ContextBackendFactory factory) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<AudioContextHandle> context = std::make_shared<AudioContextHandle>();
+  context->context.reset(new AudioContext(factory()));
+
+  std::weak_ptr<AudioContextHandle> weakContext = context;
+  context->addon = &AddonInstance::Of(env);
+  context->handle = context->addon->TrackHandle([weakContext]() {
+    std::shared_ptr<AudioContextHandle> context = weakContext.lock();
+    if (context) context->Close();
+  });
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("query", Napi::Function::New(env, [context](const Napi::CallbackInfo& info) -> Napi::Value {
+    Napi::Env env = info.Env();
+    if (!context->context) return ClosedAudioContextError(env);
+
+    AudioContext& audioContext = *context->context;
+    long errorCode = 0;
+    std::string errorMessage;
+    Napi::Object resultObj = Napi::Object::New(env);
+    if (!audioContext.Query(errorCode, errorMessage)) {
+      resultObj.Set("success", Napi::Boolean::New(env, false));
+      resultObj.Set("error", Napi::String::New(env, errorMessage));
+      resultObj.Set("code", Napi::Number::New(env, errorCode));
+      resultObj.Set("domain", Napi::String::New(env, "AudioContext"));
+      resultObj.Set("capture", Napi::Array::New(env));
+      resultObj.Set("render", Napi::Array::New(env));
+      return resultObj;
+    }
+    resultObj.Set("success", Napi::Boolean::New(env, true));
+    resultObj.Set("error", env.Null());
+    resultObj.Set("capture", ContextProcessesToArray(env, audioContext, audioContext.Capture()));
+    resultObj.Set("render", ContextProcessesToArray(env, audioContext, audioContext.Render()));
+    return resultObj;
+  }, "query"));
+  handle.Set("invalidate", Napi::Function::New(env, [context](const Napi::CallbackInfo& info) -> Napi::Value {
+    if (!context->context) return ClosedAudioContextError(info.Env());
+    context->context->Invalidate();
+    return info.Env().Undefined();
+  }, "invalidate"));
+  handle.Set("stats", Napi::Function::New(env, [context](const Napi::CallbackInfo& info) -> Napi::Value {
+    Napi::Env env = info.Env();
+    if (!context->context) return ClosedAudioContextError(env);
+    AudioContextStats stats = context->context->Stats();
+    Napi::Object statsObj = Napi::Object::New(env);
+    statsObj.Set("queries", Napi::Number::New(env, static_cast<double>(stats.queries)));
+    statsObj.Set("refreshes", Napi::Number::New(env, static_cast<double>(stats.refreshes)));
+    statsObj.Set("resolves", Napi::Number::New(env, static_cast<double>(stats.resolves)));
+    statsObj.Set("failures", Napi::Number::New(env, static_cast<double>(stats.failures)));
+    statsObj.Set("devices", Napi::Number::New(env, static_cast<double>(context->context->Devices().size())));
+    return statsObj;
+  }, "stats"));
+  handle.Set("close", Napi::Function::New(env, [context](const Napi::CallbackInfo& info) -> Napi::Value {
+    context->Close();
+    return info.Env().Undefined();
+  }, "close"));
+  return handle;
+}
@@ -0,0 +1,120 @@
+// AudioProcessWatcher.cpp
+//
+
+#include "AudioProcessWatcher.h"
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
+bool WatchedProcess::operator<(const WatchedProcess& other) const {
+    return std::tie(processId, processName, deviceName) <
+           std::tie(other.processId, other.processName, other.deviceName);
+}
+
+bool WatchedProcess::operator==(const WatchedProcess& other) const {
+    return processId == other.processId && processName == other.processName &&
+           deviceName == other.deviceName;
+}
+
+static void Normalize(std::vector<WatchedProcess>& processes) {
+    std::sort(processes.begin(), processes.end());
+    processes.erase(std::unique(processes.begin(), processes.end()), processes.end());
+}
+
+AudioProcessWatcher::AudioProcessWatcher(ScanFunction scan, DeltaCallback onDelta, std::chrono::milliseconds interval)
+    : scan_(scan), onDelta_(onDelta), interval_(interval), stopping_(false), wakePending_(false) {}
+
+AudioProcessWatcher::~AudioProcessWatcher() {
+    Stop();
+}
+
+void AudioProcessWatcher::UseScheduler(std::unique_ptr<TieredProbeScheduler> scheduler) {
+    scheduler_ = std::move(scheduler);
+}
+
+void AudioProcessWatcher::Start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread(&AudioProcessWatcher::Run, this);
+}
+
+void AudioProcessWatcher::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+void AudioProcessWatcher::Wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wakePending_ = true;
+    }
+    wake_.notify_all();
+}
+
+void AudioProcessWatcher::Diff(const std::vector<WatchedProcess>& previous,
+                               const std::vector<WatchedProcess>& current,
+                               ProcessSetDelta& delta) {
+    std::set_difference(current.begin(), current.end(), previous.begin(), previous.end(),
+                        std::back_inserter(delta.added));
+    std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(),
+                        std::back_inserter(delta.removed));
+}
+
+void AudioProcessWatcher::Run() {
+    WatchedSnapshot current;
+    std::string errorMessage;
+
+    for (;;) {
+        current.capture.clear();
+        current.render.clear();
+        errorMessage.clear();
+        long errorCode = 0;
+
+        ProbeTier tier = scheduler_ ? scheduler_->Next() : ProbeTier::Full;
+        if (tier == ProbeTier::Unchanged) {
+            // Nothing to diff
+        } else if (tier == ProbeTier::Idle || scan_(current, errorCode, errorMessage)) {
+            lastError_.clear();
+            Normalize(current.capture);
+            Normalize(current.render);
+
+            ProcessSetDelta capture;
+            ProcessSetDelta render;
+            Diff(previous_.capture, current.capture, capture);
+            Diff(previous_.render, current.render, render);
+
+            if (!capture.added.empty() || !capture.removed.empty() ||
+                !render.added.empty() || !render.removed.empty()) {
+                AudioProcessDelta* delta = new AudioProcessDelta();
+                delta->capture.added.swap(capture.added);
+                delta->capture.removed.swap(capture.removed);
+                delta->render.added.swap(render.added);
+                delta->render.removed.swap(render.removed);
+                onDelta_(delta);
+                if (scheduler_) scheduler_->ReportChanged();
+            }
+            previous_.capture.swap(current.capture);
+            previous_.render.swap(current.render);
+        } else if (errorMessage != lastError_) {
+            lastError_ = errorMessage;
+            AudioProcessDelta* delta = new AudioProcessDelta();
+            delta->errorCode = errorCode;
+            delta->errorMessage = errorMessage.empty() ? "Audio process scan failed" : errorMessage;
+            onDelta_(delta);
+        }
+
+        std::chrono::milliseconds wait = scheduler_ ? scheduler_->Interval() : interval_;
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait_for(lock, wait, [this] { return stopping_ || wakePending_; });
+        if (stopping_) return;
+        wakePending_ = false;
+    }
+}
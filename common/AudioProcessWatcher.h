@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TieredProbeScheduler.h"
+
+// One process using an audio device, as seen by the watcher
+struct WatchedProcess {
+    uint32_t processId;     // 0 when the backend only reports paths
+    std::string processName;
+    std::string deviceName;
+
+    bool operator<(const WatchedProcess& other) const;
+    bool operator==(const WatchedProcess& other) const;
+};
+
+struct WatchedSnapshot {
+    std::vector<WatchedProcess> capture;
+    std::vector<WatchedProcess> render;
+};
+
+struct ProcessSetDelta {
+    std::vector<WatchedProcess> added;
+    std::vector<WatchedProcess> removed;
+};
+
+struct AudioProcessDelta {
+    ProcessSetDelta capture;
+    ProcessSetDelta render;
+    std::string errorMessage;  // Set instead of the sets when a scan failed
+    long errorCode;
+
+    AudioProcessDelta() : errorCode(0) {}
+};
+
+// Hooks wake up to a backend's change notifications, for
+// AudioProcessWatcher::Wake(); returns the function that unhooks it, after
+// which wake is no longer called
+typedef std::function<std::function<void()>(std::function<void()> wake)> ChangeNotifier;
+
+// Polls a scan function on its own thread, keeps the previous snapshot and
+// reports only what was added or removed. Scans that change nothing never
+// reach the callback. Scan failures are reported once per distinct error.
+//
+// With a scheduler, the scan only runs when the scheduler's activity probe
+// saw a change, and the interval adapts; interval then only bounds how
+// long a running stream goes without a rescan.
+//
+// Wake() runs the next tick straight away, for backends that push change
+// notifications; polling carries on as a fallback.
+class AudioProcessWatcher {
+public:
+    typedef std::function<bool(WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage)> ScanFunction;
+    typedef std::function<void(AudioProcessDelta* delta)> DeltaCallback;  // Callee owns delta
+
+    AudioProcessWatcher(ScanFunction scan, DeltaCallback onDelta, std::chrono::milliseconds interval);
+    ~AudioProcessWatcher();
+
+    // Call before Start()
+    void UseScheduler(std::unique_ptr<TieredProbeScheduler> scheduler);
+
+    void Start();
+    void Stop();
+
+    // Safe from any thread; wakes that arrive before the tick runs are merged
+    void Wake();
+
+    // Computes added/removed between two sorted, de-duplicated lists
+    static void Diff(const std::vector<WatchedProcess>& previous,
+                     const std::vector<WatchedProcess>& current,
+                     ProcessSetDelta& delta);
+
+private:
+    void Run();
+
+    ScanFunction scan_;
+    DeltaCallback onDelta_;
+    std::chrono::milliseconds interval_;
+    std::unique_ptr<TieredProbeScheduler> scheduler_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    bool wakePending_;
+    WatchedSnapshot previous_;
+    std::string lastError_;
+};
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Result types produced by the portable enumeration pipeline. They mirror the
+// Windows structs in windows/AudioProcessMonitor.h field for field, without
+// the Win32 types.
+
+struct AudioProcessResult {
+    std::vector<std::string> processes;
+    long errorCode;
+    std::string errorMessage;
+    bool success;
+
+    AudioProcessResult() : errorCode(0), success(true) {}
+};
+
+struct RenderProcessInfo {
+    std::string processName;
+    uint32_t processId;
+    std::string deviceName;
+    bool isActive;
+};
+
+struct RenderProcessResult {
+    std::vector<RenderProcessInfo> processes;
+    long errorCode;
+    std::string errorMessage;
+    bool success;
+
+    RenderProcessResult() : errorCode(0), success(true) {}
+};
@@ -0,0 +1,33 @@
+// BackendWarmup.cpp
+//
+
+#include "BackendWarmup.h"
+
+#include <chrono>
+#include <unordered_set>
+#include <vector>
+
+static double MsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void WarmAudioBackend(AudioBackend& backend, BackendWarmup& warmup) {
+    std::vector<AudioDevice> devices;
+    std::vector<AudioSession> sessions;
+
+    auto start = std::chrono::steady_clock::now();
+    warmup.success = backend.Enumerate(devices, sessions, warmup.errorCode, warmup.errorMessage);
+    warmup.enumerateMs = MsSince(start);
+    if (!warmup.success) return;
+    warmup.devices = devices.size();
+    warmup.sessions = sessions.size();
+
+    // Inactive and muted sessions too: any of them may be reported next
+    start = std::chrono::steady_clock::now();
+    std::unordered_set<uint32_t> resolved;
+    for (const AudioSession& session : sessions) {
+        if (resolved.insert(session.processId).second) backend.ResolveProcessPath(session.processId);
+    }
+    warmup.resolveMs = MsSince(start);
+    warmup.resolvedPaths = resolved.size();
+}
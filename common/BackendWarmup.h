@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "AudioBackend.h"
+
+// What warming a backend did and how long each step took. Like
+// ProcessAudioSnapshot it carries no platform error type, so every addon
+// can return it.
+struct BackendWarmup {
+    std::string backend;   // Name of the backend that was warmed
+    size_t devices;
+    size_t sessions;
+    size_t resolvedPaths;  // Distinct PIDs whose path is now cached
+    double selectMs;       // Loading or connecting the backend; set by the platform
+    double enumerateMs;
+    double resolveMs;
+    long errorCode;
+    std::string errorMessage;
+    bool success;
+
+    BackendWarmup()
+        : devices(0), sessions(0), resolvedPaths(0), selectMs(0), enumerateMs(0), resolveMs(0), errorCode(0),
+          success(true) {}
+};
+
+// Pays the one-time costs of a backend's first enumeration ahead of the
+// first real call: one full device and session walk (which starts worker
+// pools and sizes reused buffers) and a path lookup for every PID with a
+// session, so the resolver cache already holds them.
+void WarmAudioBackend(AudioBackend& backend, BackendWarmup& warmup);
@@ -0,0 +1,76 @@
+#pragma once
+#include <napi.h>
+#include "StringTable.h"
+
+// Columnar marshaling of a RenderProcessResult. Instead of one object per
+// process, PIDs and flags come back in typed arrays and names as indices
+// into a StringTable:
+//
+//   { success, error, processIds: Int32Array, isActive: Uint8Array,
+//     processNameIds: Int32Array, deviceNameIds: Int32Array,
+//     stringTableVersion, strings? }
+//
+// `strings` is only included when the caller's stringTableVersion differs
+// from the current one.
+
+// Reads the { columnar, stringTableVersion } options argument
+static bool ParseColumnarOptions(const Napi::CallbackInfo& info, uint32_t& knownVersion) {
+  knownVersion = 0;
+  if (info.Length() < 1 || !info[0].IsObject()) return false;
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  if (!options.Get("columnar").ToBoolean().Value()) return false;
+
+  Napi::Value version = options.Get("stringTableVersion");
+  if (version.IsNumber()) {
+    knownVersion = version.As<Napi::Number>().Uint32Value();
+  }
+  return true;
+}
+
+template <typename RenderResult>
+static Napi::Value RenderProcessResultToColumns(Napi::Env env, const RenderResult& result,
+                                                StringTable& table, uint32_t knownVersion) {
+  size_t count = result.success ? result.processes.size() : 0;
+
+  Napi::Object resultObj = Napi::Object::New(env);
+  resultObj.Set("success", Napi::Boolean::New(env, result.success));
+  if (!result.success) {
+    resultObj.Set("error", Napi::String::New(env, result.errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, result.errorCode));
+    resultObj.Set("domain", Napi::String::New(env, "RenderProcessMonitor"));
+  } else {
+    resultObj.Set("error", env.Null());
+  }
+
+  Napi::Int32Array processIds = Napi::Int32Array::New(env, count);
+  Napi::Uint8Array isActive = Napi::Uint8Array::New(env, count);
+  Napi::Int32Array processNameIds = Napi::Int32Array::New(env, count);
+  Napi::Int32Array deviceNameIds = Napi::Int32Array::New(env, count);
+
+  // Each process contributes at most two new strings
+  table.Reserve(count * 2);
+  for (size_t i = 0; i < count; i++) {
+    processIds[i] = static_cast<int32_t>(result.processes[i].processId);
+    isActive[i] = result.processes[i].isActive ? 1 : 0;
+    processNameIds[i] = table.Index(result.processes[i].processName);
+    deviceNameIds[i] = table.Index(result.processes[i].deviceName);
+  }
+
+  resultObj.Set("processIds", processIds);
+  resultObj.Set("isActive", isActive);
+  resultObj.Set("processNameIds", processNameIds);
+  resultObj.Set("deviceNameIds", deviceNameIds);
+  resultObj.Set("stringTableVersion", Napi::Number::New(env, table.Version()));
+
+  if (knownVersion != table.Version()) {
+    const std::vector<std::string>& strings = table.Strings();
+    Napi::Array stringsArray = Napi::Array::New(env, strings.size());
+    for (size_t i = 0; i < strings.size(); i++) {
+      stringsArray.Set(i, Napi::String::New(env, strings[i]));
+    }
+    resultObj.Set("strings", stringsArray);
+  }
+
+  return resultObj;
+}
@@ -0,0 +1,256 @@
+// LevelKernels.cpp
+//
+
+#include "LevelKernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LEVEL_KERNELS_SSE2 1
+#endif
+#define LEVEL_KERNELS_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC emits AVX2 intrinsics without /arch:AVX2
+#define LEVEL_TARGET_AVX2
+#else
+#define LEVEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LEVEL_KERNELS_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Float squares are summed in single precision this many samples at a time,
+// then added to the double total, so long windows do not lose precision
+static const size_t kFloatBlock = 4096;
+
+static void Int16Scalar(const int16_t* samples, size_t count, Int16Levels& levels) {
+    uint32_t peak = levels.peak;
+    uint64_t sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        int32_t sample = samples[i];
+        uint32_t magnitude = static_cast<uint32_t>(sample < 0 ? -sample : sample);
+        if (magnitude > peak) peak = magnitude;
+        sum += static_cast<uint64_t>(sample * sample);
+    }
+    levels.peak = peak;
+    levels.sumSquares += sum;
+}
+
+static void Float32Scalar(const float* samples, size_t count, Float32Levels& levels) {
+    float peak = levels.peak;
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        float magnitude = std::fabs(samples[i]);
+        if (magnitude > peak) peak = magnitude;
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    levels.peak = peak;
+    levels.sumSquares += sum;
+}
+
+// Folds the lane-wise max and min of int16 samples into a peak magnitude
+static uint32_t Int16Peak(const int16_t* maxima, const int16_t* minima, size_t lanes, uint32_t peak) {
+    for (size_t i = 0; i < lanes; i++) {
+        peak = std::max(peak, static_cast<uint32_t>(maxima[i]));
+        peak = std::max(peak, static_cast<uint32_t>(-static_cast<int32_t>(minima[i])));
+    }
+    return peak;
+}
+
+#ifdef LEVEL_KERNELS_SSE2
+static void Int16Sse2(const int16_t* samples, size_t count, Int16Levels& levels) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i maxima = zero;
+    __m128i minima = zero;
+    __m128i sum = zero;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        maxima = _mm_max_epi16(maxima, x);
+        minima = _mm_min_epi16(minima, x);
+        // Pairs of squares; at most 2^31, so exact read as unsigned
+        __m128i squares = _mm_madd_epi16(x, x);
+        sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(squares, zero));
+        sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(squares, zero));
+    }
+
+    alignas(16) int16_t maxLanes[8];
+    alignas(16) int16_t minLanes[8];
+    alignas(16) uint64_t sumLanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(maxLanes), maxima);
+    _mm_store_si128(reinterpret_cast<__m128i*>(minLanes), minima);
+    _mm_store_si128(reinterpret_cast<__m128i*>(sumLanes), sum);
+    levels.peak = Int16Peak(maxLanes, minLanes, 8, levels.peak);
+    levels.sumSquares += sumLanes[0] + sumLanes[1];
+    Int16Scalar(samples + i, count - i, levels);
+}
+
+static void Float32Sse2(const float* samples, size_t count, Float32Levels& levels) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 maxima = _mm_setzero_ps();
+    size_t i = 0;
+    while (i + 4 <= count) {
+        size_t end = std::min(count, i + kFloatBlock) & ~static_cast<size_t>(3);
+        __m128 sum = _mm_setzero_ps();
+        for (; i < end; i += 4) {
+            __m128 x = _mm_loadu_ps(samples + i);
+            maxima = _mm_max_ps(maxima, _mm_and_ps(x, absMask));
+            sum = _mm_add_ps(sum, _mm_mul_ps(x, x));
+        }
+        alignas(16) float sumLanes[4];
+        _mm_store_ps(sumLanes, sum);
+        levels.sumSquares += static_cast<double>(sumLanes[0]) + sumLanes[1] + sumLanes[2] + sumLanes[3];
+    }
+
+    alignas(16) float maxLanes[4];
+    _mm_store_ps(maxLanes, maxima);
+    levels.peak = std::max(levels.peak, *std::max_element(maxLanes, maxLanes + 4));
+    Float32Scalar(samples + i, count - i, levels);
+}
+#endif
+
+#ifdef LEVEL_KERNELS_AVX2
+LEVEL_TARGET_AVX2 static void Int16Avx2(const int16_t* samples, size_t count, Int16Levels& levels) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i maxima = zero;
+    __m256i minima = zero;
+    __m256i sum = zero;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i));
+        maxima = _mm256_max_epi16(maxima, x);
+        minima = _mm256_min_epi16(minima, x);
+        __m256i squares = _mm256_madd_epi16(x, x);
+        sum = _mm256_add_epi64(sum, _mm256_unpacklo_epi32(squares, zero));
+        sum = _mm256_add_epi64(sum, _mm256_unpackhi_epi32(squares, zero));
+    }
+
+    alignas(32) int16_t maxLanes[16];
+    alignas(32) int16_t minLanes[16];
+    alignas(32) uint64_t sumLanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxLanes), maxima);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(minLanes), minima);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(sumLanes), sum);
+    levels.peak = Int16Peak(maxLanes, minLanes, 16, levels.peak);
+    levels.sumSquares += sumLanes[0] + sumLanes[1] + sumLanes[2] + sumLanes[3];
+    Int16Scalar(samples + i, count - i, levels);
+}
+
+LEVEL_TARGET_AVX2 static void Float32Avx2(const float* samples, size_t count, Float32Levels& levels) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 maxima = _mm256_setzero_ps();
+    size_t i = 0;
+    while (i + 8 <= count) {
+        size_t end = std::min(count, i + kFloatBlock) & ~static_cast<size_t>(7);
+        __m256 sum = _mm256_setzero_ps();
+        for (; i < end; i += 8) {
+            __m256 x = _mm256_loadu_ps(samples + i);
+            maxima = _mm256_max_ps(maxima, _mm256_and_ps(x, absMask));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(x, x));
+        }
+        alignas(32) float sumLanes[8];
+        _mm256_store_ps(sumLanes, sum);
+        double blockSum = 0;
+        for (float lane : sumLanes) blockSum += lane;
+        levels.sumSquares += blockSum;
+    }
+
+    alignas(32) float maxLanes[8];
+    _mm256_store_ps(maxLanes, maxima);
+    levels.peak = std::max(levels.peak, *std::max_element(maxLanes, maxLanes + 8));
+    Float32Scalar(samples + i, count - i, levels);
+}
+
+static bool CpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6;
+    if (!osSavesYmm) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#ifdef LEVEL_KERNELS_NEON
+static void Int16Neon(const int16_t* samples, size_t count, Int16Levels& levels) {
+    int16x8_t maxima = vdupq_n_s16(0);
+    int16x8_t minima = vdupq_n_s16(0);
+    int64x2_t sum = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t x = vld1q_s16(samples + i);
+        maxima = vmaxq_s16(maxima, x);
+        minima = vminq_s16(minima, x);
+        // One square is at most 2^30
+        sum = vpadalq_s32(sum, vmull_s16(vget_low_s16(x), vget_low_s16(x)));
+        sum = vpadalq_s32(sum, vmull_high_s16(x, x));
+    }
+
+    int16_t maxLane = vmaxvq_s16(maxima);
+    int16_t minLane = vminvq_s16(minima);
+    levels.peak = Int16Peak(&maxLane, &minLane, 1, levels.peak);
+    levels.sumSquares += static_cast<uint64_t>(vaddvq_s64(sum));
+    Int16Scalar(samples + i, count - i, levels);
+}
+
+static void Float32Neon(const float* samples, size_t count, Float32Levels& levels) {
+    float32x4_t maxima = vdupq_n_f32(0);
+    size_t i = 0;
+    while (i + 4 <= count) {
+        size_t end = std::min(count, i + kFloatBlock) & ~static_cast<size_t>(3);
+        float32x4_t sum = vdupq_n_f32(0);
+        for (; i < end; i += 4) {
+            float32x4_t x = vld1q_f32(samples + i);
+            maxima = vmaxq_f32(maxima, vabsq_f32(x));
+            sum = vfmaq_f32(sum, x, x);
+        }
+        levels.sumSquares += vaddvq_f32(sum);
+    }
+
+    levels.peak = std::max(levels.peak, vmaxvq_f32(maxima));
+    Float32Scalar(samples + i, count - i, levels);
+}
+#endif
+
+static const LevelKernels kScalarKernels = { "scalar", Int16Scalar, Float32Scalar };
+#ifdef LEVEL_KERNELS_SSE2
+static const LevelKernels kSse2Kernels = { "sse2", Int16Sse2, Float32Sse2 };
+#endif
+#ifdef LEVEL_KERNELS_AVX2
+static const LevelKernels kAvx2Kernels = { "avx2", Int16Avx2, Float32Avx2 };
+#endif
+#ifdef LEVEL_KERNELS_NEON
+static const LevelKernels kNeonKernels = { "neon", Int16Neon, Float32Neon };
+#endif
+
+std::vector<const LevelKernels*> SupportedLevelKernels() {
+    std::vector<const LevelKernels*> kernels;
+    kernels.push_back(&kScalarKernels);
+#ifdef LEVEL_KERNELS_SSE2
+    kernels.push_back(&kSse2Kernels);
+#endif
+#ifdef LEVEL_KERNELS_AVX2
+    if (CpuHasAvx2()) kernels.push_back(&kAvx2Kernels);
+#endif
+#ifdef LEVEL_KERNELS_NEON
+    kernels.push_back(&kNeonKernels);
+#endif
+    return kernels;
+}
+
+const LevelKernels& SelectedLevelKernels() {
+    static const LevelKernels* selected = SupportedLevelKernels().back();
+    return *selected;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Peak and sum-of-squares kernels over interleaved PCM samples, the inner
+// loop of level metering. Each instruction set gets its own implementation
+// (SSE2, AVX2, NEON) next to a scalar one; the best the CPU supports is
+// picked once at runtime, so a binary built for a baseline x86-64 still
+// uses AVX2 where it is available.
+//
+// Kernels accumulate: peak becomes the larger of its old value and the
+// block's, and the block's squares are added to sumSquares, so a window
+// can be fed in pieces. Every kernel returns exactly what the scalar one
+// does for int16; float32 sums may differ in the last bits.
+
+struct Int16Levels {
+    uint32_t peak;        // Largest |sample|, up to 32768
+    uint64_t sumSquares;  // Exact
+
+    Int16Levels() : peak(0), sumSquares(0) {}
+};
+
+struct Float32Levels {
+    float peak;  // Largest |sample|; full scale is 1.0
+    double sumSquares;
+
+    Float32Levels() : peak(0), sumSquares(0) {}
+};
+
+struct LevelKernels {
+    const char* name;  // "scalar", "sse2", "avx2" or "neon"
+    void (*int16)(const int16_t* samples, size_t count, Int16Levels& levels);
+    void (*float32)(const float* samples, size_t count, Float32Levels& levels);
+};
+
+// The fastest kernels this CPU runs; chosen on first use
+const LevelKernels& SelectedLevelKernels();
+
+// Every set this CPU runs, scalar first, for benchmarks and cross-checks
+std::vector<const LevelKernels*> SupportedLevelKernels();
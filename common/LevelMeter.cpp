@@ -0,0 +1,282 @@
+// LevelMeter.cpp
+//
+
+#include "LevelMeter.h"
+
+#include <errno.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Most a meter reads at once, so Stop() never waits long on a source
+static const uint32_t kMaxReadMs = 10;
+
+static uint64_t WallClockMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static double ToDb(double linear) {
+    return linear > 0 ? std::max(20.0 * std::log10(linear), kSilenceDb) : kSilenceDb;
+}
+
+static LevelReading ToReading(double peak, double sumSquares, size_t count) {
+    LevelReading reading;
+    reading.timestampMs = WallClockMs();
+    reading.peak = peak;
+    reading.rms = count > 0 ? std::sqrt(sumSquares / count) : 0.0;
+    reading.peakDb = ToDb(reading.peak);
+    reading.rmsDb = ToDb(reading.rms);
+    reading.voice = false;
+    return reading;
+}
+
+static LevelReading ToReading(const Int16Levels& levels, size_t count) {
+    // Full scale is 32768, so the squares scale by its square
+    return ToReading(levels.peak / 32768.0, static_cast<double>(levels.sumSquares) / (32768.0 * 32768.0), count);
+}
+
+static LevelReading ToReading(const Float32Levels& levels, size_t count) {
+    return ToReading(levels.peak, levels.sumSquares, count);
+}
+
+LevelReading MeasureLevels(const void* samples, size_t count, SampleFormat format) {
+    const LevelKernels& kernels = SelectedLevelKernels();
+    if (format == SampleFormat::Int16) {
+        Int16Levels levels;
+        kernels.int16(static_cast<const int16_t*>(samples), count, levels);
+        return ToReading(levels, count);
+    }
+    Float32Levels levels;
+    kernels.float32(static_cast<const float*>(samples), count, levels);
+    return ToReading(levels, count);
+}
+
+LevelMeter::LevelMeter(std::unique_ptr<PcmSource> source, const LevelMeterOptions& options, NotifyFunction notify)
+    : source_(std::move(source)),
+      options_(options),
+      notify_(notify),
+      kernels_(SelectedLevelKernels()),
+      stopping_(false),
+      finished_(false),
+      errorCode_(0),
+      frames_(0),
+      readings_(0),
+      dropped_(0) {
+    options_.windowMs = std::max<uint32_t>(options_.windowMs, 1);
+    options_.capacity = std::max<size_t>(options_.capacity, 1);
+}
+
+LevelMeter::~LevelMeter() {
+    Stop();
+}
+
+void LevelMeter::Start() {
+    if (thread_.joinable()) return;
+    stopping_ = false;
+    thread_ = std::thread(&LevelMeter::Run, this);
+}
+
+void LevelMeter::Stop() {
+    stopping_ = true;
+    if (thread_.joinable()) thread_.join();
+}
+
+void LevelMeter::Drain(std::vector<LevelReading>& readings, bool& finished, long& errorCode,
+                       std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    readings.assign(ring_.begin(), ring_.end());
+    ring_.clear();
+    finished = finished_;
+    errorCode = errorCode_;
+    errorMessage = errorMessage_;
+}
+
+LevelMeterStats LevelMeter::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LevelMeterStats stats;
+    stats.frames = frames_;
+    stats.readings = readings_;
+    stats.dropped = dropped_;
+    stats.kernel = kernels_.name;
+    return stats;
+}
+
+void LevelMeter::Run() {
+    const PcmFormat& format = source_->Format();
+    const size_t frameBytes = format.BytesPerFrame();
+    const size_t windowFrames = std::max<size_t>(1, static_cast<size_t>(format.sampleRate) * options_.windowMs / 1000);
+    const size_t readFrames =
+        std::min(windowFrames, std::max<size_t>(1, static_cast<size_t>(format.sampleRate) * kMaxReadMs / 1000));
+    const uint64_t holdFrames = static_cast<uint64_t>(format.sampleRate) * options_.holdMs / 1000;
+    std::vector<char> buffer(readFrames * frameBytes);
+
+    Int16Levels int16Levels;
+    Float32Levels float32Levels;
+    size_t windowFilled = 0;
+    uint64_t framesRead = 0;
+    bool voiced = false;
+    uint64_t lastVoiceFrame = 0;
+
+    // Reduces the window so far to a reading and starts the next one
+    auto finishWindow = [&]() {
+        size_t count = windowFilled * format.channels;
+        LevelReading reading = format.sampleFormat == SampleFormat::Int16 ? ToReading(int16Levels, count)
+                                                                          : ToReading(float32Levels, count);
+        if (reading.rmsDb >= options_.voiceThresholdDb) {
+            voiced = true;
+            lastVoiceFrame = framesRead;
+        }
+        reading.voice = voiced && framesRead - lastVoiceFrame <= holdFrames;
+        Publish(reading);
+
+        int16Levels = Int16Levels();
+        float32Levels = Float32Levels();
+        windowFilled = 0;
+    };
+
+    while (!stopping_) {
+        size_t want = std::min(readFrames, windowFrames - windowFilled) * frameBytes;
+        size_t read = 0;
+        long errorCode = 0;
+        std::string errorMessage;
+        if (!source_->Read(buffer.data(), want, read, errorCode, errorMessage)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_ = true;
+            errorCode_ = errorCode;
+            errorMessage_ = errorMessage;
+            break;
+        }
+        if (read == 0) {
+            if (windowFilled > 0) finishWindow();
+            std::lock_guard<std::mutex> lock(mutex_);
+            finished_ = true;
+            break;
+        }
+
+        size_t frames = read / frameBytes;
+        size_t count = frames * format.channels;
+        if (format.sampleFormat == SampleFormat::Int16) {
+            kernels_.int16(reinterpret_cast<const int16_t*>(buffer.data()), count, int16Levels);
+        } else {
+            kernels_.float32(reinterpret_cast<const float*>(buffer.data()), count, float32Levels);
+        }
+        windowFilled += frames;
+        framesRead += frames;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            frames_ += frames;
+        }
+        if (windowFilled >= windowFrames) finishWindow();
+    }
+
+    // Lets the consumer see the end of the stream or the error
+    if (!stopping_ && notify_) notify_();
+}
+
+void LevelMeter::Publish(const LevelReading& reading) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ring_.size() >= options_.capacity) {
+            ring_.pop_front();
+            dropped_++;
+        }
+        ring_.push_back(reading);
+        readings_++;
+    }
+    if (notify_) notify_();
+}
+
+static uint32_t ReadLE(const char* data, int bytes) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+    return value;
+}
+
+std::unique_ptr<PcmSource> WavFileSource::Open(const std::string& path, bool loop, bool realtime,
+                                               long& errorCode, std::string& errorMessage) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        errorCode = ENOENT;
+        errorMessage = "Failed to open " + path;
+        return nullptr;
+    }
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (bytes.size() < 12 || memcmp(bytes.data(), "RIFF", 4) != 0 || memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        errorCode = EINVAL;
+        errorMessage = path + " is not a WAVE file";
+        return nullptr;
+    }
+
+    std::unique_ptr<WavFileSource> source(new WavFileSource());
+    source->loop_ = loop;
+    source->realtime_ = realtime;
+    uint32_t encoding = 0;
+    uint32_t bitsPerSample = 0;
+    bool haveFormat = false;
+    bool haveData = false;
+
+    // Chunks are padded to an even size
+    for (size_t offset = 12; offset + 8 <= bytes.size();) {
+        const char* chunk = bytes.data() + offset;
+        size_t size = ReadLE(chunk + 4, 4);
+        size_t body = offset + 8;
+        if (size > bytes.size() - body) size = bytes.size() - body;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            encoding = ReadLE(chunk + 8, 2);
+            source->format_.channels = ReadLE(chunk + 10, 2);
+            source->format_.sampleRate = ReadLE(chunk + 12, 4);
+            bitsPerSample = ReadLE(chunk + 22, 2);
+            // WAVE_FORMAT_EXTENSIBLE keeps the real tag at the start of its GUID
+            if (encoding == 0xfffe && size >= 26) encoding = ReadLE(chunk + 32, 2);
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            source->data_.assign(bytes.begin() + body, bytes.begin() + body + size);
+            haveData = true;
+        }
+        offset = body + size + (size & 1);
+    }
+
+    if (encoding == 1 && bitsPerSample == 16) {
+        source->format_.sampleFormat = SampleFormat::Int16;
+    } else if (encoding == 3 && bitsPerSample == 32) {
+        source->format_.sampleFormat = SampleFormat::Float32;
+    } else {
+        haveFormat = false;
+    }
+    if (!haveFormat || !haveData || source->format_.channels == 0 || source->format_.sampleRate == 0) {
+        errorCode = EINVAL;
+        errorMessage = path + " is not 16-bit integer or 32-bit float PCM";
+        return nullptr;
+    }
+
+    // Drops a trailing partial frame
+    size_t frameBytes = source->format_.BytesPerFrame();
+    source->data_.resize(source->data_.size() / frameBytes * frameBytes);
+    return std::unique_ptr<PcmSource>(source.release());
+}
+
+bool WavFileSource::Read(char* data, size_t size, size_t& read, long&, std::string&) {
+    read = 0;
+    if (position_ == data_.size()) {
+        if (!loop_ || data_.empty()) return true;
+        position_ = 0;
+    }
+
+    size_t frameBytes = format_.BytesPerFrame();
+    read = std::min(size, data_.size() - position_) / frameBytes * frameBytes;
+    memcpy(data, data_.data() + position_, read);
+    position_ += read;
+
+    // Never ahead of the clock, as a capture stream would be
+    if (realtime_) {
+        if (framesPlayed_ == 0) started_ = std::chrono::steady_clock::now();
+        framesPlayed_ += read / frameBytes;
+        std::this_thread::sleep_until(started_ + std::chrono::microseconds(framesPlayed_ * 1000000 / format_.sampleRate));
+    }
+    return true;
+}
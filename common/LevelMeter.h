@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "LevelKernels.h"
+
+enum class SampleFormat {
+    Int16,
+    Float32
+};
+
+struct PcmFormat {
+    SampleFormat sampleFormat;
+    uint32_t sampleRate;
+    uint32_t channels;
+
+    size_t BytesPerFrame() const { return (sampleFormat == SampleFormat::Int16 ? 2 : 4) * channels; }
+};
+
+// Where a meter's interleaved PCM comes from: a capture stream, or a file
+// standing in for one in tests and benchmarks
+class PcmSource {
+public:
+    virtual ~PcmSource() {}
+
+    virtual const PcmFormat& Format() const = 0;
+
+    // Reads at most size bytes, whole frames only, blocking until some are
+    // available. Sets read to the bytes delivered, 0 at the end of the
+    // stream; returns false and sets errorCode / errorMessage on failure.
+    virtual bool Read(char* data, size_t size, size_t& read, long& errorCode, std::string& errorMessage) = 0;
+};
+
+// Levels of one window, across every channel
+struct LevelReading {
+    uint64_t timestampMs;  // Wall clock when the window completed
+    double peak;           // Linear, 1.0 is full scale
+    double rms;
+    double peakDb;         // dBFS, floored at kSilenceDb
+    double rmsDb;
+    bool voice;            // rmsDb reached the threshold within the hold time
+};
+
+// Floor for the dB values of digital silence
+static const double kSilenceDb = -120.0;
+
+// Levels of one block of samples, without a meter
+LevelReading MeasureLevels(const void* samples, size_t count, SampleFormat format);
+
+struct LevelMeterOptions {
+    uint32_t windowMs;         // One reading per window of source audio
+    double voiceThresholdDb;   // RMS at or above this counts as voice
+    uint32_t holdMs;           // Voice stays set this long after the RMS drops
+    size_t capacity;           // Readings kept for the consumer; the oldest go first
+
+    LevelMeterOptions() : windowMs(50), voiceThresholdDb(-45.0), holdMs(300), capacity(64) {}
+};
+
+struct LevelMeterStats {
+    uint64_t frames;     // Read from the source
+    uint64_t readings;   // Produced
+    uint64_t dropped;    // Overwritten before the consumer drained them
+    const char* kernel;
+};
+
+// Reads a PcmSource on its own thread, reduces each window of frames to a
+// LevelReading with the selected SIMD kernels and keeps the latest readings
+// in a bounded ring. notify runs on the meter thread after readings are
+// added; the consumer drains the ring at its own pace, so a slow consumer
+// costs readings, never memory or a blocked source.
+class LevelMeter {
+public:
+    typedef std::function<void()> NotifyFunction;
+
+    LevelMeter(std::unique_ptr<PcmSource> source, const LevelMeterOptions& options, NotifyFunction notify);
+    ~LevelMeter();
+
+    void Start();
+    void Stop();
+
+    // Moves the buffered readings into readings, oldest first. Once the
+    // source has ended or failed and the ring is empty, sets finished, and
+    // errorMessage when it failed.
+    void Drain(std::vector<LevelReading>& readings, bool& finished, long& errorCode, std::string& errorMessage);
+
+    LevelMeterStats Stats() const;
+
+private:
+    void Run();
+    void Publish(const LevelReading& reading);
+
+    std::unique_ptr<PcmSource> source_;
+    LevelMeterOptions options_;
+    NotifyFunction notify_;
+    const LevelKernels& kernels_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+    mutable std::mutex mutex_;
+    std::deque<LevelReading> ring_;
+    bool finished_;
+    long errorCode_;
+    std::string errorMessage_;
+    uint64_t frames_;
+    uint64_t readings_;
+    uint64_t dropped_;
+};
+
+// Plays a RIFF WAVE file of 16-bit integer or 32-bit float PCM as a
+// PcmSource, optionally looping and paced to real time, so metering can be
+// exercised without an audio device
+class WavFileSource : public PcmSource {
+public:
+    // Returns nullptr and sets errorCode / errorMessage when path cannot be
+    // read or holds another encoding
+    static std::unique_ptr<PcmSource> Open(const std::string& path, bool loop, bool realtime,
+                                           long& errorCode, std::string& errorMessage);
+
+    const PcmFormat& Format() const override { return format_; }
+    bool Read(char* data, size_t size, size_t& read, long& errorCode, std::string& errorMessage) override;
+
+private:
+    WavFileSource() : loop_(false), realtime_(false), position_(0), framesPlayed_(0) {}
+
+    PcmFormat format_;
+    std::vector<char> data_;  // The data chunk
+    bool loop_;
+    bool realtime_;
+    size_t position_;
+    uint64_t framesPlayed_;
+    std::chrono::steady_clock::time_point started_;
+};
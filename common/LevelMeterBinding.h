@@ -0,0 +1,286 @@
+#pragma once
+#include <napi.h>
+#include <atomic>
+#include <cerrno>
+#include <memory>
+#include <string>
+#include "AddonInstance.h"
+#include "LevelMeter.h"
+
+// N-API side of LevelMeter, shared by the platform addons. Each platform
+// supplies the factory for device capture, or nullptr where it has none;
+// a WAV file works everywhere as a stand-in.
+//
+// Readings reach JS as in MonitorHubBinding.h: the meter thread only adds
+// to the meter's bounded ring and, if no drain is pending, schedules one
+// with NonBlockingCall, so a busy event loop costs the oldest readings
+// rather than memory or a stalled capture stream.
+
+typedef std::unique_ptr<PcmSource> (*DeviceSourceFactory)(const std::string& device, const PcmFormat& format,
+                                                          uint32_t fragmentMs, long& errorCode,
+                                                          std::string& errorMessage);
+
+struct LevelMeterSession;
+
+static void DrainLevelMeter(Napi::Env env, Napi::Function js_callback, std::shared_ptr<LevelMeterSession>* context,
+                            void* data);
+
+typedef Napi::TypedThreadSafeFunction<std::shared_ptr<LevelMeterSession>, void, DrainLevelMeter> LevelMeterFunction;
+
+struct LevelMeterSession {
+  std::unique_ptr<LevelMeter> meter;
+  LevelMeterFunction tsfn;
+  AddonInstance* addon;
+  AddonInstance::HandleId handle;
+  std::atomic<bool> scheduled;  // A drain is queued on the TSFN
+  std::atomic<bool> released;
+
+  LevelMeterSession() : addon(nullptr), handle(0), scheduled(false), released(false) {}
+
+  // On the meter thread
+  void ScheduleDrain() {
+    if (released || scheduled.exchange(true)) return;
+    if (tsfn.NonBlockingCall() != napi_ok) {
+      scheduled = false;
+    }
+  }
+
+  // On the env's JS thread
+  void Stop() {
+    if (released.exchange(true)) return;
+    addon->UntrackHandle(handle);
+    meter->Stop();
+    tsfn.Release();
+  }
+};
+
+static Napi::Object LevelReadingToObject(Napi::Env env, const LevelReading& reading) {
+  Napi::Object readingObj = Napi::Object::New(env);
+  readingObj.Set("timestamp", Napi::Number::New(env, static_cast<double>(reading.timestampMs)));
+  readingObj.Set("peak", Napi::Number::New(env, reading.peak));
+  readingObj.Set("rms", Napi::Number::New(env, reading.rms));
+  readingObj.Set("peakDb", Napi::Number::New(env, reading.peakDb));
+  readingObj.Set("rmsDb", Napi::Number::New(env, reading.rmsDb));
+  readingObj.Set("voice", Napi::Boolean::New(env, reading.voice));
+  return readingObj;
+}
+
+static Napi::Error LevelMeterError(Napi::Env env, long errorCode, const std::string& errorMessage) {
+  Napi::Error err = Napi::Error::New(env, errorMessage);
+  err.Set("code", Napi::Number::New(env, errorCode));
+  err.Set("domain", Napi::String::New(env, "LevelMeter"));
+  return err;
+}
+
+// Calls back with (readings, error, ended): every reading buffered since the
+// last drain, oldest first, and once the source ends or fails, a last call
+// with ended set and the error if there was one
+static void DrainLevelMeter(Napi::Env env, Napi::Function js_callback, std::shared_ptr<LevelMeterSession>* context,
+                            void*) {
+  if (!env || !context) return;  // Env teardown
+  LevelMeterSession& session = **context;
+
+  // Cleared first: anything added from here on schedules another drain
+  session.scheduled = false;
+  if (session.released) return;
+
+  std::vector<LevelReading> readings;
+  bool finished = false;
+  long errorCode = 0;
+  std::string errorMessage;
+  session.meter->Drain(readings, finished, errorCode, errorMessage);
+
+  Napi::HandleScope scope(env);
+  if (!readings.empty()) {
+    Napi::Array array = Napi::Array::New(env, readings.size());
+    for (size_t i = 0; i < readings.size(); i++) {
+      array.Set(i, LevelReadingToObject(env, readings[i]));
+    }
+    js_callback.Call({ array, env.Null(), Napi::Boolean::New(env, false) });
+  }
+
+  if (finished && !session.released) {
+    Napi::Value error = errorMessage.empty() ? env.Null() : LevelMeterError(env, errorCode, errorMessage).Value();
+    js_callback.Call({ Napi::Array::New(env, 0), error, Napi::Boolean::New(env, true) });
+    session.Stop();
+  }
+}
+
+static bool LevelNumberOption(Napi::Env env, Napi::Object options, const char* name, double min, double max,
+                              double& value) {
+  Napi::Value option = options.Get(name);
+  if (option.IsUndefined()) return true;
+  if (!option.IsNumber() || option.As<Napi::Number>().DoubleValue() < min ||
+      option.As<Napi::Number>().DoubleValue() > max) {
+    Napi::RangeError::New(env, std::string(name) + " must be a number from " +
+                          std::to_string(static_cast<long long>(min)) + " to " +
+                          std::to_string(static_cast<long long>(max))).ThrowAsJavaScriptException();
+    return false;
+  }
+  value = option.As<Napi::Number>().DoubleValue();
+  return true;
+}
+
+static bool LevelBooleanOption(Napi::Object options, const char* name, bool fallback) {
+  Napi::Value value = options.Get(name);
+  return value.IsBoolean() ? value.As<Napi::Boolean>().Value() : fallback;
+}
+
+// startLevelMeter(options, callback) where options is
+// { device = "default", file, loop = false, realtime = true,
+//   format = "float32" | "int16", sampleRate = 48000, channels = 1,
+//   rateHz = 20, voiceThresholdDb = -45, holdMs = 300, bufferSize = 64 }.
+// file meters a WAV file instead of a device, in its own format. Each
+// reading is { timestamp, peak, rms, peakDb, rmsDb, voice } over 1/rateHz
+// seconds of audio; voice is set once the RMS reaches voiceThresholdDb and
+// stays set holdMs after it drops. At most bufferSize readings wait for JS.
+// Returns { stop(), stats() }.
+static Napi::Value StartLevelMeter(const Napi::CallbackInfo& info, DeviceSourceFactory openDevice) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Expected an options object and a callback function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  std::string device = "default";
+  std::string file;
+  if (options.Get("device").IsString()) device = options.Get("device").As<Napi::String>().Utf8Value();
+  if (options.Get("file").IsString()) file = options.Get("file").As<Napi::String>().Utf8Value();
+
+  PcmFormat format;
+  format.sampleFormat = SampleFormat::Float32;
+  Napi::Value formatOption = options.Get("format");
+  if (formatOption.IsString() && formatOption.As<Napi::String>().Utf8Value() == "int16") {
+    format.sampleFormat = SampleFormat::Int16;
+  } else if (!formatOption.IsUndefined() &&
+             !(formatOption.IsString() && formatOption.As<Napi::String>().Utf8Value() == "float32")) {
+    Napi::TypeError::New(env, "format must be \"int16\" or \"float32\"").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  double sampleRate = 48000;
+  double channels = 1;
+  double rateHz = 20;
+  double voiceThresholdDb = -45;
+  double holdMs = 300;
+  double bufferSize = 64;
+  if (!LevelNumberOption(env, options, "sampleRate", 8000, 192000, sampleRate) ||
+      !LevelNumberOption(env, options, "channels", 1, 32, channels) ||
+      !LevelNumberOption(env, options, "rateHz", 1, 200, rateHz) ||
+      !LevelNumberOption(env, options, "voiceThresholdDb", kSilenceDb, 0, voiceThresholdDb) ||
+      !LevelNumberOption(env, options, "holdMs", 0, 60000, holdMs) ||
+      !LevelNumberOption(env, options, "bufferSize", 1, 65536, bufferSize)) {
+    return env.Null();
+  }
+  format.sampleRate = static_cast<uint32_t>(sampleRate);
+  format.channels = static_cast<uint32_t>(channels);
+
+  LevelMeterOptions meterOptions;
+  meterOptions.windowMs = static_cast<uint32_t>(1000 / rateHz);
+  meterOptions.voiceThresholdDb = voiceThresholdDb;
+  meterOptions.holdMs = static_cast<uint32_t>(holdMs);
+  meterOptions.capacity = static_cast<size_t>(bufferSize);
+
+  long errorCode = 0;
+  std::string errorMessage;
+  std::unique_ptr<PcmSource> source;
+  if (!file.empty()) {
+    source = WavFileSource::Open(file, LevelBooleanOption(options, "loop", false),
+                                 LevelBooleanOption(options, "realtime", true), errorCode, errorMessage);
+  } else if (openDevice) {
+    source = openDevice(device, format, meterOptions.windowMs, errorCode, errorMessage);
+  } else {
+    errorCode = ENOSYS;
+    errorMessage = "Device metering is not supported on this platform; pass { file } instead";
+  }
+  if (!source) {
+    LevelMeterError(env, errorCode, errorMessage).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Shared by the JS handle and the TSFN, whichever outlives the other
+  std::shared_ptr<LevelMeterSession>* context =
+      new std::shared_ptr<LevelMeterSession>(std::make_shared<LevelMeterSession>());
+  std::shared_ptr<LevelMeterSession> session = *context;
+  session->addon = &AddonInstance::Of(env);
+
+  session->tsfn = LevelMeterFunction::New(
+    env,
+    info[1].As<Napi::Function>(),
+    "LevelMeter",
+    0,
+    1,
+    context,
+    [](Napi::Env, std::shared_ptr<LevelMeterSession>* context) {
+      // Runs once the TSFN is released or the env is torn down
+      if (!(*context)->released.exchange(true)) {
+        (*context)->addon->UntrackHandle((*context)->handle);
+      }
+      (*context)->meter->Stop();
+      delete context;
+    }
+  );
+
+  // The meter belongs to the session and is joined before it goes away
+  LevelMeterSession* raw = session.get();
+  session->meter.reset(new LevelMeter(std::move(source), meterOptions, [raw]() { raw->ScheduleDrain(); }));
+  session->meter->Start();
+
+  std::weak_ptr<LevelMeterSession> weakSession = session;
+  session->handle = session->addon->TrackHandle([weakSession]() {
+    std::shared_ptr<LevelMeterSession> session = weakSession.lock();
+    if (session) session->Stop();
+  });
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("stop", Napi::Function::New(env, [session](const Napi::CallbackInfo& info) -> Napi::Value {
+    session->Stop();
+    return info.Env().Undefined();
+  }, "stop"));
+  handle.Set("stats", Napi::Function::New(env, [session](const Napi::CallbackInfo& info) -> Napi::Value {
+    Napi::Env env = info.Env();
+    LevelMeterStats stats = session->meter->Stats();
+    Napi::Object statsObj = Napi::Object::New(env);
+    statsObj.Set("frames", Napi::Number::New(env, static_cast<double>(stats.frames)));
+    statsObj.Set("readings", Napi::Number::New(env, static_cast<double>(stats.readings)));
+    statsObj.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+    statsObj.Set("kernel", Napi::String::New(env, stats.kernel));
+    return statsObj;
+  }, "stats"));
+  return handle;
+}
+
+// measureLevel(samples) with an Int16Array or Float32Array of interleaved
+// PCM: { peak, rms, peakDb, rmsDb, kernel } over all of it, computed
+// synchronously with the same kernels as the meter
+static Napi::Value MeasureLevel(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsTypedArray()) {
+    Napi::TypeError::New(env, "Expected an Int16Array or Float32Array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::TypedArray array = info[0].As<Napi::TypedArray>();
+  LevelReading reading;
+  if (array.TypedArrayType() == napi_int16_array) {
+    Napi::Int16Array samples = array.As<Napi::Int16Array>();
+    reading = MeasureLevels(samples.Data(), samples.ElementLength(), SampleFormat::Int16);
+  } else if (array.TypedArrayType() == napi_float32_array) {
+    Napi::Float32Array samples = array.As<Napi::Float32Array>();
+    reading = MeasureLevels(samples.Data(), samples.ElementLength(), SampleFormat::Float32);
+  } else {
+    Napi::TypeError::New(env, "Expected an Int16Array or Float32Array").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object resultObj = Napi::Object::New(env);
+  resultObj.Set("peak", Napi::Number::New(env, reading.peak));
+  resultObj.Set("rms", Napi::Number::New(env, reading.rms));
+  resultObj.Set("peakDb", Napi::Number::New(env, reading.peakDb));
+  resultObj.Set("rmsDb", Napi::Number::New(env, reading.rmsDb));
+  resultObj.Set("kernel", Napi::String::New(env, SelectedLevelKernels().name));
+  return resultObj;
+}
@@ -0,0 +1,129 @@
+// MonitorEventQueue.cpp
+//
+
+#include "MonitorEventQueue.h"
+
+#include <thread>
+
+static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+MonitorEventQueue::MonitorEventQueue(size_t capacity)
+    : mask_(RoundUpToPowerOfTwo(capacity < 2 ? 2 : capacity) - 1),
+      head_(0), tail_(0), pushed_(0), delivered_(0), merged_(0), dropped_(0) {
+    slots_.reset(new Slot[mask_ + 1]);
+}
+
+bool MonitorEventQueue::Push(const MonitorEvent& event) {
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+
+    // Fold into the newest pending slot unless the consumer has claimed it
+    if (!event.hasError && tail != head && MergeInto(slots_[(tail - 1) & mask_], event)) {
+        return true;
+    }
+
+    if (tail - head > mask_) {
+        if (ReplacePending(head, tail, event)) return true;
+
+        // The consumer may have released slots while they were searched
+        head = head_.load(std::memory_order_acquire);
+        if (tail - head > mask_) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // The slot was released by the consumer (head moved past it), so it can
+    // be written without claiming it. Assignment reuses the strings' buffers.
+    Slot& slot = slots_[tail & mask_];
+    slot.event = event;
+    slot.state.store(kReady, std::memory_order_release);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+// Only the producer writes a slot's event, so it reads pending slots without
+// claiming them; the claim keeps the consumer off while one is rewritten
+bool MonitorEventQueue::MergeInto(Slot& slot, const MonitorEvent& event) {
+    if (slot.event.hasError || slot.event.deviceId != event.deviceId) return false;
+
+    uint8_t expected = kReady;
+    if (!slot.state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) return false;
+    slot.event.active = event.active;
+    slot.state.store(kReady, std::memory_order_release);
+    merged_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+// A full queue must not hold back the newest state of a device, so instead of
+// dropping it: merge it into the device's newest pending state, or else
+// overwrite the oldest pending event that no longer decides what the
+// consumer ends up with, an error or a state a later slot supersedes. Only
+// when every slot holds the last state of a different device is it dropped.
+bool MonitorEventQueue::ReplacePending(size_t head, size_t tail, const MonitorEvent& event) {
+    if (!event.hasError) {
+        for (size_t index = tail; index != head;) {
+            Slot& slot = slots_[--index & mask_];
+            if (slot.event.hasError || slot.event.deviceId != event.deviceId) continue;
+            // Claimed by the consumer, so it is at the head and the event
+            // has to go after it
+            if (MergeInto(slot, event)) return true;
+            break;
+        }
+    }
+
+    for (size_t index = head; index != tail; index++) {
+        Slot& slot = slots_[index & mask_];
+        bool superseded = slot.event.hasError;
+        for (size_t later = index + 1; !superseded && later != tail; later++) {
+            const MonitorEvent& laterEvent = slots_[later & mask_].event;
+            superseded = !laterEvent.hasError && laterEvent.deviceId == slot.event.deviceId;
+        }
+        if (!superseded) continue;
+
+        uint8_t expected = kReady;
+        if (!slot.state.compare_exchange_strong(expected, kWriting, std::memory_order_acquire)) continue;
+        slot.event = event;
+        slot.state.store(kReady, std::memory_order_release);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+const MonitorEvent* MonitorEventQueue::Front() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return nullptr;
+
+    // The producer holds a slot only while it merges into or overwrites it
+    Slot& slot = slots_[head & mask_];
+    for (;;) {
+        uint8_t expected = kReady;
+        if (slot.state.compare_exchange_weak(expected, kReading, std::memory_order_acquire)) break;
+        if (expected == kReading) break;  // Front() called twice without PopFront()
+        std::this_thread::yield();
+    }
+    return &slot.event;
+}
+
+void MonitorEventQueue::PopFront() {
+    size_t head = head_.load(std::memory_order_relaxed);
+    slots_[head & mask_].state.store(kConsumed, std::memory_order_relaxed);
+    delivered_.fetch_add(1, std::memory_order_relaxed);
+    head_.store(head + 1, std::memory_order_release);
+}
+
+MonitorQueueStats MonitorEventQueue::Stats() const {
+    MonitorQueueStats stats;
+    stats.pushed = pushed_.load(std::memory_order_relaxed);
+    stats.delivered = delivered_.load(std::memory_order_relaxed);
+    stats.merged = merged_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    return stats;
+}
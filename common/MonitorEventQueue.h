@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "MonitorHub.h"
+
+struct MonitorQueueStats {
+    uint64_t pushed;     // Events offered by the producer
+    uint64_t delivered;  // Events handed to the consumer
+    uint64_t merged;     // State changes folded into the pending one for the same device
+    uint64_t dropped;    // Events lost to a full queue, overwritten or turned away
+};
+
+// Bounded single-producer/single-consumer queue of monitor events. Slots are
+// allocated once and reused, so steady-state pushes do not allocate. A state
+// change for the device whose state is already waiting at the back of the
+// queue overwrites it instead of taking a new slot; errors are never merged.
+// When the queue is full a state change is never turned away in favour of
+// older events: it merges into its device's pending state, or takes the slot
+// of an error or superseded state. So as long as the subscriber's devices fit
+// in the queue, the consumer always ends up with the last state of each.
+// Neither side ever blocks on the other.
+class MonitorEventQueue {
+public:
+    explicit MonitorEventQueue(size_t capacity);
+
+    // Producer side. Returns false when the event was dropped: the queue was
+    // full of the last states of other devices.
+    bool Push(const MonitorEvent& event);
+
+    // Consumer side: the oldest event, or nullptr when empty. The event stays
+    // valid until PopFront().
+    const MonitorEvent* Front();
+    void PopFront();
+
+    size_t Capacity() const { return mask_ + 1; }
+    MonitorQueueStats Stats() const;
+
+private:
+    enum SlotState : uint8_t { kConsumed, kReady, kWriting, kReading };
+
+    struct Slot {
+        MonitorEvent event;
+        std::atomic<uint8_t> state;
+
+        Slot() : state(kConsumed) {}
+    };
+
+    bool MergeInto(Slot& slot, const MonitorEvent& event);
+    bool ReplacePending(size_t head, size_t tail, const MonitorEvent& event);
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<size_t> head_;  // Next slot to consume; written by the consumer only
+    std::atomic<size_t> tail_;  // Next slot to fill; written by the producer only
+    std::atomic<uint64_t> pushed_;
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> merged_;
+    std::atomic<uint64_t> dropped_;
+};
@@ -0,0 +1,182 @@
+// MonitorHub.cpp
+//
+
+#include "MonitorHub.h"
+
+#include <vector>
+
+void MonitorHub::Subscription::Deliver(const MonitorEvent& event) {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (!active) return;
+
+    if (event.hasError) {
+        bool isInfo = event.errorCode == kMonitorInfoCode;
+        if (isInfo ? !filter.includeInfo : !filter.includeErrors) return;
+    } else {
+        auto last = lastStates.find(event.deviceId);
+        if (last == lastStates.end()) {
+            lastStates.emplace(event.deviceId, event.active);
+        } else if (filter.changesOnly && last->second == event.active) {
+            return;
+        } else {
+            last->second = event.active;
+        }
+    }
+
+    callback(event);
+}
+
+MonitorHub::MonitorHub(MonitorSourceFactory factory)
+    : factory_(factory), nextId_(1) {}
+
+MonitorHub::~MonitorHub() {
+    std::map<std::string, std::shared_ptr<Listener>> listeners;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        listeners.swap(listeners_);
+        subscriptionDevices_.clear();
+        for (auto& entry : listeners) {
+            entry.second->running = false;
+        }
+    }
+
+    for (auto& entry : listeners) {
+        for (auto& subscription : entry.second->subscriptions) {
+            std::lock_guard<std::recursive_mutex> lock(subscription.second->mutex);
+            subscription.second->active = false;
+        }
+        entry.second->source->Stop();
+    }
+}
+
+MonitorHub::SubscriptionId MonitorHub::Subscribe(const std::string& deviceId, const MonitorFilter& filter,
+                                                 Subscriber subscriber, MonitorEvent& error) {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+
+    std::shared_ptr<Subscription> subscription = std::make_shared<Subscription>();
+    subscription->active = true;
+    subscription->deviceId = deviceId;
+    subscription->filter = filter;
+    subscription->callback = subscriber;
+
+    // Held until the replay below is delivered, so a concurrent event for
+    // this device cannot overtake it
+    std::unique_lock<std::recursive_mutex> deliveryLock(subscription->mutex);
+
+    SubscriptionId id;
+    std::shared_ptr<Listener> listener;
+    bool startListener = false;
+    std::vector<MonitorEvent> replay;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+
+        auto it = listeners_.find(deviceId);
+        if (it == listeners_.end()) {
+            listener = std::make_shared<Listener>();
+            listener->source = factory_();
+            listener->running = true;
+            listeners_[deviceId] = listener;
+            startListener = true;
+        } else {
+            listener = it->second;
+            for (auto& entry : listener->lastStates) {
+                replay.push_back(entry.second);
+            }
+        }
+
+        listener->subscriptions[id] = subscription;
+        subscriptionDevices_[id] = deviceId;
+    }
+
+    if (startListener) {
+        deliveryLock.unlock();  // Start() may deliver the initial state synchronously
+
+        std::weak_ptr<Listener> weakListener = listener;
+        bool started = listener->source->Start(
+            deviceId, [this, weakListener](const MonitorEvent& event) { Dispatch(weakListener, event); }, error);
+
+        if (!started) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            listener->running = false;
+            listeners_.erase(deviceId);
+            subscriptionDevices_.erase(id);
+            subscription->active = false;
+            return 0;
+        }
+        return id;
+    }
+
+    for (const MonitorEvent& event : replay) {
+        subscription->Deliver(event);
+    }
+    return id;
+}
+
+void MonitorHub::Unsubscribe(SubscriptionId id) {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+
+    std::shared_ptr<Subscription> subscription;
+    std::shared_ptr<Listener> stoppedListener;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto device = subscriptionDevices_.find(id);
+        if (device == subscriptionDevices_.end()) return;
+
+        auto it = listeners_.find(device->second);
+        if (it != listeners_.end()) {
+            subscription = it->second->subscriptions[id];
+            it->second->subscriptions.erase(id);
+            if (it->second->subscriptions.empty()) {
+                it->second->running = false;
+                stoppedListener = it->second;
+                listeners_.erase(it);
+            }
+        }
+        subscriptionDevices_.erase(device);
+    }
+
+    if (subscription) {
+        // Waits for a delivery in progress on another thread to finish
+        std::lock_guard<std::recursive_mutex> lock(subscription->mutex);
+        subscription->active = false;
+    }
+
+    if (stoppedListener) {
+        stoppedListener->source->Stop();
+    }
+}
+
+size_t MonitorHub::ListenerCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return listeners_.size();
+}
+
+size_t MonitorHub::SubscriberCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscriptionDevices_.size();
+}
+
+void MonitorHub::Dispatch(const std::weak_ptr<Listener>& weakListener, const MonitorEvent& event) {
+    std::shared_ptr<Listener> listener = weakListener.lock();
+    if (!listener) return;
+
+    std::vector<std::shared_ptr<Subscription>> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!listener->running) return;
+
+        if (!event.hasError) {
+            listener->lastStates[event.deviceId] = event;
+        }
+
+        subscriptions.reserve(listener->subscriptions.size());
+        for (auto& entry : listener->subscriptions) {
+            subscriptions.push_back(entry.second);
+        }
+    }
+
+    for (auto& subscription : subscriptions) {
+        subscription->Deliver(event);
+    }
+}
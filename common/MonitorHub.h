@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Microphone state change, or an error/info message, for one device
+struct MonitorEvent {
+    std::string deviceId;
+    std::string deviceName;
+    bool active;
+    bool hasError;
+    long errorCode;
+    std::string errorDomain;
+    std::string errorMessage;
+    double rearmMs;  // On info messages about a device change: time to re-arm, else negative
+
+    MonitorEvent() : active(false), hasError(false), errorCode(0), rearmMs(-1) {}
+};
+
+// Info messages (e.g. "Waiting to restart monitoring...") use this code, as
+// INFO_ERROR_CODE does in MicrophoneUsageMonitor.h
+static const long kMonitorInfoCode = 1;
+
+// A backend listener for one device ID. A listener may stand for several
+// devices (e.g. "*" for every capture device), in which case each event
+// carries the ID of the device it is about. Start() may deliver events on
+// any thread until Stop() returns.
+class MonitorSource {
+public:
+    typedef std::function<void(const MonitorEvent& event)> EventSink;
+
+    virtual ~MonitorSource() {}
+    virtual bool Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) = 0;
+    virtual void Stop() = 0;
+};
+
+typedef std::function<std::unique_ptr<MonitorSource>()> MonitorSourceFactory;
+
+struct MonitorFilter {
+    bool includeInfo;    // Deliver info-code messages
+    bool includeErrors;  // Deliver other errors
+    bool changesOnly;    // Drop events that repeat the subscriber's last state
+
+    MonitorFilter() : includeInfo(true), includeErrors(true), changesOnly(false) {}
+};
+
+// Fans events from one backend listener per device out to any number of
+// subscribers. Listeners are reference-counted: the first subscriber to a
+// device starts one, the last to leave stops it. New subscribers to a running
+// listener are sent its last known state for every device straight away.
+// Calls to any one subscriber never overlap.
+class MonitorHub {
+public:
+    typedef uint64_t SubscriptionId;
+    typedef std::function<void(const MonitorEvent& event)> Subscriber;
+
+    explicit MonitorHub(MonitorSourceFactory factory);
+    ~MonitorHub();
+
+    // Returns 0 and fills error when the device's listener fails to start
+    SubscriptionId Subscribe(const std::string& deviceId, const MonitorFilter& filter,
+                             Subscriber subscriber, MonitorEvent& error);
+
+    // Once this returns the subscriber is never called again
+    void Unsubscribe(SubscriptionId id);
+
+    size_t ListenerCount() const;
+    size_t SubscriberCount() const;
+
+private:
+    struct Subscription {
+        std::recursive_mutex mutex;  // Held while delivering; allows unsubscribing from the callback
+        bool active;
+        std::string deviceId;
+        MonitorFilter filter;
+        Subscriber callback;
+        std::map<std::string, bool> lastStates;  // Per device, for changesOnly
+
+        void Deliver(const MonitorEvent& event);
+    };
+
+    struct Listener {
+        std::unique_ptr<MonitorSource> source;
+        bool running;  // Cleared when the last subscriber leaves; late events are dropped
+        std::map<SubscriptionId, std::shared_ptr<Subscription>> subscriptions;
+        std::map<std::string, MonitorEvent> lastStates;  // Per device
+    };
+
+    void Dispatch(const std::weak_ptr<Listener>& weakListener, const MonitorEvent& event);
+
+    MonitorSourceFactory factory_;
+    std::mutex lifecycleMutex_;  // Serializes Subscribe/Unsubscribe, held across Start/Stop
+    mutable std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Listener>> listeners_;
+    std::map<SubscriptionId, std::string> subscriptionDevices_;
+    SubscriptionId nextId_;
+};
@@ -0,0 +1,233 @@
+#pragma once
+#include <napi.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include "AddonInstance.h"
+#include "MonitorEventQueue.h"
+#include "MonitorHub.h"
+
+// N-API side of MonitorHub: each JS subscriber gets its own thread-safe
+// function, so any number of them can share one backend listener and each
+// can unsubscribe without affecting the others.
+//
+// Events reach JS through a per-subscriber MonitorEventQueue. The listener
+// thread only pushes into the queue and, if no drain is pending, schedules one
+// with NonBlockingCall; it never waits for the JS thread.
+//
+// Subscriptions hold a reference to the hub, and each is tracked by its
+// env's AddonInstance, so a subscription left open when a worker exits is
+// removed from the shared hub by the env cleanup hook.
+
+struct HubSubscription;
+
+static void DrainHubSubscription(Napi::Env env, Napi::Function js_callback,
+                                 std::shared_ptr<HubSubscription>* context, void* data);
+
+typedef Napi::TypedThreadSafeFunction<std::shared_ptr<HubSubscription>, void, DrainHubSubscription> HubSubscriptionFunction;
+
+struct HubSubscription {
+  std::shared_ptr<MonitorHub> hub;
+  MonitorHub::SubscriptionId id;
+  AddonInstance* addon;
+  AddonInstance::HandleId handle;
+  HubSubscriptionFunction tsfn;
+  std::unique_ptr<MonitorEventQueue> queue;
+  std::atomic<bool> scheduled;  // A drain is queued on the TSFN
+  std::atomic<bool> released;
+
+  explicit HubSubscription(size_t queueSize)
+    : id(0), addon(nullptr), handle(0), queue(new MonitorEventQueue(queueSize)), scheduled(false), released(false) {}
+
+  // Called on the listener thread; deliveries to one subscriber are serialized
+  // by the hub, so this is the queue's only producer
+  void Enqueue(const MonitorEvent& event) {
+    if (released) return;
+    queue->Push(event);
+    ScheduleDrain();
+  }
+
+  void ScheduleDrain() {
+    if (scheduled.exchange(true)) return;
+    if (tsfn.NonBlockingCall() != napi_ok) {
+      scheduled = false;
+    }
+  }
+
+  // On the env's JS thread
+  void Unsubscribe() {
+    if (released.exchange(true)) return;
+    addon->UntrackHandle(handle);
+    hub->Unsubscribe(id);
+    tsfn.Release();
+  }
+};
+
+static Napi::Error MonitorEventToError(Napi::Env env, const MonitorEvent& event) {
+  Napi::Error err = Napi::Error::New(env, event.errorMessage);
+  err.Set("code", Napi::Number::New(env, event.errorCode));
+  err.Set("domain", Napi::String::New(env, event.errorDomain));
+  if (event.rearmMs >= 0) {
+    err.Set("rearmMs", Napi::Number::New(env, event.rearmMs));
+  }
+  return err;
+}
+
+static void DrainHubSubscription(Napi::Env env, Napi::Function js_callback,
+                                 std::shared_ptr<HubSubscription>* context, void*) {
+  if (!env || !context) return;  // Env teardown
+  HubSubscription& subscription = **context;
+
+  // Cleared first: anything pushed from here on schedules another drain
+  subscription.scheduled = false;
+
+  // At most one queue's worth per turn, so a busy device cannot starve the loop
+  for (size_t budget = subscription.queue->Capacity(); budget > 0; budget--) {
+    if (subscription.released) return;
+
+    const MonitorEvent* event = subscription.queue->Front();
+    if (!event) return;
+
+    Napi::HandleScope scope(env);
+    Napi::Value active = Napi::Boolean::New(env, event->active);
+    Napi::Value error = event->hasError ? MonitorEventToError(env, *event).Value() : env.Null();
+    Napi::Value deviceId = Napi::String::New(env, event->deviceId);
+    Napi::Value deviceName = Napi::String::New(env, event->deviceName);
+    subscription.queue->PopFront();
+
+    js_callback.Call({ active, error, deviceId, deviceName });
+  }
+
+  if (subscription.queue->Front()) {
+    subscription.ScheduleDrain();
+  }
+}
+
+// Subscribes callback(active, error, deviceId, deviceName) to deviceId. Returns nullptr
+// with a pending JS exception when the device's listener fails to start.
+static std::shared_ptr<HubSubscription> AddHubSubscription(Napi::Env env, AddonInstance& addon,
+                                                           const std::string& deviceId,
+                                                           const MonitorFilter& filter, size_t queueSize,
+                                                           Napi::Function callback) {
+  // Shared by the JS handle and the TSFN, whichever outlives the other
+  std::shared_ptr<HubSubscription>* context =
+      new std::shared_ptr<HubSubscription>(std::make_shared<HubSubscription>(queueSize));
+  std::shared_ptr<HubSubscription> subscription = *context;
+  subscription->hub = addon.Hub();
+  subscription->addon = &addon;
+
+  subscription->tsfn = HubSubscriptionFunction::New(
+    env,
+    callback,
+    "MicListener",
+    0,
+    1,
+    context,
+    [](Napi::Env, std::shared_ptr<HubSubscription>* context) {
+      // Runs once the TSFN is released or the env is torn down
+      if (!(*context)->released.exchange(true)) {
+        (*context)->addon->UntrackHandle((*context)->handle);
+        (*context)->hub->Unsubscribe((*context)->id);
+      }
+      delete context;
+    }
+  );
+
+  // Created before subscribing: the hub may replay the last state right away
+  MonitorEvent error;
+  MonitorHub::SubscriptionId id = subscription->hub->Subscribe(deviceId, filter, [subscription](const MonitorEvent& event) {
+    subscription->Enqueue(event);
+  }, error);
+
+  if (id == 0) {
+    subscription->released = true;
+    subscription->tsfn.Release();
+    MonitorEventToError(env, error).ThrowAsJavaScriptException();
+    return nullptr;
+  }
+
+  subscription->id = id;
+  std::weak_ptr<HubSubscription> weakSubscription = subscription;
+  subscription->handle = addon.TrackHandle([weakSubscription]() {
+    std::shared_ptr<HubSubscription> subscription = weakSubscription.lock();
+    if (subscription) subscription->Unsubscribe();
+  });
+  return subscription;
+}
+
+static Napi::Object MonitorQueueStatsToObject(Napi::Env env, const MonitorQueueStats& stats) {
+  Napi::Object statsObj = Napi::Object::New(env);
+  statsObj.Set("pushed", Napi::Number::New(env, static_cast<double>(stats.pushed)));
+  statsObj.Set("delivered", Napi::Number::New(env, static_cast<double>(stats.delivered)));
+  statsObj.Set("merged", Napi::Number::New(env, static_cast<double>(stats.merged)));
+  statsObj.Set("dropped", Napi::Number::New(env, static_cast<double>(stats.dropped)));
+  return statsObj;
+}
+
+static bool BooleanOption(Napi::Object options, const char* name, bool fallback) {
+  Napi::Value value = options.Get(name);
+  return value.IsBoolean() ? value.As<Napi::Boolean>().Value() : fallback;
+}
+
+// Pending events per subscriber before older ones are merged or overwritten
+static const size_t kDefaultQueueSize = 64;
+
+// subscribeMicrophone([options], callback) where options is
+// { deviceId = "default" (or "*" for every capture device, where supported), includeInfo = true, includeErrors = true,
+//   changesOnly = false, queueSize = 64 }.
+// Returns { deviceId, unsubscribe(), stats() }.
+static Napi::Value SubscribeToHub(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  size_t callbackIndex = info.Length() > 1 ? 1 : 0;
+  if (info.Length() < 1 || !info[callbackIndex].IsFunction() ||
+      (callbackIndex == 1 && !info[0].IsObject() && !info[0].IsUndefined())) {
+    Napi::TypeError::New(env, "Expected an optional options object and a callback function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::string deviceId = "default";
+  MonitorFilter filter;
+  size_t queueSize = kDefaultQueueSize;
+  if (callbackIndex == 1 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    Napi::Value device = options.Get("deviceId");
+    if (device.IsString()) {
+      deviceId = device.As<Napi::String>().Utf8Value();
+    } else if (!device.IsUndefined()) {
+      Napi::TypeError::New(env, "deviceId must be a string").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+    filter.includeInfo = BooleanOption(options, "includeInfo", filter.includeInfo);
+    filter.includeErrors = BooleanOption(options, "includeErrors", filter.includeErrors);
+    filter.changesOnly = BooleanOption(options, "changesOnly", filter.changesOnly);
+
+    Napi::Value size = options.Get("queueSize");
+    if (size.IsNumber()) {
+      int64_t requested = size.As<Napi::Number>().Int64Value();
+      if (requested < 1 || requested > 65536) {
+        Napi::RangeError::New(env, "queueSize must be between 1 and 65536").ThrowAsJavaScriptException();
+        return env.Null();
+      }
+      queueSize = static_cast<size_t>(requested);
+    } else if (!size.IsUndefined()) {
+      Napi::TypeError::New(env, "queueSize must be a number").ThrowAsJavaScriptException();
+      return env.Null();
+    }
+  }
+
+  std::shared_ptr<HubSubscription> subscription =
+      AddHubSubscription(env, AddonInstance::Of(env), deviceId, filter, queueSize, info[callbackIndex].As<Napi::Function>());
+  if (!subscription) return env.Null();
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("deviceId", Napi::String::New(env, deviceId));
+  handle.Set("unsubscribe", Napi::Function::New(env, [subscription](const Napi::CallbackInfo& info) -> Napi::Value {
+    subscription->Unsubscribe();
+    return info.Env().Undefined();
+  }, "unsubscribe"));
+  handle.Set("stats", Napi::Function::New(env, [subscription](const Napi::CallbackInfo& info) -> Napi::Value {
+    return MonitorQueueStatsToObject(info.Env(), subscription->queue->Stats());
+  }, "stats"));
+  return handle;
+}
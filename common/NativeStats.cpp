@@ -0,0 +1,203 @@
+// NativeStats.cpp
+//
+
+#include "NativeStats.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const char* StatsCallName(StatsCall call) {
+    switch (call) {
+        case StatsCall::RunningInputProcesses: return "getRunningInputAudioProcesses";
+        case StatsCall::MicrophoneProcesses: return "getProcessesAccessingMicrophoneWithResult";
+        case StatsCall::SpeakerProcesses: return "getProcessesAccessingSpeakersWithResult";
+        case StatsCall::WatchPoll: return "watchAudioProcesses";
+        case StatsCall::MonitorProbe: return "microphoneMonitorProbe";
+        case StatsCall::AudioSnapshot: return "getAudioSnapshot";
+    }
+    return "unknown";
+}
+
+uint64_t LatencySnapshot::PercentileNs(double fraction) const {
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(count));
+    if (rank >= count) rank = count - 1;
+
+    uint64_t seen = 0;
+    for (const auto& bucket : buckets) {
+        seen += bucket.second;
+        if (seen > rank) {
+            // The top bucket is open-ended; the max is the better answer there
+            return bucket.first < maxNs ? bucket.first : maxNs;
+        }
+    }
+    return maxNs;
+}
+
+#ifndef NATIVE_STATS_DISABLED
+
+LatencyHistogram::LatencyHistogram() : sumNs_(0), maxNs_(0) {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+static int HighestSetBit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+// Values below kSubBuckets get a bucket each; above that, the highest set bit
+// picks the power of two and the next kSubBucketBits bits the linear step
+int LatencyHistogram::BucketIndex(uint64_t ns) {
+    if (ns < static_cast<uint64_t>(kSubBuckets)) return static_cast<int>(ns);
+
+    int msb = HighestSetBit(ns);
+    if (msb >= kMaxBits) return kBucketCount - 1;
+
+    int shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + static_cast<int>((ns >> shift) & (kSubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+    if (index < kSubBuckets) return static_cast<uint64_t>(index) + 1;
+
+    int shift = index / kSubBuckets - 1;
+    uint64_t lower = static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << shift;
+    return lower + (static_cast<uint64_t>(1) << shift);
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+    buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    sumNs_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t max = maxNs_.load(std::memory_order_relaxed);
+    while (ns > max && !maxNs_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::Snapshot(LatencySnapshot& snapshot) const {
+    snapshot.buckets.clear();
+    snapshot.count = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        uint64_t count = buckets_[i].load(std::memory_order_relaxed);
+        if (count == 0) continue;
+        snapshot.buckets.emplace_back(BucketUpperBound(i), count);
+        snapshot.count += count;
+    }
+    snapshot.sumNs = sumNs_.load(std::memory_order_relaxed);
+    snapshot.maxNs = maxNs_.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::Reset() {
+    for (std::atomic<uint64_t>& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sumNs_.store(0, std::memory_order_relaxed);
+    maxNs_.store(0, std::memory_order_relaxed);
+}
+
+void NativeStats::RecordCall(StatsCall call, uint64_t ns, bool succeeded) {
+    CallCounters& counters = calls_[static_cast<int>(call)];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    if (!succeeded) counters.errors.fetch_add(1, std::memory_order_relaxed);
+    counters.latency.Record(ns);
+}
+
+void NativeStats::RecordStage(PipelineStage stage, uint64_t ns) {
+    stages_[static_cast<int>(stage)].Record(ns);
+}
+
+void NativeStats::Snapshot(CallStatsSnapshot (&calls)[kStatsCallCount],
+                           LatencySnapshot (&stages)[kPipelineStageCount]) const {
+    for (int i = 0; i < kStatsCallCount; i++) {
+        calls[i].calls = calls_[i].calls.load(std::memory_order_relaxed);
+        calls[i].errors = calls_[i].errors.load(std::memory_order_relaxed);
+        calls_[i].latency.Snapshot(calls[i].latency);
+    }
+    for (int i = 0; i < kPipelineStageCount; i++) {
+        stages_[i].Snapshot(stages[i]);
+    }
+}
+
+void NativeStats::Reset() {
+    for (CallCounters& counters : calls_) {
+        counters.calls.store(0, std::memory_order_relaxed);
+        counters.errors.store(0, std::memory_order_relaxed);
+        counters.latency.Reset();
+    }
+    for (LatencyHistogram& stage : stages_) {
+        stage.Reset();
+    }
+}
+
+NativeStats& SharedNativeStats() {
+    static NativeStats* stats = new NativeStats();
+    return *stats;
+}
+
+namespace {
+
+// Stage start times are per thread, so one instance serves every caller
+class StatsObserver : public PipelineObserver {
+public:
+    void StageBegin(PipelineStage stage) override {
+        begin_[static_cast<int>(stage)] = std::chrono::steady_clock::now();
+    }
+
+    void StageEnd(PipelineStage stage) override {
+        SharedNativeStats().RecordStage(stage, StatsElapsedNs(begin_[static_cast<int>(stage)]));
+    }
+
+private:
+    static thread_local std::chrono::steady_clock::time_point begin_[kPipelineStageCount];
+};
+
+thread_local std::chrono::steady_clock::time_point StatsObserver::begin_[kPipelineStageCount];
+
+}  // namespace
+
+PipelineObserver* StatsPipelineObserver() {
+    static StatsObserver observer;
+    return &observer;
+}
+
+bool NativeStatsEnabled() {
+    return true;
+}
+
+void GetNativeStats(CallStatsSnapshot (&calls)[kStatsCallCount], LatencySnapshot (&stages)[kPipelineStageCount]) {
+    SharedNativeStats().Snapshot(calls, stages);
+}
+
+void ResetNativeStats() {
+    SharedNativeStats().Reset();
+}
+
+#else
+
+bool NativeStatsEnabled() {
+    return false;
+}
+
+void GetNativeStats(CallStatsSnapshot (&calls)[kStatsCallCount], LatencySnapshot (&stages)[kPipelineStageCount]) {
+    for (CallStatsSnapshot& call : calls) {
+        call.calls = 0;
+        call.errors = 0;
+        call.latency = LatencySnapshot();
+    }
+    for (LatencySnapshot& stage : stages) {
+        stage = LatencySnapshot();
+    }
+}
+
+void ResetNativeStats() {}
+
+#endif
@@ -0,0 +1,165 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "PipelineStage.h"
+
+// Process-wide timing of every public scan and of the pipeline stages inside
+// it, exposed to JS as getStats() / resetStats(). Recording is a handful of
+// relaxed atomic adds, so it stays on in release builds.
+//
+// Building with NATIVE_STATS_DISABLED (node-gyp rebuild --native_stats=0)
+// turns the scopes below into empty inline classes and compiles the
+// registry out entirely.
+
+enum class StatsCall {
+    RunningInputProcesses,
+    MicrophoneProcesses,
+    SpeakerProcesses,
+    WatchPoll,
+    MonitorProbe,
+    AudioSnapshot
+};
+
+static const int kStatsCallCount = 6;
+
+const char* StatsCallName(StatsCall call);
+
+struct LatencySnapshot {
+    uint64_t count;
+    uint64_t sumNs;
+    uint64_t maxNs;
+    std::vector<std::pair<uint64_t, uint64_t>> buckets;  // (upper bound ns, count), non-empty buckets only
+
+    LatencySnapshot() : count(0), sumNs(0), maxNs(0) {}
+
+    // Upper bound of the bucket holding the given fraction (0..1) of samples
+    uint64_t PercentileNs(double fraction) const;
+};
+
+struct CallStatsSnapshot {
+    uint64_t calls;
+    uint64_t errors;
+    LatencySnapshot latency;
+};
+
+#ifndef NATIVE_STATS_DISABLED
+
+// Log-linear histogram of durations in nanoseconds: each power of two is
+// split into 8 linear buckets, so any reported percentile is within 12.5% of
+// the true value. Samples above ~36 minutes land in the last bucket.
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 3;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+    static const int kMaxBits = 41;
+    static const int kBucketCount = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram();
+
+    void Record(uint64_t ns);
+    void Snapshot(LatencySnapshot& snapshot) const;
+    void Reset();
+
+    static int BucketIndex(uint64_t ns);
+    static uint64_t BucketUpperBound(int index);
+
+private:
+    std::atomic<uint64_t> buckets_[kBucketCount];  // The count is their sum
+    std::atomic<uint64_t> sumNs_;
+    std::atomic<uint64_t> maxNs_;
+};
+
+class NativeStats {
+public:
+    void RecordCall(StatsCall call, uint64_t ns, bool succeeded);
+    void RecordStage(PipelineStage stage, uint64_t ns);
+
+    void Snapshot(CallStatsSnapshot (&calls)[kStatsCallCount], LatencySnapshot (&stages)[kPipelineStageCount]) const;
+
+    // Samples recorded while this runs may be kept or dropped
+    void Reset();
+
+private:
+    struct CallCounters {
+        std::atomic<uint64_t> calls;
+        std::atomic<uint64_t> errors;
+        LatencyHistogram latency;
+
+        CallCounters() : calls(0), errors(0) {}
+    };
+
+    CallCounters calls_[kStatsCallCount];
+    LatencyHistogram stages_[kPipelineStageCount];
+};
+
+NativeStats& SharedNativeStats();
+
+inline uint64_t StatsElapsedNs(std::chrono::steady_clock::time_point begin) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count());
+}
+
+// Times one public call. With succeeded set, the call counts as an error
+// unless *succeeded is true when the scope ends.
+class StatsCallScope {
+public:
+    explicit StatsCallScope(StatsCall call, const bool* succeeded = nullptr)
+        : call_(call), succeeded_(succeeded), begin_(std::chrono::steady_clock::now()) {}
+    ~StatsCallScope() {
+        SharedNativeStats().RecordCall(call_, StatsElapsedNs(begin_), !succeeded_ || *succeeded_);
+    }
+
+private:
+    StatsCall call_;
+    const bool* succeeded_;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// Times one stage; End() closes it before the scope does
+class StatsStageScope {
+public:
+    explicit StatsStageScope(PipelineStage stage)
+        : stage_(stage), begin_(std::chrono::steady_clock::now()), ended_(false) {}
+    ~StatsStageScope() { End(); }
+
+    void End() {
+        if (ended_) return;
+        ended_ = true;
+        SharedNativeStats().RecordStage(stage_, StatsElapsedNs(begin_));
+    }
+
+private:
+    PipelineStage stage_;
+    std::chrono::steady_clock::time_point begin_;
+    bool ended_;
+};
+
+// Observer that feeds SessionPipeline stages into SharedNativeStats(); safe
+// to share between threads
+PipelineObserver* StatsPipelineObserver();
+
+#else
+
+class StatsCallScope {
+public:
+    explicit StatsCallScope(StatsCall, const bool* = nullptr) {}
+};
+
+class StatsStageScope {
+public:
+    explicit StatsStageScope(PipelineStage) {}
+    void End() {}
+};
+
+inline PipelineObserver* StatsPipelineObserver() { return nullptr; }
+
+#endif
+
+// False when built with NATIVE_STATS_DISABLED; the snapshot is then empty
+bool NativeStatsEnabled();
+void GetNativeStats(CallStatsSnapshot (&calls)[kStatsCallCount], LatencySnapshot (&stages)[kPipelineStageCount]);
+void ResetNativeStats();
@@ -0,0 +1,63 @@
+#pragma once
+#include <napi.h>
+#include "NativeStats.h"
+
+// getStats() / resetStats(), shared by every platform addon. Times are in
+// milliseconds; percentiles are histogram bucket upper bounds, so they may
+// overstate the true value by up to 12.5%.
+
+static Napi::Object LatencySnapshotToObject(Napi::Env env, const LatencySnapshot& latency) {
+  Napi::Object latencyObj = Napi::Object::New(env);
+  latencyObj.Set("count", Napi::Number::New(env, static_cast<double>(latency.count)));
+  latencyObj.Set("totalMs", Napi::Number::New(env, latency.sumNs / 1e6));
+  latencyObj.Set("meanMs", Napi::Number::New(env, latency.count ? latency.sumNs / 1e6 / latency.count : 0));
+  latencyObj.Set("p50Ms", Napi::Number::New(env, latency.PercentileNs(0.5) / 1e6));
+  latencyObj.Set("p90Ms", Napi::Number::New(env, latency.PercentileNs(0.9) / 1e6));
+  latencyObj.Set("p99Ms", Napi::Number::New(env, latency.PercentileNs(0.99) / 1e6));
+  latencyObj.Set("maxMs", Napi::Number::New(env, latency.maxNs / 1e6));
+
+  // [upperBoundMs, count] for every non-empty bucket
+  Napi::Array histogram = Napi::Array::New(env, latency.buckets.size());
+  for (size_t i = 0; i < latency.buckets.size(); i++) {
+    Napi::Array bucket = Napi::Array::New(env, 2);
+    bucket.Set(static_cast<uint32_t>(0), Napi::Number::New(env, latency.buckets[i].first / 1e6));
+    bucket.Set(static_cast<uint32_t>(1), Napi::Number::New(env, static_cast<double>(latency.buckets[i].second)));
+    histogram.Set(i, bucket);
+  }
+  latencyObj.Set("histogram", histogram);
+  return latencyObj;
+}
+
+// { enabled, calls: { <api>: { calls, errors, latency } }, stages: { <stage>: latency } }
+static Napi::Value GetStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  CallStatsSnapshot calls[kStatsCallCount];
+  LatencySnapshot stages[kPipelineStageCount];
+  GetNativeStats(calls, stages);
+
+  Napi::Object callsObj = Napi::Object::New(env);
+  for (int i = 0; i < kStatsCallCount; i++) {
+    Napi::Object callObj = Napi::Object::New(env);
+    callObj.Set("calls", Napi::Number::New(env, static_cast<double>(calls[i].calls)));
+    callObj.Set("errors", Napi::Number::New(env, static_cast<double>(calls[i].errors)));
+    callObj.Set("latency", LatencySnapshotToObject(env, calls[i].latency));
+    callsObj.Set(StatsCallName(static_cast<StatsCall>(i)), callObj);
+  }
+
+  Napi::Object stagesObj = Napi::Object::New(env);
+  for (int i = 0; i < kPipelineStageCount; i++) {
+    stagesObj.Set(PipelineStageName(static_cast<PipelineStage>(i)), LatencySnapshotToObject(env, stages[i]));
+  }
+
+  Napi::Object statsObj = Napi::Object::New(env);
+  statsObj.Set("enabled", Napi::Boolean::New(env, NativeStatsEnabled()));
+  statsObj.Set("calls", callsObj);
+  statsObj.Set("stages", stagesObj);
+  return statsObj;
+}
+
+static Napi::Value ResetStats(const Napi::CallbackInfo& info) {
+  ResetNativeStats();
+  return info.Env().Undefined();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// Stages of the enumeration pipeline in SessionPipeline.h. Kept apart from
+// the pipeline so that NativeStats.h can be included next to the Windows and
+// macOS result types, which AudioResults.h would clash with.
+//
+// Marshal is not run by the pipeline; the N-API layer reports it to the same
+// observer. The last three are finer steps some backends report inside
+// Enumerate (see NativeStats.h); the pipeline itself never emits them.
+
+enum class PipelineStage {
+    Enumerate,
+    Filter,
+    ResolvePath,
+    Dedupe,
+    Marshal,
+    BackendInit,
+    EnumerateDevices,
+    WalkSessions
+};
+
+static const int kPipelineStageCount = 8;
+
+const char* PipelineStageName(PipelineStage stage);
+
+// Notified around every stage, e.g. to time it or count allocations
+class PipelineObserver {
+public:
+    virtual ~PipelineObserver() {}
+    virtual void StageBegin(PipelineStage stage) = 0;
+    virtual void StageEnd(PipelineStage stage) = 0;
+};
+
+class PipelineStageScope {
+public:
+    PipelineStageScope(PipelineObserver* observer, PipelineStage stage)
+        : observer_(observer), stage_(stage) {
+        if (observer_) observer_->StageBegin(stage_);
+    }
+    ~PipelineStageScope() {
+        if (observer_) observer_->StageEnd(stage_);
+    }
+
+private:
+    PipelineObserver* observer_;
+    PipelineStage stage_;
+};
@@ -0,0 +1,192 @@
+// PollingMonitorSource.cpp
+//
+
+#include "PollingMonitorSource.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <utility>
+
+PollingMonitorSource::PollingMonitorSource(ProbeFunction probe, const std::string& errorDomain,
+                                           std::chrono::milliseconds interval)
+    : probe_(probe), errorDomain_(errorDomain), interval_(interval), stopping_(false), wakePending_(false) {}
+
+// After a wake the device list may still be settling (a node removed before
+// its card, or the reverse), so the probe is repeated at this pace until it
+// shows a change or the wake is older than the timeout
+static const std::chrono::milliseconds kTopologyRetryInterval(50);
+static const std::chrono::seconds kTopologyChangeTimeout(2);
+
+PollingMonitorSource::~PollingMonitorSource() {
+    Stop();
+}
+
+bool PollingMonitorSource::Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) {
+    // Probe once up front so an unknown device fails the subscribe call
+    std::vector<DeviceActivity> devices;
+    long errorCode = 0;
+    std::string errorMessage;
+    if (!probe_(deviceId, devices, errorCode, errorMessage)) {
+        error.deviceId = deviceId;
+        error.hasError = true;
+        error.errorCode = errorCode;
+        error.errorDomain = errorDomain_;
+        error.errorMessage = errorMessage.empty() ? "Failed to start monitoring" : errorMessage;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) return true;
+    deviceId_ = deviceId;
+    sink_ = sink;
+    stopping_ = false;
+    wakePending_ = false;
+    thread_ = std::thread(&PollingMonitorSource::Run, this);
+    return true;
+}
+
+void PollingMonitorSource::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+        thread_.join();
+    }
+}
+
+void PollingMonitorSource::Wake(std::chrono::steady_clock::time_point detectedAt) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!wakePending_) {
+            wakePending_ = true;
+            wakeDetectedAt_ = detectedAt;
+        }
+    }
+    wake_.notify_all();
+}
+
+void PollingMonitorSource::ReportTopologyChange(const std::vector<std::string>& added,
+                                                const std::vector<std::string>& removed,
+                                                std::chrono::steady_clock::time_point detectedAt) {
+    double rearmMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - detectedAt).count();
+
+    std::string message = "Capture devices changed:";
+    for (const std::string& id : added) message += " +" + id;
+    for (const std::string& id : removed) message += " -" + id;
+
+    char timing[64];
+    snprintf(timing, sizeof(timing), "; re-armed in %.1f ms", rearmMs);
+    message += timing;
+
+    MonitorEvent event;
+    event.deviceId = deviceId_;
+    event.hasError = true;
+    event.errorCode = kMonitorInfoCode;
+    event.errorDomain = errorDomain_;
+    event.errorMessage = message;
+    event.rearmMs = rearmMs;
+    sink_(event);
+}
+
+void PollingMonitorSource::UseScheduler(std::unique_ptr<TieredProbeScheduler> scheduler) {
+    scheduler_ = std::move(scheduler);
+}
+
+void PollingMonitorSource::Run() {
+    std::map<std::string, std::pair<std::string, bool>> known;  // ID -> (name, active)
+    std::vector<DeviceActivity> devices;
+    std::string lastError;
+    bool firstProbe = true;
+    bool topologyPending = false;  // A wake has not yet shown a device change
+    std::chrono::steady_clock::time_point topologyDetectedAt;
+
+    for (;;) {
+        devices.clear();
+        long errorCode = 0;
+        std::string errorMessage;
+
+        // Stream activity says nothing about devices being plugged, so the
+        // gate is bypassed until a wake has shown its device change
+        bool gated = scheduler_ && !firstProbe && !topologyPending;
+        if (scheduler_ && !gated) {
+            scheduler_->Invalidate();
+        }
+        if (gated && scheduler_->Next() == ProbeTier::Unchanged) {
+            // Nothing to report
+        } else if (probe_(deviceId_, devices, errorCode, errorMessage)) {
+            lastError.clear();
+
+            std::vector<std::string> added;
+            std::vector<std::string> removed;
+
+            std::map<std::string, std::pair<std::string, bool>> current;
+            for (const DeviceActivity& device : devices) {
+                current[device.id] = std::make_pair(device.name, device.active);
+
+                auto previous = known.find(device.id);
+                if (previous == known.end()) {
+                    added.push_back(device.id);
+                } else if (previous->second.second == device.active) {
+                    continue;
+                }
+
+                MonitorEvent event;
+                event.deviceId = device.id;
+                event.deviceName = device.name;
+                event.active = device.active;
+                sink_(event);
+                if (scheduler_) scheduler_->ReportChanged();
+            }
+
+            for (const auto& previous : known) {
+                if (current.count(previous.first)) continue;
+                removed.push_back(previous.first);
+                if (!previous.second.second) continue;
+
+                MonitorEvent event;
+                event.deviceId = previous.first;
+                event.deviceName = previous.second.first;
+                event.active = false;
+                sink_(event);
+            }
+            known.swap(current);
+
+            if (topologyPending && !firstProbe && (!added.empty() || !removed.empty())) {
+                topologyPending = false;
+                ReportTopologyChange(added, removed, topologyDetectedAt);
+            }
+            firstProbe = false;
+        } else if (errorMessage != lastError) {
+            lastError = errorMessage;
+
+            MonitorEvent event;
+            event.deviceId = deviceId_;
+            event.hasError = true;
+            event.errorCode = errorCode;
+            event.errorDomain = errorDomain_;
+            event.errorMessage = errorMessage.empty() ? "Microphone probe failed" : errorMessage;
+            sink_(event);
+        }
+
+        if (topologyPending && std::chrono::steady_clock::now() - topologyDetectedAt > kTopologyChangeTimeout) {
+            topologyPending = false;
+        }
+
+        std::chrono::milliseconds interval = scheduler_ ? scheduler_->Interval() : interval_;
+        std::chrono::milliseconds wait = topologyPending ? std::min(interval, kTopologyRetryInterval) : interval;
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wake_.wait_for(lock, wait, [this] { return stopping_ || wakePending_; }) && stopping_) {
+            return;
+        }
+        if (wakePending_) {
+            wakePending_ = false;
+            if (!topologyPending) {
+                topologyPending = true;
+                topologyDetectedAt = wakeDetectedAt_;
+            }
+        }
+    }
+}
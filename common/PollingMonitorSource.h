@@ -0,0 +1,69 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "MonitorHub.h"
+#include "TieredProbeScheduler.h"
+
+// State of one device as reported by a probe
+struct DeviceActivity {
+    std::string id;
+    std::string name;
+    bool active;
+};
+
+// MonitorSource for backends without change notifications (Windows, Linux):
+// probes on its own thread and reports the first state of every device the
+// probe returns and every change after it. A device that disappears while
+// active is reported inactive. Probe failures are reported once per
+// distinct error.
+//
+// Wake() probes straight away instead of at the next interval, for backends
+// that are told about hot-plug, and keeps probing briefly until the device
+// list changes. The change is reported as usual, followed by an info
+// message carrying the time from the wake to the new device set (rearmMs).
+//
+// With a scheduler, the device probe only runs when the scheduler's activity
+// probe saw a change (or after a wake), and the interval adapts between the
+// schedule's fast and idle intervals.
+class PollingMonitorSource : public MonitorSource {
+public:
+    // Fills devices with every device covered by deviceId
+    typedef std::function<bool(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                               long& errorCode, std::string& errorMessage)> ProbeFunction;
+
+    PollingMonitorSource(ProbeFunction probe, const std::string& errorDomain, std::chrono::milliseconds interval);
+    ~PollingMonitorSource() override;
+
+    // Call before Start()
+    void UseScheduler(std::unique_ptr<TieredProbeScheduler> scheduler);
+
+    bool Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) override;
+    void Stop() override;
+
+    // Safe from any thread; wakes that arrive before the probe runs are merged
+    void Wake(std::chrono::steady_clock::time_point detectedAt);
+
+private:
+    void Run();
+    void ReportTopologyChange(const std::vector<std::string>& added, const std::vector<std::string>& removed,
+                              std::chrono::steady_clock::time_point detectedAt);
+
+    ProbeFunction probe_;
+    std::string errorDomain_;
+    std::chrono::milliseconds interval_;
+    std::unique_ptr<TieredProbeScheduler> scheduler_;
+    std::string deviceId_;
+    EventSink sink_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+    bool wakePending_;
+    std::chrono::steady_clock::time_point wakeDetectedAt_;
+};
@@ -0,0 +1,74 @@
+// ProbeWorkerPool.cpp
+//
+
+#include "ProbeWorkerPool.h"
+
+#include <algorithm>
+
+ProbeWorkerPool::ProbeWorkerPool(size_t threads)
+    : task_(nullptr), count_(0), next_(0), busy_(0), batch_(0), stopping_(false) {
+    if (threads == 0) {
+        threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 4);
+    }
+    for (size_t i = 1; i < threads; i++) {
+        workers_.emplace_back(&ProbeWorkerPool::WorkerLoop, this);
+    }
+}
+
+ProbeWorkerPool::~ProbeWorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ProbeWorkerPool::Run(size_t count, const std::function<void(size_t index)>& task) {
+    if (workers_.empty() || count <= 1) {
+        for (size_t i = 0; i < count; i++) task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run(runMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        next_ = 0;
+        busy_ = workers_.size();
+        batch_++;
+    }
+    wake_.notify_all();
+
+    Work();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+}
+
+void ProbeWorkerPool::WorkerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seen] { return stopping_ || batch_ != seen; });
+            if (stopping_) return;
+            seen = batch_;
+        }
+
+        Work();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void ProbeWorkerPool::Work() {
+    for (size_t i = next_++; i < count_; i = next_++) {
+        (*task_)(i);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads that run independent per-device probes side by side,
+// so probing N devices costs about as long as the slowest one rather than
+// the sum. The calling thread takes part in every batch.
+class ProbeWorkerPool {
+public:
+    // threads counts the caller; 0 picks min(hardware threads, 4), 1 runs
+    // every task inline
+    explicit ProbeWorkerPool(size_t threads = 0);
+    ~ProbeWorkerPool();
+
+    // Calls task(i) for every i in [0, count) and returns once all calls
+    // have finished. Batches from different callers run one at a time.
+    void Run(size_t count, const std::function<void(size_t index)>& task);
+
+    size_t Threads() const { return workers_.size() + 1; }
+
+private:
+    void WorkerLoop();
+    void Work();
+
+    std::vector<std::thread> workers_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)>* task_;
+    size_t count_;
+    std::atomic<size_t> next_;
+    size_t busy_;
+    uint64_t batch_;
+    bool stopping_;
+};
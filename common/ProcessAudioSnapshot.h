@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioBackend.h"
+#include "PipelineStage.h"
+#include "ProcessFilter.h"
+
+// Everything one process is doing with audio, from a single enumeration of
+// every endpoint in both directions. Unlike AudioResults.h these types carry
+// no platform error type, so the Windows and macOS addons can use them too.
+
+// ProcessDeviceUse position of a session the use does not have
+static const size_t kNoSession = static_cast<size_t>(-1);
+
+// Sessions of one process on one endpoint, folded together
+struct ProcessDeviceUse {
+    std::string deviceId;
+    std::string deviceName;
+    AudioDirection direction;
+    bool isActive;  // Some session on the device is active
+    bool isMuted;   // Every active session is muted, or every session when none is active
+    // Positions in the enumeration of the first active session and of the
+    // first active, unmuted one, so results derived from the snapshot keep
+    // the order a per-session walk would give them
+    size_t firstActiveSession;
+    size_t firstAudibleSession;
+};
+
+struct ProcessAudioRecord {
+    uint32_t processId;
+    std::string path;
+    bool capture;   // Has a session on a capture endpoint
+    bool render;    // Has a session on a render endpoint
+    bool isActive;  // Active on some endpoint
+    bool isMuted;   // Has render sessions and is muted on every render endpoint
+    std::vector<ProcessDeviceUse> devices;
+};
+
+struct ProcessAudioSnapshot {
+    std::vector<ProcessAudioRecord> processes;
+    long errorCode;
+    std::string errorMessage;
+    bool success;
+
+    ProcessAudioSnapshot() : errorCode(0), success(true) {}
+};
+
+// One record per PID with any session, active or not, in the order the PIDs
+// first appear. Enumerates once and resolves each distinct PID once. With a
+// filter, only matching sessions count towards a record.
+ProcessAudioSnapshot CollectProcessAudioSnapshot(AudioBackend& backend, PipelineObserver* observer = nullptr,
+                                                 const ProcessFilter* filter = nullptr);
@@ -0,0 +1,90 @@
+// ProcessFilter.cpp
+//
+
+#include "ProcessFilter.h"
+
+#include <algorithm>
+#include <cctype>
+
+static char Lower(char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+}
+
+static std::string Lowercase(const std::string& value) {
+    std::string lowered(value);
+    std::transform(lowered.begin(), lowered.end(), lowered.begin(), Lower);
+    return lowered;
+}
+
+// Iterative glob with single-star backtracking; pattern is already lowercase
+static bool GlobMatches(const std::string& pattern, const char* text, size_t length) {
+    size_t p = 0;
+    size_t t = 0;
+    size_t starP = std::string::npos;
+    size_t starT = 0;
+
+    while (t < length) {
+        if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == Lower(text[t]))) {
+            p++;
+            t++;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            starP = p++;
+            starT = t;
+        } else if (starP != std::string::npos) {
+            p = starP + 1;
+            t = ++starT;
+        } else {
+            return false;
+        }
+    }
+
+    while (p < pattern.size() && pattern[p] == '*') p++;
+    return p == pattern.size();
+}
+
+static bool HasPrefix(const std::string& value, const std::string& prefix) {
+    if (prefix.size() > value.size()) return false;
+    for (size_t i = 0; i < prefix.size(); i++) {
+        if (Lower(value[i]) != prefix[i]) return false;
+    }
+    return true;
+}
+
+ProcessFilter::ProcessFilter(const ProcessFilterSpec& spec)
+    : processIds_(spec.processIds), deviceNames_(spec.deviceNames), capture_(spec.capture), render_(spec.render) {
+    std::sort(processIds_.begin(), processIds_.end());
+    processIds_.erase(std::unique(processIds_.begin(), processIds_.end()), processIds_.end());
+
+    for (const std::string& name : spec.names) names_.push_back(Lowercase(name));
+    for (const std::string& bundleId : spec.bundleIds) bundleIds_.push_back(Lowercase(bundleId));
+}
+
+bool ProcessFilter::MatchesSession(uint32_t processId, const std::string& deviceName, AudioDirection direction) const {
+    if (!MatchesDirection(direction)) return false;
+
+    if (!processIds_.empty() && !std::binary_search(processIds_.begin(), processIds_.end(), processId)) {
+        return false;
+    }
+
+    if (!deviceNames_.empty() &&
+        std::find(deviceNames_.begin(), deviceNames_.end(), deviceName) == deviceNames_.end()) {
+        return false;
+    }
+    return true;
+}
+
+bool ProcessFilter::MatchesPath(const std::string& path) const {
+    if (!NeedsPath()) return true;
+
+    size_t lastSlash = path.find_last_of("/\\");
+    const char* basename = path.c_str() + (lastSlash == std::string::npos ? 0 : lastSlash + 1);
+    size_t basenameLength = path.size() - (basename - path.c_str());
+    for (const std::string& name : names_) {
+        if (GlobMatches(name, basename, basenameLength)) return true;
+    }
+
+    for (const std::string& bundleId : bundleIds_) {
+        if (HasPrefix(path, bundleId)) return true;
+    }
+    return false;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AudioBackend.h"
+
+// What a caller wants to see from an enumeration call. Each list left empty
+// places no constraint; a non-empty list matches when any entry does, and
+// every constrained category has to match.
+struct ProcessFilterSpec {
+    std::vector<uint32_t> processIds;
+    std::vector<std::string> names;        // Globs (* and ?) over the executable's basename
+    std::vector<std::string> bundleIds;    // Prefixes of the full identifier (a bundle ID on macOS)
+    std::vector<std::string> deviceNames;  // Exact endpoint names
+    bool capture;
+    bool render;
+
+    ProcessFilterSpec() : capture(true), render(true) {}
+};
+
+// A ProcessFilterSpec compiled for repeated matching: PIDs sorted for binary
+// search, patterns lowercased once. Names and identifiers compare ignoring
+// ASCII case. Immutable, so one filter can be shared between threads.
+//
+// The checks are split by what they need, so a pipeline can drop sessions
+// on PID, device and direction before paying for path resolution, and on
+// the path before marshaling. names and bundleIds together form one
+// category: a path matches when either does.
+class ProcessFilter {
+public:
+    explicit ProcessFilter(const ProcessFilterSpec& spec);
+
+    bool MatchesSession(uint32_t processId, const std::string& deviceName, AudioDirection direction) const;
+
+    // Whether MatchesPath can reject anything; when false it need not be called
+    bool NeedsPath() const { return !names_.empty() || !bundleIds_.empty(); }
+    bool MatchesPath(const std::string& path) const;
+
+    bool MatchesDirection(AudioDirection direction) const {
+        return direction == AudioDirection::Capture ? capture_ : render_;
+    }
+
+private:
+    std::vector<uint32_t> processIds_;
+    std::vector<std::string> names_;
+    std::vector<std::string> bundleIds_;
+    std::vector<std::string> deviceNames_;
+    bool capture_;
+    bool render_;
+};
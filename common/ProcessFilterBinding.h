@@ -0,0 +1,135 @@
+#pragma once
+#include <napi.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ProcessFilter.h"
+
+// createProcessFilter({ processIds, names, bundleIds, devices, direction })
+// compiles a ProcessFilter once and returns an opaque handle. The
+// enumeration calls take it as { filter } and apply it natively, before
+// paths are resolved where the backend allows and always before anything
+// is marshaled. A plain spec object is accepted there too and compiled for
+// that call only.
+//
+// The handle is a tagged, wrapped JS object, so a look-alike object or one
+// wrapped by another addon is never mistaken for it.
+
+static const napi_type_tag kProcessFilterTag = { 0x6e6d755f66696c74ULL, 0x3a1f9c0d5e27b481ULL };
+
+static void FinalizeProcessFilter(napi_env, void* data, void*) {
+  delete static_cast<std::shared_ptr<const ProcessFilter>*>(data);
+}
+
+static bool ReadFilterStrings(Napi::Env env, Napi::Object spec, const char* name, std::vector<std::string>& out) {
+  Napi::Value value = spec.Get(name);
+  if (value.IsUndefined()) return true;
+  if (!value.IsArray()) {
+    Napi::TypeError::New(env, std::string(name) + " must be an array of strings").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  Napi::Array array = value.As<Napi::Array>();
+  for (uint32_t i = 0; i < array.Length(); i++) {
+    Napi::Value entry = array.Get(i);
+    if (!entry.IsString()) {
+      Napi::TypeError::New(env, std::string(name) + " must be an array of strings").ThrowAsJavaScriptException();
+      return false;
+    }
+    out.push_back(entry.As<Napi::String>().Utf8Value());
+  }
+  return true;
+}
+
+// Throws and returns false when value is not a valid spec
+static bool ParseProcessFilterSpec(Napi::Env env, Napi::Value value, ProcessFilterSpec& spec) {
+  if (!value.IsObject()) {
+    Napi::TypeError::New(env, "Expected a filter spec object").ThrowAsJavaScriptException();
+    return false;
+  }
+  Napi::Object object = value.As<Napi::Object>();
+
+  Napi::Value processIds = object.Get("processIds");
+  if (!processIds.IsUndefined()) {
+    if (!processIds.IsArray()) {
+      Napi::TypeError::New(env, "processIds must be an array of numbers").ThrowAsJavaScriptException();
+      return false;
+    }
+    Napi::Array array = processIds.As<Napi::Array>();
+    for (uint32_t i = 0; i < array.Length(); i++) {
+      Napi::Value entry = array.Get(i);
+      if (!entry.IsNumber()) {
+        Napi::TypeError::New(env, "processIds must be an array of numbers").ThrowAsJavaScriptException();
+        return false;
+      }
+      spec.processIds.push_back(entry.As<Napi::Number>().Uint32Value());
+    }
+  }
+
+  if (!ReadFilterStrings(env, object, "names", spec.names) ||
+      !ReadFilterStrings(env, object, "bundleIds", spec.bundleIds) ||
+      !ReadFilterStrings(env, object, "devices", spec.deviceNames)) {
+    return false;
+  }
+
+  Napi::Value direction = object.Get("direction");
+  if (!direction.IsUndefined()) {
+    std::string name = direction.IsString() ? direction.As<Napi::String>().Utf8Value() : "";
+    if (name != "capture" && name != "render" && name != "any") {
+      Napi::TypeError::New(env, "direction must be 'capture', 'render' or 'any'").ThrowAsJavaScriptException();
+      return false;
+    }
+    spec.capture = name != "render";
+    spec.render = name != "capture";
+  }
+  return true;
+}
+
+static Napi::Value CreateProcessFilter(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  ProcessFilterSpec spec;
+  if (!ParseProcessFilterSpec(env, info.Length() > 0 ? info[0] : env.Undefined(), spec)) {
+    return env.Null();
+  }
+
+  Napi::Object handle = Napi::Object::New(env);
+  std::shared_ptr<const ProcessFilter>* filter =
+      new std::shared_ptr<const ProcessFilter>(std::make_shared<ProcessFilter>(spec));
+  if (napi_wrap(env, handle, filter, FinalizeProcessFilter, nullptr, nullptr) != napi_ok) {
+    delete filter;
+    Napi::Error::New(env).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (napi_type_tag_object(env, handle, &kProcessFilterTag) != napi_ok) {
+    Napi::Error::New(env).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return handle;
+}
+
+// Reads { filter } from the options object in info[0]. Returns false with a
+// pending exception on a bad filter; filter stays null when none was given.
+static bool ProcessFilterOption(const Napi::CallbackInfo& info, std::shared_ptr<const ProcessFilter>& filter) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsObject()) return true;
+
+  Napi::Value value = info[0].As<Napi::Object>().Get("filter");
+  if (value.IsUndefined() || value.IsNull()) return true;
+
+  bool tagged = false;
+  if (value.IsObject() && napi_check_object_type_tag(env, value, &kProcessFilterTag, &tagged) == napi_ok && tagged) {
+    void* data = nullptr;
+    if (napi_unwrap(env, value, &data) != napi_ok) {
+      Napi::Error::New(env).ThrowAsJavaScriptException();
+      return false;
+    }
+    filter = *static_cast<std::shared_ptr<const ProcessFilter>*>(data);
+    return true;
+  }
+
+  ProcessFilterSpec spec;
+  if (!ParseProcessFilterSpec(env, value, spec)) return false;
+  filter = std::make_shared<ProcessFilter>(spec);
+  return true;
+}
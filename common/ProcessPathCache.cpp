@@ -0,0 +1,121 @@
+// ProcessPathCache.cpp
+//
+
+#include "ProcessPathCache.h"
+
+ProcessPathCache::ProcessPathCache(size_t capacity)
+    : capacity_(capacity > 0 ? capacity : 1), hits_(0), misses_(0), evictions_(0) {}
+
+ProcessPathCache::PathRef ProcessPathCache::Find(uint32_t pid, uint64_t startTime) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = entries_.find(pid);
+    if (it == entries_.end()) {
+        misses_++;
+        return PathRef();
+    }
+
+    if (it->second->startTime != startTime) {
+        // PID was reused by a new process
+        lru_.erase(it->second);
+        entries_.erase(it);
+        misses_++;
+        return PathRef();
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    hits_++;
+    return it->second->path;
+}
+
+ProcessPathCache::PathRef ProcessPathCache::Insert(uint32_t pid, uint64_t startTime, const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    PathRef interned = Intern(path);
+
+    auto it = entries_.find(pid);
+    if (it != entries_.end()) {
+        it->second->startTime = startTime;
+        it->second->path = interned;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return interned;
+    }
+
+    lru_.push_front(Entry{pid, startTime, interned});
+    entries_[pid] = lru_.begin();
+    EvictToCapacity();
+    return interned;
+}
+
+void ProcessPathCache::SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity > 0 ? capacity : 1;
+    EvictToCapacity();
+}
+
+ProcessPathCacheStats ProcessPathCache::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessPathCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.size = entries_.size();
+    stats.capacity = capacity_;
+    stats.internedPaths = interned_.size();
+    return stats;
+}
+
+void ProcessPathCache::ResetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+}
+
+void ProcessPathCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    entries_.clear();
+    interned_.clear();
+}
+
+ProcessPathCache::PathRef ProcessPathCache::Intern(const std::string& path) {
+    auto it = interned_.find(path);
+    if (it != interned_.end()) {
+        PathRef existing = it->second.lock();
+        if (existing) return existing;
+    }
+
+    PathRef created = std::make_shared<const std::string>(path);
+    interned_[path] = created;
+    return created;
+}
+
+void ProcessPathCache::EvictToCapacity() {
+    while (entries_.size() > capacity_) {
+        entries_.erase(lru_.back().pid);
+        lru_.pop_back();
+        evictions_++;
+    }
+
+    // Live interned strings never outnumber entries, so once the table is
+    // twice the capacity at least half of it belongs to evicted or reused
+    // PIDs. Pruning then keeps the sweep amortized O(1) per insert.
+    if (interned_.size() > 2 * capacity_) PruneInterned();
+}
+
+// Drops interned strings no cache entry refers to any more
+void ProcessPathCache::PruneInterned() {
+    for (auto it = interned_.begin(); it != interned_.end();) {
+        if (it->second.expired()) {
+            it = interned_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+ProcessPathCache& SharedProcessPathCache() {
+    static ProcessPathCache cache;
+    return cache;
+}
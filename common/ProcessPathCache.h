@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+struct ProcessPathCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t size;
+    size_t capacity;
+    size_t internedPaths;
+};
+
+// Bounded LRU cache of PID -> executable path. Entries are keyed by PID plus
+// the process start time, so a reused PID never returns the previous owner's
+// path. Paths are interned: every entry for the same executable shares one
+// string.
+class ProcessPathCache {
+public:
+    typedef std::shared_ptr<const std::string> PathRef;
+
+    explicit ProcessPathCache(size_t capacity = 1024);
+
+    // Returns the cached path, or null on a miss. A PID cached with a
+    // different start time is treated as a miss and dropped.
+    PathRef Find(uint32_t pid, uint64_t startTime);
+
+    // Caches a freshly resolved path and returns the interned copy
+    PathRef Insert(uint32_t pid, uint64_t startTime, const std::string& path);
+
+    void SetCapacity(size_t capacity);
+    ProcessPathCacheStats Stats() const;
+    void ResetStats();
+    void Clear();
+
+private:
+    struct Entry {
+        uint32_t pid;
+        uint64_t startTime;
+        PathRef path;
+    };
+
+    PathRef Intern(const std::string& path);
+    void EvictToCapacity();
+    void PruneInterned();
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // Most recently used first
+    std::unordered_map<uint32_t, std::list<Entry>::iterator> entries_;
+    std::unordered_map<std::string, std::weak_ptr<const std::string>> interned_;
+    size_t capacity_;
+    uint64_t hits_;
+    uint64_t misses_;
+    uint64_t evictions_;
+};
+
+// Cache shared by every resolver in the addon
+ProcessPathCache& SharedProcessPathCache();
@@ -0,0 +1,147 @@
+#pragma once
+#include <napi.h>
+#include <string>
+#include <vector>
+#include "BackendWarmup.h"
+#include "ProcessAudioSnapshot.h"
+
+// Object-per-process marshaling shared by the platform addons. The result
+// types differ per platform but have the same fields, so these are templates
+// over them.
+
+// Converts a list of process paths to a JavaScript array
+static Napi::Value ProcessListToArray(Napi::Env env, const std::vector<std::string>& processes) {
+  Napi::Array result = Napi::Array::New(env);
+  for (size_t i = 0; i < processes.size(); i++) {
+    result.Set(i, Napi::String::New(env, processes[i]));
+  }
+  return result;
+}
+
+// Create a JavaScript object to represent the AudioProcessResult
+template <typename AudioResult>
+static Napi::Value AudioProcessResultToObject(Napi::Env env, const AudioResult& result) {
+  Napi::Object resultObj = Napi::Object::New(env);
+  if (!result.success) {
+    // Set error information
+    resultObj.Set("success", Napi::Boolean::New(env, false));
+    resultObj.Set("error", Napi::String::New(env, result.errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, result.errorCode));
+    resultObj.Set("domain", Napi::String::New(env, "AudioProcessMonitor"));
+    resultObj.Set("processes", Napi::Array::New(env));
+  } else {
+    // Set success information
+    resultObj.Set("success", Napi::Boolean::New(env, true));
+    resultObj.Set("error", env.Null());
+    resultObj.Set("processes", ProcessListToArray(env, result.processes));
+  }
+
+  return resultObj;
+}
+
+// Create a JavaScript object to represent the RenderProcessResult
+template <typename RenderResult>
+static Napi::Value RenderProcessResultToObject(Napi::Env env, const RenderResult& result) {
+  Napi::Object resultObj = Napi::Object::New(env);
+  if (!result.success) {
+    // Set error information
+    resultObj.Set("success", Napi::Boolean::New(env, false));
+    resultObj.Set("error", Napi::String::New(env, result.errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, result.errorCode));
+    resultObj.Set("domain", Napi::String::New(env, "RenderProcessMonitor"));
+    resultObj.Set("processes", Napi::Array::New(env));
+  } else {
+    // Set success information
+    resultObj.Set("success", Napi::Boolean::New(env, true));
+    resultObj.Set("error", env.Null());
+
+    // Convert processes array
+    Napi::Array processesArray = Napi::Array::New(env);
+    for (size_t i = 0; i < result.processes.size(); i++) {
+      Napi::Object processObj = Napi::Object::New(env);
+      processObj.Set("processName", Napi::String::New(env, result.processes[i].processName));
+      processObj.Set("processId", Napi::Number::New(env, result.processes[i].processId));
+      processObj.Set("deviceName", Napi::String::New(env, result.processes[i].deviceName));
+      processObj.Set("isActive", Napi::Boolean::New(env, result.processes[i].isActive));
+      processesArray.Set(i, processObj);
+    }
+    resultObj.Set("processes", processesArray);
+  }
+
+  return resultObj;
+}
+
+static const char* AudioDirectionName(AudioDirection direction) {
+  return direction == AudioDirection::Capture ? "capture" : "render";
+}
+
+// Create a JavaScript object to represent the ProcessAudioSnapshot
+static Napi::Value ProcessAudioSnapshotToObject(Napi::Env env, const ProcessAudioSnapshot& snapshot) {
+  Napi::Object resultObj = Napi::Object::New(env);
+  if (!snapshot.success) {
+    resultObj.Set("success", Napi::Boolean::New(env, false));
+    resultObj.Set("error", Napi::String::New(env, snapshot.errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, snapshot.errorCode));
+    resultObj.Set("domain", Napi::String::New(env, "AudioProcessMonitor"));
+    resultObj.Set("processes", Napi::Array::New(env));
+    return resultObj;
+  }
+
+  resultObj.Set("success", Napi::Boolean::New(env, true));
+  resultObj.Set("error", env.Null());
+
+  Napi::Array processesArray = Napi::Array::New(env, snapshot.processes.size());
+  for (size_t i = 0; i < snapshot.processes.size(); i++) {
+    const ProcessAudioRecord& record = snapshot.processes[i];
+    Napi::Object processObj = Napi::Object::New(env);
+    processObj.Set("processId", Napi::Number::New(env, record.processId));
+    processObj.Set("path", Napi::String::New(env, record.path));
+
+    Napi::Array directions = Napi::Array::New(env);
+    if (record.capture) directions.Set(directions.Length(), Napi::String::New(env, "capture"));
+    if (record.render) directions.Set(directions.Length(), Napi::String::New(env, "render"));
+    processObj.Set("directions", directions);
+
+    Napi::Array devicesArray = Napi::Array::New(env, record.devices.size());
+    for (size_t j = 0; j < record.devices.size(); j++) {
+      const ProcessDeviceUse& use = record.devices[j];
+      Napi::Object deviceObj = Napi::Object::New(env);
+      deviceObj.Set("id", Napi::String::New(env, use.deviceId));
+      deviceObj.Set("name", Napi::String::New(env, use.deviceName));
+      deviceObj.Set("direction", Napi::String::New(env, AudioDirectionName(use.direction)));
+      deviceObj.Set("isActive", Napi::Boolean::New(env, use.isActive));
+      deviceObj.Set("isMuted", Napi::Boolean::New(env, use.isMuted));
+      devicesArray.Set(j, deviceObj);
+    }
+    processObj.Set("devices", devicesArray);
+    processObj.Set("isActive", Napi::Boolean::New(env, record.isActive));
+    processObj.Set("isMuted", Napi::Boolean::New(env, record.isMuted));
+    processesArray.Set(i, processObj);
+  }
+  resultObj.Set("processes", processesArray);
+
+  return resultObj;
+}
+
+// prewarm() result: { success, error, backend, devices, sessions,
+// resolvedPaths, selectMs, enumerateMs, resolveMs }, plus code and domain on
+// failure
+static Napi::Value BackendWarmupToObject(Napi::Env env, const BackendWarmup& warmup) {
+  Napi::Object resultObj = Napi::Object::New(env);
+  resultObj.Set("success", Napi::Boolean::New(env, warmup.success));
+  if (!warmup.success) {
+    resultObj.Set("error", Napi::String::New(env, warmup.errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, warmup.errorCode));
+    resultObj.Set("domain", Napi::String::New(env, "AudioProcessMonitor"));
+  } else {
+    resultObj.Set("error", env.Null());
+  }
+  resultObj.Set("backend", Napi::String::New(env, warmup.backend));
+  resultObj.Set("devices", Napi::Number::New(env, static_cast<double>(warmup.devices)));
+  resultObj.Set("sessions", Napi::Number::New(env, static_cast<double>(warmup.sessions)));
+  resultObj.Set("resolvedPaths", Napi::Number::New(env, static_cast<double>(warmup.resolvedPaths)));
+  resultObj.Set("selectMs", Napi::Number::New(env, warmup.selectMs));
+  resultObj.Set("enumerateMs", Napi::Number::New(env, warmup.enumerateMs));
+  resultObj.Set("resolveMs", Napi::Number::New(env, warmup.resolveMs));
+  return resultObj;
+}
@@ -0,0 +1,317 @@
+// SessionPipeline.cpp
+//
+
+#include "SessionPipeline.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+const char* PipelineStageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Enumerate: return "enumerate";
+        case PipelineStage::Filter: return "filter";
+        case PipelineStage::ResolvePath: return "resolvePath";
+        case PipelineStage::Dedupe: return "dedupe";
+        case PipelineStage::Marshal: return "marshal";
+        case PipelineStage::BackendInit: return "backendInit";
+        case PipelineStage::EnumerateDevices: return "enumerateDevices";
+        case PipelineStage::WalkSessions: return "walkSessions";
+    }
+    return "unknown";
+}
+
+// Sessions that survive the filter stage, with their resolved path
+struct SelectedSession {
+    uint32_t processId;
+    size_t deviceIndex;
+    const AudioSession* session;
+    const std::string* path;
+};
+
+static bool EnumerateSessions(AudioBackend& backend, PipelineObserver* observer,
+                              std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                              long& errorCode, std::string& errorMessage) {
+    PipelineStageScope stage(observer, PipelineStage::Enumerate);
+    return backend.Enumerate(devices, sessions, errorCode, errorMessage);
+}
+
+// Whether a session gets past the filter's checks that need no path
+static bool SessionMatches(const ProcessFilter* filter, const AudioSession& session, const AudioDevice& device) {
+    return !filter || filter->MatchesSession(session.processId, device.name, device.direction);
+}
+
+// Resolves each distinct PID once, however many sessions it has, then drops
+// sessions whose path the filter rejects
+static void ResolvePaths(AudioBackend& backend, PipelineObserver* observer, const ProcessFilter* filter,
+                         std::vector<SelectedSession>& selected,
+                         std::unordered_map<uint32_t, std::string>& paths) {
+    {
+        PipelineStageScope stage(observer, PipelineStage::ResolvePath);
+        for (SelectedSession& session : selected) {
+            auto it = paths.find(session.processId);
+            if (it == paths.end()) {
+                it = paths.emplace(session.processId, backend.ResolveProcessPath(session.processId)).first;
+            }
+            session.path = &it->second;
+        }
+    }
+
+    if (filter && filter->NeedsPath()) {
+        PipelineStageScope stage(observer, PipelineStage::Filter);
+        selected.erase(std::remove_if(selected.begin(), selected.end(), [filter](const SelectedSession& session) {
+            return !filter->MatchesPath(*session.path);
+        }), selected.end());
+    }
+}
+
+AudioProcessResult CollectCaptureProcesses(AudioBackend& backend, PipelineObserver* observer,
+                                           const ProcessFilter* filter) {
+    AudioProcessResult result;
+
+    std::vector<AudioDevice> devices;
+    std::vector<AudioSession> sessions;
+    if (!EnumerateSessions(backend, observer, devices, sessions, result.errorCode, result.errorMessage)) {
+        result.success = false;
+        return result;
+    }
+
+    std::vector<SelectedSession> selected;
+    {
+        PipelineStageScope stage(observer, PipelineStage::Filter);
+        for (const AudioSession& session : sessions) {
+            if (session.processId == 0 || !session.isActive) continue;
+            if (devices[session.deviceIndex].direction != AudioDirection::Capture) continue;
+            if (!SessionMatches(filter, session, devices[session.deviceIndex])) continue;
+            selected.push_back(SelectedSession{session.processId, session.deviceIndex, &session, nullptr});
+        }
+    }
+
+    std::unordered_map<uint32_t, std::string> paths;
+    ResolvePaths(backend, observer, filter, selected, paths);
+
+    {
+        PipelineStageScope stage(observer, PipelineStage::Dedupe);
+        std::unordered_set<std::string> seen;  // Track unique strings
+        for (const SelectedSession& session : selected) {
+            if (seen.insert(*session.path).second) {
+                result.processes.push_back(*session.path);
+            }
+        }
+    }
+
+    return result;
+}
+
+RenderProcessResult CollectRenderProcesses(AudioBackend& backend, PipelineObserver* observer,
+                                           const ProcessFilter* filter) {
+    RenderProcessResult result;
+
+    std::vector<AudioDevice> devices;
+    std::vector<AudioSession> sessions;
+    if (!EnumerateSessions(backend, observer, devices, sessions, result.errorCode, result.errorMessage)) {
+        result.success = false;
+        return result;
+    }
+
+    std::vector<SelectedSession> selected;
+    {
+        PipelineStageScope stage(observer, PipelineStage::Filter);
+        for (const AudioSession& session : sessions) {
+            // For render sessions, active state + not muted = active
+            if (session.processId == 0 || !session.isActive || session.isMuted) continue;
+            if (devices[session.deviceIndex].direction != AudioDirection::Render) continue;
+            if (!SessionMatches(filter, session, devices[session.deviceIndex])) continue;
+            selected.push_back(SelectedSession{session.processId, session.deviceIndex, &session, nullptr});
+        }
+    }
+
+    std::unordered_map<uint32_t, std::string> paths;
+    ResolvePaths(backend, observer, filter, selected, paths);
+
+    {
+        PipelineStageScope stage(observer, PipelineStage::Dedupe);
+        std::set<std::pair<uint32_t, size_t>> seen;  // One entry per process and device
+        for (const SelectedSession& session : selected) {
+            if (!seen.insert(std::make_pair(session.processId, session.deviceIndex)).second) continue;
+
+            RenderProcessInfo info;
+            info.processId = session.processId;
+
+            // Extract filename from path
+            size_t lastSlash = session.path->find_last_of("/\\");
+            info.processName = lastSlash == std::string::npos ? *session.path : session.path->substr(lastSlash + 1);
+
+            info.deviceName = devices[session.deviceIndex].name;
+            info.isActive = true;
+            result.processes.push_back(info);
+        }
+    }
+
+    return result;
+}
+
+// Session counts behind one ProcessDeviceUse, folded into its flags at the end
+struct DeviceTally {
+    size_t deviceIndex;
+    size_t sessions;
+    size_t muted;
+    size_t active;
+    size_t activeMuted;
+    size_t firstActive;
+    size_t firstAudible;
+};
+
+ProcessAudioSnapshot CollectProcessAudioSnapshot(AudioBackend& backend, PipelineObserver* observer,
+                                                 const ProcessFilter* filter) {
+    ProcessAudioSnapshot result;
+
+    std::vector<AudioDevice> devices;
+    std::vector<AudioSession> sessions;
+    if (!EnumerateSessions(backend, observer, devices, sessions, result.errorCode, result.errorMessage)) {
+        result.success = false;
+        return result;
+    }
+
+    // Inactive and muted sessions are kept; the flags carry the state instead
+    std::vector<SelectedSession> selected;
+    {
+        PipelineStageScope stage(observer, PipelineStage::Filter);
+        selected.reserve(sessions.size());
+        for (const AudioSession& session : sessions) {
+            if (session.processId == 0) continue;
+            if (!SessionMatches(filter, session, devices[session.deviceIndex])) continue;
+            selected.push_back(SelectedSession{session.processId, session.deviceIndex, &session, nullptr});
+        }
+    }
+
+    std::unordered_map<uint32_t, std::string> paths;
+    ResolvePaths(backend, observer, filter, selected, paths);
+
+    PipelineStageScope stage(observer, PipelineStage::Dedupe);
+    std::unordered_map<uint32_t, size_t> recordIndices;
+    std::vector<std::vector<DeviceTally>> tallies;
+    for (const SelectedSession& resolved : selected) {
+        const AudioSession& session = *resolved.session;
+
+        auto it = recordIndices.find(session.processId);
+        if (it == recordIndices.end()) {
+            ProcessAudioRecord record;
+            record.processId = session.processId;
+            record.path = *resolved.path;
+            record.capture = false;
+            record.render = false;
+            record.isActive = false;
+            record.isMuted = false;
+            result.processes.push_back(record);
+            tallies.emplace_back();
+            it = recordIndices.emplace(session.processId, result.processes.size() - 1).first;
+        }
+
+        std::vector<DeviceTally>& deviceTallies = tallies[it->second];
+        DeviceTally* tally = nullptr;
+        for (DeviceTally& candidate : deviceTallies) {
+            if (candidate.deviceIndex == session.deviceIndex) {
+                tally = &candidate;
+                break;
+            }
+        }
+        if (!tally) {
+            deviceTallies.push_back(DeviceTally{session.deviceIndex, 0, 0, 0, 0, kNoSession, kNoSession});
+            tally = &deviceTallies.back();
+        }
+
+        size_t position = static_cast<size_t>(resolved.session - sessions.data());
+        tally->sessions++;
+        if (session.isMuted) tally->muted++;
+        if (session.isActive) {
+            tally->active++;
+            if (tally->firstActive == kNoSession) tally->firstActive = position;
+            if (session.isMuted) {
+                tally->activeMuted++;
+            } else if (tally->firstAudible == kNoSession) {
+                tally->firstAudible = position;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < result.processes.size(); i++) {
+        ProcessAudioRecord& record = result.processes[i];
+        bool everyRenderMuted = true;
+        for (const DeviceTally& tally : tallies[i]) {
+            const AudioDevice& device = devices[tally.deviceIndex];
+
+            ProcessDeviceUse use;
+            use.deviceId = device.id;
+            use.deviceName = device.name;
+            use.direction = device.direction;
+            use.isActive = tally.active > 0;
+            use.isMuted = use.isActive ? tally.activeMuted == tally.active : tally.muted == tally.sessions;
+            use.firstActiveSession = tally.firstActive;
+            use.firstAudibleSession = tally.firstAudible;
+            record.devices.push_back(use);
+
+            record.isActive = record.isActive || use.isActive;
+            if (device.direction == AudioDirection::Capture) {
+                record.capture = true;
+            } else {
+                record.render = true;
+                everyRenderMuted = everyRenderMuted && use.isMuted;
+            }
+        }
+        record.isMuted = record.render && everyRenderMuted;
+    }
+
+    return result;
+}
+
+void SplitProcessAudioSnapshot(const ProcessAudioSnapshot& snapshot, AudioProcessResult& capture,
+                               RenderProcessResult& render) {
+    capture = AudioProcessResult();
+    render = RenderProcessResult();
+    if (!snapshot.success) {
+        capture.success = render.success = false;
+        capture.errorCode = render.errorCode = snapshot.errorCode;
+        capture.errorMessage = render.errorMessage = snapshot.errorMessage;
+        return;
+    }
+
+    // Records follow each PID's first session; the collectors walk sessions in
+    // enumeration order, so each use is emitted at the position of its first
+    // session that counts. Positions are distinct, as a session has one use.
+    std::vector<std::pair<size_t, const std::string*>> capturePaths;
+    std::vector<std::pair<size_t, RenderProcessInfo>> renderInfos;
+    for (const ProcessAudioRecord& record : snapshot.processes) {
+        for (const ProcessDeviceUse& use : record.devices) {
+            if (!use.isActive) continue;
+
+            if (use.direction == AudioDirection::Capture) {
+                capturePaths.push_back(std::make_pair(use.firstActiveSession, &record.path));
+            } else if (!use.isMuted) {
+                RenderProcessInfo info;
+                info.processId = record.processId;
+                size_t lastSlash = record.path.find_last_of("/\\");
+                info.processName = lastSlash == std::string::npos ? record.path : record.path.substr(lastSlash + 1);
+                info.deviceName = use.deviceName;
+                info.isActive = true;
+                renderInfos.push_back(std::make_pair(use.firstAudibleSession, info));
+            }
+        }
+    }
+
+    std::sort(capturePaths.begin(), capturePaths.end());
+    std::unordered_set<std::string> seen;
+    for (const auto& entry : capturePaths) {
+        if (seen.insert(*entry.second).second) capture.processes.push_back(*entry.second);
+    }
+
+    std::sort(renderInfos.begin(), renderInfos.end(),
+              [](const std::pair<size_t, RenderProcessInfo>& a, const std::pair<size_t, RenderProcessInfo>& b) {
+                  return a.first < b.first;
+              });
+    for (auto& entry : renderInfos) {
+        render.processes.push_back(std::move(entry.second));
+    }
+}
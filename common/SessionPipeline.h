@@ -0,0 +1,26 @@
+#pragma once
+#include "AudioBackend.h"
+#include "AudioResults.h"
+#include "PipelineStage.h"
+#include "ProcessFilter.h"
+#include "ProcessAudioSnapshot.h"
+
+// The enumeration pipeline behind getProcessesAccessingMicrophoneWithResult
+// and getProcessesAccessingSpeakersWithResult, split into the stages in
+// PipelineStage.h. A filter, when given, drops sessions on PID, device and
+// direction in the filter stage, before any path is resolved, and on the
+// resolved path right after.
+
+// Unique executable paths of processes with an active capture session
+AudioProcessResult CollectCaptureProcesses(AudioBackend& backend, PipelineObserver* observer = nullptr,
+                                           const ProcessFilter* filter = nullptr);
+
+// One entry per process and render device with an active, unmuted session
+RenderProcessResult CollectRenderProcesses(AudioBackend& backend, PipelineObserver* observer = nullptr,
+                                           const ProcessFilter* filter = nullptr);
+
+// The capture and render results CollectCaptureProcesses and
+// CollectRenderProcesses would report for the same enumeration, derived from
+// a snapshot without enumerating again
+void SplitProcessAudioSnapshot(const ProcessAudioSnapshot& snapshot, AudioProcessResult& capture,
+                               RenderProcessResult& render);
@@ -0,0 +1,38 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <mutex>
+
+// A process-wide object shared by every addon instance (one per Node env:
+// the main thread, each worker_thread, each Electron renderer). The first
+// Acquire() creates it and it is destroyed when the last holder lets go, so
+// a backend listener outlives no env that uses it and is never duplicated
+// while any env does.
+template <typename T>
+class SharedResource {
+public:
+    typedef std::function<T*()> Factory;
+
+    explicit SharedResource(Factory factory) : factory_(factory) {}
+
+    std::shared_ptr<T> Acquire() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::shared_ptr<T> resource = resource_.lock();
+        if (!resource) {
+            resource.reset(factory_());
+            resource_ = resource;
+        }
+        return resource;
+    }
+
+    // Number of holders, for tests
+    long UseCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return resource_.use_count();
+    }
+
+private:
+    Factory factory_;
+    mutable std::mutex mutex_;
+    std::weak_ptr<T> resource_;
+};
@@ -0,0 +1,159 @@
+// SnapshotCodec.cpp
+//
+
+#include "SnapshotCodec.h"
+
+#include <cstdint>
+
+// Bumped whenever the layout below changes
+static const uint32_t kSnapshotFormat = 1;
+
+// Upper bound on entries per list, so a corrupt count fails fast instead of
+// reserving a huge vector
+static const uint32_t kMaxEntries = 1 << 20;
+
+namespace {
+
+class Writer {
+public:
+    explicit Writer(std::string& out) : out_(out) {}
+
+    void U8(uint8_t value) { out_.push_back(static_cast<char>(value)); }
+
+    void U32(uint32_t value) {
+        char bytes[4];
+        for (int i = 0; i < 4; i++) bytes[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+        out_.append(bytes, 4);
+    }
+
+    void I64(int64_t value) {
+        uint64_t bits = static_cast<uint64_t>(value);
+        U32(static_cast<uint32_t>(bits));
+        U32(static_cast<uint32_t>(bits >> 32));
+    }
+
+    void String(const std::string& value) {
+        U32(static_cast<uint32_t>(value.size()));
+        out_.append(value);
+    }
+
+private:
+    std::string& out_;
+};
+
+class Reader {
+public:
+    Reader(const char* data, size_t size) : data_(data), left_(size) {}
+
+    bool U8(uint8_t& value) {
+        if (left_ < 1) return false;
+        value = static_cast<uint8_t>(*data_);
+        Skip(1);
+        return true;
+    }
+
+    bool U32(uint32_t& value) {
+        if (left_ < 4) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(static_cast<uint8_t>(data_[i])) << (8 * i);
+        Skip(4);
+        return true;
+    }
+
+    bool I64(int64_t& value) {
+        uint32_t low = 0;
+        uint32_t high = 0;
+        if (!U32(low) || !U32(high)) return false;
+        value = static_cast<int64_t>((static_cast<uint64_t>(high) << 32) | low);
+        return true;
+    }
+
+    bool String(std::string& value) {
+        uint32_t length = 0;
+        if (!U32(length) || length > left_) return false;
+        value.assign(data_, length);
+        Skip(length);
+        return true;
+    }
+
+    bool Count(uint32_t& count) {
+        return U32(count) && count <= kMaxEntries && count <= left_;
+    }
+
+    bool AtEnd() const { return left_ == 0; }
+
+private:
+    void Skip(size_t bytes) {
+        data_ += bytes;
+        left_ -= bytes;
+    }
+
+    const char* data_;
+    size_t left_;
+};
+
+template <typename Result>
+void EncodeStatus(Writer& writer, const Result& result) {
+    writer.U8(result.success ? 1 : 0);
+    writer.I64(result.errorCode);
+    writer.String(result.errorMessage);
+}
+
+template <typename Result>
+bool DecodeStatus(Reader& reader, Result& result) {
+    uint8_t success = 0;
+    int64_t errorCode = 0;
+    if (!reader.U8(success) || !reader.I64(errorCode) || !reader.String(result.errorMessage)) return false;
+    result.success = success != 0;
+    result.errorCode = static_cast<long>(errorCode);
+    return true;
+}
+
+}  // namespace
+
+void EncodeAudioSnapshot(const AudioSnapshot& snapshot, std::string& out) {
+    Writer writer(out);
+    writer.U32(kSnapshotFormat);
+
+    EncodeStatus(writer, snapshot.capture);
+    writer.U32(static_cast<uint32_t>(snapshot.capture.processes.size()));
+    for (const std::string& process : snapshot.capture.processes) {
+        writer.String(process);
+    }
+
+    EncodeStatus(writer, snapshot.render);
+    writer.U32(static_cast<uint32_t>(snapshot.render.processes.size()));
+    for (const RenderProcessInfo& process : snapshot.render.processes) {
+        writer.U32(process.processId);
+        writer.U8(process.isActive ? 1 : 0);
+        writer.String(process.processName);
+        writer.String(process.deviceName);
+    }
+}
+
+bool DecodeAudioSnapshot(const char* data, size_t size, AudioSnapshot& snapshot) {
+    Reader reader(data, size);
+
+    uint32_t format = 0;
+    if (!reader.U32(format) || format != kSnapshotFormat) return false;
+
+    uint32_t count = 0;
+    if (!DecodeStatus(reader, snapshot.capture) || !reader.Count(count)) return false;
+    snapshot.capture.processes.resize(count);
+    for (std::string& process : snapshot.capture.processes) {
+        if (!reader.String(process)) return false;
+    }
+
+    if (!DecodeStatus(reader, snapshot.render) || !reader.Count(count)) return false;
+    snapshot.render.processes.resize(count);
+    for (RenderProcessInfo& process : snapshot.render.processes) {
+        uint8_t active = 0;
+        if (!reader.U32(process.processId) || !reader.U8(active) ||
+            !reader.String(process.processName) || !reader.String(process.deviceName)) {
+            return false;
+        }
+        process.isActive = active != 0;
+    }
+
+    return reader.AtEnd();
+}
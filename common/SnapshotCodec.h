@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include "AudioResults.h"
+
+// Capture and render results taken together, as published to a shared
+// snapshot segment
+struct AudioSnapshot {
+    AudioProcessResult capture;
+    RenderProcessResult render;
+};
+
+// Flat little-endian encoding of an AudioSnapshot. Appends to out, so a
+// caller can reuse one buffer across encodes.
+void EncodeAudioSnapshot(const AudioSnapshot& snapshot, std::string& out);
+
+// Returns false when data is truncated or malformed. Every length is checked
+// against the bytes left, so a torn or hostile payload cannot read past size.
+bool DecodeAudioSnapshot(const char* data, size_t size, AudioSnapshot& snapshot);
@@ -0,0 +1,26 @@
+// StringTable.cpp
+//
+
+#include "StringTable.h"
+
+StringTable::StringTable(size_t maxStrings)
+    : maxStrings_(maxStrings > 0 ? maxStrings : 1), version_(1) {}
+
+void StringTable::Reserve(size_t count) {
+    if (strings_.size() + count <= maxStrings_) return;
+
+    strings_.clear();
+    indices_.clear();
+    version_++;
+}
+
+int32_t StringTable::Index(const std::string& value) {
+    auto it = indices_.find(value);
+    if (it != indices_.end()) return it->second;
+
+    int32_t index = static_cast<int32_t>(strings_.size());
+    strings_.push_back(value);
+    indices_.emplace(value, index);
+    version_++;
+    return index;
+}
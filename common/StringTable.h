@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Append-only table of strings referenced by index from columnar results.
+// The version changes whenever a string is added or the table is reset, so
+// callers only need the strings again when the version they hold is stale.
+// Not synchronized; owned by whichever thread marshals results.
+class StringTable {
+public:
+    explicit StringTable(size_t maxStrings = 4096);
+
+    // Makes room for `count` new strings, resetting the table when it would
+    // grow past its cap. Call before indexing a batch so indices handed out
+    // for the batch stay valid.
+    void Reserve(size_t count);
+
+    int32_t Index(const std::string& value);
+
+    uint32_t Version() const { return version_; }
+    const std::vector<std::string>& Strings() const { return strings_; }
+
+private:
+    size_t maxStrings_;
+    uint32_t version_;
+    std::vector<std::string> strings_;
+    std::unordered_map<std::string, int32_t> indices_;
+};
@@ -0,0 +1,69 @@
+// TieredProbeScheduler.cpp
+//
+
+#include "TieredProbeScheduler.h"
+
+#include <algorithm>
+
+TieredProbeScheduler::TieredProbeScheduler(ActivityProbe activity, const ProbeSchedule& schedule)
+    : activity_(activity), schedule_(schedule), interval_(schedule.fastInterval), primed_(false),
+      stats_{0, 0, 0, 0} {}
+
+void TieredProbeScheduler::Speed() {
+    interval_ = schedule_.fastInterval;
+}
+
+void TieredProbeScheduler::SlowDown() {
+    interval_ = std::min(interval_ * 2, schedule_.idleInterval);
+}
+
+void TieredProbeScheduler::ReportChanged() {
+    Speed();
+}
+
+void TieredProbeScheduler::Invalidate() {
+    primed_ = false;
+}
+
+ProbeTier TieredProbeScheduler::Next() {
+    stats_.ticks++;
+
+    ActivitySample sample;
+    long errorCode = 0;
+    std::string errorMessage;
+    if (!activity_(sample, errorCode, errorMessage)) {
+        // The expensive probe reports the error, or finds it was transient
+        primed_ = false;
+        SlowDown();
+        stats_.full++;
+        lastFull_ = std::chrono::steady_clock::now();
+        return ProbeTier::Full;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    bool changed = !primed_ || sample.signature != last_.signature || sample.active != last_.active;
+    bool refreshDue = sample.active && now - lastFull_ >= schedule_.refreshInterval;
+
+    primed_ = true;
+    last_.signature.swap(sample.signature);
+    last_.active = sample.active;
+
+    if (changed) {
+        Speed();
+    } else {
+        SlowDown();
+        if (!refreshDue) {
+            stats_.unchanged++;
+            return ProbeTier::Unchanged;
+        }
+    }
+
+    if (!last_.active) {
+        stats_.idle++;
+        return ProbeTier::Idle;
+    }
+
+    stats_.full++;
+    lastFull_ = now;
+    return ProbeTier::Full;
+}
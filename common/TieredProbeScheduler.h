@@ -0,0 +1,80 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// What the cheap first-tier probe saw: a signature of every open stream and
+// whether any of them is running. The signature must change whenever a
+// device probe or a per-process scan could report something different.
+struct ActivitySample {
+    std::string signature;
+    bool active;
+
+    ActivitySample() : active(false) {}
+};
+
+typedef std::function<bool(ActivitySample& sample, long& errorCode, std::string& errorMessage)> ActivityProbe;
+
+struct ProbeSchedule {
+    std::chrono::milliseconds fastInterval;     // Pace right after activity changed
+    std::chrono::milliseconds idleInterval;     // Slowest pace; bounds detection latency
+    std::chrono::milliseconds refreshInterval;  // Rescan at least this often while something runs
+
+    ProbeSchedule()
+        : fastInterval(50), idleInterval(200), refreshInterval(1000) {}
+};
+
+// What the caller should do after a tick
+enum class ProbeTier {
+    Unchanged,  // Nothing changed; skip the expensive probe
+    Idle,       // Nothing is running; report an empty result without probing
+    Full        // Run the expensive probe (device state or per-process scan)
+};
+
+struct TieredProbeStats {
+    uint64_t ticks;
+    uint64_t unchanged;
+    uint64_t idle;
+    uint64_t full;
+};
+
+// Gates an expensive probe behind a cheap activity probe, and adapts the
+// polling interval: fastInterval after a change, doubling on every quiet
+// tick up to idleInterval. The expensive probe is a per-device probe for
+// microphone monitors and a per-process scan for watchers; either way it
+// runs only when the activity signature changed, when a refresh is due
+// while streams are running, or when the activity probe itself failed (so
+// the expensive probe reports the error).
+//
+// Not thread-safe; each polling thread owns its scheduler.
+class TieredProbeScheduler {
+public:
+    TieredProbeScheduler(ActivityProbe activity, const ProbeSchedule& schedule = ProbeSchedule());
+
+    ProbeTier Next();
+
+    // Wait before the next call to Next()
+    std::chrono::milliseconds Interval() const { return interval_; }
+
+    // Tells the scheduler the expensive probe found a change, so polling
+    // stays fast while activity keeps changing
+    void ReportChanged();
+
+    // Forgets the last signature, so the next tick runs the full probe
+    void Invalidate();
+
+    TieredProbeStats Stats() const { return stats_; }
+
+private:
+    void Speed();
+    void SlowDown();
+
+    ActivityProbe activity_;
+    ProbeSchedule schedule_;
+    std::chrono::milliseconds interval_;
+    bool primed_;
+    ActivitySample last_;
+    std::chrono::steady_clock::time_point lastFull_;
+    TieredProbeStats stats_;
+};
@@ -0,0 +1,185 @@
+#pragma once
+#include <napi.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include "AddonInstance.h"
+#include "AudioProcessWatcher.h"
+
+// Shared implementation of watchAudioProcesses(options, callback) for the
+// platform addons. Each platform supplies the scan function; the watcher
+// thread diffs snapshots natively and only crosses into JS when the set of
+// capture or render processes actually changed.
+//
+// A platform that also supplies a cheap activity probe gets adaptive polling
+// by default: the scan only runs when the probe saw streams open, close or
+// start, and intervalMs becomes the longest a running stream goes without a
+// rescan. Pass { adaptive: false } to scan every intervalMs regardless.
+//
+// A platform whose backend pushes change notifications also supplies a
+// ChangeNotifier, and the watcher rescans as soon as one arrives.
+
+struct AudioProcessWatch {
+  std::unique_ptr<AudioProcessWatcher> watcher;
+  Napi::ThreadSafeFunction tsfn;
+  std::atomic<bool> stopped;
+  AddonInstance* addon;
+  AddonInstance::HandleId handle;
+
+  std::function<void()> unhook;
+
+  AudioProcessWatch() : stopped(false), addon(nullptr), handle(0) {}
+
+  // On the env's JS thread; no wake reaches the watcher after this
+  void Unhook() {
+    if (!unhook) return;
+    std::function<void()> pending;
+    pending.swap(unhook);
+    pending();
+  }
+
+  // On the env's JS thread
+  void Stop() {
+    if (stopped.exchange(true)) return;
+    addon->UntrackHandle(handle);
+    Unhook();
+    watcher->Stop();
+    tsfn.Release();
+  }
+};
+
+static Napi::Array WatchedProcessesToArray(Napi::Env env, const std::vector<WatchedProcess>& processes) {
+  Napi::Array array = Napi::Array::New(env, processes.size());
+  for (size_t i = 0; i < processes.size(); i++) {
+    Napi::Object processObj = Napi::Object::New(env);
+    processObj.Set("processId", Napi::Number::New(env, processes[i].processId));
+    processObj.Set("processName", Napi::String::New(env, processes[i].processName));
+    processObj.Set("deviceName", Napi::String::New(env, processes[i].deviceName));
+    array.Set(i, processObj);
+  }
+  return array;
+}
+
+static Napi::Object ProcessSetDeltaToObject(Napi::Env env, const ProcessSetDelta& delta) {
+  Napi::Object deltaObj = Napi::Object::New(env);
+  deltaObj.Set("added", WatchedProcessesToArray(env, delta.added));
+  deltaObj.Set("removed", WatchedProcessesToArray(env, delta.removed));
+  return deltaObj;
+}
+
+static Napi::Value StartAudioProcessWatch(const Napi::CallbackInfo& info, AudioProcessWatcher::ScanFunction scan,
+                                          ActivityProbe activity = ActivityProbe(),
+                                          ChangeNotifier notifier = ChangeNotifier()) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+    Napi::TypeError::New(env, "Expected an options object and a callback function").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  int64_t intervalMs = 1000;
+  Napi::Value interval = options.Get("intervalMs");
+  if (interval.IsNumber()) {
+    intervalMs = interval.As<Napi::Number>().Int64Value();
+  } else if (!interval.IsUndefined()) {
+    Napi::TypeError::New(env, "intervalMs must be a number").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  if (intervalMs < 10) {
+    Napi::RangeError::New(env, "intervalMs must be at least 10").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  bool adaptive = static_cast<bool>(activity);
+  Napi::Value adaptiveOption = options.Get("adaptive");
+  if (adaptiveOption.IsBoolean()) {
+    adaptive = adaptive && adaptiveOption.As<Napi::Boolean>().Value();
+  } else if (!adaptiveOption.IsUndefined()) {
+    Napi::TypeError::New(env, "adaptive must be a boolean").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // Shared by the JS stop() closure and the TSFN, whichever outlives the other
+  std::shared_ptr<AudioProcessWatch>* context =
+      new std::shared_ptr<AudioProcessWatch>(std::make_shared<AudioProcessWatch>());
+  std::shared_ptr<AudioProcessWatch> watch = *context;
+  watch->addon = &AddonInstance::Of(env);
+
+  watch->tsfn = Napi::ThreadSafeFunction::New(
+    env,
+    info[1].As<Napi::Function>(),
+    "AudioProcessWatcher",
+    0,
+    1,
+    context,
+    [](Napi::Env, std::shared_ptr<AudioProcessWatch>* context) {
+      // Runs once the TSFN is released or the env is torn down
+      if (!(*context)->stopped.exchange(true)) {
+        (*context)->addon->UntrackHandle((*context)->handle);
+      }
+      (*context)->Unhook();
+      (*context)->watcher->Stop();
+      delete context;
+    }
+  );
+
+  std::weak_ptr<AudioProcessWatch> weakWatch = watch;
+  watch->watcher.reset(new AudioProcessWatcher(
+    scan,
+    [weakWatch](AudioProcessDelta* delta) {
+      std::shared_ptr<AudioProcessWatch> watch = weakWatch.lock();
+      if (!watch) {
+        delete delta;
+        return;
+      }
+
+      auto callback = [watch](Napi::Env env, Napi::Function js_callback, AudioProcessDelta* delta) {
+        std::unique_ptr<AudioProcessDelta> owned(delta);
+        if (watch->stopped || !env) return;
+
+        if (!delta->errorMessage.empty()) {
+          Napi::Error err = Napi::Error::New(env, delta->errorMessage);
+          err.Set("code", Napi::Number::New(env, delta->errorCode));
+          err.Set("domain", Napi::String::New(env, "AudioProcessWatcher"));
+          js_callback.Call({ env.Null(), err.Value() });
+          return;
+        }
+
+        Napi::Object deltaObj = Napi::Object::New(env);
+        deltaObj.Set("capture", ProcessSetDeltaToObject(env, delta->capture));
+        deltaObj.Set("render", ProcessSetDeltaToObject(env, delta->render));
+        js_callback.Call({ deltaObj, env.Null() });
+      };
+
+      if (watch->tsfn.BlockingCall(delta, callback) != napi_ok) {
+        delete delta;
+      }
+    },
+    std::chrono::milliseconds(intervalMs)));
+
+  if (adaptive) {
+    ProbeSchedule schedule;
+    schedule.refreshInterval = std::chrono::milliseconds(intervalMs);
+    schedule.idleInterval = std::min(schedule.idleInterval, schedule.refreshInterval);
+    schedule.fastInterval = std::min(schedule.fastInterval, schedule.idleInterval);
+    watch->watcher->UseScheduler(std::unique_ptr<TieredProbeScheduler>(new TieredProbeScheduler(activity, schedule)));
+  }
+  watch->watcher->Start();
+  if (notifier) {
+    AudioProcessWatcher* watcher = watch->watcher.get();
+    watch->unhook = notifier([watcher]() { watcher->Wake(); });
+  }
+
+  watch->handle = watch->addon->TrackHandle([weakWatch]() {
+    std::shared_ptr<AudioProcessWatch> watch = weakWatch.lock();
+    if (watch) watch->Stop();
+  });
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("stop", Napi::Function::New(env, [watch](const Napi::CallbackInfo& info) -> Napi::Value {
+    watch->Stop();
+    return info.Env().Undefined();
+  }, "stop"));
+  return handle;
+}
@@ -0,0 +1,139 @@
+// WorkStealingPool.cpp
+//
+
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+// Indices taken from a thread's own range at a time
+static const size_t kChunk = 16;
+
+WorkStealingPool::WorkStealingPool(size_t threads)
+    : task_(nullptr), busy_(0), batch_(0), steals_(0), stopping_(false) {
+    if (threads == 0) {
+        threads = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 4);
+    }
+    threads_ = threads;
+    ranges_.reset(new Range[threads]);
+    for (size_t i = 0; i < threads; i++) {
+        ranges_[i].begin = 0;
+        ranges_[i].end = 0;
+    }
+    for (size_t i = 1; i < threads; i++) {
+        workers_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::Run(size_t count, const std::function<void(size_t index, size_t thread)>& task) {
+    std::lock_guard<std::mutex> run(runMutex_);
+    steals_ = 0;
+
+    // Not worth waking anyone for
+    if (workers_.empty() || count <= kChunk) {
+        for (size_t i = 0; i < count; i++) task(i, 0);
+        return;
+    }
+
+    for (size_t i = 0; i < threads_; i++) {
+        std::lock_guard<std::mutex> lock(ranges_[i].mutex);
+        ranges_[i].begin = count * i / threads_;
+        ranges_[i].end = count * (i + 1) / threads_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        busy_ = workers_.size();
+        batch_++;
+    }
+    wake_.notify_all();
+
+    Work(0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkStealingPool::WorkerLoop(size_t thread) {
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seen] { return stopping_ || batch_ != seen; });
+            if (stopping_) return;
+            seen = batch_;
+        }
+
+        Work(thread);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--busy_ == 0) done_.notify_one();
+    }
+}
+
+void WorkStealingPool::Work(size_t thread) {
+    size_t begin = 0;
+    size_t end = 0;
+    for (;;) {
+        if (!Take(thread, begin, end)) {
+            if (!Steal(thread)) return;
+            continue;
+        }
+        for (size_t i = begin; i < end; i++) {
+            (*task_)(i, thread);
+        }
+    }
+}
+
+// Takes the next chunk from the front of this thread's own range
+bool WorkStealingPool::Take(size_t thread, size_t& begin, size_t& end) {
+    Range& own = ranges_[thread];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (own.begin >= own.end) return false;
+    begin = own.begin;
+    end = std::min(own.end, begin + kChunk);
+    own.begin = end;
+    return true;
+}
+
+// Moves the back half of the first non-empty range found into this thread's
+// own, which is empty. Ranges only ever shrink, so a thread that finds every
+// range empty can stop: whatever is left belongs to a thread still working.
+bool WorkStealingPool::Steal(size_t thread) {
+    for (size_t offset = 1; offset < threads_; offset++) {
+        Range& victim = ranges_[(thread + offset) % threads_];
+        size_t begin = 0;
+        size_t end = 0;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.begin >= victim.end) continue;
+            size_t remaining = victim.end - victim.begin;
+            size_t take = remaining > kChunk ? remaining / 2 : remaining;
+            end = victim.end;
+            begin = end - take;
+            victim.end = begin;
+        }
+
+        Range& own = ranges_[thread];
+        {
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = begin;
+            own.end = end;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        steals_++;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads for batches of many small, uneven tasks, such as one
+// per PID. Each batch is split into one contiguous range per thread; a
+// thread takes small chunks from the front of its own range and, once that
+// is empty, steals the back half of another thread's range. Neighbouring
+// indices stay on one thread, and a thread stuck on a slow task does not
+// hold back the rest. The calling thread takes part in every batch.
+class WorkStealingPool {
+public:
+    // threads counts the caller; 0 picks min(hardware threads, 4), 1 runs
+    // every task inline
+    explicit WorkStealingPool(size_t threads = 0);
+    ~WorkStealingPool();
+
+    // Calls task(index, thread) for every index in [0, count) and returns
+    // once all calls have finished. thread is in [0, Threads()) and no two
+    // calls with the same thread run at once, so it can index per-thread
+    // scratch state. Batches from different callers run one at a time.
+    void Run(size_t count, const std::function<void(size_t index, size_t thread)>& task);
+
+    size_t Threads() const { return threads_; }
+
+    // Ranges stolen during the last batch
+    uint64_t LastSteals() const { return steals_; }
+
+private:
+    struct alignas(64) Range {
+        std::mutex mutex;
+        size_t begin;
+        size_t end;
+    };
+
+    void WorkerLoop(size_t thread);
+    void Work(size_t thread);
+    bool Take(size_t thread, size_t& begin, size_t& end);
+    bool Steal(size_t thread);
+
+    size_t threads_;
+    std::unique_ptr<Range[]> ranges_;
+    std::vector<std::thread> workers_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t, size_t)>* task_;
+    size_t busy_;
+    uint64_t batch_;
+    uint64_t steals_;
+    bool stopping_;
+};
@@ -11,40 +11,183 @@ const noopPlatformUtils = {
       processes: ["", ""],
     };
   },
-  getProcessesAccessingSpeakersWithResult: () => {
+  getProcessesAccessingSpeakersWithResult: (options) => {
+    if (options && options.columnar) {
+      return {
+        success: true,
+        error: null,
+        processIds: new Int32Array(0),
+        isActive: new Uint8Array(0),
+        processNameIds: new Int32Array(0),
+        deviceNameIds: new Int32Array(0),
+        stringTableVersion: 1,
+        strings: [],
+      };
+    }
     return {
       success: true,
       error: null,
       processes: [],
     };
   },
+  getRunningInputAudioProcessesAsync: () => {
+    return Promise.resolve(noopPlatformUtils.getRunningInputAudioProcesses());
+  },
+  getProcessesAccessingMicrophoneWithResultAsync: () => {
+    return Promise.resolve(
+      noopPlatformUtils.getProcessesAccessingMicrophoneWithResult()
+    );
+  },
+  getProcessesAccessingSpeakersWithResultAsync: () => {
+    return Promise.resolve(
+      noopPlatformUtils.getProcessesAccessingSpeakersWithResult()
+    );
+  },
+  getAudioSnapshot: () => {
+    return {
+      success: true,
+      error: null,
+      processes: [],
+    };
+  },
+  getAudioSnapshotAsync: () => {
+    return Promise.resolve(noopPlatformUtils.getAudioSnapshot());
+  },
+  watchAudioProcesses: () => {
+    return { stop: () => {} };
+  },
+  subscribeMicrophone: (options) => {
+    return {
+      deviceId: (options && options.deviceId) || "default",
+      unsubscribe: () => {},
+      stats: () => ({ pushed: 0, delivered: 0, merged: 0, dropped: 0 }),
+    };
+  },
+  startLevelMeter: () => {
+    return {
+      stop: () => {},
+      stats: () => ({ frames: 0, readings: 0, dropped: 0, kernel: "scalar" }),
+    };
+  },
+  measureLevel: () => {
+    return { peak: 0, rms: 0, peakDb: -120, rmsDb: -120, kernel: "scalar" };
+  },
+  getStats: () => {
+    return { enabled: false, calls: {}, stages: {} };
+  },
+  resetStats: () => {},
+  getInstanceStats: () => {
+    return { instances: 1, openHandles: 0, hubListeners: 0, hubSubscribers: 0 };
+  },
+  createProcessFilter: () => {
+    return {};
+  },
+  createAudioContext: () => {
+    return {
+      query: () => ({ success: true, error: null, capture: [], render: [] }),
+      invalidate: () => {},
+      stats: () => ({ queries: 0, refreshes: 0, resolves: 0, failures: 0, devices: 0 }),
+      close: () => {},
+    };
+  },
 };
 
-if (process.platform === "darwin") {
-  platform_utils = require("bindings")("mac_utils.node");
-} else if (process.platform === "win32") {
-  platform_utils = require("bindings")("win_utils.node");
-} else {
-  console.log("node-mac-utils Unsupported platform:", process.platform);
-  platform_utils = noopPlatformUtils;
+// How long loading the native module took, once it has been loaded
+let loadMs = null;
+
+// The native module is loaded on first use rather than at require() time, so
+// importing this package costs nothing until a function is called.
+function loadPlatformUtils() {
+  if (platform_utils) return platform_utils;
+
+  const start = process.hrtime.bigint();
+  if (process.platform === "darwin") {
+    platform_utils = require("bindings")("mac_utils.node");
+  } else if (process.platform === "win32") {
+    platform_utils = require("bindings")("win_utils.node");
+  } else if (process.platform === "linux") {
+    platform_utils = require("bindings")("linux_utils.node");
+  } else {
+    console.log("node-mac-utils Unsupported platform:", process.platform);
+    platform_utils = noopPlatformUtils;
+  }
+  loadMs = Number(process.hrtime.bigint() - start) / 1e6;
+  return platform_utils;
+}
+
+function lazy(name) {
+  return (...args) => loadPlatformUtils()[name](...args);
+}
+
+// Loads the native module and, where the platform supports it, selects and
+// warms the audio backend on a background native thread: device list,
+// session walk and resolver cache. Resolves with how long each step took, so
+// the first enumeration call afterwards pays none of it.
+function prewarm() {
+  const utils = loadPlatformUtils();
+  const warmup = utils.prewarm
+    ? utils.prewarm()
+    : Promise.resolve({ success: true, error: null, backend: null });
+  return warmup.then((result) => Object.assign({ loadMs }, result));
 }
 
 module.exports = {
   // Common exports that work on all platforms
-  getRunningInputAudioProcesses: platform_utils.getRunningInputAudioProcesses,
+  getRunningInputAudioProcesses: lazy("getRunningInputAudioProcesses"),
   getProcessesAccessingMicrophoneWithResult:
-    platform_utils.getProcessesAccessingMicrophoneWithResult,
+    lazy("getProcessesAccessingMicrophoneWithResult"),
   getProcessesAccessingSpeakersWithResult:
-    platform_utils.getProcessesAccessingSpeakersWithResult,
+    lazy("getProcessesAccessingSpeakersWithResult"),
+  getRunningInputAudioProcessesAsync:
+    lazy("getRunningInputAudioProcessesAsync"),
+  getProcessesAccessingMicrophoneWithResultAsync:
+    lazy("getProcessesAccessingMicrophoneWithResultAsync"),
+  getProcessesAccessingSpeakersWithResultAsync:
+    lazy("getProcessesAccessingSpeakersWithResultAsync"),
+  getAudioSnapshot: lazy("getAudioSnapshot"),
+  getAudioSnapshotAsync: lazy("getAudioSnapshotAsync"),
+  watchAudioProcesses: lazy("watchAudioProcesses"),
+  subscribeMicrophone: lazy("subscribeMicrophone"),
+  startLevelMeter: lazy("startLevelMeter"),
+  measureLevel: lazy("measureLevel"),
+  getStats: lazy("getStats"),
+  resetStats: lazy("resetStats"),
+  getInstanceStats: lazy("getInstanceStats"),
+  createProcessFilter: lazy("createProcessFilter"),
+  createAudioContext: lazy("createAudioContext"),
+  prewarm,
   INFO_ERROR_CODE: 1,
   ERROR_DOMAIN: "com.MicrophoneUsageMonitor",
 
+  // Windows and Linux exports
+  ...(process.platform === "win32" || process.platform === "linux"
+    ? {
+        getResolverCacheStats: lazy("getResolverCacheStats"),
+        setResolverCacheCapacity: lazy("setResolverCacheCapacity"),
+      }
+    : {}),
+
+  // Linux-specific exports
+  ...(process.platform === "linux"
+    ? {
+        getCaptureDevices: lazy("getCaptureDevices"),
+        setAudioBackend: lazy("setAudioBackend"),
+        getAudioStreams: lazy("getAudioStreams"),
+        startSnapshotPublisher: lazy("startSnapshotPublisher"),
+        readSharedSnapshot: lazy("readSharedSnapshot"),
+        startUsageLog: lazy("startUsageLog"),
+        queryUsage: lazy("queryUsage"),
+        getProcessApplication: lazy("getProcessApplication"),
+        setScanThreads: lazy("setScanThreads"),
+      }
+    : {}),
+
   // Mac-specific exports
   ...(process.platform === "darwin"
     ? {
-        makeKeyAndOrderFront: platform_utils.makeKeyAndOrderFront,
-        startMonitoringMic: platform_utils.startMonitoringMic,
-        stopMonitoringMic: platform_utils.stopMonitoringMic,
+        makeKeyAndOrderFront: lazy("makeKeyAndOrderFront"),
+        startMonitoringMic: lazy("startMonitoringMic"),
+        stopMonitoringMic: lazy("stopMonitoringMic"),
       }
     : {}),
 };
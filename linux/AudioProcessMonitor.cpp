@@ -0,0 +1,378 @@
+// AudioProcessMonitor.cpp
+//
+
+#include "AudioProcessMonitor.h"
+
+#include <errno.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/NativeStats.h"
+#include "../common/SessionPipeline.h"
+#include "ProcAudioBackend.h"
+#include "ProcAudioScanner.h"
+#include "ProcContextBackend.h"
+#include "ProcStat.h"
+#include "ProcessTree.h"
+#include "PulseContextBackend.h"
+#include "PulseSessionBackend.h"
+#include "SoundDeviceWatcher.h"
+
+static ProcAudioBackend& SharedProcAudioBackend() {
+    static ProcAudioBackend backend;
+    return backend;
+}
+
+static PulseSessionBackend& SharedPulseSessionBackend() {
+    static PulseSessionBackend backend;
+    return backend;
+}
+
+// Both backends live for the life of the process, so switching never pulls
+// one out from under a call in flight. Null until the first call picks one.
+static std::atomic<AudioBackend*> selectedBackend(nullptr);
+
+AudioBackend& SharedAudioBackend() {
+    AudioBackend* backend = selectedBackend.load();
+    if (!backend) {
+        long errorCode = 0;
+        std::string errorMessage;
+        SelectAudioBackend("auto", errorCode, errorMessage);
+        backend = selectedBackend.load();
+    }
+    return *backend;
+}
+
+const char* SelectAudioBackend(const std::string& name, long& errorCode, std::string& errorMessage) {
+    if (name == "proc") {
+        selectedBackend = &SharedProcAudioBackend();
+        return "proc";
+    }
+    if (name != "auto" && name != "pulse") {
+        errorCode = EINVAL;
+        errorMessage = "Unknown audio backend: " + name;
+        return nullptr;
+    }
+
+    if (!SharedPulseSessionBackend().Connect(errorCode, errorMessage)) {
+        if (name == "pulse") return nullptr;
+        selectedBackend = &SharedProcAudioBackend();
+        return "proc";
+    }
+    selectedBackend = &SharedPulseSessionBackend();
+    return "pulse";
+}
+
+const char* SelectedAudioBackend() {
+    return &SharedAudioBackend() == &SharedPulseSessionBackend() ? "pulse" : "proc";
+}
+
+BackendWarmup PrewarmAudioBackend() {
+    BackendWarmup warmup;
+    auto start = std::chrono::steady_clock::now();
+    AudioBackend& backend = SharedAudioBackend();
+    warmup.selectMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    warmup.backend = SelectedAudioBackend();
+    WarmAudioBackend(backend, warmup);
+    return warmup;
+}
+
+// Rebuilt over the other shared backend when the selection switches
+class SelectedContextBackend : public ContextBackend {
+public:
+    SelectedContextBackend() : selected_(nullptr), switches_(0) {}
+
+    uint64_t TopologyVersion() override {
+        Follow();
+        // A switch moves the version too, so the context reopens its devices
+        return (switches_ << 48) ^ backend_->TopologyVersion();
+    }
+
+    bool OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) override {
+        Follow();
+        return backend_->OpenDevices(devices, errorCode, errorMessage);
+    }
+
+    bool ReadSessions(std::vector<AudioSession>& sessions, long& errorCode, std::string& errorMessage) override {
+        return backend_->ReadSessions(sessions, errorCode, errorMessage);
+    }
+
+    std::string ResolveProcessPath(uint32_t processId) override {
+        return backend_->ResolveProcessPath(processId);
+    }
+
+private:
+    void Follow() {
+        AudioBackend* selected = &SharedAudioBackend();
+        if (selected == selected_) return;
+        selected_ = selected;
+        switches_++;
+        if (selected == &SharedPulseSessionBackend()) {
+            backend_.reset(new PulseContextBackend(SharedPulseSessionBackend()));
+        } else {
+            backend_.reset(new ProcContextBackend(SharedProcAudioBackend()));
+        }
+    }
+
+    AudioBackend* selected_;
+    uint64_t switches_;
+    std::unique_ptr<ContextBackend> backend_;
+};
+
+std::unique_ptr<ContextBackend> CreateAudioContextBackend() {
+    return std::unique_ptr<ContextBackend>(new SelectedContextBackend());
+}
+
+bool GetSoundServerStreams(std::vector<SoundServerStream>& streams, long& errorCode, std::string& errorMessage) {
+    return SharedPulseSessionBackend().Streams(streams, errorCode, errorMessage);
+}
+
+std::function<void()> SubscribeAudioChanges(std::function<void()> wake) {
+    PulseSessionBackend& backend = SharedPulseSessionBackend();
+    PulseSessionBackend::ListenerId id =
+        backend.AddListener([wake](std::chrono::steady_clock::time_point) { wake(); });
+    return [&backend, id]() { backend.RemoveListener(id); };
+}
+
+size_t SetScanThreads(size_t threads) {
+    return SharedProcAudioBackend().SetScanThreads(threads);
+}
+
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult(const ProcessFilter* filter) {
+    AudioProcessResult result;
+    StatsCallScope call(StatsCall::MicrophoneProcesses, &result.success);
+    result = CollectCaptureProcesses(SharedAudioBackend(), StatsPipelineObserver(), filter);
+    return result;
+}
+
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
+    return GetProcessesAccessingMicrophoneWithResult(nullptr);
+}
+
+std::vector<std::string> GetAudioInputProcesses(const ProcessFilter* filter) {
+    AudioProcessResult result;
+    StatsCallScope call(StatsCall::RunningInputProcesses, &result.success);
+    result = CollectCaptureProcesses(SharedAudioBackend(), StatsPipelineObserver(), filter);
+    return result.processes;
+}
+
+std::vector<std::string> GetAudioInputProcesses() {
+    return GetAudioInputProcesses(nullptr);
+}
+
+// Speaker/render process detection - separate from microphone monitoring
+RenderProcessResult GetRenderProcessesWithResult(const ProcessFilter* filter) {
+    RenderProcessResult result;
+    StatsCallScope call(StatsCall::SpeakerProcesses, &result.success);
+    result = CollectRenderProcesses(SharedAudioBackend(), StatsPipelineObserver(), filter);
+    return result;
+}
+
+RenderProcessResult GetRenderProcessesWithResult() {
+    return GetRenderProcessesWithResult(nullptr);
+}
+
+ProcessAudioSnapshot GetAudioSnapshot(const ProcessFilter* filter) {
+    ProcessAudioSnapshot result;
+    StatsCallScope call(StatsCall::AudioSnapshot, &result.success);
+    result = CollectProcessAudioSnapshot(SharedAudioBackend(), StatsPipelineObserver(), filter);
+    return result;
+}
+
+ProcessAudioSnapshot GetAudioSnapshot() {
+    return GetAudioSnapshot(nullptr);
+}
+
+// New PIDs are picked up by the walk itself, so the sync only has to keep
+// exited ones from piling up
+static const uint64_t kProcessTreeSyncMs = 2000;
+
+std::vector<ApplicationInfo> AttributeToApplications(const std::vector<uint32_t>& pids) {
+    ProcessTree& tree = SharedProcessTree();
+    int errorCode = 0;
+    std::string errorMessage;
+    tree.SyncIfOlderThan(kProcessTreeSyncMs, errorCode, errorMessage);
+
+    // Sessions of one process usually come in runs, and several helpers
+    // share an application, so both lookups are done once per PID
+    std::unordered_map<uint32_t, size_t> byProcess;
+    std::unordered_map<uint32_t, size_t> byApplication;
+    std::vector<ApplicationInfo> applications;
+    applications.reserve(pids.size());
+
+    for (uint32_t pid : pids) {
+        auto known = byProcess.find(pid);
+        if (known != byProcess.end()) {
+            applications.push_back(applications[known->second]);
+            continue;
+        }
+
+        ProcessAttribution attribution;
+        if (!tree.Attribute(static_cast<pid_t>(pid), attribution)) {
+            attribution.processId = pid;
+            attribution.depth = 0;
+        }
+
+        ApplicationInfo application;
+        application.processId = attribution.processId;
+        application.depth = attribution.depth;
+        auto resolved = byApplication.find(attribution.processId);
+        if (resolved != byApplication.end()) {
+            application.path = applications[resolved->second].path;
+            application.name = applications[resolved->second].name;
+        } else {
+            application.path = GetProcessExecutablePath(static_cast<pid_t>(attribution.processId));
+            size_t lastSlash = application.path.find_last_of("/");
+            if (application.path == "Unknown" && !attribution.comm.empty()) {
+                application.name = attribution.comm;
+            } else if (lastSlash != std::string::npos) {
+                application.name = application.path.substr(lastSlash + 1);
+            } else {
+                application.name = application.path;
+            }
+            byApplication.emplace(attribution.processId, applications.size());
+        }
+
+        byProcess.emplace(pid, applications.size());
+        applications.push_back(application);
+    }
+    return applications;
+}
+
+bool GetWatchedProcesses(WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage) {
+    bool succeeded = false;
+    StatsCallScope call(StatsCall::WatchPoll, &succeeded);
+    AudioBackend& backend = SharedAudioBackend();
+
+    std::vector<AudioDevice> devices;
+    std::vector<AudioSession> sessions;
+    if (!backend.Enumerate(devices, sessions, errorCode, errorMessage)) {
+        return false;
+    }
+
+    for (const AudioSession& session : sessions) {
+        if (!session.isActive) continue;
+
+        WatchedProcess process;
+        process.processId = session.processId;
+        process.processName = backend.ResolveProcessPath(session.processId);
+        process.deviceName = devices[session.deviceIndex].name;
+
+        if (devices[session.deviceIndex].direction == AudioDirection::Capture) {
+            snapshot.capture.push_back(process);
+        } else {
+            // Render entries carry the executable name, as in RenderProcessInfo
+            size_t lastSlash = process.processName.find_last_of("/");
+            if (lastSlash != std::string::npos) {
+                process.processName = process.processName.substr(lastSlash + 1);
+            }
+            snapshot.render.push_back(process);
+        }
+    }
+
+    succeeded = true;
+    return true;
+}
+
+bool ProbeAudioActivity(ActivitySample& sample, long& errorCode, std::string& errorMessage) {
+    // The sound server holds its devices open whether or not anything plays,
+    // so /proc/asound says nothing about its streams
+    if (&SharedAudioBackend() == &SharedPulseSessionBackend()) {
+        return SharedPulseSessionBackend().ReadActivity(sample, errorCode, errorMessage);
+    }
+    if (!ProcAudioScanner::ReadActivity("/proc", sample.signature, sample.active)) {
+        sample.signature.clear();
+        sample.active = false;
+    }
+    return true;
+}
+
+static CaptureDeviceProbe& SharedCaptureDeviceProbe() {
+    static CaptureDeviceProbe probe;
+    return probe;
+}
+
+bool GetCaptureDevices(std::vector<CaptureDeviceState>& devices, long& errorCode, std::string& errorMessage) {
+    int probeError = 0;
+    if (!SharedCaptureDeviceProbe().Probe(devices, probeError, errorMessage)) {
+        errorCode = probeError;
+        return false;
+    }
+    return true;
+}
+
+bool ProbeCaptureDevices(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                         long& errorCode, std::string& errorMessage) {
+    bool succeeded = false;
+    StatsCallScope call(StatsCall::MonitorProbe, &succeeded);
+
+    std::vector<CaptureDeviceState> states;
+    if (!GetCaptureDevices(states, errorCode, errorMessage)) {
+        return false;
+    }
+
+    if (deviceId == "default") {
+        DeviceActivity any = {"default", "Any capture device", false};
+        for (const CaptureDeviceState& state : states) {
+            any.active = any.active || state.active;
+        }
+        devices.push_back(any);
+        succeeded = true;
+        return true;
+    }
+
+    for (const CaptureDeviceState& state : states) {
+        if (deviceId == "*" || deviceId == state.id) {
+            devices.push_back(DeviceActivity{state.id, state.name, state.active});
+        }
+    }
+
+    if (devices.empty() && deviceId != "*") {
+        errorCode = ENODEV;
+        errorMessage = "Unknown capture device: " + deviceId;
+        return false;
+    }
+    succeeded = true;
+    return true;
+}
+
+namespace {
+
+class CaptureMonitorSource : public PollingMonitorSource {
+public:
+    CaptureMonitorSource()
+        : PollingMonitorSource(ProbeCaptureDevices, "LinuxMicrophoneMonitor", std::chrono::milliseconds(250)),
+          watcherId_(0) {
+        UseScheduler(std::unique_ptr<TieredProbeScheduler>(new TieredProbeScheduler(ProbeAudioActivity)));
+    }
+
+    ~CaptureMonitorSource() override { Stop(); }
+
+    bool Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) override {
+        if (!PollingMonitorSource::Start(deviceId, sink, error)) return false;
+        watcherId_ = SharedSoundDeviceWatcher().AddListener([this](std::chrono::steady_clock::time_point detectedAt) {
+            Wake(detectedAt);
+        });
+        return true;
+    }
+
+    void Stop() override {
+        // Unhooked first so no wake arrives while the poller shuts down
+        if (watcherId_ != 0) {
+            SharedSoundDeviceWatcher().RemoveListener(watcherId_);
+            watcherId_ = 0;
+        }
+        PollingMonitorSource::Stop();
+    }
+
+private:
+    SoundDeviceWatcher::ListenerId watcherId_;
+};
+
+}  // namespace
+
+std::unique_ptr<MonitorSource> CreateCaptureMonitorSource() {
+    return std::unique_ptr<MonitorSource>(new CaptureMonitorSource());
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../common/AudioContext.h"
+#include "../common/AudioProcessWatcher.h"
+#include "../common/AudioResults.h"
+#include "../common/BackendWarmup.h"
+#include "../common/PollingMonitorSource.h"
+#include "../common/ProcessFilter.h"
+#include "../common/ProcessAudioSnapshot.h"
+#include "../common/TieredProbeScheduler.h"
+#include "CaptureDeviceProbe.h"
+#include "PulseSessionBackend.h"
+
+class AudioBackend;
+
+// Backend shared by every call: the sound server's session list when a
+// PulseAudio or PipeWire server is reachable, /proc otherwise. Chosen on the
+// first call, with "auto" semantics, unless SelectAudioBackend ran first.
+AudioBackend& SharedAudioBackend();
+
+// "pulse" uses the sound server and fails without one, "proc" scans /proc
+// for processes holding ALSA PCMs open, and "auto" tries the sound server
+// first. Returns the name of the backend now in use, or nullptr and sets
+// errorCode / errorMessage.
+const char* SelectAudioBackend(const std::string& name, long& errorCode, std::string& errorMessage);
+
+// "pulse" or "proc"
+const char* SelectedAudioBackend();
+
+// ContextBackend for createAudioContext() over the backend SharedAudioBackend()
+// uses, sharing its state: the sound server's cached lists, or the /proc
+// scanner with its pool. Follows SelectAudioBackend() when it switches.
+std::unique_ptr<ContextBackend> CreateAudioContextBackend();
+
+// Every sink input and source output on the sound server, with its client
+bool GetSoundServerStreams(std::vector<SoundServerStream>& streams, long& errorCode, std::string& errorMessage);
+
+// Picks the shared backend if no call has yet (connecting to the sound server
+// when there is one) and warms it; see BackendWarmup.h. Blocks, so run it off
+// the JS thread.
+BackendWarmup PrewarmAudioBackend();
+
+// ChangeNotifier for AudioProcessWatcher: wakes it on every change the sound
+// server pushes; only fires while the sound server is connected.
+std::function<void()> SubscribeAudioChanges(std::function<void()> wake);
+
+// Sizes the pool the shared backend walks /proc with, counting the calling
+// thread (0 picks a default); returns the thread count in use
+size_t SetScanThreads(size_t threads);
+
+// The enumeration calls below take an optional filter, applied in the
+// session pipeline before paths are resolved; see ProcessFilter.h
+
+// Original function returning vector
+std::vector<std::string> GetAudioInputProcesses();
+std::vector<std::string> GetAudioInputProcesses(const ProcessFilter* filter);
+
+// Function with structured result
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult();
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult(const ProcessFilter* filter);
+
+// Speaker/render process detection
+RenderProcessResult GetRenderProcessesWithResult();
+RenderProcessResult GetRenderProcessesWithResult(const ProcessFilter* filter);
+
+// Capture and render use of every process from one /proc scan
+ProcessAudioSnapshot GetAudioSnapshot();
+ProcessAudioSnapshot GetAudioSnapshot(const ProcessFilter* filter);
+
+// The application behind a process, e.g. the browser behind its audio service
+struct ApplicationInfo {
+    uint32_t processId;
+    std::string name;  // Executable basename, or comm when the path is unreadable
+    std::string path;
+    uint32_t depth;    // Parent steps from the process to the application
+};
+
+// Attributes each PID to its top-level application through the shared
+// ProcessTree, synced at most every couple of seconds. Entries line up with
+// pids; a PID that has exited is attributed to itself.
+std::vector<ApplicationInfo> AttributeToApplications(const std::vector<uint32_t>& pids);
+
+// Capture and render processes from a single scan, for AudioProcessWatcher
+bool GetWatchedProcesses(WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage);
+
+// Cheap first tier for TieredProbeScheduler: reads substream state from
+// /proc/asound without touching any /proc/<pid>/fd, or the sound server's
+// cached stream state when that is the backend. A host without ALSA reports
+// no activity.
+bool ProbeAudioActivity(ActivitySample& sample, long& errorCode, std::string& errorMessage);
+
+// Capture devices covered by deviceId, for PollingMonitorSource: "*" lists
+// every ALSA capture PCM separately, "default" reports one entry that is
+// active when any of them is, and "hw:<card>,<device>" reports that PCM.
+bool ProbeCaptureDevices(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                         long& errorCode, std::string& errorMessage);
+
+// Microphone monitor for MonitorHub: polls ProbeCaptureDevices, gated by
+// ProbeAudioActivity, and probes again as soon as /dev/snd changes, so
+// hot-plugged devices are picked up without waiting for the next poll
+std::unique_ptr<MonitorSource> CreateCaptureMonitorSource();
+
+// Every ALSA capture PCM and whether it is in use
+bool GetCaptureDevices(std::vector<CaptureDeviceState>& devices, long& errorCode, std::string& errorMessage);
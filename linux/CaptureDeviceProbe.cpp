@@ -0,0 +1,115 @@
+// CaptureDeviceProbe.cpp
+//
+
+#include "CaptureDeviceProbe.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "ProcFiles.h"
+
+CaptureDeviceProbe::CaptureDeviceProbe(const std::string& procRoot, size_t threads)
+    : procRoot_(procRoot), pool_(threads) {}
+
+bool CaptureDeviceProbe::ListDevices(std::vector<CaptureDeviceState>& devices, int& errorCode,
+                                     std::string& errorMessage) {
+    std::string asoundPath = procRoot_ + "/asound";
+    DIR* asoundDir = opendir(asoundPath.c_str());
+    if (!asoundDir) {
+        if (errno == ENOENT) return true;  // No ALSA
+        errorCode = errno;
+        errorMessage = "Failed to open " + asoundPath;
+        return false;
+    }
+
+    while (struct dirent* cardEntry = readdir(asoundDir)) {
+        long card = 0;
+        if (strncmp(cardEntry->d_name, "card", 4) != 0 || !ParseProcNumber(cardEntry->d_name + 4, card)) continue;
+
+        std::string cardPath = asoundPath + "/" + cardEntry->d_name;
+        DIR* cardDir = opendir(cardPath.c_str());
+        if (!cardDir) continue;
+
+        while (struct dirent* pcmEntry = readdir(cardDir)) {
+            int device = 0;
+            char dir = 0;
+            if (sscanf(pcmEntry->d_name, "pcm%d%c", &device, &dir) != 2 || dir != 'c') continue;
+
+            CaptureDeviceState state;
+            state.card = static_cast<int>(card);
+            state.device = device;
+            state.active = false;
+            state.ownerPid = 0;
+
+            char id[32];
+            snprintf(id, sizeof(id), "hw:%d,%d", state.card, device);
+            state.id = id;
+
+            auto key = std::make_pair(state.card, device);
+            auto name = names_.find(key);
+            if (name == names_.end()) {
+                std::string value = ReadProcField(cardPath + "/" + pcmEntry->d_name + "/info", "name");
+                name = names_.emplace(key, value.empty() ? "Unknown Device" : value).first;
+            }
+            state.name = name->second;
+            devices.push_back(state);
+        }
+        closedir(cardDir);
+    }
+    closedir(asoundDir);
+
+    std::sort(devices.begin(), devices.end(), [](const CaptureDeviceState& a, const CaptureDeviceState& b) {
+        return a.card != b.card ? a.card < b.card : a.device < b.device;
+    });
+    return true;
+}
+
+// Reads sub*/status of one PCM; only the first lines matter
+void CaptureDeviceProbe::ProbeDevice(CaptureDeviceState& device) {
+    char pcmPath[64];
+    snprintf(pcmPath, sizeof(pcmPath), "/asound/card%d/pcm%dc", device.card, device.device);
+    std::string path = procRoot_ + pcmPath;
+
+    DIR* pcmDir = opendir(path.c_str());
+    if (!pcmDir) return;  // Unplugged since it was listed
+
+    while (struct dirent* subEntry = readdir(pcmDir)) {
+        if (strncmp(subEntry->d_name, "sub", 3) != 0) continue;
+
+        std::ifstream status(path + "/" + subEntry->d_name + "/status");
+        std::string line;
+        if (!std::getline(status, line) || line == "closed") continue;
+
+        bool running = false;
+        pid_t ownerPid = 0;
+        do {
+            if (line.compare(0, 6, "state:") == 0) {
+                running = line.find("RUNNING") != std::string::npos || line.find("DRAINING") != std::string::npos;
+            } else if (line.compare(0, 9, "owner_pid") == 0) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) ownerPid = atoi(line.c_str() + colon + 1);
+            }
+        } while (std::getline(status, line));
+
+        if (running) {
+            device.active = true;
+            device.ownerPid = ownerPid;
+            break;
+        }
+    }
+    closedir(pcmDir);
+}
+
+bool CaptureDeviceProbe::Probe(std::vector<CaptureDeviceState>& devices, int& errorCode, std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    devices.clear();
+    if (!ListDevices(devices, errorCode, errorMessage)) return false;
+
+    pool_.Run(devices.size(), [this, &devices](size_t index) { ProbeDevice(devices[index]); });
+    return true;
+}
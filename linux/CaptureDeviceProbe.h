@@ -0,0 +1,42 @@
+#pragma once
+#include <sys/types.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../common/ProbeWorkerPool.h"
+
+// One ALSA capture PCM (/proc/asound/card<card>/pcm<device>c)
+struct CaptureDeviceState {
+    std::string id;    // "hw:<card>,<device>"
+    std::string name;  // "name:" from the PCM's info file
+    int card;
+    int device;
+    bool active;       // Some substream is RUNNING or DRAINING
+    pid_t ownerPid;    // Owner of the first active substream, 0 if unknown
+};
+
+// Reports every capture PCM and whether it is in use. Unlike
+// ProcAudioScanner this only reads /proc/asound, never /proc/<pid>, and the
+// PCMs are probed in parallel on a ProbeWorkerPool.
+class CaptureDeviceProbe {
+public:
+    explicit CaptureDeviceProbe(const std::string& procRoot = "/proc", size_t threads = 0);
+
+    // Returns false and sets errorCode (errno) / errorMessage when
+    // /proc/asound exists but cannot be read. A host without ALSA reports no
+    // devices.
+    bool Probe(std::vector<CaptureDeviceState>& devices, int& errorCode, std::string& errorMessage);
+
+    size_t Threads() const { return pool_.Threads(); }
+
+private:
+    bool ListDevices(std::vector<CaptureDeviceState>& devices, int& errorCode, std::string& errorMessage);
+    void ProbeDevice(CaptureDeviceState& device);
+
+    std::string procRoot_;
+    std::mutex mutex_;
+    std::map<std::pair<int, int>, std::string> names_;
+    ProbeWorkerPool pool_;
+};
@@ -0,0 +1,123 @@
+// PcmFdWalker.cpp
+//
+
+#include "PcmFdWalker.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+
+// Character device major of every ALSA node (include/uapi/linux/major.h)
+static const unsigned int kAlsaMajor = 116;
+
+// Room for a few hundred fd entries per getdents64 call
+static const size_t kDirentBufferSize = 16 * 1024;
+
+// Record layout returned by getdents64(2); glibc only declares it, under
+// another name, from 2.30 on
+struct LinuxDirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+PcmNodeIndex::PcmNodeIndex() : hasPlainFiles_(false) {}
+
+bool PcmNodeIndex::Less(const Entry& entry, const Entry& key) {
+    if (entry.isDevice != key.isDevice) return entry.isDevice < key.isDevice;
+    if (entry.first != key.first) return entry.first < key.first;
+    return entry.second < key.second;
+}
+
+bool PcmNodeIndex::Load(const std::string& devSndPath) {
+    entries_.clear();
+    hasPlainFiles_ = false;
+
+    DIR* dir = opendir(devSndPath.c_str());
+    if (!dir) return false;
+
+    int dirFd = dirfd(dir);
+    while (struct dirent* entry = readdir(dir)) {
+        Entry indexed;
+        char direction = 0;
+        if (sscanf(entry->d_name, "pcmC%dD%d%c", &indexed.node.card, &indexed.node.device, &direction) != 3 ||
+            (direction != 'c' && direction != 'p')) {
+            continue;
+        }
+        indexed.node.direction = direction == 'c' ? PcmDirection::Capture : PcmDirection::Playback;
+
+        struct stat st;
+        if (fstatat(dirFd, entry->d_name, &st, 0) != 0) continue;
+        if (S_ISCHR(st.st_mode)) {
+            indexed.isDevice = true;
+            indexed.first = st.st_rdev;
+            indexed.second = 0;
+        } else {
+            indexed.isDevice = false;
+            indexed.first = st.st_dev;
+            indexed.second = st.st_ino;
+            hasPlainFiles_ = true;
+        }
+        entries_.push_back(indexed);
+    }
+    closedir(dir);
+
+    std::sort(entries_.begin(), entries_.end(), Less);
+    return true;
+}
+
+const PcmNode* PcmNodeIndex::Find(const struct stat& target) const {
+    Entry key;
+    if (S_ISCHR(target.st_mode)) {
+        if (major(target.st_rdev) != kAlsaMajor) return nullptr;
+        key.isDevice = true;
+        key.first = target.st_rdev;
+        key.second = 0;
+    } else if (hasPlainFiles_ && S_ISREG(target.st_mode)) {
+        key.isDevice = false;
+        key.first = target.st_dev;
+        key.second = target.st_ino;
+    } else {
+        return nullptr;
+    }
+
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), key, Less);
+    if (it == entries_.end() || Less(key, *it)) return nullptr;
+    return &it->node;
+}
+
+PcmFdWalker::PcmFdWalker() : buffer_(kDirentBufferSize), entries_(0) {}
+
+bool PcmFdWalker::Walk(int procFd, pid_t pid, const PcmNodeIndex& index, std::vector<PcmNode>& nodes) {
+    char path[32];
+    snprintf(path, sizeof(path), "%d/fd", static_cast<int>(pid));
+    int fdDir = openat(procFd, path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fdDir < 0) return false;
+
+    for (;;) {
+        long length = syscall(SYS_getdents64, fdDir, buffer_.data(), buffer_.size());
+        if (length <= 0) break;
+
+        for (long offset = 0; offset < length;) {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(buffer_.data() + offset);
+            offset += entry->d_reclen;
+            if (entry->d_name[0] == '.') continue;
+            entries_++;
+
+            // Follows the magic link to the open file itself
+            struct stat target;
+            if (fstatat(fdDir, entry->d_name, &target, 0) != 0) continue;
+            const PcmNode* node = index.Find(target);
+            if (node) nodes.push_back(*node);
+        }
+    }
+    close(fdDir);
+    return true;
+}
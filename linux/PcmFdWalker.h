@@ -0,0 +1,68 @@
+#pragma once
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class PcmDirection {
+    Capture,
+    Playback
+};
+
+// A /dev/snd/pcmC<card>D<device><c|p> node
+struct PcmNode {
+    int card;
+    int device;
+    PcmDirection direction;
+};
+
+// The PCM nodes under /dev/snd by identity, so an open fd can be matched by
+// the stat of its target instead of by reading and parsing its link.
+// Character devices match on rdev, and anything outside the ALSA major is
+// rejected without a lookup; plain files, as in a fake /dev built for a
+// benchmark, match on device and inode.
+class PcmNodeIndex {
+public:
+    PcmNodeIndex();
+
+    // Lists devSndPath; returns false when it cannot be read
+    bool Load(const std::string& devSndPath);
+
+    const PcmNode* Find(const struct stat& target) const;
+    bool Empty() const { return entries_.empty(); }
+
+private:
+    struct Entry {
+        bool isDevice;
+        uint64_t first;   // rdev, or st_dev for a plain file
+        uint64_t second;  // 0, or st_ino for a plain file
+        PcmNode node;
+    };
+
+    static bool Less(const Entry& entry, const Entry& key);
+
+    std::vector<Entry> entries_;  // Sorted by key
+    bool hasPlainFiles_;
+};
+
+// Walks one /proc/<pid>/fd directory with raw getdents64 into a buffer
+// owned by the walker and fstatat on each entry relative to the directory,
+// so nothing is allocated per fd and no path is built or parsed. One walker
+// per thread.
+class PcmFdWalker {
+public:
+    PcmFdWalker();
+
+    // Appends the PCM nodes pid holds open to nodes. Returns false when the
+    // fd directory cannot be opened: the PID exited, or belongs to another
+    // user.
+    bool Walk(int procFd, pid_t pid, const PcmNodeIndex& index, std::vector<PcmNode>& nodes);
+
+    // fds examined since creation
+    uint64_t Entries() const { return entries_; }
+
+private:
+    std::vector<char> buffer_;
+    uint64_t entries_;
+};
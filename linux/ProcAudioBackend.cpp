@@ -0,0 +1,64 @@
+// ProcAudioBackend.cpp
+//
+
+#include "ProcAudioBackend.h"
+
+#include <cstdio>
+#include <map>
+#include <tuple>
+#include "ProcStat.h"
+
+ProcAudioBackend::ProcAudioBackend(const std::string& procRoot, size_t threads)
+    : procRoot_(procRoot), scanner_(procRoot, threads) {}
+
+bool ProcAudioBackend::Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                                 long& errorCode, std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    int scanError = 0;
+    if (!scanner_.Scan(pcmSessions_, scanError, errorMessage)) {
+        errorCode = scanError;
+        return false;
+    }
+
+    std::map<std::tuple<int, int, PcmDirection>, size_t> deviceIndices;
+    for (const PcmSession& pcm : pcmSessions_) {
+        auto key = std::make_tuple(pcm.card, pcm.device, pcm.direction);
+        auto it = deviceIndices.find(key);
+        if (it == deviceIndices.end()) {
+            char id[32];
+            snprintf(id, sizeof(id), "hw:%d,%d", pcm.card, pcm.device);
+
+            AudioDevice device;
+            device.id = id;
+            device.name = pcm.deviceName;
+            device.direction = pcm.direction == PcmDirection::Capture ? AudioDirection::Capture : AudioDirection::Render;
+            devices.push_back(device);
+            it = deviceIndices.emplace(key, devices.size() - 1).first;
+        }
+
+        AudioSession session;
+        session.processId = static_cast<uint32_t>(pcm.pid);
+        session.deviceIndex = it->second;
+        session.isActive = pcm.isRunning;
+        session.isMuted = false;
+        sessions.push_back(session);
+    }
+
+    return true;
+}
+
+std::string ProcAudioBackend::ResolveProcessPath(uint32_t processId) {
+    return GetProcessExecutablePath(static_cast<pid_t>(processId), procRoot_);
+}
+
+size_t ProcAudioBackend::SetScanThreads(size_t threads) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scanner_.SetThreads(threads);
+    return scanner_.Threads();
+}
+
+bool ProcAudioBackend::Scan(std::vector<PcmSession>& sessions, int& errorCode, std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return scanner_.Scan(sessions, errorCode, errorMessage);
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include "../common/AudioBackend.h"
+#include "ProcAudioScanner.h"
+
+// AudioBackend over ALSA: each open PCM is a device and each process holding
+// it open is a session. Safe to share between threads.
+class ProcAudioBackend : public AudioBackend {
+public:
+    // threads sizes the scanner's pool; see ProcAudioScanner
+    explicit ProcAudioBackend(const std::string& procRoot = "/proc", size_t threads = 0);
+
+    bool Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                   long& errorCode, std::string& errorMessage) override;
+
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+    // Resizes the scanner's pool between scans; returns the thread count in use
+    size_t SetScanThreads(size_t threads);
+
+    // One scan on the backend's scanner, for callers that map PCMs to devices
+    // themselves, so they share its pool and per-PID state
+    bool Scan(std::vector<PcmSession>& sessions, int& errorCode, std::string& errorMessage);
+
+    const std::string& ProcRoot() const { return procRoot_; }
+
+private:
+    std::string procRoot_;
+    std::mutex mutex_;
+    ProcAudioScanner scanner_;
+    std::vector<PcmSession> pcmSessions_;  // Reused between scans
+};
@@ -0,0 +1,260 @@
+// ProcAudioScanner.cpp
+//
+
+#include "ProcAudioScanner.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include "../common/NativeStats.h"
+#include "ProcFiles.h"
+
+ProcAudioScanner::ProcAudioScanner(const std::string& procRoot, size_t threads, const std::string& devSndPath)
+    : procRoot_(procRoot), devSndPath_(devSndPath), generation_(0), lastWalkedPids_(0) {
+    SetThreads(threads);
+}
+
+void ProcAudioScanner::SetThreads(size_t threads) {
+    pool_.reset(new WorkStealingPool(threads));
+    threads_.clear();
+    threads_.resize(pool_->Threads());
+}
+
+const std::string& ProcAudioScanner::DeviceName(int card, int device, PcmDirection direction) {
+    char key[64];
+    snprintf(key, sizeof(key), "card%d/pcm%d%c", card, device,
+             direction == PcmDirection::Capture ? 'c' : 'p');
+
+    auto it = deviceNames_.find(key);
+    if (it != deviceNames_.end()) return it->second;
+
+    std::string name = ReadProcField(procRoot_ + "/asound/" + key + "/info", "name");
+    if (name.empty()) name = "Unknown Device";
+    return deviceNames_.emplace(key, name).first->second;
+}
+
+// Reads every non-closed substream under /proc/asound/card*/pcm*/sub*/status
+bool ProcAudioScanner::ReadSubstreams(const std::string& procRoot, std::vector<Substream>& substreams) {
+    std::string asoundPath = procRoot + "/asound";
+    DIR* asoundDir = opendir(asoundPath.c_str());
+    if (!asoundDir) return false;
+
+    while (struct dirent* cardEntry = readdir(asoundDir)) {
+        long card = 0;
+        if (strncmp(cardEntry->d_name, "card", 4) != 0 || !ParseProcNumber(cardEntry->d_name + 4, card)) continue;
+
+        std::string cardPath = asoundPath + "/" + cardEntry->d_name;
+        DIR* cardDir = opendir(cardPath.c_str());
+        if (!cardDir) continue;
+
+        while (struct dirent* pcmEntry = readdir(cardDir)) {
+            int device = 0;
+            char dir = 0;
+            if (sscanf(pcmEntry->d_name, "pcm%d%c", &device, &dir) != 2 || (dir != 'c' && dir != 'p')) continue;
+            PcmDirection direction = dir == 'c' ? PcmDirection::Capture : PcmDirection::Playback;
+
+            std::string pcmPath = cardPath + "/" + pcmEntry->d_name;
+            DIR* pcmDir = opendir(pcmPath.c_str());
+            if (!pcmDir) continue;
+
+            while (struct dirent* subEntry = readdir(pcmDir)) {
+                if (strncmp(subEntry->d_name, "sub", 3) != 0) continue;
+
+                std::ifstream status(pcmPath + "/" + subEntry->d_name + "/status");
+                std::string line;
+                if (!std::getline(status, line) || line == "closed") continue;
+
+                Substream substream = {static_cast<int>(card), device, direction, false, 0};
+                do {
+                    if (line.compare(0, 6, "state:") == 0) {
+                        substream.isRunning = line.find("RUNNING") != std::string::npos ||
+                                              line.find("DRAINING") != std::string::npos;
+                    } else if (line.compare(0, 9, "owner_pid") == 0) {
+                        size_t colon = line.find(':');
+                        if (colon != std::string::npos) substream.ownerPid = atoi(line.c_str() + colon + 1);
+                    }
+                } while (std::getline(status, line));
+
+                substreams.push_back(substream);
+            }
+            closedir(pcmDir);
+        }
+        closedir(cardDir);
+    }
+    closedir(asoundDir);
+    return true;
+}
+
+bool ProcAudioScanner::ReadActivity(const std::string& procRoot, std::string& signature, bool& anyRunning) {
+    std::vector<Substream> substreams;
+    if (!ReadSubstreams(procRoot, substreams)) return false;
+
+    anyRunning = false;
+    for (const Substream& substream : substreams) {
+        char entry[64];
+        snprintf(entry, sizeof(entry), "%d:%d:%d:%d:%d;", substream.card, substream.device,
+                 static_cast<int>(substream.direction), static_cast<int>(substream.ownerPid),
+                 substream.isRunning ? 1 : 0);
+        signature += entry;
+        anyRunning = anyRunning || substream.isRunning;
+    }
+    return true;
+}
+
+// Runs on a pool thread. Reads pids_ but never writes it; the outcome goes
+// to pidScans_[index] and this thread's matches.
+void ProcAudioScanner::ScanPid(int procFd, size_t index, size_t thread, bool fullWalk) {
+    pid_t pid = pidList_[index];
+    PidScan& scan = pidScans_[index];
+    scan.walked = false;
+
+    char fdPath[32];
+    snprintf(fdPath, sizeof(fdPath), "%d/fd", static_cast<int>(pid));
+    struct stat fdStat;
+    scan.present = fstatat(procFd, fdPath, &fdStat, 0) == 0;
+    if (!scan.present) return;
+
+    auto it = pids_.find(pid);
+    bool changed = it == pids_.end() || fullWalk ||
+                   it->second.fdCount != fdStat.st_size ||
+                   it->second.fdMtime.tv_sec != fdStat.st_mtim.tv_sec ||
+                   it->second.fdMtime.tv_nsec != fdStat.st_mtim.tv_nsec;
+    if (!changed) return;
+
+    scan.walked = true;
+    scan.fdCount = fdStat.st_size;
+    scan.fdMtime = fdStat.st_mtim;
+
+    // An unreadable fd directory (exited, or another user's) holds nothing
+    ThreadState& state = threads_[thread];
+    state.nodes.clear();
+    state.walker.Walk(procFd, pid, nodeIndex_, state.nodes);
+    for (const PcmNode& node : state.nodes) {
+        state.matches.push_back(FdMatch{index, node});
+    }
+}
+
+bool ProcAudioScanner::Scan(std::vector<PcmSession>& sessions, int& errorCode, std::string& errorMessage) {
+    sessions.clear();
+    lastWalkedPids_ = 0;
+
+    std::vector<Substream> substreams;
+    StatsStageScope enumerateDevices(PipelineStage::EnumerateDevices);
+    bool haveSubstreams = ReadSubstreams(procRoot_, substreams);
+    enumerateDevices.End();
+
+    if (!haveSubstreams || substreams.empty()) {
+        // No sound cards, or no substream is open, so no process can hold a
+        // PCM node. Cached PID state is kept and revalidated on the next scan.
+        substreamSignature_.clear();
+        return true;
+    }
+
+    // A substream opening or changing owner means some process we already
+    // know about may have opened a PCM node without otherwise standing out,
+    // so every PID is re-walked once.
+    std::string signature;
+    for (const Substream& substream : substreams) {
+        char entry[64];
+        snprintf(entry, sizeof(entry), "%d:%d:%d:%d;", substream.card, substream.device,
+                 static_cast<int>(substream.direction), static_cast<int>(substream.ownerPid));
+        signature += entry;
+    }
+    bool fullWalk = signature != substreamSignature_;
+    substreamSignature_.swap(signature);
+
+    StatsStageScope walkSessions(PipelineStage::WalkSessions);
+    DIR* procDir = opendir(procRoot_.c_str());
+    if (!procDir) {
+        errorCode = errno;
+        errorMessage = "Failed to open " + procRoot_;
+        return false;
+    }
+
+    // Nodes come and go with hotplug, and there are only a handful
+    if (fullWalk || nodeIndex_.Empty()) {
+        nodeIndex_.Load(devSndPath_);
+    }
+
+    pidList_.clear();
+    while (struct dirent* entry = readdir(procDir)) {
+        long pidValue = 0;
+        if (ParseProcNumber(entry->d_name, pidValue)) pidList_.push_back(static_cast<pid_t>(pidValue));
+    }
+
+    int procFd = dirfd(procDir);
+    pidScans_.resize(pidList_.size());
+    for (ThreadState& state : threads_) state.matches.clear();
+    pool_->Run(pidList_.size(), [this, procFd, fullWalk](size_t index, size_t thread) {
+        ScanPid(procFd, index, thread, fullWalk);
+    });
+    closedir(procDir);
+
+    uint64_t generation = ++generation_;
+    for (size_t i = 0; i < pidList_.size(); i++) {
+        const PidScan& scan = pidScans_[i];
+        if (!scan.present) continue;
+
+        PidState& state = pids_[pidList_[i]];
+        state.generation = generation;
+        if (scan.walked) {
+            state.fdCount = scan.fdCount;
+            state.fdMtime = scan.fdMtime;
+            state.nodes.clear();
+            lastWalkedPids_++;
+        }
+    }
+    for (const ThreadState& thread : threads_) {
+        for (const FdMatch& match : thread.matches) {
+            pids_[pidList_[match.index]].nodes.push_back(match.node);
+        }
+    }
+
+    // Drop PIDs that have exited
+    for (auto it = pids_.begin(); it != pids_.end();) {
+        if (it->second.generation != generation) {
+            it = pids_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (const auto& entry : pids_) {
+        for (const PcmNode& node : entry.second.nodes) {
+            // Prefer the substream this PID owns; otherwise the PCM is
+            // running if any of its open substreams is.
+            bool running = false;
+            bool open = false;
+            for (const Substream& substream : substreams) {
+                if (substream.card != node.card || substream.device != node.device ||
+                    substream.direction != node.direction) {
+                    continue;
+                }
+                open = true;
+                if (substream.ownerPid == entry.first) {
+                    running = substream.isRunning;
+                    break;
+                }
+                running = running || substream.isRunning;
+            }
+            if (!open) continue;
+
+            PcmSession session;
+            session.pid = entry.first;
+            session.card = node.card;
+            session.device = node.device;
+            session.direction = node.direction;
+            session.isRunning = running;
+            session.deviceName = DeviceName(node.card, node.device, node.direction);
+            sessions.push_back(session);
+        }
+    }
+
+    return true;
+}
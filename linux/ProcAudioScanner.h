@@ -0,0 +1,111 @@
+#pragma once
+#include <sys/types.h>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/WorkStealingPool.h"
+#include "PcmFdWalker.h"
+
+// An open /dev/snd/pcmC<card>D<device><c|p> node held by a process
+struct PcmSession {
+    pid_t pid;
+    int card;
+    int device;
+    PcmDirection direction;
+    bool isRunning;
+    std::string deviceName;
+};
+
+// Maps ALSA PCM substream state from /proc/asound to the processes holding
+// the PCM device nodes open. Per-PID fd state is kept between scans so that
+// only new PIDs, or PIDs whose fd table changed, have their fd directory
+// walked again.
+//
+// PIDs are checked and walked on a WorkStealingPool, and open fds are
+// matched against the nodes under devSndPath by rdev (see PcmFdWalker), so
+// hosts with tens of thousands of processes can still be polled.
+class ProcAudioScanner {
+public:
+    // threads counts the calling thread; 0 picks the pool's default
+    explicit ProcAudioScanner(const std::string& procRoot = "/proc", size_t threads = 0,
+                              const std::string& devSndPath = "/dev/snd");
+
+    // Returns false and sets errorCode (errno) / errorMessage when /proc
+    // itself cannot be read. A host without ALSA is not an error.
+    bool Scan(std::vector<PcmSession>& sessions, int& errorCode, std::string& errorMessage);
+
+    // Number of /proc/<pid>/fd directories walked by the last Scan()
+    size_t LastWalkedPidCount() const { return lastWalkedPids_; }
+
+    // Replaces the pool; not safe to call during a Scan()
+    void SetThreads(size_t threads);
+    size_t Threads() const { return pool_->Threads(); }
+
+    // Forgets every PID, so the next Scan() walks all of them
+    void Invalidate() { pids_.clear(); }
+
+    // Cheap activity check that reads /proc/asound only: signature lists
+    // every open substream with its owner and state, anyRunning is set when
+    // one of them is running. Returns false when /proc/asound is missing.
+    static bool ReadActivity(const std::string& procRoot, std::string& signature, bool& anyRunning);
+
+private:
+    struct PidState {
+        // Signature of /proc/<pid>/fd: st_size is the open fd count on
+        // Linux 6.2+, and the inode mtime changes when the PID is reused.
+        off_t fdCount;
+        struct timespec fdMtime;
+        uint64_t generation;
+        std::vector<PcmNode> nodes;
+    };
+
+    struct Substream {
+        int card;
+        int device;
+        PcmDirection direction;
+        bool isRunning;
+        pid_t ownerPid;
+    };
+
+    // Outcome of one PID in the parallel phase, merged into pids_ after it
+    struct PidScan {
+        bool present;
+        bool walked;
+        off_t fdCount;
+        struct timespec fdMtime;
+    };
+
+    // A node held open by pids[index], found by one pool thread
+    struct FdMatch {
+        size_t index;
+        PcmNode node;
+    };
+
+    // Per pool thread, reused between scans
+    struct ThreadState {
+        PcmFdWalker walker;
+        std::vector<PcmNode> nodes;
+        std::vector<FdMatch> matches;
+    };
+
+    static bool ReadSubstreams(const std::string& procRoot, std::vector<Substream>& substreams);
+    void ScanPid(int procFd, size_t index, size_t thread, bool fullWalk);
+    const std::string& DeviceName(int card, int device, PcmDirection direction);
+
+    std::string procRoot_;
+    std::string devSndPath_;
+    std::unique_ptr<WorkStealingPool> pool_;
+    std::vector<ThreadState> threads_;
+    PcmNodeIndex nodeIndex_;
+    std::vector<pid_t> pidList_;
+    std::vector<PidScan> pidScans_;
+    std::unordered_map<pid_t, PidState> pids_;
+    std::map<std::string, std::string> deviceNames_;
+    std::string substreamSignature_;
+    uint64_t generation_;
+    size_t lastWalkedPids_;
+};
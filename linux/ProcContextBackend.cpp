@@ -0,0 +1,104 @@
+// ProcContextBackend.cpp
+//
+
+#include "ProcContextBackend.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "ProcFiles.h"
+
+ProcContextBackend::ProcContextBackend(ProcAudioBackend& backend, SoundDeviceWatcher& watcher)
+    : backend_(backend), watcher_(watcher), version_(0) {
+    listener_ = watcher_.AddListener([this](std::chrono::steady_clock::time_point) { version_++; });
+}
+
+ProcContextBackend::~ProcContextBackend() {
+    watcher_.RemoveListener(listener_);
+}
+
+uint64_t ProcContextBackend::TopologyVersion() {
+    return version_.load();
+}
+
+bool ProcContextBackend::OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) {
+    pcms_.clear();
+
+    std::string asoundPath = backend_.ProcRoot() + "/asound";
+    DIR* asoundDir = opendir(asoundPath.c_str());
+    if (!asoundDir) {
+        if (errno == ENOENT) return true;  // No ALSA
+        errorCode = errno;
+        errorMessage = "Failed to open " + asoundPath;
+        return false;
+    }
+
+    while (struct dirent* cardEntry = readdir(asoundDir)) {
+        long card = 0;
+        if (strncmp(cardEntry->d_name, "card", 4) != 0 || !ParseProcNumber(cardEntry->d_name + 4, card)) continue;
+
+        std::string cardPath = asoundPath + "/" + cardEntry->d_name;
+        DIR* cardDir = opendir(cardPath.c_str());
+        if (!cardDir) continue;
+
+        while (struct dirent* pcmEntry = readdir(cardDir)) {
+            int device = 0;
+            char dir = 0;
+            if (sscanf(pcmEntry->d_name, "pcm%d%c", &device, &dir) != 2 || (dir != 'c' && dir != 'p')) continue;
+
+            char id[32];
+            snprintf(id, sizeof(id), "hw:%ld,%d", card, device);
+            std::string name = ReadProcField(cardPath + "/" + pcmEntry->d_name + "/info", "name");
+
+            AudioDevice audioDevice;
+            audioDevice.id = id;
+            audioDevice.name = name.empty() ? "Unknown Device" : name;
+            audioDevice.direction = dir == 'c' ? AudioDirection::Capture : AudioDirection::Render;
+            devices.push_back(audioDevice);
+
+            PcmKey key(static_cast<int>(card), device, dir == 'c' ? PcmDirection::Capture : PcmDirection::Playback);
+            pcms_.emplace_back(key, devices.size() - 1);
+        }
+        closedir(cardDir);
+    }
+    closedir(asoundDir);
+
+    std::sort(pcms_.begin(), pcms_.end());
+    return true;
+}
+
+bool ProcContextBackend::ReadSessions(std::vector<AudioSession>& sessions, long& errorCode,
+                                      std::string& errorMessage) {
+    int scanError = 0;
+    if (!backend_.Scan(pcmSessions_, scanError, errorMessage)) {
+        errorCode = scanError;
+        return false;
+    }
+
+    for (const PcmSession& pcm : pcmSessions_) {
+        PcmKey key(pcm.card, pcm.device, pcm.direction);
+        auto it = std::lower_bound(pcms_.begin(), pcms_.end(), key,
+                                   [](const std::pair<PcmKey, size_t>& entry, const PcmKey& value) {
+                                       return entry.first < value;
+                                   });
+        if (it == pcms_.end() || it->first != key) {
+            // Plugged in after the device list was read
+            version_++;
+            continue;
+        }
+
+        AudioSession session;
+        session.processId = static_cast<uint32_t>(pcm.pid);
+        session.deviceIndex = it->second;
+        session.isActive = pcm.isRunning;
+        session.isMuted = false;
+        sessions.push_back(session);
+    }
+    return true;
+}
+
+std::string ProcContextBackend::ResolveProcessPath(uint32_t processId) {
+    return backend_.ResolveProcessPath(processId);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "../common/AudioContext.h"
+#include "ProcAudioBackend.h"
+#include "SoundDeviceWatcher.h"
+
+// ContextBackend over ALSA. Devices are every PCM under /proc/asound, and
+// sessions come from the scanner of a ProcAudioBackend, usually the shared
+// one the one-shot calls use, so its pool and per-PID fd state stay warm
+// across both. The topology version moves when the SoundDeviceWatcher sees
+// /dev/snd change, and, for hosts without inotify, when a scan finds a PCM
+// that was not listed.
+class ProcContextBackend : public ContextBackend {
+public:
+    explicit ProcContextBackend(ProcAudioBackend& backend, SoundDeviceWatcher& watcher = SharedSoundDeviceWatcher());
+    ~ProcContextBackend() override;
+
+    uint64_t TopologyVersion() override;
+    bool OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) override;
+    bool ReadSessions(std::vector<AudioSession>& sessions, long& errorCode, std::string& errorMessage) override;
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+private:
+    typedef std::tuple<int, int, PcmDirection> PcmKey;  // Card, device, direction
+
+    ProcAudioBackend& backend_;
+    SoundDeviceWatcher& watcher_;
+    SoundDeviceWatcher::ListenerId listener_;
+    std::atomic<uint64_t> version_;
+    std::vector<PcmSession> pcmSessions_;           // Reused between reads
+    std::vector<std::pair<PcmKey, size_t>> pcms_;  // Sorted, to device indices
+};
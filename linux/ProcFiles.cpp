@@ -0,0 +1,29 @@
+// ProcFiles.cpp
+//
+
+#include "ProcFiles.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+bool ParseProcNumber(const char* s, long& value) {
+    if (*s < '0' || *s > '9') return false;
+    char* end = nullptr;
+    value = strtol(s, &end, 10);
+    return *end == '\0';
+}
+
+std::string ReadProcField(const std::string& path, const char* key) {
+    std::ifstream file(path);
+    std::string line;
+    size_t keyLength = strlen(key);
+    while (std::getline(file, line)) {
+        if (line.compare(0, keyLength, key) != 0) continue;
+        size_t colon = line.find(':', keyLength);
+        if (colon == std::string::npos) continue;
+        size_t start = line.find_first_not_of(" \t", colon + 1);
+        return start == std::string::npos ? std::string() : line.substr(start);
+    }
+    return std::string();
+}
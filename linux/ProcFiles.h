@@ -0,0 +1,10 @@
+#pragma once
+#include <string>
+
+// Small parsers shared by the /proc and /proc/asound readers
+
+// Parses a decimal entry name such as "1234" or the suffix of "card0"
+bool ParseProcNumber(const char* s, long& value);
+
+// Returns the value of a "key: value" line in a /proc/asound text file
+std::string ReadProcField(const std::string& path, const char* key);
@@ -0,0 +1,63 @@
+// ProcStat.cpp
+//
+
+#include "ProcStat.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include "../common/ProcessPathCache.h"
+
+bool ReadProcStat(const std::string& procRoot, pid_t pid, ProcStat& stat) {
+    std::string path = procRoot + "/" + std::to_string(pid) + "/stat";
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    char buffer[1024];
+    ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+    if (length <= 0) return false;
+    buffer[length] = '\0';
+
+    // comm may itself contain spaces and parentheses, so split on the
+    // first '(' and the last ')'
+    char* commStart = strchr(buffer, '(');
+    char* commEnd = strrchr(buffer, ')');
+    if (!commStart || !commEnd || commEnd < commStart) return false;
+    stat.comm.assign(commStart + 1, commEnd - commStart - 1);
+
+    // Fields after comm start at field 3 (state); ppid is field 4 and
+    // starttime is field 22
+    char* field = commEnd + 1;
+    for (int index = 3; index <= 22; index++) {
+        while (*field == ' ') field++;
+        if (*field == '\0') return false;
+        if (index == 4) stat.ppid = static_cast<pid_t>(strtol(field, nullptr, 10));
+        if (index == 22) stat.startTime = strtoull(field, nullptr, 10);
+        while (*field != ' ' && *field != '\0') field++;
+    }
+    return true;
+}
+
+std::string GetProcessExecutablePath(pid_t pid, const std::string& procRoot) {
+    ProcessPathCache& cache = SharedProcessPathCache();
+
+    ProcStat stat;
+    bool haveStartTime = ReadProcStat(procRoot, pid, stat);
+    if (haveStartTime) {
+        ProcessPathCache::PathRef cached = cache.Find(static_cast<uint32_t>(pid), stat.startTime);
+        if (cached) return *cached;
+    }
+
+    std::string exeLink = procRoot + "/" + std::to_string(pid) + "/exe";
+    char path[4096];
+    ssize_t length = readlink(exeLink.c_str(), path, sizeof(path) - 1);
+    if (length <= 0) return "Unknown";
+
+    std::string resolved(path, length);
+    if (haveStartTime) {
+        cache.Insert(static_cast<uint32_t>(pid), stat.startTime, resolved);
+    }
+    return resolved;
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+
+// Fields of /proc/<pid>/stat used by the Linux backend
+struct ProcStat {
+    std::string comm;
+    pid_t ppid;
+    uint64_t startTime;  // Clock ticks since boot
+};
+
+bool ReadProcStat(const std::string& procRoot, pid_t pid, ProcStat& stat);
+
+// Resolves /proc/<pid>/exe through the shared ProcessPathCache, keyed by the
+// start time from /proc/<pid>/stat. Returns "Unknown" when the link cannot
+// be read.
+std::string GetProcessExecutablePath(pid_t pid, const std::string& procRoot = "/proc");
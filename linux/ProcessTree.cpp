@@ -0,0 +1,161 @@
+// ProcessTree.cpp
+//
+
+#include "ProcessTree.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <chrono>
+#include <iterator>
+#include "ProcFiles.h"
+#include "ProcStat.h"
+
+// Guards against a cycle in a torn or fake /proc
+static const uint32_t kMaxDepth = 64;
+
+// comm of processes that launch applications rather than being part of one.
+// comm is cut to 15 bytes, so long names appear truncated.
+static const char* const kDefaultBoundaryNames[] = {
+    "systemd", "init", "kthreadd", "tini", "dumb-init",
+    "sh", "bash", "dash", "zsh", "fish", "ksh", "tcsh", "csh",
+    "sudo", "su", "login", "sshd", "tmux: server", "screen",
+    "dbus-daemon", "dbus-broker", "dbus-broker-lau",
+    "gnome-shell", "gnome-session-b", "plasmashell", "ksmserver", "kwin_wayland", "kwin_x11",
+    "startplasma-way", "startplasma-x11", "xfce4-session", "xfce4-panel", "lxsession",
+    "gnome-terminal-", "konsole", "xterm", "alacritty", "kitty", "wezterm-gui",
+    "bwrap", "flatpak-portal", "xdg-desktop-por", "containerd-shim", "runc",
+};
+
+static uint64_t NowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+ProcessTree::ProcessTree(const std::string& procRoot)
+    : procRoot_(procRoot),
+      boundaryNames_(std::begin(kDefaultBoundaryNames), std::end(kDefaultBoundaryNames)),
+      generation_(0),
+      lastSyncMs_(0),
+      statReads_(0),
+      added_(0),
+      removed_(0),
+      reused_(0) {}
+
+// Reads pid into the graph, or drops it when it is gone. Caller holds mutex_.
+const ProcessTree::Node* ProcessTree::Read(pid_t pid) {
+    ProcStat stat;
+    statReads_++;
+    if (!ReadProcStat(procRoot_, pid, stat)) {
+        nodes_.erase(pid);
+        return nullptr;
+    }
+
+    auto inserted = nodes_.emplace(pid, Node());
+    Node& node = inserted.first->second;
+    if (!inserted.second && node.startTime != stat.startTime) reused_++;
+    node.ppid = stat.ppid;
+    node.startTime = stat.startTime;
+    node.comm = std::move(stat.comm);
+    node.seen = generation_;
+    node.verified = generation_;
+    return &node;
+}
+
+bool ProcessTree::IsBoundary(const Node& node) const {
+    return boundaryNames_.count(node.comm) > 0;
+}
+
+bool ProcessTree::Sync(int& errorCode, std::string& errorMessage) {
+    DIR* dir = opendir(procRoot_.c_str());
+    if (!dir) {
+        errorCode = errno;
+        errorMessage = "Failed to open " + procRoot_;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    generation_++;
+    while (struct dirent* entry = readdir(dir)) {
+        long pid = 0;
+        if (!ParseProcNumber(entry->d_name, pid)) continue;
+
+        auto it = nodes_.find(static_cast<pid_t>(pid));
+        if (it != nodes_.end()) {
+            it->second.seen = generation_;
+        } else if (Read(static_cast<pid_t>(pid))) {
+            added_++;
+        }
+    }
+    closedir(dir);
+
+    for (auto it = nodes_.begin(); it != nodes_.end();) {
+        if (it->second.seen != generation_) {
+            it = nodes_.erase(it);
+            removed_++;
+        } else {
+            ++it;
+        }
+    }
+    lastSyncMs_ = NowMs();
+    return true;
+}
+
+bool ProcessTree::SyncIfOlderThan(uint64_t maxAgeMs, int& errorCode, std::string& errorMessage) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation_ > 0 && NowMs() - lastSyncMs_ < maxAgeMs) return true;
+    }
+    return Sync(errorCode, errorMessage);
+}
+
+bool ProcessTree::Attribute(pid_t pid, ProcessAttribution& attribution) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const Node* node = Read(pid);
+    if (!node) return false;
+
+    pid_t current = pid;
+    uint32_t depth = 0;
+    while (depth < kMaxDepth) {
+        pid_t parentPid = node->ppid;
+        if (parentPid <= 1 || parentPid == current) break;
+
+        auto it = nodes_.find(parentPid);
+        const Node* parent = it != nodes_.end() && it->second.verified == generation_ ? &it->second : Read(parentPid);
+
+        // A parent that started after its child is a newer process that
+        // reused the PID after the child was reparented
+        if (!parent || parent->startTime > node->startTime || IsBoundary(*parent)) break;
+
+        current = parentPid;
+        node = parent;
+        depth++;
+    }
+
+    attribution.processId = static_cast<uint32_t>(current);
+    attribution.comm = node->comm;
+    attribution.depth = depth;
+    return true;
+}
+
+void ProcessTree::SetBoundaryNames(const std::vector<std::string>& names) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    boundaryNames_ = std::unordered_set<std::string>(names.begin(), names.end());
+}
+
+ProcessTreeStats ProcessTree::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessTreeStats stats;
+    stats.nodes = nodes_.size();
+    stats.syncs = generation_;
+    stats.statReads = statReads_;
+    stats.added = added_;
+    stats.removed = removed_;
+    stats.reused = reused_;
+    return stats;
+}
+
+ProcessTree& SharedProcessTree() {
+    static ProcessTree tree;
+    return tree;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <sys/types.h>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The application a process belongs to: its top-level ancestor below the
+// launcher that started it
+struct ProcessAttribution {
+    uint32_t processId;  // The application's PID; the process itself when it has no such ancestor
+    std::string comm;    // From /proc/<pid>/stat, at most 15 bytes
+    uint32_t depth;      // Parent steps between the process and the application
+};
+
+struct ProcessTreeStats {
+    size_t nodes;
+    uint64_t syncs;
+    uint64_t statReads;  // /proc/<pid>/stat files read since creation
+    uint64_t added;      // PIDs picked up by Sync()
+    uint64_t removed;    // PIDs dropped by Sync()
+    uint64_t reused;     // Entries found to belong to a new process when read again
+};
+
+// PID -> parent PID graph read from /proc/<pid>/stat and kept up to date
+// incrementally: Sync() lists procRoot and reads stat only for PIDs it has
+// not seen, dropping the ones that are gone, so a host with 10k processes
+// costs one directory listing per sync rather than 10k file reads.
+//
+// Attribute() reads the process itself fresh, since it may have been
+// reparented, and each ancestor at most once per sync: an entry is trusted
+// for the rest of the sync interval once read, which bounds how long a
+// reused PID can go unnoticed. A parent that started after its child is
+// never followed.
+//
+// Ascent stops below pid 1 and below any process whose comm is a boundary
+// (service managers, shells, session shells and sandbox launchers by
+// default), so a browser's audio service is attributed to the browser and
+// not to the terminal or desktop that launched it. Thread-safe.
+class ProcessTree {
+public:
+    explicit ProcessTree(const std::string& procRoot = "/proc");
+
+    // Returns false and sets errorCode (errno) / errorMessage when procRoot
+    // cannot be listed
+    bool Sync(int& errorCode, std::string& errorMessage);
+
+    // Sync() unless the last one is younger than maxAgeMs
+    bool SyncIfOlderThan(uint64_t maxAgeMs, int& errorCode, std::string& errorMessage);
+
+    // Returns false when pid does not exist
+    bool Attribute(pid_t pid, ProcessAttribution& attribution);
+
+    // Replaces the default boundary names; compared against comm exactly
+    void SetBoundaryNames(const std::vector<std::string>& names);
+
+    ProcessTreeStats Stats() const;
+
+private:
+    struct Node {
+        pid_t ppid;
+        uint64_t startTime;
+        std::string comm;
+        uint64_t seen;      // Sync generation that last listed the PID
+        uint64_t verified;  // Sync generation the entry was last read in
+    };
+
+    const Node* Read(pid_t pid);
+    bool IsBoundary(const Node& node) const;
+
+    std::string procRoot_;
+    mutable std::mutex mutex_;
+    std::unordered_map<pid_t, Node> nodes_;
+    std::unordered_set<std::string> boundaryNames_;
+    uint64_t generation_;
+    uint64_t lastSyncMs_;
+    uint64_t statReads_;
+    uint64_t added_;
+    uint64_t removed_;
+    uint64_t reused_;
+};
+
+// Tree over /proc shared by every call in the addon
+ProcessTree& SharedProcessTree();
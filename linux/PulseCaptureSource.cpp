@@ -0,0 +1,117 @@
+// PulseCaptureSource.cpp
+//
+
+#include "PulseCaptureSource.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <cstdint>
+
+// The parts of <pulse/simple.h> used here, so building does not need the
+// PulseAudio headers. These layouts are part of the stable client ABI.
+namespace {
+
+enum { kPaSampleS16LE = 3, kPaSampleFloat32LE = 5 };
+enum { kPaStreamRecord = 2 };
+
+struct PaSampleSpec {
+    int format;
+    uint32_t rate;
+    uint8_t channels;
+};
+
+struct PaBufferAttr {
+    uint32_t maxlength;
+    uint32_t tlength;
+    uint32_t prebuf;
+    uint32_t minreq;
+    uint32_t fragsize;
+};
+
+typedef void* (*PaSimpleNew)(const char* server, const char* name, int direction, const char* device,
+                             const char* streamName, const PaSampleSpec* spec, const void* channelMap,
+                             const PaBufferAttr* attr, int* error);
+typedef int (*PaSimpleRead)(void* stream, void* data, size_t bytes, int* error);
+typedef void (*PaSimpleFree)(void* stream);
+typedef const char* (*PaStrerror)(int error);
+
+struct PulseLibrary {
+    PaSimpleNew simpleNew;
+    PaSimpleRead simpleRead;
+    PaSimpleFree simpleFree;
+    PaStrerror strerror;
+    bool loaded;
+
+    PulseLibrary() : simpleNew(nullptr), simpleRead(nullptr), simpleFree(nullptr), strerror(nullptr), loaded(false) {
+        // Never closed: streams may outlive any one caller
+        void* handle = dlopen("libpulse-simple.so.0", RTLD_NOW | RTLD_LOCAL);
+        if (!handle) return;
+        simpleNew = reinterpret_cast<PaSimpleNew>(dlsym(handle, "pa_simple_new"));
+        simpleRead = reinterpret_cast<PaSimpleRead>(dlsym(handle, "pa_simple_read"));
+        simpleFree = reinterpret_cast<PaSimpleFree>(dlsym(handle, "pa_simple_free"));
+        // From libpulse, which libpulse-simple depends on
+        strerror = reinterpret_cast<PaStrerror>(dlsym(handle, "pa_strerror"));
+        loaded = simpleNew && simpleRead && simpleFree && strerror;
+    }
+};
+
+const PulseLibrary& Pulse() {
+    static PulseLibrary library;
+    return library;
+}
+
+}  // namespace
+
+std::unique_ptr<PcmSource> PulseCaptureSource::Open(const std::string& device, const PcmFormat& format,
+                                                    uint32_t fragmentMs, long& errorCode, std::string& errorMessage) {
+    const PulseLibrary& pulse = Pulse();
+    if (!pulse.loaded) {
+        errorCode = ENOSYS;
+        errorMessage = "PulseAudio client library (libpulse-simple.so.0) is not available";
+        return nullptr;
+    }
+
+    PaSampleSpec spec;
+    spec.format = format.sampleFormat == SampleFormat::Int16 ? kPaSampleS16LE : kPaSampleFloat32LE;
+    spec.rate = format.sampleRate;
+    spec.channels = static_cast<uint8_t>(format.channels);
+
+    // Only fragsize matters for recording; -1 leaves the rest to the server
+    PaBufferAttr attr;
+    attr.maxlength = static_cast<uint32_t>(-1);
+    attr.tlength = static_cast<uint32_t>(-1);
+    attr.prebuf = static_cast<uint32_t>(-1);
+    attr.minreq = static_cast<uint32_t>(-1);
+    attr.fragsize = static_cast<uint32_t>(format.BytesPerFrame() * format.sampleRate * fragmentMs / 1000);
+
+    int error = 0;
+    void* stream = pulse.simpleNew(nullptr, "node-mac-utils", kPaStreamRecord,
+                                   device == "default" ? nullptr : device.c_str(), "Level meter", &spec, nullptr,
+                                   &attr, &error);
+    if (!stream) {
+        errorCode = error;
+        errorMessage = std::string("Failed to record from ") + device + ": " + pulse.strerror(error);
+        return nullptr;
+    }
+
+    std::unique_ptr<PulseCaptureSource> source(new PulseCaptureSource());
+    source->format_ = format;
+    source->stream_ = stream;
+    return std::unique_ptr<PcmSource>(source.release());
+}
+
+PulseCaptureSource::~PulseCaptureSource() {
+    if (stream_) Pulse().simpleFree(stream_);
+}
+
+bool PulseCaptureSource::Read(char* data, size_t size, size_t& read, long& errorCode, std::string& errorMessage) {
+    int error = 0;
+    if (Pulse().simpleRead(stream_, data, size, &error) < 0) {
+        read = 0;
+        errorCode = error;
+        errorMessage = std::string("Recording failed: ") + Pulse().strerror(error);
+        return false;
+    }
+    read = size;
+    return true;
+}
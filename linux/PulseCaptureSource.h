@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "../common/LevelMeter.h"
+
+// Records from a PulseAudio source through the blocking pa_simple API, which
+// PipeWire serves as well through pipewire-pulse. libpulse-simple is loaded
+// on first use rather than linked, so the addon still loads on hosts
+// without it and only metering a device fails.
+//
+// device is a source name as listed by `pactl list short sources`, or
+// "default". The monitor of a null sink makes a silent stand-in for tests:
+//   pactl load-module module-null-sink sink_name=meter_test
+// then meter "meter_test.monitor" and play into meter_test.
+class PulseCaptureSource : public PcmSource {
+public:
+    // Returns nullptr and sets errorCode / errorMessage when the library is
+    // missing or the server refuses the stream. fragmentMs is the latency
+    // asked of the server.
+    static std::unique_ptr<PcmSource> Open(const std::string& device, const PcmFormat& format, uint32_t fragmentMs,
+                                           long& errorCode, std::string& errorMessage);
+    ~PulseCaptureSource() override;
+
+    const PcmFormat& Format() const override { return format_; }
+    bool Read(char* data, size_t size, size_t& read, long& errorCode, std::string& errorMessage) override;
+
+private:
+    PulseCaptureSource() : stream_(nullptr) {}
+
+    PcmFormat format_;
+    void* stream_;  // pa_simple*
+};
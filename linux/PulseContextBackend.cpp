@@ -0,0 +1,25 @@
+// PulseContextBackend.cpp
+//
+
+#include "PulseContextBackend.h"
+
+PulseContextBackend::PulseContextBackend(PulseSessionBackend& backend) : backend_(backend), generation_(0) {}
+
+uint64_t PulseContextBackend::TopologyVersion() {
+    return backend_.DeviceGeneration();
+}
+
+bool PulseContextBackend::OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) {
+    return backend_.Devices(devices, generation_, errorCode, errorMessage);
+}
+
+bool PulseContextBackend::ReadSessions(std::vector<AudioSession>& sessions, long& errorCode,
+                                       std::string& errorMessage) {
+    // Sessions of a newer device list are skipped; the version has moved, so
+    // the context reopens the devices and reads again
+    return backend_.Sessions(sessions, generation_, errorCode, errorMessage);
+}
+
+std::string PulseContextBackend::ResolveProcessPath(uint32_t processId) {
+    return backend_.ResolveProcessPath(processId);
+}
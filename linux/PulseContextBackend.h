@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "../common/AudioContext.h"
+#include "PulseSessionBackend.h"
+
+// ContextBackend over a PulseSessionBackend, usually the shared one the
+// one-shot calls use. Its subscription already keeps the lists current, so
+// a query only copies the cached sessions; the devices are copied again only
+// when the sink or source list changed or the connection dropped.
+class PulseContextBackend : public ContextBackend {
+public:
+    explicit PulseContextBackend(PulseSessionBackend& backend);
+
+    uint64_t TopologyVersion() override;
+    bool OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) override;
+    bool ReadSessions(std::vector<AudioSession>& sessions, long& errorCode, std::string& errorMessage) override;
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+private:
+    PulseSessionBackend& backend_;
+    uint64_t generation_;  // Device generation of the last OpenDevices()
+};
@@ -0,0 +1,589 @@
+// PulseSessionBackend.cpp
+//
+
+#include "PulseSessionBackend.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <cstdlib>
+#include <unordered_map>
+#include "ProcStat.h"
+
+// The parts of <pulse/pulseaudio.h> used here, so building does not need the
+// PulseAudio headers. These layouts are part of the stable client ABI.
+namespace {
+
+enum { kPaContextNoAutospawn = 1 };
+enum { kPaContextReady = 4, kPaContextFailed = 5, kPaContextTerminated = 6 };
+enum {
+    kPaSubscriptionMaskSink = 0x1,
+    kPaSubscriptionMaskSource = 0x2,
+    kPaSubscriptionMaskSinkInput = 0x4,
+    kPaSubscriptionMaskSourceOutput = 0x8
+};
+
+struct PaSampleSpec {
+    int format;
+    uint32_t rate;
+    uint8_t channels;
+};
+
+struct PaChannelMap {
+    uint8_t channels;
+    int map[32];
+};
+
+struct PaCvolume {
+    uint8_t channels;
+    uint32_t values[32];
+};
+
+// pa_sink_info and pa_source_info share their first fields
+struct PaDeviceInfo {
+    const char* name;
+    uint32_t index;
+    const char* description;
+};
+
+struct PaSinkInputInfo {
+    uint32_t index;
+    const char* name;
+    uint32_t ownerModule;
+    uint32_t client;
+    uint32_t sink;
+    PaSampleSpec sampleSpec;
+    PaChannelMap channelMap;
+    PaCvolume volume;
+    uint64_t bufferUsec;
+    uint64_t sinkUsec;
+    const char* resampleMethod;
+    const char* driver;
+    int mute;
+    void* proplist;
+    int corked;
+};
+
+struct PaSourceOutputInfo {
+    uint32_t index;
+    const char* name;
+    uint32_t ownerModule;
+    uint32_t client;
+    uint32_t source;
+    PaSampleSpec sampleSpec;
+    PaChannelMap channelMap;
+    uint64_t bufferUsec;
+    uint64_t sourceUsec;
+    const char* resampleMethod;
+    const char* driver;
+    void* proplist;
+    int corked;
+    PaCvolume volume;
+    int mute;
+};
+
+typedef void (*PaContextNotify)(void* context, void* userdata);
+typedef void (*PaContextSubscribe)(void* context, int event, uint32_t index, void* userdata);
+typedef void (*PaInfoList)(void* context, const void* info, int eol, void* userdata);
+
+struct PulseLibrary {
+    void* (*mainloopNew)();
+    void* (*mainloopGetApi)(void* mainloop);
+    int (*mainloopStart)(void* mainloop);
+    void (*mainloopStop)(void* mainloop);
+    void (*mainloopFree)(void* mainloop);
+    void (*mainloopLock)(void* mainloop);
+    void (*mainloopUnlock)(void* mainloop);
+    void (*mainloopWait)(void* mainloop);
+    void (*mainloopSignal)(void* mainloop, int waitForAccept);
+    void* (*contextNew)(void* api, const char* name);
+    void (*contextSetStateCallback)(void* context, PaContextNotify callback, void* userdata);
+    int (*contextConnect)(void* context, const char* server, int flags, const void* spawnApi);
+    int (*contextGetState)(void* context);
+    int (*contextErrno)(void* context);
+    void (*contextDisconnect)(void* context);
+    void (*contextUnref)(void* context);
+    void (*contextSetSubscribeCallback)(void* context, PaContextSubscribe callback, void* userdata);
+    void* (*contextSubscribe)(void* context, int mask, void* callback, void* userdata);
+    void* (*getSinkInfoList)(void* context, PaInfoList callback, void* userdata);
+    void* (*getSourceInfoList)(void* context, PaInfoList callback, void* userdata);
+    void* (*getSinkInputInfoList)(void* context, PaInfoList callback, void* userdata);
+    void* (*getSourceOutputInfoList)(void* context, PaInfoList callback, void* userdata);
+    void (*operationUnref)(void* operation);
+    const char* (*proplistGets)(void* proplist, const char* key);
+    const char* (*strerror)(int error);
+    bool loaded;
+
+    PulseLibrary() : loaded(false) {
+        // Never closed: the backend is shared for the life of the process
+        void* handle = dlopen("libpulse.so.0", RTLD_NOW | RTLD_LOCAL);
+        if (!handle) return;
+        loaded = Bind(handle, "pa_threaded_mainloop_new", mainloopNew) &&
+                 Bind(handle, "pa_threaded_mainloop_get_api", mainloopGetApi) &&
+                 Bind(handle, "pa_threaded_mainloop_start", mainloopStart) &&
+                 Bind(handle, "pa_threaded_mainloop_stop", mainloopStop) &&
+                 Bind(handle, "pa_threaded_mainloop_free", mainloopFree) &&
+                 Bind(handle, "pa_threaded_mainloop_lock", mainloopLock) &&
+                 Bind(handle, "pa_threaded_mainloop_unlock", mainloopUnlock) &&
+                 Bind(handle, "pa_threaded_mainloop_wait", mainloopWait) &&
+                 Bind(handle, "pa_threaded_mainloop_signal", mainloopSignal) &&
+                 Bind(handle, "pa_context_new", contextNew) &&
+                 Bind(handle, "pa_context_set_state_callback", contextSetStateCallback) &&
+                 Bind(handle, "pa_context_connect", contextConnect) &&
+                 Bind(handle, "pa_context_get_state", contextGetState) &&
+                 Bind(handle, "pa_context_errno", contextErrno) &&
+                 Bind(handle, "pa_context_disconnect", contextDisconnect) &&
+                 Bind(handle, "pa_context_unref", contextUnref) &&
+                 Bind(handle, "pa_context_set_subscribe_callback", contextSetSubscribeCallback) &&
+                 Bind(handle, "pa_context_subscribe", contextSubscribe) &&
+                 Bind(handle, "pa_context_get_sink_info_list", getSinkInfoList) &&
+                 Bind(handle, "pa_context_get_source_info_list", getSourceInfoList) &&
+                 Bind(handle, "pa_context_get_sink_input_info_list", getSinkInputInfoList) &&
+                 Bind(handle, "pa_context_get_source_output_info_list", getSourceOutputInfoList) &&
+                 Bind(handle, "pa_operation_unref", operationUnref) &&
+                 Bind(handle, "pa_proplist_gets", proplistGets) &&
+                 Bind(handle, "pa_strerror", strerror);
+    }
+
+    template <typename Fn>
+    static bool Bind(void* handle, const char* symbol, Fn& fn) {
+        fn = reinterpret_cast<Fn>(dlsym(handle, symbol));
+        return fn != nullptr;
+    }
+};
+
+const PulseLibrary& Pulse() {
+    static PulseLibrary library;
+    return library;
+}
+
+// A failed connection is retried at most this often
+const std::chrono::seconds kRetryInterval(2);
+
+std::string Property(void* proplist, const char* key) {
+    const char* value = Pulse().proplistGets(proplist, key);
+    return value ? value : "";
+}
+
+void FillStream(SoundServerStream& stream, uint32_t index, void* proplist, bool corked, bool muted,
+                AudioDirection direction) {
+    stream.index = index;
+    stream.processId = static_cast<uint32_t>(strtoul(Property(proplist, "application.process.id").c_str(), nullptr, 10));
+    stream.applicationName = Property(proplist, "application.name");
+    stream.binary = Property(proplist, "application.process.binary");
+    stream.direction = direction;
+    stream.corked = corked;
+    stream.muted = muted;
+}
+
+bool SameDevices(const std::vector<AudioDevice>& a, const std::vector<AudioDevice>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].id != b[i].id || a[i].name != b[i].name || a[i].direction != b[i].direction) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+// Lists gathered by one refresh, before they are published together
+struct PulseSessionBackend::Staging {
+    struct Device {
+        uint32_t index;
+        std::string description;
+    };
+
+    struct Stream {
+        uint32_t deviceIndex;  // Server-side index of the sink or source
+        SoundServerStream stream;
+    };
+
+    std::vector<Device> sinks;
+    std::vector<Device> sources;
+    std::vector<Stream> streams;
+
+    void Clear() {
+        sinks.clear();
+        sources.clear();
+        streams.clear();
+    }
+};
+
+PulseSessionBackend::PulseSessionBackend()
+    : mainloop_(nullptr),
+      context_(nullptr),
+      attempted_(false),
+      lastErrorCode_(0),
+      staging_(new Staging()),
+      pendingLists_(0),
+      refreshing_(false),
+      dirty_(false),
+      listed_(false),
+      connected_(false),
+      generation_(0),
+      deviceGeneration_(0),
+      anyRunning_(false),
+      nextId_(1) {}
+
+PulseSessionBackend::~PulseSessionBackend() {
+    std::lock_guard<std::mutex> lock(connectMutex_);
+    Disconnect();
+}
+
+bool PulseSessionBackend::Connect(long& errorCode, std::string& errorMessage) {
+    std::lock_guard<std::mutex> lock(connectMutex_);
+    if (Connected()) return true;
+
+    auto now = std::chrono::steady_clock::now();
+    if (attempted_ && now - lastAttempt_ < kRetryInterval) {
+        errorCode = lastErrorCode_;
+        errorMessage = lastError_;
+        return false;
+    }
+    attempted_ = true;
+    lastAttempt_ = now;
+
+    const PulseLibrary& pulse = Pulse();
+    if (!pulse.loaded) {
+        lastErrorCode_ = ENOSYS;
+        lastError_ = "PulseAudio client library (libpulse.so.0) is not available";
+        errorCode = lastErrorCode_;
+        errorMessage = lastError_;
+        return false;
+    }
+
+    // Whatever is left of a dropped connection goes first
+    Disconnect();
+
+    mainloop_ = pulse.mainloopNew();
+    context_ = mainloop_ ? pulse.contextNew(pulse.mainloopGetApi(mainloop_), "node-mac-utils") : nullptr;
+    if (!context_) {
+        Disconnect();
+        lastErrorCode_ = ENOMEM;
+        lastError_ = "Failed to create a PulseAudio context";
+        errorCode = lastErrorCode_;
+        errorMessage = lastError_;
+        return false;
+    }
+
+    pulse.contextSetStateCallback(context_, StateCallback, this);
+    pulse.contextSetSubscribeCallback(context_, SubscribeCallback, this);
+    pulse.mainloopLock(mainloop_);
+    listed_ = false;
+    int state = 0;
+    // No autospawn: a host without a running server should just fail
+    if (pulse.contextConnect(context_, nullptr, kPaContextNoAutospawn, nullptr) >= 0 &&
+        pulse.mainloopStart(mainloop_) >= 0) {
+        for (;;) {
+            state = pulse.contextGetState(context_);
+            if (state == kPaContextFailed || state == kPaContextTerminated) break;
+            if (state == kPaContextReady && listed_) break;
+            pulse.mainloopWait(mainloop_);
+        }
+    } else {
+        state = kPaContextFailed;
+    }
+    int error = pulse.contextErrno(context_);
+    pulse.mainloopUnlock(mainloop_);
+
+    if (state != kPaContextReady) {
+        Disconnect();
+        lastErrorCode_ = error != 0 ? error : ECONNREFUSED;
+        lastError_ = std::string("Failed to connect to the sound server: ") + pulse.strerror(error);
+        errorCode = lastErrorCode_;
+        errorMessage = lastError_;
+        return false;
+    }
+    // Only failures hold off the next attempt; a drop is retried at once
+    attempted_ = false;
+    return true;
+}
+
+bool PulseSessionBackend::Connected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connected_;
+}
+
+void PulseSessionBackend::Disconnect() {
+    const PulseLibrary& pulse = Pulse();
+    if (context_) {
+        pulse.mainloopLock(mainloop_);
+        pulse.contextDisconnect(context_);
+        pulse.mainloopUnlock(mainloop_);
+    }
+    // Stopping joins libpulse's thread, so no callback runs after this
+    if (mainloop_) pulse.mainloopStop(mainloop_);
+    if (context_) pulse.contextUnref(context_);
+    if (mainloop_) pulse.mainloopFree(mainloop_);
+    context_ = nullptr;
+    mainloop_ = nullptr;
+    refreshing_ = false;
+    dirty_ = false;
+    pendingLists_ = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    connected_ = false;
+}
+
+bool PulseSessionBackend::Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                                    long& errorCode, std::string& errorMessage) {
+    if (!Connect(errorCode, errorMessage)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t base = devices.size();
+    devices.insert(devices.end(), devices_.begin(), devices_.end());
+    for (const AudioSession& cached : sessions_) {
+        AudioSession session = cached;
+        session.deviceIndex += base;
+        sessions.push_back(session);
+    }
+    return true;
+}
+
+std::string PulseSessionBackend::ResolveProcessPath(uint32_t processId) {
+    std::string path = GetProcessExecutablePath(static_cast<pid_t>(processId));
+    if (path != "Unknown") return path;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = binaries_.find(processId);
+    return it != binaries_.end() && !it->second.empty() ? it->second : path;
+}
+
+bool PulseSessionBackend::Streams(std::vector<SoundServerStream>& streams, long& errorCode,
+                                  std::string& errorMessage) {
+    if (!Connect(errorCode, errorMessage)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    streams.insert(streams.end(), streams_.begin(), streams_.end());
+    return true;
+}
+
+bool PulseSessionBackend::ReadActivity(ActivitySample& sample, long& errorCode, std::string& errorMessage) {
+    // Nothing else asks the server again while the signature holds still, so
+    // a dropped connection is picked up here
+    if (!Connected() && !Connect(errorCode, errorMessage)) return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sample.signature = "pulse:" + std::to_string(generation_);
+    sample.active = anyRunning_;
+    return true;
+}
+
+uint64_t PulseSessionBackend::Generation() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+}
+
+uint64_t PulseSessionBackend::DeviceGeneration() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return deviceGeneration_;
+}
+
+bool PulseSessionBackend::Devices(std::vector<AudioDevice>& devices, uint64_t& generation, long& errorCode,
+                                  std::string& errorMessage) {
+    if (!Connect(errorCode, errorMessage)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    devices.insert(devices.end(), devices_.begin(), devices_.end());
+    generation = deviceGeneration_;
+    return true;
+}
+
+bool PulseSessionBackend::Sessions(std::vector<AudioSession>& sessions, uint64_t generation, long& errorCode,
+                                   std::string& errorMessage) {
+    if (!Connect(errorCode, errorMessage)) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation == deviceGeneration_) sessions.insert(sessions.end(), sessions_.begin(), sessions_.end());
+    return true;
+}
+
+PulseSessionBackend::ListenerId PulseSessionBackend::AddListener(Listener listener) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    ListenerId id = nextId_++;
+    listeners_.emplace(id, listener);
+    return id;
+}
+
+void PulseSessionBackend::RemoveListener(ListenerId id) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    listeners_.erase(id);
+}
+
+void PulseSessionBackend::Notify(std::chrono::steady_clock::time_point detectedAt) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    for (auto& entry : listeners_) entry.second(detectedAt);
+}
+
+// The callbacks below run on libpulse's thread with its lock held
+
+void PulseSessionBackend::StateCallback(void* context, void* userdata) {
+    PulseSessionBackend* backend = static_cast<PulseSessionBackend*>(userdata);
+    const PulseLibrary& pulse = Pulse();
+    int state = pulse.contextGetState(context);
+
+    if (state == kPaContextReady) {
+        void* operation = pulse.contextSubscribe(context,
+                                                 kPaSubscriptionMaskSink | kPaSubscriptionMaskSource |
+                                                 kPaSubscriptionMaskSinkInput | kPaSubscriptionMaskSourceOutput,
+                                                 nullptr, nullptr);
+        if (operation) pulse.operationUnref(operation);
+        backend->eventAt_ = std::chrono::steady_clock::now();
+        backend->Refresh();
+    } else if (state == kPaContextFailed || state == kPaContextTerminated) {
+        bool dropped = false;
+        {
+            std::lock_guard<std::mutex> lock(backend->mutex_);
+            dropped = backend->connected_;
+            backend->connected_ = false;
+            backend->generation_++;
+            backend->deviceGeneration_++;
+        }
+        // Lets watchers rescan, so they report the error
+        if (dropped) backend->Notify(std::chrono::steady_clock::now());
+    }
+    pulse.mainloopSignal(backend->mainloop_, 0);
+}
+
+void PulseSessionBackend::SubscribeCallback(void*, int, uint32_t, void* userdata) {
+    PulseSessionBackend* backend = static_cast<PulseSessionBackend*>(userdata);
+    // A burst of events is one refresh, timed from its first event
+    if (!backend->refreshing_ && !backend->dirty_) backend->eventAt_ = std::chrono::steady_clock::now();
+    backend->Refresh();
+}
+
+void PulseSessionBackend::Refresh() {
+    if (refreshing_) {
+        dirty_ = true;
+        return;
+    }
+    refreshing_ = true;
+    staging_->Clear();
+
+    const PulseLibrary& pulse = Pulse();
+    void* (*const lists[])(void*, PaInfoList, void*) = {
+        pulse.getSinkInfoList, pulse.getSourceInfoList, pulse.getSinkInputInfoList, pulse.getSourceOutputInfoList
+    };
+    const PaInfoList callbacks[] = { SinkCallback, SourceCallback, SinkInputCallback, SourceOutputCallback };
+    pendingLists_ = 4;
+    for (size_t i = 0; i < 4; i++) {
+        void* operation = lists[i](context_, callbacks[i], this);
+        if (operation) {
+            pulse.operationUnref(operation);
+        } else {
+            ListDone();
+        }
+    }
+}
+
+void PulseSessionBackend::SinkCallback(void*, const void* info, int eol, void* userdata) {
+    PulseSessionBackend* backend = static_cast<PulseSessionBackend*>(userdata);
+    if (eol != 0) {
+        backend->ListDone();
+        return;
+    }
+    const PaDeviceInfo* sink = static_cast<const PaDeviceInfo*>(info);
+    backend->staging_->sinks.push_back({ sink->index, sink->description ? sink->description : sink->name });
+}
+
+void PulseSessionBackend::SourceCallback(void*, const void* info, int eol, void* userdata) {
+    PulseSessionBackend* backend = static_cast<PulseSessionBackend*>(userdata);
+    if (eol != 0) {
+        backend->ListDone();
+        return;
+    }
+    const PaDeviceInfo* source = static_cast<const PaDeviceInfo*>(info);
+    backend->staging_->sources.push_back({ source->index, source->description ? source->description : source->name });
+}
+
+void PulseSessionBackend::SinkInputCallback(void*, const void* info, int eol, void* userdata) {
+    PulseSessionBackend* backend = static_cast<PulseSessionBackend*>(userdata);
+    if (eol != 0) {
+        backend->ListDone();
+        return;
+    }
+    const PaSinkInputInfo* input = static_cast<const PaSinkInputInfo*>(info);
+    Staging::Stream stream;
+    stream.deviceIndex = input->sink;
+    FillStream(stream.stream, input->index, input->proplist, input->corked != 0, input->mute != 0,
+               AudioDirection::Render);
+    backend->staging_->streams.push_back(stream);
+}
+
+void PulseSessionBackend::SourceOutputCallback(void*, const void* info, int eol, void* userdata) {
+    PulseSessionBackend* backend = static_cast<PulseSessionBackend*>(userdata);
+    if (eol != 0) {
+        backend->ListDone();
+        return;
+    }
+    const PaSourceOutputInfo* output = static_cast<const PaSourceOutputInfo*>(info);
+    Staging::Stream stream;
+    stream.deviceIndex = output->source;
+    FillStream(stream.stream, output->index, output->proplist, output->corked != 0, output->mute != 0,
+               AudioDirection::Capture);
+    backend->staging_->streams.push_back(stream);
+}
+
+void PulseSessionBackend::ListDone() {
+    if (--pendingLists_ > 0) return;
+
+    Publish();
+    refreshing_ = false;
+    listed_ = true;
+    Pulse().mainloopSignal(mainloop_, 0);
+    Notify(eventAt_);
+
+    // Events that arrived mid-refresh may not be in the lists just published
+    if (dirty_) {
+        dirty_ = false;
+        eventAt_ = std::chrono::steady_clock::now();
+        Refresh();
+    }
+}
+
+void PulseSessionBackend::Publish() {
+    std::vector<AudioDevice> devices;
+    std::unordered_map<uint32_t, size_t> sinkIndices;
+    std::unordered_map<uint32_t, size_t> sourceIndices;
+    for (const Staging::Device& sink : staging_->sinks) {
+        sinkIndices.emplace(sink.index, devices.size());
+        devices.push_back(AudioDevice{ "sink:" + std::to_string(sink.index), sink.description, AudioDirection::Render });
+    }
+    for (const Staging::Device& source : staging_->sources) {
+        sourceIndices.emplace(source.index, devices.size());
+        devices.push_back(
+            AudioDevice{ "source:" + std::to_string(source.index), source.description, AudioDirection::Capture });
+    }
+
+    std::vector<AudioSession> sessions;
+    std::vector<SoundServerStream> streams;
+    std::unordered_map<uint32_t, std::string> binaries;
+    bool anyRunning = false;
+    for (Staging::Stream& staged : staging_->streams) {
+        const std::unordered_map<uint32_t, size_t>& indices =
+            staged.stream.direction == AudioDirection::Render ? sinkIndices : sourceIndices;
+        auto device = indices.find(staged.deviceIndex);
+        // A device removed between the lists takes its streams with it
+        if (device == indices.end()) continue;
+
+        staged.stream.deviceName = devices[device->second].name;
+        anyRunning = anyRunning || !staged.stream.corked;
+        // Streams of server modules have no client process
+        if (staged.stream.processId != 0) {
+            AudioSession session;
+            session.processId = staged.stream.processId;
+            session.deviceIndex = device->second;
+            session.isActive = !staged.stream.corked;
+            session.isMuted = staged.stream.muted;
+            sessions.push_back(session);
+            binaries[staged.stream.processId] =
+                staged.stream.binary.empty() ? staged.stream.applicationName : staged.stream.binary;
+        }
+        streams.push_back(std::move(staged.stream));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!connected_ || !SameDevices(devices_, devices)) deviceGeneration_++;
+    devices_.swap(devices);
+    sessions_.swap(sessions);
+    streams_.swap(streams);
+    binaries_.swap(binaries);
+    anyRunning_ = anyRunning;
+    connected_ = true;
+    generation_++;
+}
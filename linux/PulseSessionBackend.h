@@ -0,0 +1,142 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../common/AudioBackend.h"
+#include "../common/TieredProbeScheduler.h"
+
+// One stream on the sound server: a sink input (render) or a source output
+// (capture), with the client that opened it
+struct SoundServerStream {
+    uint32_t index;              // Server-side index of the sink input / source output
+    uint32_t processId;          // application.process.id, 0 when the client did not set it
+    std::string applicationName; // application.name
+    std::string binary;          // application.process.binary
+    std::string deviceName;      // Description of the sink or source
+    AudioDirection direction;
+    bool corked;
+    bool muted;
+};
+
+// AudioBackend over a PulseAudio server, or PipeWire's pulse server, which
+// is where per-application attribution lives on desktops whose ALSA devices
+// are held by the sound server itself. Each sink and source is a device and
+// each sink input and source output a session of the client's PID; a
+// corked stream is inactive.
+//
+// The server's session list is kept in a cache that a subscription to sink,
+// source, sink input and source output events refreshes on libpulse's own
+// thread, so Enumerate() never waits on a server round-trip, and listeners
+// are told as soon as a refresh lands instead of at the next poll.
+//
+// libpulse.so.0 is loaded with dlopen, so a host without it only fails to
+// connect. Safe to share between threads.
+class PulseSessionBackend : public AudioBackend {
+public:
+    typedef std::function<void(std::chrono::steady_clock::time_point detectedAt)> Listener;
+    typedef uint64_t ListenerId;
+
+    PulseSessionBackend();
+    ~PulseSessionBackend() override;
+
+    // Connects to the default server and waits for the first session list.
+    // Returns true at once when already connected; a failed attempt is not
+    // retried for a couple of seconds, so polling a host without a server
+    // stays cheap. A connection that dropped is retried on the next call.
+    bool Connect(long& errorCode, std::string& errorMessage);
+
+    bool Connected();
+
+    // Copies the cached lists, connecting first when needed
+    bool Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                   long& errorCode, std::string& errorMessage) override;
+
+    // The executable from /proc, or the binary the client reported when its
+    // PID is not visible here (e.g. from inside a sandbox)
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+    // Every stream in the cache, with its client's identity
+    bool Streams(std::vector<SoundServerStream>& streams, long& errorCode, std::string& errorMessage);
+
+    // First tier for TieredProbeScheduler: the signature changes with every
+    // refresh and active is set while any stream is uncorked. Touches the
+    // server only to reconnect after the connection dropped; when that fails
+    // it returns false with the error, so the scheduler runs the full probe
+    // that reports it.
+    bool ReadActivity(ActivitySample& sample, long& errorCode, std::string& errorMessage);
+
+    // Called on libpulse's thread after every refresh and when the
+    // connection drops. The listener is not called after RemoveListener
+    // returns; must not be removed from a listener.
+    ListenerId AddListener(Listener listener);
+    void RemoveListener(ListenerId id);
+
+    // Refreshes published since construction
+    uint64_t Generation();
+
+    // Moves when the sink or source list changes and when the connection
+    // drops, not on stream changes
+    uint64_t DeviceGeneration();
+
+    // The cached devices and the DeviceGeneration() they belong to,
+    // connecting first when needed
+    bool Devices(std::vector<AudioDevice>& devices, uint64_t& generation, long& errorCode,
+                 std::string& errorMessage);
+
+    // Appends the cached sessions, whose device indices are into the list of
+    // generation; appends none once the device list has moved on
+    bool Sessions(std::vector<AudioSession>& sessions, uint64_t generation, long& errorCode,
+                  std::string& errorMessage);
+
+private:
+    struct Staging;
+
+    void Disconnect();
+    void Refresh();
+    void Publish();
+    void Notify(std::chrono::steady_clock::time_point detectedAt);
+
+    static void StateCallback(void* context, void* userdata);
+    static void SubscribeCallback(void* context, int event, uint32_t index, void* userdata);
+    static void SinkCallback(void* context, const void* info, int eol, void* userdata);
+    static void SourceCallback(void* context, const void* info, int eol, void* userdata);
+    static void SinkInputCallback(void* context, const void* info, int eol, void* userdata);
+    static void SourceOutputCallback(void* context, const void* info, int eol, void* userdata);
+    void ListDone();
+
+    std::mutex connectMutex_;  // Serializes Connect and Disconnect
+    void* mainloop_;
+    void* context_;
+    std::chrono::steady_clock::time_point lastAttempt_;
+    bool attempted_;
+    long lastErrorCode_;
+    std::string lastError_;
+
+    // Touched only on libpulse's thread, or with its lock held
+    std::unique_ptr<Staging> staging_;
+    int pendingLists_;
+    bool refreshing_;
+    bool dirty_;
+    bool listed_;  // The first refresh after connecting landed
+    std::chrono::steady_clock::time_point eventAt_;
+
+    std::mutex mutex_;  // Guards the published cache
+    bool connected_;
+    uint64_t generation_;
+    uint64_t deviceGeneration_;
+    std::vector<AudioDevice> devices_;
+    std::vector<AudioSession> sessions_;
+    std::vector<SoundServerStream> streams_;
+    std::unordered_map<uint32_t, std::string> binaries_;
+    bool anyRunning_;
+
+    std::mutex listenersMutex_;  // Held while listeners are called
+    std::map<ListenerId, Listener> listeners_;
+    ListenerId nextId_;
+};
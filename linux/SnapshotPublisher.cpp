@@ -0,0 +1,84 @@
+// SnapshotPublisher.cpp
+//
+
+#include "SnapshotPublisher.h"
+
+#include <errno.h>
+#include <algorithm>
+
+SnapshotPublisher::SnapshotPublisher(ScanFunction scan, ActivityProbe activity, std::chrono::milliseconds interval)
+    : scan_(scan), activity_(activity), interval_(interval), generation_(0), scans_(0), stopping_(false) {}
+
+SnapshotPublisher::~SnapshotPublisher() {
+    Stop();
+}
+
+bool SnapshotPublisher::Start(const std::string& path, size_t capacity, int& errorCode, std::string& errorMessage) {
+    if (!segment_.Open(path, capacity, errorCode, errorMessage)) return false;
+    generation_ = segment_.Generation();
+    stopping_ = false;
+    thread_ = std::thread(&SnapshotPublisher::Run, this);
+    return true;
+}
+
+void SnapshotPublisher::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    // The last snapshot stays readable; readers see the heartbeat go stale
+    segment_.Close();
+}
+
+void SnapshotPublisher::Publish(const AudioSnapshot& snapshot) {
+    payload_.clear();
+    EncodeAudioSnapshot(snapshot, payload_);
+    if (!segment_.Publish(payload_.data(), payload_.size())) {
+        AudioSnapshot overflow;
+        overflow.capture.success = false;
+        overflow.capture.errorCode = E2BIG;
+        overflow.capture.errorMessage = "Snapshot exceeds the segment capacity";
+        overflow.render.success = false;
+        overflow.render.errorCode = E2BIG;
+        overflow.render.errorMessage = overflow.capture.errorMessage;
+        payload_.clear();
+        EncodeAudioSnapshot(overflow, payload_);
+        segment_.Publish(payload_.data(), payload_.size());
+    }
+    generation_ = segment_.Generation();
+}
+
+void SnapshotPublisher::Run() {
+    ProbeSchedule schedule;
+    schedule.refreshInterval = interval_;
+    schedule.idleInterval = std::min(schedule.idleInterval, schedule.refreshInterval);
+    schedule.fastInterval = std::min(schedule.fastInterval, schedule.idleInterval);
+    TieredProbeScheduler scheduler(activity_, schedule);
+
+    for (;;) {
+        switch (scheduler.Next()) {
+        case ProbeTier::Unchanged:
+            segment_.Heartbeat();
+            break;
+        case ProbeTier::Idle:
+            Publish(AudioSnapshot());
+            break;
+        case ProbeTier::Full: {
+            AudioSnapshot snapshot;
+            scan_(snapshot);
+            scans_++;
+            uint64_t before = generation_;
+            Publish(snapshot);
+            if (generation_ != before) scheduler.ReportChanged();
+            break;
+        }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wake_.wait_for(lock, scheduler.Interval(), [this] { return stopping_; })) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "../common/SnapshotCodec.h"
+#include "../common/TieredProbeScheduler.h"
+#include "SnapshotSegment.h"
+
+// Scans on its own thread and publishes the capture and render results to a
+// SnapshotSegment, so other processes read them instead of scanning too.
+// Scans are gated by an activity probe as in watchAudioProcesses: interval
+// only bounds how long a running stream goes without a rescan, and quiet
+// ticks just refresh the heartbeat.
+class SnapshotPublisher {
+public:
+    typedef std::function<void(AudioSnapshot& snapshot)> ScanFunction;
+
+    SnapshotPublisher(ScanFunction scan, ActivityProbe activity, std::chrono::milliseconds interval);
+    ~SnapshotPublisher();
+
+    bool Start(const std::string& path, size_t capacity, int& errorCode, std::string& errorMessage);
+    void Stop();
+
+    uint64_t Generation() const { return generation_; }
+    uint64_t Scans() const { return scans_; }
+
+private:
+    void Run();
+    void Publish(const AudioSnapshot& snapshot);
+
+    ScanFunction scan_;
+    ActivityProbe activity_;
+    std::chrono::milliseconds interval_;
+    SnapshotSegmentWriter segment_;
+    std::string payload_;
+    std::atomic<uint64_t> generation_;
+    std::atomic<uint64_t> scans_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stopping_;
+};
@@ -0,0 +1,318 @@
+// SnapshotSegment.cpp
+//
+
+#include "SnapshotSegment.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <thread>
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Segment header atomics must be lock-free to be shared between processes");
+
+static const uint32_t kSegmentMagic = 0x4e4d5553;  // "NMUS"
+static const uint32_t kSegmentLayout = 1;
+
+// How often a reader retries while the writer is mid-update
+static const int kMaxReadAttempts = 1000;
+
+// Shared between processes, so only lock-free atomics and no pointers
+struct SegmentHeader {
+    std::atomic<uint32_t> magic;  // Stored last when a segment is created
+    uint32_t layout;
+    std::atomic<uint64_t> capacity;
+    std::atomic<uint64_t> sequence;  // Odd while the payload is being written
+    std::atomic<uint64_t> generation;
+    std::atomic<uint64_t> payloadSize;
+    std::atomic<uint64_t> publishedAtMs;
+    std::atomic<uint64_t> heartbeatAtMs;
+    std::atomic<uint32_t> publisherPid;
+};
+
+static const size_t kPayloadOffset = 128;
+static_assert(sizeof(SegmentHeader) <= kPayloadOffset, "Header overlaps the payload");
+
+static uint64_t NowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static SegmentHeader* Header(void* mapping) {
+    return static_cast<SegmentHeader*>(mapping);
+}
+
+static const SegmentHeader* Header(const void* mapping) {
+    return static_cast<const SegmentHeader*>(mapping);
+}
+
+SnapshotSegmentWriter::SnapshotSegmentWriter() : fd_(-1), mapping_(nullptr), mappedSize_(0), capacity_(0) {}
+
+SnapshotSegmentWriter::~SnapshotSegmentWriter() {
+    Close();
+}
+
+bool SnapshotSegmentWriter::Open(const std::string& path, size_t capacity, int& errorCode, std::string& errorMessage) {
+    Close();
+
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        errorCode = errno;
+        errorMessage = "Failed to open " + path;
+        return false;
+    }
+
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        errorCode = errno == EWOULDBLOCK ? EBUSY : errno;
+        errorMessage = "Another publisher owns " + path;
+        Close();
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        errorCode = errno;
+        errorMessage = "Failed to stat " + path;
+        Close();
+        return false;
+    }
+
+    // Never shrink: readers may have the old size mapped
+    size_t existingSize = static_cast<size_t>(st.st_size);
+    mappedSize_ = kPayloadOffset + capacity;
+    if (existingSize > mappedSize_) mappedSize_ = existingSize;
+    if (existingSize < mappedSize_ && ftruncate(fd_, static_cast<off_t>(mappedSize_)) != 0) {
+        errorCode = errno;
+        errorMessage = "Failed to size " + path;
+        Close();
+        return false;
+    }
+    capacity_ = mappedSize_ - kPayloadOffset;
+
+    mapping_ = mmap(nullptr, mappedSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (mapping_ == MAP_FAILED) {
+        mapping_ = nullptr;
+        errorCode = errno;
+        errorMessage = "Failed to map " + path;
+        Close();
+        return false;
+    }
+
+    SegmentHeader* header = Header(mapping_);
+    bool reuse = existingSize >= kPayloadOffset &&
+                 header->magic.load(std::memory_order_acquire) == kSegmentMagic &&
+                 header->layout == kSegmentLayout;
+    if (reuse) {
+        // A publisher that died mid-write left the sequence odd
+        uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+        if (sequence & 1) header->sequence.store(sequence + 1, std::memory_order_release);
+    } else {
+        header = new (mapping_) SegmentHeader();
+        header->layout = kSegmentLayout;
+        header->sequence.store(0, std::memory_order_relaxed);
+        header->generation.store(0, std::memory_order_relaxed);
+        header->payloadSize.store(0, std::memory_order_relaxed);
+        header->publishedAtMs.store(0, std::memory_order_relaxed);
+        header->heartbeatAtMs.store(0, std::memory_order_relaxed);
+        header->magic.store(kSegmentMagic, std::memory_order_release);
+    }
+    header->capacity.store(capacity_, std::memory_order_relaxed);
+    header->publisherPid.store(static_cast<uint32_t>(getpid()), std::memory_order_relaxed);
+    Heartbeat();
+    return true;
+}
+
+void SnapshotSegmentWriter::Close() {
+    if (mapping_) {
+        munmap(mapping_, mappedSize_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);  // Releases the flock
+        fd_ = -1;
+    }
+    mappedSize_ = 0;
+    capacity_ = 0;
+}
+
+bool SnapshotSegmentWriter::Publish(const char* payload, size_t size) {
+    if (!mapping_ || size > capacity_) return false;
+
+    SegmentHeader* header = Header(mapping_);
+    char* current = static_cast<char*>(mapping_) + kPayloadOffset;
+
+    // Only this process writes, so the payload can be compared without the seqlock
+    uint64_t generation = header->generation.load(std::memory_order_relaxed);
+    if (generation != 0 && header->payloadSize.load(std::memory_order_relaxed) == size &&
+        memcmp(current, payload, size) == 0) {
+        Heartbeat();
+        return true;
+    }
+
+    uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    memcpy(current, payload, size);
+    uint64_t now = NowMs();
+    header->payloadSize.store(size, std::memory_order_relaxed);
+    header->publishedAtMs.store(now, std::memory_order_relaxed);
+    header->generation.store(generation + 1, std::memory_order_relaxed);
+
+    header->sequence.store(sequence + 2, std::memory_order_release);
+    header->heartbeatAtMs.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+void SnapshotSegmentWriter::Heartbeat() {
+    if (!mapping_) return;
+    Header(mapping_)->heartbeatAtMs.store(NowMs(), std::memory_order_relaxed);
+}
+
+uint64_t SnapshotSegmentWriter::Generation() const {
+    return mapping_ ? Header(mapping_)->generation.load(std::memory_order_relaxed) : 0;
+}
+
+SnapshotSegmentReader::SnapshotSegmentReader()
+    : fd_(-1), mapping_(nullptr), mappedSize_(0), device_(0), inode_(0) {}
+
+SnapshotSegmentReader::~SnapshotSegmentReader() {
+    Close();
+}
+
+bool SnapshotSegmentReader::Open(const std::string& path, int& errorCode, std::string& errorMessage) {
+    Close();
+    path_ = path;
+
+    fd_ = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        errorCode = errno;
+        errorMessage = errno == ENOENT ? "No snapshot publisher at " + path : "Failed to open " + path;
+        return false;
+    }
+    return Remap(errorCode, errorMessage);
+}
+
+void SnapshotSegmentReader::Close() {
+    if (mapping_) {
+        munmap(const_cast<void*>(mapping_), mappedSize_);
+        mapping_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    mappedSize_ = 0;
+}
+
+// Maps the whole file again, after Open() or when the publisher grew it
+bool SnapshotSegmentReader::Remap(int& errorCode, std::string& errorMessage) {
+    if (mapping_) {
+        munmap(const_cast<void*>(mapping_), mappedSize_);
+        mapping_ = nullptr;
+        mappedSize_ = 0;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0) {
+        errorCode = errno;
+        errorMessage = "Failed to stat " + path_;
+        return false;
+    }
+    if (static_cast<size_t>(st.st_size) < kPayloadOffset) {
+        errorCode = EBADMSG;
+        errorMessage = "Not a snapshot segment: " + path_;
+        return false;
+    }
+    device_ = st.st_dev;
+    inode_ = st.st_ino;
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        errorCode = errno;
+        errorMessage = "Failed to map " + path_;
+        return false;
+    }
+    mapping_ = mapping;
+    mappedSize_ = static_cast<size_t>(st.st_size);
+
+    const SegmentHeader* header = Header(mapping_);
+    if (header->magic.load(std::memory_order_acquire) != kSegmentMagic || header->layout != kSegmentLayout) {
+        errorCode = EBADMSG;
+        errorMessage = "Not a snapshot segment: " + path_;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotSegmentReader::Peek(SnapshotSegmentInfo& info) const {
+    if (!mapping_) return false;
+    const SegmentHeader* header = Header(mapping_);
+    info.generation = header->generation.load(std::memory_order_acquire);
+    info.publishedAtMs = header->publishedAtMs.load(std::memory_order_relaxed);
+    info.heartbeatAtMs = header->heartbeatAtMs.load(std::memory_order_relaxed);
+    info.publisherPid = header->publisherPid.load(std::memory_order_relaxed);
+    return true;
+}
+
+bool SnapshotSegmentReader::Read(const DecodeFunction& decode, SnapshotSegmentInfo& info,
+                                 int& errorCode, std::string& errorMessage) {
+    if (!mapping_) {
+        errorCode = EBADF;
+        errorMessage = "Snapshot segment is not open";
+        return false;
+    }
+
+    for (int attempt = 0; attempt < kMaxReadAttempts; attempt++) {
+        const SegmentHeader* header = Header(mapping_);
+        uint64_t before = header->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        uint64_t size = header->payloadSize.load(std::memory_order_relaxed);
+        if (size > mappedSize_ - kPayloadOffset) {
+            // Grown by the publisher since we mapped it, or torn
+            if (header->capacity.load(std::memory_order_relaxed) > mappedSize_ - kPayloadOffset &&
+                !Remap(errorCode, errorMessage)) {
+                return false;
+            }
+            continue;
+        }
+
+        const char* payload = static_cast<const char*>(mapping_) + kPayloadOffset;
+        bool decoded = decode(payload, static_cast<size_t>(size));
+        info.generation = header->generation.load(std::memory_order_relaxed);
+        info.publishedAtMs = header->publishedAtMs.load(std::memory_order_relaxed);
+        info.publisherPid = header->publisherPid.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->sequence.load(std::memory_order_relaxed) != before) continue;
+
+        info.heartbeatAtMs = header->heartbeatAtMs.load(std::memory_order_relaxed);
+        if (!decoded) {
+            errorCode = EBADMSG;
+            errorMessage = "Snapshot payload does not decode";
+            return false;
+        }
+        return true;
+    }
+
+    errorCode = EAGAIN;
+    errorMessage = "Snapshot publisher kept the segment busy";
+    return false;
+}
+
+bool SnapshotSegmentReader::Replaced() const {
+    struct stat st;
+    if (stat(path_.c_str(), &st) != 0) return true;
+    return st.st_dev != device_ || st.st_ino != inode_;
+}
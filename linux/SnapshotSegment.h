@@ -0,0 +1,86 @@
+#pragma once
+#include <sys/types.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// Header fields of a snapshot segment as a reader saw them
+struct SnapshotSegmentInfo {
+    uint64_t generation;     // Bumped whenever the payload bytes change
+    uint64_t publishedAtMs;  // Wall clock of the last payload change
+    uint64_t heartbeatAtMs;  // Wall clock of the last publisher tick
+    uint32_t publisherPid;
+};
+
+// A memory-mapped file holding the latest encoded snapshot, written by one
+// publisher process and read by any number of others without any service in
+// between. The payload is guarded by a seqlock: the writer makes the sequence
+// odd, rewrites the payload in place and makes it even again; a reader
+// decodes straight out of the mapping and retries if the sequence moved.
+//
+// The file only ever grows, so a reader that mapped it earlier never faults
+// on a shrunk file. An exclusive flock keeps a second publisher off the same
+// path while the first is alive.
+class SnapshotSegmentWriter {
+public:
+    SnapshotSegmentWriter();
+    ~SnapshotSegmentWriter();
+
+    // Creates or reopens path with room for capacity payload bytes. A
+    // segment left by an earlier publisher keeps counting its generation,
+    // so readers never see a stale generation come back.
+    bool Open(const std::string& path, size_t capacity, int& errorCode, std::string& errorMessage);
+    void Close();
+
+    // Returns false, leaving the segment untouched, when size exceeds the
+    // capacity. Identical payloads only refresh the heartbeat.
+    bool Publish(const char* payload, size_t size);
+
+    // Tells readers the publisher is alive without touching the payload
+    void Heartbeat();
+
+    uint64_t Generation() const;
+    size_t Capacity() const { return capacity_; }
+
+private:
+    int fd_;
+    void* mapping_;
+    size_t mappedSize_;
+    size_t capacity_;
+};
+
+class SnapshotSegmentReader {
+public:
+    // Called with the payload inside the read; must treat it as untrusted
+    // (it may be torn) and return false if it does not decode
+    typedef std::function<bool(const char* payload, size_t size)> DecodeFunction;
+
+    SnapshotSegmentReader();
+    ~SnapshotSegmentReader();
+
+    bool Open(const std::string& path, int& errorCode, std::string& errorMessage);
+    void Close();
+
+    // Header only; no payload is touched
+    bool Peek(SnapshotSegmentInfo& info) const;
+
+    // Runs decode on a consistent payload. Fails with EAGAIN when the writer
+    // kept the payload busy for every attempt, or EBADMSG when a consistent
+    // payload does not decode.
+    bool Read(const DecodeFunction& decode, SnapshotSegmentInfo& info, int& errorCode, std::string& errorMessage);
+
+    // Whether path now names a different file than the one mapped, e.g.
+    // after the segment was deleted and created again
+    bool Replaced() const;
+
+private:
+    bool Remap(int& errorCode, std::string& errorMessage);
+
+    std::string path_;
+    int fd_;
+    const void* mapping_;
+    size_t mappedSize_;
+    dev_t device_;
+    ino_t inode_;
+};
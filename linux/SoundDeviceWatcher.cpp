@@ -0,0 +1,167 @@
+// SoundDeviceWatcher.cpp
+//
+
+#include "SoundDeviceWatcher.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cstring>
+
+static const uint32_t kDevRootMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+static const uint32_t kSoundMask = IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF;
+
+// Only PCM and control nodes change when a card comes or goes; timers and
+// sequencers are ignored
+static bool IsSoundNode(const char* name) {
+    return strncmp(name, "pcmC", 4) == 0 || strncmp(name, "controlC", 8) == 0;
+}
+
+SoundDeviceWatcher::SoundDeviceWatcher(const std::string& devRoot)
+    : devRoot_(devRoot), nextId_(1), stopFd_(-1), soundWatch_(-1), watching_(false) {}
+
+SoundDeviceWatcher::~SoundDeviceWatcher() {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+    StopThread();
+}
+
+SoundDeviceWatcher::ListenerId SoundDeviceWatcher::AddListener(Listener listener) {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+
+    ListenerId id;
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(listenersMutex_);
+        id = nextId_++;
+        first = listeners_.empty();
+        listeners_[id] = listener;
+    }
+
+    if (first) StartThread();
+    return id;
+}
+
+void SoundDeviceWatcher::RemoveListener(ListenerId id) {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+
+    bool last;
+    {
+        // Waits out a notification in progress
+        std::lock_guard<std::mutex> lock(listenersMutex_);
+        listeners_.erase(id);
+        last = listeners_.empty();
+    }
+
+    if (last) StopThread();
+}
+
+bool SoundDeviceWatcher::Watching() {
+    std::lock_guard<std::mutex> lifecycle(lifecycleMutex_);
+    return watching_;
+}
+
+bool SoundDeviceWatcher::StartThread() {
+    int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) return false;
+
+    int stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopFd < 0) {
+        close(inotifyFd);
+        return false;
+    }
+
+    // /dev itself is watched so /dev/snd appearing (first card plugged in) is seen
+    if (inotify_add_watch(inotifyFd, devRoot_.c_str(), kDevRootMask) < 0) {
+        close(stopFd);
+        close(inotifyFd);
+        return false;
+    }
+    WatchSoundDirectory(inotifyFd);
+
+    stopFd_ = stopFd;
+    watching_ = true;
+    thread_ = std::thread(&SoundDeviceWatcher::Run, this, inotifyFd, stopFd);
+    return true;
+}
+
+void SoundDeviceWatcher::StopThread() {
+    if (!thread_.joinable()) return;
+
+    uint64_t one = 1;
+    ssize_t written = write(stopFd_, &one, sizeof(one));
+    (void)written;
+    thread_.join();
+
+    close(stopFd_);
+    stopFd_ = -1;
+    watching_ = false;
+}
+
+void SoundDeviceWatcher::WatchSoundDirectory(int inotifyFd) {
+    std::string path = devRoot_ + "/snd";
+    soundWatch_ = inotify_add_watch(inotifyFd, path.c_str(), kSoundMask);
+}
+
+void SoundDeviceWatcher::Notify(std::chrono::steady_clock::time_point detectedAt) {
+    std::lock_guard<std::mutex> lock(listenersMutex_);
+    for (const auto& listener : listeners_) {
+        listener.second(detectedAt);
+    }
+}
+
+void SoundDeviceWatcher::Run(int inotifyFd, int stopFd) {
+    // Large enough for a burst of events; a card brings several nodes at once
+    alignas(struct inotify_event) char buffer[4096];
+
+    for (;;) {
+        struct pollfd fds[2] = {{stopFd, POLLIN, 0}, {inotifyFd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents) break;
+        if (!(fds[1].revents & POLLIN)) continue;
+
+        std::chrono::steady_clock::time_point detectedAt = std::chrono::steady_clock::now();
+        bool changed = false;
+
+        // Drain everything queued so a burst produces one notification
+        for (;;) {
+            ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) break;
+
+            for (char* cursor = buffer; cursor < buffer + length;) {
+                const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(cursor);
+                cursor += sizeof(struct inotify_event) + event->len;
+
+                if (event->wd == soundWatch_) {
+                    if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                        soundWatch_ = -1;
+                        changed = true;
+                    } else if (event->len > 0 && IsSoundNode(event->name)) {
+                        changed = true;
+                    }
+                } else if (event->len > 0 && strcmp(event->name, "snd") == 0) {
+                    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                        // Nodes created before the watch was added are covered by
+                        // the probe this notification triggers
+                        WatchSoundDirectory(inotifyFd);
+                    }
+                    changed = true;
+                }
+            }
+        }
+
+        if (changed) Notify(detectedAt);
+    }
+
+    close(inotifyFd);
+    soundWatch_ = -1;
+}
+
+SoundDeviceWatcher& SharedSoundDeviceWatcher() {
+    static SoundDeviceWatcher* watcher = new SoundDeviceWatcher();
+    return *watcher;
+}
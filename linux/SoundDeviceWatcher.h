@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Watches /dev/snd with inotify and calls every listener when a PCM or
+// control node appears, disappears or changes, i.e. when a sound card is
+// plugged in or removed. Listeners are told when the change was seen, so
+// callers can report how long re-arming took.
+//
+// The watching thread runs only while there are listeners. If inotify is
+// unavailable no listener is ever called and callers keep their own polling.
+class SoundDeviceWatcher {
+public:
+    typedef std::function<void(std::chrono::steady_clock::time_point detectedAt)> Listener;
+    typedef uint64_t ListenerId;
+
+    explicit SoundDeviceWatcher(const std::string& devRoot = "/dev");
+    ~SoundDeviceWatcher();
+
+    ListenerId AddListener(Listener listener);
+
+    // The listener is not called after this returns. Must not be called from
+    // a listener.
+    void RemoveListener(ListenerId id);
+
+    // True while the watching thread is running with inotify
+    bool Watching();
+
+private:
+    bool StartThread();
+    void StopThread();
+    void Run(int inotifyFd, int stopFd);
+    void WatchSoundDirectory(int inotifyFd);
+    void Notify(std::chrono::steady_clock::time_point detectedAt);
+
+    std::string devRoot_;
+    std::mutex lifecycleMutex_;  // Serializes AddListener / RemoveListener
+    std::mutex listenersMutex_;  // Held while listeners are called
+    std::map<ListenerId, Listener> listeners_;
+    ListenerId nextId_;
+    std::thread thread_;
+    int stopFd_;
+    int soundWatch_;
+    bool watching_;
+};
+
+// Watcher for the real /dev, shared by every capture monitor
+SoundDeviceWatcher& SharedSoundDeviceWatcher();
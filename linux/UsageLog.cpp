@@ -0,0 +1,531 @@
+// UsageLog.cpp
+//
+
+#include "UsageLog.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <unordered_set>
+
+static const uint32_t kUsageLogMagic = 0x4e4d554c;  // "NMUL"
+static const uint32_t kUsageLogLayout = 1;
+
+// magic u32, layout u32, baseTimeMs u64, endTimeMs u64, flags u32, reserved
+// u32; little-endian. endTimeMs is rewritten after every flush.
+static const size_t kHeaderSize = 32;
+static const size_t kEndTimeOffset = 16;
+static const uint32_t kHeaderClosed = 1;
+
+// Record tags. A name record is followed by a varint length and the bytes,
+// and takes the next id. A transition carries its flags in the low bits and
+// is followed by varints for the time delta, process id and device id.
+static const uint8_t kRecordName = 0x20;
+static const uint8_t kRecordTransition = 0x10;
+static const uint8_t kFlagActive = 0x01;
+static const uint8_t kFlagRender = 0x02;
+static const uint8_t kFlagRestated = 0x04;  // Still active from the previous file
+
+// Largest transition record: tag plus three maximal varints
+static const size_t kMaxTransitionBytes = 1 + 10 + 5 + 5;
+
+// Files beyond this are never looked at, whatever maxFiles was
+static const size_t kMaxLogFiles = 64;
+
+static uint64_t NowMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+static void PutVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static bool GetVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+static void PutLE(char* out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; i++) out[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+}
+
+static uint64_t GetLE(const uint8_t* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; i++) value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    return value;
+}
+
+static std::string LogFilePath(const std::string& path, size_t index) {
+    return index == 0 ? path : path + "." + std::to_string(index);
+}
+
+// path -> path.1 -> ... -> path.<maxFiles - 1>, dropping the oldest
+static void ShiftLogFiles(const std::string& path, size_t maxFiles) {
+    if (maxFiles <= 1) {
+        unlink(path.c_str());
+        return;
+    }
+    for (size_t i = maxFiles - 1; i >= 1; i--) {
+        rename(LogFilePath(path, i - 1).c_str(), LogFilePath(path, i).c_str());
+    }
+}
+
+static bool WriteAll(int fd, const char* data, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+UsageLogWriter::UsageLogWriter()
+    : fd_(-1), fileBytes_(0), lastTimeMs_(0), fileTransitions_(0), transitions_(0), bytesWritten_(0),
+      rotations_(0) {}
+
+UsageLogWriter::~UsageLogWriter() {
+    Close(NowMs());
+}
+
+bool UsageLogWriter::Open(const std::string& path, const UsageLogOptions& options, uint64_t nowMs,
+                          int& errorCode, std::string& errorMessage) {
+    Close(nowMs);
+
+    UsageLogOptions clamped = options;
+    clamped.maxBytes = std::max<size_t>(clamped.maxBytes, 4096);
+    clamped.maxFiles = std::min(std::max<size_t>(clamped.maxFiles, 1), kMaxLogFiles);
+
+    // Checks for a live writer before moving anything
+    int existing = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (existing >= 0) {
+        bool busy = flock(existing, LOCK_EX | LOCK_NB) != 0 && errno == EWOULDBLOCK;
+        struct stat st;
+        bool empty = fstat(existing, &st) == 0 && st.st_size == 0;
+        close(existing);
+        if (busy) {
+            errorCode = EBUSY;
+            errorMessage = "Another writer owns " + path;
+            return false;
+        }
+        if (!empty) ShiftLogFiles(path, clamped.maxFiles);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    options_ = clamped;
+    sessions_.clear();
+    transitions_ = 0;
+    bytesWritten_ = 0;
+    rotations_ = 0;
+    return StartFile(nowMs, errorCode, errorMessage);
+}
+
+void UsageLogWriter::Close(uint64_t nowMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) return;
+
+    for (const auto& session : sessions_) {
+        Encode(nowMs, session.first, false, false);
+    }
+    sessions_.clear();
+    FlushLocked();
+    CloseFile(lastTimeMs_, true);
+}
+
+bool UsageLogWriter::Append(uint64_t timeMs, const AudioProcessDelta& delta) {
+    if (!delta.errorMessage.empty()) return true;
+
+    // Leaves first, so a process moving between devices never shows on both
+    for (const WatchedProcess& process : delta.capture.removed) {
+        Record(timeMs, process.processName, process.deviceName, AudioDirection::Capture, false);
+    }
+    for (const WatchedProcess& process : delta.render.removed) {
+        Record(timeMs, process.processName, process.deviceName, AudioDirection::Render, false);
+    }
+    for (const WatchedProcess& process : delta.capture.added) {
+        Record(timeMs, process.processName, process.deviceName, AudioDirection::Capture, true);
+    }
+    for (const WatchedProcess& process : delta.render.added) {
+        Record(timeMs, process.processName, process.deviceName, AudioDirection::Render, true);
+    }
+    return Flush();
+}
+
+void UsageLogWriter::Record(uint64_t timeMs, const std::string& process, const std::string& device,
+                            AudioDirection direction, bool active) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0) return;
+
+    SessionKey key(process, device, direction == AudioDirection::Render);
+    auto it = sessions_.find(key);
+    if (active && it != sessions_.end()) {
+        it->second++;
+        return;
+    }
+    if (!active && (it == sessions_.end() || --it->second > 0)) return;
+
+    // Rotated before the session set changes, so the new file restates the
+    // state this edge applies to
+    size_t worstCase = kMaxTransitionBytes + 2 * (1 + 5) + process.size() + device.size();
+    if (fileTransitions_ > 0 && fileBytes_ + pending_.size() + worstCase > options_.maxBytes) {
+        if (!Rotate(std::max(timeMs, lastTimeMs_))) return;
+    }
+
+    if (active) {
+        sessions_.emplace(key, 1);
+    } else {
+        sessions_.erase(key);
+    }
+    Encode(timeMs, key, active, false);
+}
+
+bool UsageLogWriter::Flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return FlushLocked();
+}
+
+UsageLogStats UsageLogWriter::Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    UsageLogStats stats;
+    stats.transitions = transitions_;
+    stats.bytesWritten = bytesWritten_;
+    stats.rotations = rotations_;
+    stats.active = sessions_.size();
+    return stats;
+}
+
+bool UsageLogWriter::StartFile(uint64_t nowMs, int& errorCode, std::string& errorMessage) {
+    // Truncated only once the lock is held, so a second writer turned away
+    // here leaves the owner's log intact
+    fd_ = open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        errorCode = errno;
+        errorMessage = "Failed to open " + path_;
+        return false;
+    }
+    if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+        errorCode = errno == EWOULDBLOCK ? EBUSY : errno;
+        errorMessage = "Another writer owns " + path_;
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    if (ftruncate(fd_, 0) != 0) {
+        errorCode = errno;
+        errorMessage = "Failed to truncate " + path_;
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    char header[kHeaderSize] = {};
+    PutLE(header, kUsageLogMagic, 4);
+    PutLE(header + 4, kUsageLogLayout, 4);
+    PutLE(header + 8, nowMs, 8);
+    PutLE(header + kEndTimeOffset, nowMs, 8);
+    if (!WriteAll(fd_, header, kHeaderSize, 0)) {
+        errorCode = errno;
+        errorMessage = "Failed to write " + path_;
+        close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    fileBytes_ = kHeaderSize;
+    bytesWritten_ += kHeaderSize;
+    lastTimeMs_ = nowMs;
+    fileTransitions_ = 0;
+    names_.clear();
+    pending_.clear();
+
+    for (const auto& session : sessions_) {
+        Encode(nowMs, session.first, true, true);
+    }
+    return FlushLocked();
+}
+
+void UsageLogWriter::CloseFile(uint64_t endMs, bool closed) {
+    if (fd_ < 0) return;
+    WriteHeaderEnd(endMs, closed);
+    close(fd_);  // Releases the flock
+    fd_ = -1;
+}
+
+bool UsageLogWriter::FlushLocked() {
+    if (pending_.empty()) return fd_ >= 0;
+    if (fd_ < 0 || !WriteAll(fd_, pending_.data(), pending_.size(), fileBytes_)) {
+        pending_.clear();
+        return false;
+    }
+    fileBytes_ += pending_.size();
+    bytesWritten_ += pending_.size();
+    pending_.clear();
+    WriteHeaderEnd(lastTimeMs_, false);
+    return true;
+}
+
+bool UsageLogWriter::Rotate(uint64_t nowMs) {
+    FlushLocked();
+    CloseFile(nowMs, true);
+    ShiftLogFiles(path_, options_.maxFiles);
+    rotations_++;
+
+    int errorCode = 0;
+    std::string errorMessage;
+    return StartFile(nowMs, errorCode, errorMessage);
+}
+
+uint32_t UsageLogWriter::Intern(const std::string& name) {
+    auto it = names_.find(name);
+    if (it != names_.end()) return it->second;
+
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    names_.emplace(name, id);
+    pending_.push_back(static_cast<char>(kRecordName));
+    PutVarint(pending_, name.size());
+    pending_.append(name);
+    return id;
+}
+
+void UsageLogWriter::Encode(uint64_t timeMs, const SessionKey& key, bool active, bool restated) {
+    // The wall clock can step back; the log never does
+    if (timeMs < lastTimeMs_) timeMs = lastTimeMs_;
+
+    uint32_t processId = Intern(std::get<0>(key));
+    uint32_t deviceId = Intern(std::get<1>(key));
+    uint8_t tag = kRecordTransition;
+    if (active) tag |= kFlagActive;
+    if (std::get<2>(key)) tag |= kFlagRender;
+    if (restated) tag |= kFlagRestated;
+
+    pending_.push_back(static_cast<char>(tag));
+    PutVarint(pending_, timeMs - lastTimeMs_);
+    PutVarint(pending_, processId);
+    PutVarint(pending_, deviceId);
+    lastTimeMs_ = timeMs;
+    if (!restated) {
+        fileTransitions_++;
+        transitions_++;
+    }
+}
+
+void UsageLogWriter::WriteHeaderEnd(uint64_t endMs, bool closed) {
+    char fields[12];
+    PutLE(fields, endMs, 8);
+    PutLE(fields + 8, closed ? kHeaderClosed : 0, 4);
+    WriteAll(fd_, fields, sizeof(fields), kEndTimeOffset);
+}
+
+namespace {
+
+// Per-application state while one file is decoded
+struct AppState {
+    int matches;         // -1 until the name is checked against the filter
+    uint32_t open[2];    // Devices active, by direction
+    uint64_t since[2];   // When the direction last went active
+};
+
+class FileScan {
+public:
+    FileScan(uint64_t fromMs, uint64_t toMs, const std::string& process, std::map<std::string, AppUsage>& totals)
+        : fromMs_(fromMs), toMs_(toMs), process_(process), totals_(totals) {}
+
+    // Returns the bytes decoded; stops at the first record that does not
+    // decode, which for the live file is one still being written
+    size_t Run(const uint8_t* data, size_t size, uint64_t baseMs, uint64_t endMs, uint64_t& records) {
+        uint64_t time = baseMs;
+        size_t pos = kHeaderSize;
+        size_t decoded = pos;
+        bool pastWindow = false;
+
+        while (pos < size) {
+            uint8_t tag = data[pos++];
+            if (tag == kRecordName) {
+                uint64_t length = 0;
+                if (!GetVarint(data, size, pos, length) || length > size - pos) break;
+                names_.emplace_back(reinterpret_cast<const char*>(data + pos), static_cast<size_t>(length));
+                apps_.push_back(AppState{-1, {0, 0}, {0, 0}});
+                pos += static_cast<size_t>(length);
+                decoded = pos;
+                continue;
+            }
+            if ((tag & 0xf0) != kRecordTransition) break;
+
+            uint64_t delta = 0;
+            uint64_t processId = 0;
+            uint64_t deviceId = 0;
+            if (!GetVarint(data, size, pos, delta) || !GetVarint(data, size, pos, processId) ||
+                !GetVarint(data, size, pos, deviceId) || processId >= names_.size() || deviceId >= names_.size()) {
+                break;
+            }
+            decoded = pos;
+            records++;
+            time += delta;
+            if (time > toMs_) {
+                pastWindow = true;
+                break;
+            }
+            Transition(time, static_cast<uint32_t>(processId), static_cast<uint32_t>(deviceId), tag);
+        }
+
+        // Whatever is still active ran until the file stopped being written
+        uint64_t closeAt = pastWindow ? time : std::max(endMs, time);
+        for (uint32_t id = 0; id < apps_.size(); id++) {
+            for (int direction = 0; direction < 2; direction++) {
+                if (apps_[id].open[direction] > 0) Credit(id, direction, apps_[id].since[direction], closeAt);
+            }
+        }
+        return decoded;
+    }
+
+private:
+    void Transition(uint64_t time, uint32_t processId, uint32_t deviceId, uint8_t tag) {
+        if (!Matches(processId)) return;
+
+        int direction = (tag & kFlagRender) ? 1 : 0;
+        uint64_t session = (static_cast<uint64_t>(processId) << 33) | (static_cast<uint64_t>(deviceId) << 1) |
+                           static_cast<uint64_t>(direction);
+        AppState& app = apps_[processId];
+
+        if (tag & kFlagActive) {
+            if (!active_.emplace(session).second) return;
+            if (app.open[direction]++ > 0) return;
+            app.since[direction] = time;
+            bool wasIdle = app.open[1 - direction] == 0;
+            if (wasIdle && !(tag & kFlagRestated) && time >= fromMs_) {
+                Usage(processId).activations++;
+            }
+        } else {
+            if (active_.erase(session) == 0) return;
+            if (--app.open[direction] > 0) return;
+            Credit(processId, direction, app.since[direction], time);
+        }
+    }
+
+    bool Matches(uint32_t processId) {
+        AppState& app = apps_[processId];
+        if (app.matches < 0) {
+            const std::string& name = names_[processId];
+            size_t slash = name.find_last_of('/');
+            app.matches = process_.empty() || name == process_ ||
+                          (slash != std::string::npos && name.compare(slash + 1, std::string::npos, process_) == 0);
+        }
+        return app.matches > 0;
+    }
+
+    void Credit(uint32_t processId, int direction, uint64_t beginMs, uint64_t endMs) {
+        beginMs = std::max(beginMs, fromMs_);
+        endMs = std::min(endMs, toMs_);
+        if (endMs <= beginMs) return;
+        AppUsage& usage = Usage(processId);
+        (direction == 1 ? usage.renderMs : usage.captureMs) += endMs - beginMs;
+    }
+
+    AppUsage& Usage(uint32_t processId) {
+        const std::string& name = names_[processId];
+        auto it = totals_.find(name);
+        if (it == totals_.end()) {
+            it = totals_.emplace(name, AppUsage{name, 0, 0, 0}).first;
+        }
+        return it->second;
+    }
+
+    uint64_t fromMs_;
+    uint64_t toMs_;
+    const std::string& process_;
+    std::map<std::string, AppUsage>& totals_;
+    std::vector<std::string> names_;
+    std::vector<AppState> apps_;
+    std::unordered_set<uint64_t> active_;
+};
+
+}  // namespace
+
+bool QueryUsageLog(const std::string& path, uint64_t fromMs, uint64_t toMs, const std::string& process,
+                   uint64_t nowMs, std::vector<AppUsage>& usage, UsageQueryStats& stats,
+                   int& errorCode, std::string& errorMessage) {
+    usage.clear();
+    stats = UsageQueryStats();
+    std::map<std::string, AppUsage> totals;
+
+    for (size_t index = 0; index < kMaxLogFiles; index++) {
+        std::string filePath = LogFilePath(path, index);
+        int fd = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (index > 0) break;
+            errorCode = errno;
+            errorMessage = errno == ENOENT ? "No usage log at " + path : "Failed to open " + path;
+            return false;
+        }
+
+        // A writer holds an exclusive flock on the live file
+        bool live = false;
+        if (flock(fd, LOCK_SH | LOCK_NB) != 0) {
+            live = errno == EWOULDBLOCK;
+        } else {
+            flock(fd, LOCK_UN);
+        }
+
+        struct stat st;
+        size_t size = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+        void* mapping = size >= kHeaderSize ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            // Just created, not yet headed
+            if (size < kHeaderSize && live) continue;
+            if (index > 0) continue;
+            errorCode = size < kHeaderSize ? EBADMSG : errno;
+            errorMessage = "Failed to map " + filePath;
+            return false;
+        }
+
+        const uint8_t* data = static_cast<const uint8_t*>(mapping);
+        if (GetLE(data, 4) != kUsageLogMagic || GetLE(data + 4, 4) != kUsageLogLayout) {
+            munmap(mapping, size);
+            if (index > 0) continue;
+            errorCode = EBADMSG;
+            errorMessage = filePath + " is not a usage log";
+            return false;
+        }
+
+        uint64_t baseMs = GetLE(data + 8, 8);
+        uint64_t endMs = GetLE(data + kEndTimeOffset, 8);
+        if (live) endMs = std::max(endMs, nowMs);
+
+        if (baseMs > toMs || endMs < fromMs) {
+            stats.filesSkipped++;
+        } else {
+            FileScan scan(fromMs, toMs, process, totals);
+            stats.bytesScanned += scan.Run(data, size, baseMs, endMs, stats.records);
+            stats.filesRead++;
+        }
+        munmap(mapping, size);
+    }
+
+    usage.reserve(totals.size());
+    for (auto& entry : totals) {
+        usage.push_back(std::move(entry.second));
+    }
+    return true;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+#include "../common/AudioBackend.h"
+#include "../common/AudioProcessWatcher.h"
+
+// Append-only history of when each application started and stopped using
+// each device, for audits that need "who used the microphone, and for how
+// long" long after the fact.
+//
+// Only edges are written: a process name joining or leaving a device in
+// one direction, counted across PIDs so a second instance of an app adds
+// nothing. Each record is a tag byte carrying the direction and on/off
+// flags, then varints for the milliseconds since the previous record and
+// for the process and device names, which are interned per file by a name
+// record the first time they appear. A transition is typically 4-6 bytes.
+//
+// Files are size-bounded and rotated like logrotate: path is the live
+// file, path.1 the one before it, up to path.<maxFiles - 1>. Each file
+// starts by restating whatever is still active, so it can be read without
+// the ones before it.
+
+struct UsageLogOptions {
+    size_t maxBytes;  // Per file
+    size_t maxFiles;  // Including the live one
+
+    UsageLogOptions() : maxBytes(4 << 20), maxFiles(4) {}
+};
+
+struct UsageLogStats {
+    uint64_t transitions;   // Edges written since Open()
+    uint64_t bytesWritten;  // Header, name and transition bytes
+    uint64_t rotations;
+    size_t active;          // (process, device, direction) currently on
+};
+
+class UsageLogWriter {
+public:
+    UsageLogWriter();
+    ~UsageLogWriter();
+
+    // Starts a fresh live file at path; one already there is rotated out
+    // first. An exclusive flock keeps a second writer off the same path.
+    bool Open(const std::string& path, const UsageLogOptions& options, uint64_t nowMs,
+              int& errorCode, std::string& errorMessage);
+
+    // Logs every open session as ended at nowMs and marks the file closed
+    void Close(uint64_t nowMs);
+
+    // Records the edges in a watcher delta and writes them in one go
+    bool Append(uint64_t timeMs, const AudioProcessDelta& delta);
+
+    // Counts one PID of process joining (active) or leaving device; only
+    // the first join and the last leave become records. Buffered until
+    // Flush().
+    void Record(uint64_t timeMs, const std::string& process, const std::string& device, AudioDirection direction,
+                bool active);
+    bool Flush();
+
+    UsageLogStats Stats() const;
+
+private:
+    typedef std::tuple<std::string, std::string, bool> SessionKey;  // process, device, render
+
+    bool StartFile(uint64_t nowMs, int& errorCode, std::string& errorMessage);
+    void CloseFile(uint64_t endMs, bool closed);
+    bool FlushLocked();
+    bool Rotate(uint64_t nowMs);
+    uint32_t Intern(const std::string& name);
+    void Encode(uint64_t timeMs, const SessionKey& key, bool active, bool restated);
+    void WriteHeaderEnd(uint64_t endMs, bool closed);
+
+    mutable std::mutex mutex_;
+    std::string path_;
+    UsageLogOptions options_;
+    int fd_;
+    uint64_t fileBytes_;
+    uint64_t lastTimeMs_;
+    uint64_t fileTransitions_;  // Not counting the restated ones
+    std::string pending_;
+    std::unordered_map<std::string, uint32_t> names_;  // Interned in the live file
+    std::map<SessionKey, uint32_t> sessions_;          // PIDs per active session
+    uint64_t transitions_;
+    uint64_t bytesWritten_;
+    uint64_t rotations_;
+};
+
+// Active time of one application within a query window
+struct AppUsage {
+    std::string process;
+    uint64_t captureMs;      // Any capture device in use
+    uint64_t renderMs;       // Any render device in use
+    uint32_t activations;    // Times either direction went from idle to active
+};
+
+struct UsageQueryStats {
+    size_t filesRead;
+    size_t filesSkipped;  // Entirely outside the window; only the header was read
+    uint64_t bytesScanned;
+    uint64_t records;
+};
+
+// Maps each file of the log at path in turn and sums active time within
+// [fromMs, toMs], by process name. A non-empty process keeps only names
+// equal to it or whose basename is. Sessions still open at the end of a
+// file run to the file's last write, or to nowMs while a writer holds it.
+// Returns false and sets errorCode / errorMessage when the live file is
+// missing or is not a usage log.
+bool QueryUsageLog(const std::string& path, uint64_t fromMs, uint64_t toMs, const std::string& process,
+                   uint64_t nowMs, std::vector<AppUsage>& usage, UsageQueryStats& stats,
+                   int& errorCode, std::string& errorMessage);
@@ -0,0 +1,785 @@
+#include <napi.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include "AudioProcessMonitor.h"
+#include "ProcStat.h"
+#include "PulseCaptureSource.h"
+#include "SnapshotPublisher.h"
+#include "UsageLog.h"
+#include "../common/AddonInstance.h"
+#include "../common/AsyncSnapshot.h"
+#include "../common/AudioContextBinding.h"
+#include "../common/ColumnarResult.h"
+#include "../common/LevelMeterBinding.h"
+#include "../common/MonitorHubBinding.h"
+#include "../common/NativeStatsBinding.h"
+#include "../common/PollingMonitorSource.h"
+#include "../common/ProcessFilterBinding.h"
+#include "../common/ProcessPathCache.h"
+#include "../common/ResultMarshal.h"
+#include "../common/SessionPipeline.h"
+#include "../common/SharedResource.h"
+#include "../common/WatchAudioProcesses.h"
+
+// One polling listener per device, shared by every subscriber in every env,
+// and stopped once the last env using it exits
+static SharedResource<MonitorHub> microphoneHub([]() {
+  return new MonitorHub(CreateCaptureMonitorSource);
+});
+
+// Per-env state; see AddonInstance.h
+struct LinuxAddon : public AddonInstance {
+  // Promise-returning variants. Each scan runs on the libuv worker pool, and
+  // concurrent callers in this env share whichever scan is already in flight.
+  AsyncSnapshot<std::vector<std::string>> inputProcessesSnapshot;
+  AsyncSnapshot<AudioProcessResult> microphoneSnapshot;
+  AsyncSnapshot<RenderProcessResult> renderSnapshot;
+  AsyncSnapshot<ProcessAudioSnapshot> audioSnapshot;
+  AsyncSnapshot<BackendWarmup> warmup;
+
+  // Names referenced by columnar render results
+  StringTable renderStringTable;
+
+  // Shared snapshot segments this env has read from, by path
+  std::map<std::string, std::unique_ptr<SnapshotSegmentReader>> snapshotReaders;
+
+  LinuxAddon()
+    : AddonInstance(microphoneHub.Acquire()),
+      inputProcessesSnapshot("GetRunningInputAudioProcesses", GetAudioInputProcesses, ProcessListToArray),
+      microphoneSnapshot("GetProcessesAccessingMicrophoneWithResult", GetProcessesAccessingMicrophoneWithResult,
+                         AudioProcessResultToObject<AudioProcessResult>),
+      renderSnapshot("GetRenderProcessesWithResult", GetRenderProcessesWithResult,
+                     RenderProcessResultToObject<RenderProcessResult>),
+      audioSnapshot("GetAudioSnapshot", GetAudioSnapshot, ProcessAudioSnapshotToObject),
+      warmup("PrewarmAudioBackend", [](const ProcessFilter*) { return PrewarmAudioBackend(); },
+             BackendWarmupToObject) {}
+
+  static LinuxAddon& Of(Napi::Env env) {
+    return static_cast<LinuxAddon&>(AddonInstance::Of(env));
+  }
+};
+
+// Gets a list of processes that are accessing input (microphone) - original interface.
+// Every enumeration call takes { filter }; see ProcessFilterBinding.h.
+Napi::Value GetRunningInputAudioProcesses(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
+
+  try {
+    std::vector<std::string> processes = GetAudioInputProcesses(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    return ProcessListToArray(env, processes);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Gets processes accessing microphone with structured result
+Napi::Value GetProcessesAccessingMicrophoneWithResult(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
+
+  try {
+    AudioProcessResult result = GetProcessesAccessingMicrophoneWithResult(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    return AudioProcessResultToObject(env, result);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+static bool AttributeOption(const Napi::CallbackInfo& info) {
+  return info.Length() > 0 && info[0].IsObject() && info[0].As<Napi::Object>().Get("attribute").ToBoolean().Value();
+}
+
+static Napi::Object ApplicationToObject(Napi::Env env, const ApplicationInfo& application) {
+  Napi::Object applicationObj = Napi::Object::New(env);
+  applicationObj.Set("processId", Napi::Number::New(env, application.processId));
+  applicationObj.Set("name", Napi::String::New(env, application.name));
+  applicationObj.Set("path", Napi::String::New(env, application.path));
+  applicationObj.Set("depth", Napi::Number::New(env, application.depth));
+  return applicationObj;
+}
+
+// Sets result.processes[i].application for { attribute: true }; the array
+// was marshaled in the same order as pids
+static void AttachApplications(Napi::Env env, Napi::Value result, const std::vector<uint32_t>& pids) {
+  std::vector<ApplicationInfo> applications = AttributeToApplications(pids);
+  Napi::Array processes = result.As<Napi::Object>().Get("processes").As<Napi::Array>();
+  for (size_t i = 0; i < applications.size() && i < processes.Length(); i++) {
+    processes.Get(i).As<Napi::Object>().Set("application", ApplicationToObject(env, applications[i]));
+  }
+}
+
+// Gets a list of processes that are using speakers/render devices.
+// Pass { columnar: true, stringTableVersion } to get typed-array columns, or
+// { attribute: true } to add each process's top-level application.
+Napi::Value GetRenderProcessesWithResult(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
+
+  try {
+    uint32_t knownVersion = 0;
+    bool columnar = ParseColumnarOptions(info, knownVersion);
+
+    RenderProcessResult result = GetRenderProcessesWithResult(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    if (columnar) {
+      return RenderProcessResultToColumns(env, result, LinuxAddon::Of(env).renderStringTable, knownVersion);
+    }
+    Napi::Value resultObj = RenderProcessResultToObject(env, result);
+    if (result.success && AttributeOption(info)) {
+      std::vector<uint32_t> pids;
+      for (const RenderProcessInfo& process : result.processes) pids.push_back(process.processId);
+      AttachApplications(env, resultObj, pids);
+    }
+    return resultObj;
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Capture and render use of every process, grouped per PID, from one scan.
+// Takes { filter } and { attribute: true } like the calls above.
+Napi::Value GetAudioSnapshot(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
+
+  try {
+    ProcessAudioSnapshot result = GetAudioSnapshot(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    Napi::Value resultObj = ProcessAudioSnapshotToObject(env, result);
+    if (result.success && AttributeOption(info)) {
+      std::vector<uint32_t> pids;
+      for (const ProcessAudioRecord& record : result.processes) pids.push_back(record.processId);
+      AttachApplications(env, resultObj, pids);
+    }
+    return resultObj;
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// getProcessApplication(pid): the top-level application behind pid, or null
+// when pid does not exist
+Napi::Value GetProcessApplication(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber()) {
+    Napi::TypeError::New(env, "Expected a process ID").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  uint32_t pid = info[0].As<Napi::Number>().Uint32Value();
+
+  ProcStat stat;
+  if (pid == 0 || !ReadProcStat("/proc", static_cast<pid_t>(pid), stat)) return env.Null();
+  return ApplicationToObject(env, AttributeToApplications({ pid })[0]);
+}
+
+// Promise variants of the calls above. They take the same { filter }, which
+// is checked before the promise is made; requests with different filters
+// never share a scan (see AsyncSnapshot.h).
+Napi::Value GetRunningInputAudioProcessesAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return LinuxAddon::Of(info.Env()).inputProcessesSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetProcessesAccessingMicrophoneWithResultAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return LinuxAddon::Of(info.Env()).microphoneSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetRenderProcessesWithResultAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return LinuxAddon::Of(info.Env()).renderSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetAudioSnapshotAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return LinuxAddon::Of(info.Env()).audioSnapshot.Request(info.Env(), filter);
+}
+
+// prewarm(): selects and warms the shared backend on the libuv worker pool,
+// so the first enumeration call skips the sound server connect, the first
+// /proc walk and most path lookups. Concurrent calls share one warm-up.
+Napi::Value Prewarm(const Napi::CallbackInfo& info) {
+  return LinuxAddon::Of(info.Env()).warmup.Request(info.Env());
+}
+
+// Returns hit/miss/eviction counters for the PID-to-path resolver cache
+Napi::Value GetResolverCacheStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ProcessPathCacheStats stats = SharedProcessPathCache().Stats();
+
+  Napi::Object statsObj = Napi::Object::New(env);
+  statsObj.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+  statsObj.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+  statsObj.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+  statsObj.Set("size", Napi::Number::New(env, static_cast<double>(stats.size)));
+  statsObj.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+  statsObj.Set("internedPaths", Napi::Number::New(env, static_cast<double>(stats.internedPaths)));
+  return statsObj;
+}
+
+// Sets the maximum number of cached PIDs, evicting least recently used ones
+Napi::Value SetResolverCacheCapacity(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int64Value() < 1) {
+    Napi::TypeError::New(env, "Expected a positive capacity").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  SharedProcessPathCache().SetCapacity(static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+  return env.Undefined();
+}
+
+// setScanThreads(n): threads the /proc fd scan runs on, counting the calling
+// thread; 0 restores the default. Returns the count in use.
+Napi::Value SetScanThreads(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int64Value() < 0 ||
+      info[0].As<Napi::Number>().Int64Value() > 64) {
+    Napi::TypeError::New(env, "Expected a thread count from 0 to 64").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  size_t threads = SetScanThreads(static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+  return Napi::Number::New(env, static_cast<double>(threads));
+}
+
+// Watches capture and render processes, calling back with {added, removed}
+// batches only when something changed
+Napi::Value WatchAudioProcesses(const Napi::CallbackInfo& info) {
+  return StartAudioProcessWatch(info, GetWatchedProcesses, ProbeAudioActivity, SubscribeAudioChanges);
+}
+
+// Streams input levels; see LevelMeterBinding.h. Devices are PulseAudio or
+// PipeWire sources.
+Napi::Value StartInputLevelMeter(const Napi::CallbackInfo& info) {
+  return StartLevelMeter(info, PulseCaptureSource::Open);
+}
+
+// Long-lived session context; see AudioContextBinding.h. It reads through the
+// backend the one-shot calls use, the sound server's cached lists or the
+// shared /proc scanner, and re-reads the device list only when that changes.
+Napi::Value CreateLinuxAudioContext(const Napi::CallbackInfo& info) {
+  return CreateAudioContext(info, CreateAudioContextBackend);
+}
+
+// Subscribes to microphone state changes; see MonitorHubBinding.h
+Napi::Value SubscribeMicrophone(const Napi::CallbackInfo& info) {
+  return SubscribeToHub(info);
+}
+
+// Every ALSA capture PCM as { id, name, active, ownerPid }
+Napi::Value GetCaptureDevices(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::vector<CaptureDeviceState> devices;
+  long errorCode = 0;
+  std::string errorMessage;
+  if (!GetCaptureDevices(devices, errorCode, errorMessage)) {
+    Napi::Error err = Napi::Error::New(env, errorMessage);
+    err.Set("code", Napi::Number::New(env, errorCode));
+    err.Set("domain", Napi::String::New(env, "LinuxMicrophoneMonitor"));
+    err.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array array = Napi::Array::New(env, devices.size());
+  for (size_t i = 0; i < devices.size(); i++) {
+    Napi::Object deviceObj = Napi::Object::New(env);
+    deviceObj.Set("id", Napi::String::New(env, devices[i].id));
+    deviceObj.Set("name", Napi::String::New(env, devices[i].name));
+    deviceObj.Set("active", Napi::Boolean::New(env, devices[i].active));
+    deviceObj.Set("ownerPid", Napi::Number::New(env, devices[i].ownerPid));
+    array.Set(i, deviceObj);
+  }
+  return array;
+}
+
+// setAudioBackend("auto" | "pulse" | "proc"): picks where the enumeration
+// calls get their sessions from; returns "pulse" or "proc", the backend now
+// in use. With no argument, only reports it.
+Napi::Value SetAudioBackend(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || info[0].IsUndefined()) {
+    return Napi::String::New(env, SelectedAudioBackend());
+  }
+  if (!info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected \"auto\", \"pulse\" or \"proc\"").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  long errorCode = 0;
+  std::string errorMessage;
+  const char* selected = SelectAudioBackend(info[0].As<Napi::String>().Utf8Value(), errorCode, errorMessage);
+  if (!selected) {
+    Napi::Error err = Napi::Error::New(env, errorMessage);
+    err.Set("code", Napi::Number::New(env, errorCode));
+    err.Set("domain", Napi::String::New(env, "LinuxAudioBackend"));
+    err.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+  return Napi::String::New(env, selected);
+}
+
+// Every stream on the PulseAudio / PipeWire server as { index, processId,
+// applicationName, binary, deviceName, direction, corked, muted }
+Napi::Value GetAudioStreams(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::vector<SoundServerStream> streams;
+  long errorCode = 0;
+  std::string errorMessage;
+  if (!GetSoundServerStreams(streams, errorCode, errorMessage)) {
+    Napi::Error err = Napi::Error::New(env, errorMessage);
+    err.Set("code", Napi::Number::New(env, errorCode));
+    err.Set("domain", Napi::String::New(env, "LinuxAudioBackend"));
+    err.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Array array = Napi::Array::New(env, streams.size());
+  for (size_t i = 0; i < streams.size(); i++) {
+    Napi::Object streamObj = Napi::Object::New(env);
+    streamObj.Set("index", Napi::Number::New(env, streams[i].index));
+    streamObj.Set("processId", Napi::Number::New(env, streams[i].processId));
+    streamObj.Set("applicationName", Napi::String::New(env, streams[i].applicationName));
+    streamObj.Set("binary", Napi::String::New(env, streams[i].binary));
+    streamObj.Set("deviceName", Napi::String::New(env, streams[i].deviceName));
+    streamObj.Set("direction", Napi::String::New(env, streams[i].direction == AudioDirection::Capture ? "capture"
+                                                                                                        : "render"));
+    streamObj.Set("corked", Napi::Boolean::New(env, streams[i].corked));
+    streamObj.Set("muted", Napi::Boolean::New(env, streams[i].muted));
+    array.Set(i, streamObj);
+  }
+  return array;
+}
+
+static const char* kDefaultSnapshotPath = "/dev/shm/node-mac-utils-audio-snapshot";
+
+static std::string SnapshotPathOption(const Napi::CallbackInfo& info) {
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Value path = info[0].As<Napi::Object>().Get("path");
+    if (path.IsString()) return path.As<Napi::String>().Utf8Value();
+  }
+  return kDefaultSnapshotPath;
+}
+
+// One enumeration covers both directions
+static void ScanAudioSnapshot(AudioSnapshot& snapshot) {
+  SplitProcessAudioSnapshot(GetAudioSnapshot(), snapshot.capture, snapshot.render);
+}
+
+struct SnapshotPublisherHandle {
+  std::unique_ptr<SnapshotPublisher> publisher;
+  AddonInstance* addon;
+  AddonInstance::HandleId handle;
+};
+
+// Starts publishing capture and render results to a shared memory segment
+// that readSharedSnapshot() in other processes reads without scanning.
+// Options: { path, intervalMs = 1000, capacityBytes = 1 MiB }. Returns
+// { path, stop(), generation() }.
+Napi::Value StartSnapshotPublisher(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::string path = SnapshotPathOption(info);
+  int64_t intervalMs = 1000;
+  int64_t capacityBytes = 1 << 20;
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Object options = info[0].As<Napi::Object>();
+    if (options.Get("intervalMs").IsNumber()) {
+      intervalMs = options.Get("intervalMs").As<Napi::Number>().Int64Value();
+    }
+    if (options.Get("capacityBytes").IsNumber()) {
+      capacityBytes = options.Get("capacityBytes").As<Napi::Number>().Int64Value();
+    }
+  }
+  if (intervalMs < 10 || capacityBytes < 1024) {
+    Napi::RangeError::New(env, "intervalMs must be at least 10 and capacityBytes at least 1024")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<SnapshotPublisherHandle> publisher = std::make_shared<SnapshotPublisherHandle>();
+  publisher->publisher.reset(new SnapshotPublisher(ScanAudioSnapshot, ProbeAudioActivity,
+                                                   std::chrono::milliseconds(intervalMs)));
+  int errorCode = 0;
+  std::string errorMessage;
+  if (!publisher->publisher->Start(path, static_cast<size_t>(capacityBytes), errorCode, errorMessage)) {
+    Napi::Error err = Napi::Error::New(env, errorMessage);
+    err.Set("code", Napi::Number::New(env, errorCode));
+    err.Set("domain", Napi::String::New(env, "SharedSnapshot"));
+    err.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::weak_ptr<SnapshotPublisherHandle> weakPublisher = publisher;
+  publisher->addon = &AddonInstance::Of(env);
+  publisher->handle = publisher->addon->TrackHandle([weakPublisher]() {
+    std::shared_ptr<SnapshotPublisherHandle> publisher = weakPublisher.lock();
+    if (publisher) publisher->publisher->Stop();
+  });
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("path", Napi::String::New(env, path));
+  handle.Set("stop", Napi::Function::New(env, [publisher](const Napi::CallbackInfo& info) -> Napi::Value {
+    publisher->publisher->Stop();
+    publisher->addon->UntrackHandle(publisher->handle);
+    return info.Env().Undefined();
+  }, "stop"));
+  handle.Set("generation", Napi::Function::New(env, [publisher](const Napi::CallbackInfo& info) -> Napi::Value {
+    return Napi::Number::New(info.Env(), static_cast<double>(publisher->publisher->Generation()));
+  }, "generation"));
+  return handle;
+}
+
+static Napi::Object SharedSnapshotError(Napi::Env env, int errorCode, const std::string& errorMessage) {
+  Napi::Object resultObj = Napi::Object::New(env);
+  resultObj.Set("success", Napi::Boolean::New(env, false));
+  resultObj.Set("error", Napi::String::New(env, errorMessage));
+  resultObj.Set("code", Napi::Number::New(env, errorCode));
+  resultObj.Set("domain", Napi::String::New(env, "SharedSnapshot"));
+  return resultObj;
+}
+
+// Reads the latest snapshot published by startSnapshotPublisher(), possibly
+// from another process. Options: { path, sinceGeneration }. When the segment
+// is still at sinceGeneration only the header is read and capture/render are
+// left out, with changed: false.
+Napi::Value ReadSharedSnapshot(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::string path = SnapshotPathOption(info);
+  double sinceGeneration = -1;
+  if (info.Length() > 0 && info[0].IsObject()) {
+    Napi::Value since = info[0].As<Napi::Object>().Get("sinceGeneration");
+    if (since.IsNumber()) sinceGeneration = since.As<Napi::Number>().DoubleValue();
+  }
+
+  int errorCode = 0;
+  std::string errorMessage;
+  std::unique_ptr<SnapshotSegmentReader>& reader = LinuxAddon::Of(env).snapshotReaders[path];
+  if (reader && reader->Replaced()) reader.reset();
+  if (!reader) {
+    reader.reset(new SnapshotSegmentReader());
+    if (!reader->Open(path, errorCode, errorMessage)) {
+      reader.reset();
+      return SharedSnapshotError(env, errorCode, errorMessage);
+    }
+  }
+
+  SnapshotSegmentInfo segment;
+  AudioSnapshot snapshot;
+  bool changed = true;
+  if (reader->Peek(segment) && static_cast<double>(segment.generation) == sinceGeneration) {
+    changed = false;
+  } else {
+    bool read = reader->Read([&snapshot](const char* payload, size_t size) {
+      snapshot = AudioSnapshot();
+      return DecodeAudioSnapshot(payload, size, snapshot);
+    }, segment, errorCode, errorMessage);
+    if (!read) {
+      // Reopened on the next call, in case the segment was recreated
+      reader.reset();
+      return SharedSnapshotError(env, errorCode, errorMessage);
+    }
+  }
+
+  StatsStageScope marshal(PipelineStage::Marshal);
+  Napi::Object resultObj = Napi::Object::New(env);
+  resultObj.Set("success", Napi::Boolean::New(env, true));
+  resultObj.Set("error", env.Null());
+  resultObj.Set("generation", Napi::Number::New(env, static_cast<double>(segment.generation)));
+  resultObj.Set("changed", Napi::Boolean::New(env, changed));
+  resultObj.Set("publisherPid", Napi::Number::New(env, segment.publisherPid));
+  resultObj.Set("publishedAt", Napi::Number::New(env, static_cast<double>(segment.publishedAtMs)));
+  resultObj.Set("heartbeatAt", Napi::Number::New(env, static_cast<double>(segment.heartbeatAtMs)));
+  if (changed) {
+    resultObj.Set("capture", AudioProcessResultToObject(env, snapshot.capture));
+    resultObj.Set("render", RenderProcessResultToObject(env, snapshot.render));
+  }
+  return resultObj;
+}
+
+static uint64_t WallClockMs() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+struct UsageLogHandle {
+  std::unique_ptr<AudioProcessWatcher> watcher;
+  UsageLogWriter writer;
+  AddonInstance* addon;
+  AddonInstance::HandleId handle;
+  bool stopped;
+
+  UsageLogHandle() : addon(nullptr), handle(0), stopped(false) {}
+
+  // On the env's JS thread; the watcher is joined before the log is closed
+  void Stop() {
+    if (stopped) return;
+    stopped = true;
+    watcher->Stop();
+    writer.Close(WallClockMs());
+  }
+};
+
+static bool UsageLogPathOption(const Napi::CallbackInfo& info, std::string& path) {
+  if (info.Length() < 1 || !info[0].IsObject()) return false;
+  Napi::Value value = info[0].As<Napi::Object>().Get("path");
+  if (!value.IsString()) return false;
+  path = value.As<Napi::String>().Utf8Value();
+  return !path.empty();
+}
+
+// Appends every capture and render start and stop to a compact binary log
+// that queryUsage() reads back, from this process or any other. The watcher
+// behind it polls as watchAudioProcesses does, without calling into JS.
+// Options: { path, intervalMs = 1000, adaptive = true, maxBytes = 4 MiB,
+// maxFiles = 4 }. Returns { path, stop(), stats() }.
+Napi::Value StartUsageLog(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::string path;
+  if (!UsageLogPathOption(info, path)) {
+    Napi::TypeError::New(env, "Expected an options object with a path").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  int64_t intervalMs = 1000;
+  bool adaptive = true;
+  UsageLogOptions logOptions;
+  if (options.Get("intervalMs").IsNumber()) {
+    intervalMs = options.Get("intervalMs").As<Napi::Number>().Int64Value();
+  }
+  if (options.Get("adaptive").IsBoolean()) {
+    adaptive = options.Get("adaptive").As<Napi::Boolean>().Value();
+  }
+  if (options.Get("maxBytes").IsNumber()) {
+    logOptions.maxBytes = static_cast<size_t>(std::max<int64_t>(options.Get("maxBytes").As<Napi::Number>().Int64Value(), 0));
+  }
+  if (options.Get("maxFiles").IsNumber()) {
+    logOptions.maxFiles = static_cast<size_t>(std::max<int64_t>(options.Get("maxFiles").As<Napi::Number>().Int64Value(), 0));
+  }
+  if (intervalMs < 10 || logOptions.maxBytes < 4096 || logOptions.maxFiles < 1 || logOptions.maxFiles > 64) {
+    Napi::RangeError::New(env, "intervalMs must be at least 10, maxBytes at least 4096 and maxFiles from 1 to 64")
+      .ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::shared_ptr<UsageLogHandle> log = std::make_shared<UsageLogHandle>();
+  int errorCode = 0;
+  std::string errorMessage;
+  if (!log->writer.Open(path, logOptions, WallClockMs(), errorCode, errorMessage)) {
+    Napi::Error err = Napi::Error::New(env, errorMessage);
+    err.Set("code", Napi::Number::New(env, errorCode));
+    err.Set("domain", Napi::String::New(env, "UsageLog"));
+    err.ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  // The writer lives as long as the watcher that feeds it
+  UsageLogWriter* writer = &log->writer;
+  log->watcher.reset(new AudioProcessWatcher(
+    GetWatchedProcesses,
+    [writer](AudioProcessDelta* delta) {
+      std::unique_ptr<AudioProcessDelta> owned(delta);
+      writer->Append(WallClockMs(), *delta);
+    },
+    std::chrono::milliseconds(intervalMs)));
+  if (adaptive) {
+    ProbeSchedule schedule;
+    schedule.refreshInterval = std::chrono::milliseconds(intervalMs);
+    schedule.idleInterval = std::min(schedule.idleInterval, schedule.refreshInterval);
+    schedule.fastInterval = std::min(schedule.fastInterval, schedule.idleInterval);
+    log->watcher->UseScheduler(std::unique_ptr<TieredProbeScheduler>(
+      new TieredProbeScheduler(ProbeAudioActivity, schedule)));
+  }
+  log->watcher->Start();
+
+  std::weak_ptr<UsageLogHandle> weakLog = log;
+  log->addon = &AddonInstance::Of(env);
+  log->handle = log->addon->TrackHandle([weakLog]() {
+    std::shared_ptr<UsageLogHandle> log = weakLog.lock();
+    if (log) log->Stop();
+  });
+
+  Napi::Object handle = Napi::Object::New(env);
+  handle.Set("path", Napi::String::New(env, path));
+  handle.Set("stop", Napi::Function::New(env, [log](const Napi::CallbackInfo& info) -> Napi::Value {
+    if (!log->stopped) log->addon->UntrackHandle(log->handle);
+    log->Stop();
+    return info.Env().Undefined();
+  }, "stop"));
+  handle.Set("stats", Napi::Function::New(env, [log](const Napi::CallbackInfo& info) -> Napi::Value {
+    Napi::Env env = info.Env();
+    UsageLogStats stats = log->writer.Stats();
+    Napi::Object statsObj = Napi::Object::New(env);
+    statsObj.Set("transitions", Napi::Number::New(env, static_cast<double>(stats.transitions)));
+    statsObj.Set("bytesWritten", Napi::Number::New(env, static_cast<double>(stats.bytesWritten)));
+    statsObj.Set("rotations", Napi::Number::New(env, static_cast<double>(stats.rotations)));
+    statsObj.Set("active", Napi::Number::New(env, static_cast<double>(stats.active)));
+    return statsObj;
+  }, "stats"));
+  return handle;
+}
+
+// Active time per application recorded by startUsageLog(), read straight
+// out of the mapped log files. Options: { path, from = 0, to = now,
+// process }, times in ms since the epoch; process matches a full name or
+// its basename. Returns { success, error, from, to, apps: [{ process,
+// captureMs, renderMs, activations }] }; files wholly outside the window
+// are skipped after their header.
+Napi::Value QueryUsage(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::string path;
+  if (!UsageLogPathOption(info, path)) {
+    Napi::TypeError::New(env, "Expected an options object with a path").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  Napi::Object options = info[0].As<Napi::Object>();
+  uint64_t nowMs = WallClockMs();
+  double from = 0;
+  double to = static_cast<double>(nowMs);
+  std::string process;
+  if (options.Get("from").IsNumber()) from = options.Get("from").As<Napi::Number>().DoubleValue();
+  if (options.Get("to").IsNumber()) to = options.Get("to").As<Napi::Number>().DoubleValue();
+  if (options.Get("process").IsString()) process = options.Get("process").As<Napi::String>().Utf8Value();
+  if (!(from >= 0) || !(to >= from)) {
+    Napi::RangeError::New(env, "from must be at least 0 and no later than to").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  std::vector<AppUsage> usage;
+  UsageQueryStats stats;
+  int errorCode = 0;
+  std::string errorMessage;
+  Napi::Object resultObj = Napi::Object::New(env);
+  if (!QueryUsageLog(path, static_cast<uint64_t>(from), static_cast<uint64_t>(to), process, nowMs, usage, stats,
+                     errorCode, errorMessage)) {
+    resultObj.Set("success", Napi::Boolean::New(env, false));
+    resultObj.Set("error", Napi::String::New(env, errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, errorCode));
+    resultObj.Set("domain", Napi::String::New(env, "UsageLog"));
+    return resultObj;
+  }
+
+  Napi::Array apps = Napi::Array::New(env, usage.size());
+  for (size_t i = 0; i < usage.size(); i++) {
+    Napi::Object appObj = Napi::Object::New(env);
+    appObj.Set("process", Napi::String::New(env, usage[i].process));
+    appObj.Set("captureMs", Napi::Number::New(env, static_cast<double>(usage[i].captureMs)));
+    appObj.Set("renderMs", Napi::Number::New(env, static_cast<double>(usage[i].renderMs)));
+    appObj.Set("activations", Napi::Number::New(env, usage[i].activations));
+    apps.Set(i, appObj);
+  }
+  resultObj.Set("success", Napi::Boolean::New(env, true));
+  resultObj.Set("error", env.Null());
+  resultObj.Set("from", Napi::Number::New(env, from));
+  resultObj.Set("to", Napi::Number::New(env, to));
+  resultObj.Set("apps", apps);
+  return resultObj;
+}
+
+// Initialize the module exports
+Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  AddonInstance::Install(env, new LinuxAddon());
+
+  Napi::Value (*originalAudioProcessesFunc)(const Napi::CallbackInfo&) = GetRunningInputAudioProcesses;
+  Napi::Value (*microphoneAccessFunc)(const Napi::CallbackInfo&) = GetProcessesAccessingMicrophoneWithResult;
+  Napi::Value (*renderProcessesFunc)(const Napi::CallbackInfo&) = GetRenderProcessesWithResult;
+  Napi::Value (*captureDevicesFunc)(const Napi::CallbackInfo&) = GetCaptureDevices;
+  Napi::Value (*audioSnapshotFunc)(const Napi::CallbackInfo&) = GetAudioSnapshot;
+
+  exports.Set("getRunningInputAudioProcesses",
+              Napi::Function::New(env, originalAudioProcessesFunc));
+  exports.Set("getProcessesAccessingMicrophoneWithResult",
+              Napi::Function::New(env, microphoneAccessFunc));
+  exports.Set("getProcessesAccessingSpeakersWithResult",
+              Napi::Function::New(env, renderProcessesFunc));
+
+  exports.Set("getRunningInputAudioProcessesAsync",
+              Napi::Function::New(env, GetRunningInputAudioProcessesAsync));
+  exports.Set("getProcessesAccessingMicrophoneWithResultAsync",
+              Napi::Function::New(env, GetProcessesAccessingMicrophoneWithResultAsync));
+  exports.Set("getProcessesAccessingSpeakersWithResultAsync",
+              Napi::Function::New(env, GetRenderProcessesWithResultAsync));
+  exports.Set("getAudioSnapshot",
+              Napi::Function::New(env, audioSnapshotFunc));
+  exports.Set("getAudioSnapshotAsync",
+              Napi::Function::New(env, GetAudioSnapshotAsync));
+
+  exports.Set("watchAudioProcesses",
+              Napi::Function::New(env, WatchAudioProcesses));
+  exports.Set("startLevelMeter",
+              Napi::Function::New(env, StartInputLevelMeter));
+  exports.Set("measureLevel",
+              Napi::Function::New(env, MeasureLevel));
+  exports.Set("subscribeMicrophone",
+              Napi::Function::New(env, SubscribeMicrophone));
+  exports.Set("getCaptureDevices",
+              Napi::Function::New(env, captureDevicesFunc));
+  exports.Set("getResolverCacheStats",
+              Napi::Function::New(env, GetResolverCacheStats));
+  exports.Set("setResolverCacheCapacity",
+              Napi::Function::New(env, SetResolverCacheCapacity));
+  exports.Set("getStats",
+              Napi::Function::New(env, GetStats));
+  exports.Set("resetStats",
+              Napi::Function::New(env, ResetStats));
+  exports.Set("getInstanceStats",
+              Napi::Function::New(env, GetInstanceStats));
+  exports.Set("setScanThreads",
+              Napi::Function::New(env, SetScanThreads));
+  exports.Set("getProcessApplication",
+              Napi::Function::New(env, GetProcessApplication));
+  exports.Set("createProcessFilter",
+              Napi::Function::New(env, CreateProcessFilter));
+  exports.Set("startSnapshotPublisher",
+              Napi::Function::New(env, StartSnapshotPublisher));
+  exports.Set("readSharedSnapshot",
+              Napi::Function::New(env, ReadSharedSnapshot));
+  exports.Set("setAudioBackend",
+              Napi::Function::New(env, SetAudioBackend));
+  exports.Set("getAudioStreams",
+              Napi::Function::New(env, GetAudioStreams));
+  exports.Set("startUsageLog",
+              Napi::Function::New(env, StartUsageLog));
+  exports.Set("queryUsage",
+              Napi::Function::New(env, QueryUsage));
+  exports.Set("prewarm",
+              Napi::Function::New(env, Prewarm));
+  exports.Set("createAudioContext",
+              Napi::Function::New(env, CreateLinuxAudioContext));
+
+  return exports;
+}
+
+NODE_API_MODULE(linux_utils, Init)
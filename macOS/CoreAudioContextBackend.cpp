@@ -0,0 +1,187 @@
+// CoreAudioContextBackend.cpp
+//
+
+#include "CoreAudioContextBackend.h"
+
+#include <libproc.h>
+#include <cstring>
+
+namespace {
+
+const AudioObjectPropertySelector kHardwareSelectors[] = {
+    kAudioHardwarePropertyDevices,
+    kAudioHardwarePropertyDefaultInputDevice,
+    kAudioHardwarePropertyDefaultOutputDevice,
+};
+
+AudioObjectPropertyAddress GlobalAddress(AudioObjectPropertySelector selector) {
+    AudioObjectPropertyAddress address = {
+        selector,
+        kAudioObjectPropertyScopeGlobal,
+        kAudioObjectPropertyElementMain
+    };
+    return address;
+}
+
+// A CFString property as UTF-8, or an empty string
+std::string StringProperty(AudioObjectID objectId, AudioObjectPropertySelector selector) {
+    AudioObjectPropertyAddress address = GlobalAddress(selector);
+    CFStringRef value = nullptr;
+    UInt32 dataSize = sizeof(value);
+    if (AudioObjectGetPropertyData(objectId, &address, 0, nullptr, &dataSize, &value) != noErr || !value) {
+        return std::string();
+    }
+
+    std::string result;
+    CFIndex maxSize = CFStringGetMaximumSizeForEncoding(CFStringGetLength(value), kCFStringEncodingUTF8) + 1;
+    result.resize(static_cast<size_t>(maxSize));
+    if (CFStringGetCString(value, &result[0], maxSize, kCFStringEncodingUTF8)) {
+        result.resize(strlen(result.c_str()));
+    } else {
+        result.clear();
+    }
+    CFRelease(value);
+    return result;
+}
+
+bool FlagProperty(AudioObjectID objectId, AudioObjectPropertySelector selector) {
+    AudioObjectPropertyAddress address = GlobalAddress(selector);
+    UInt32 value = 0;
+    UInt32 dataSize = sizeof(value);
+    return AudioObjectGetPropertyData(objectId, &address, 0, nullptr, &dataSize, &value) == noErr && value != 0;
+}
+
+}  // namespace
+
+// A listener that cannot be added leaves that change to Invalidate()
+CoreAudioContextBackend::CoreAudioContextBackend()
+    : version_(0), captureDevice_(kNoDevice), renderDevice_(kNoDevice) {
+    for (AudioObjectPropertySelector selector : kHardwareSelectors) {
+        AudioObjectPropertyAddress address = GlobalAddress(selector);
+        AudioObjectAddPropertyListener(kAudioObjectSystemObject, &address, OnHardwareChanged, this);
+    }
+}
+
+CoreAudioContextBackend::~CoreAudioContextBackend() {
+    for (AudioObjectPropertySelector selector : kHardwareSelectors) {
+        AudioObjectPropertyAddress address = GlobalAddress(selector);
+        AudioObjectRemovePropertyListener(kAudioObjectSystemObject, &address, OnHardwareChanged, this);
+    }
+}
+
+// Called on CoreAudio's notification thread
+OSStatus CoreAudioContextBackend::OnHardwareChanged(AudioObjectID, UInt32, const AudioObjectPropertyAddress*,
+                                                    void* clientData) {
+    static_cast<CoreAudioContextBackend*>(clientData)->version_++;
+    return noErr;
+}
+
+uint64_t CoreAudioContextBackend::TopologyVersion() {
+    return version_.load();
+}
+
+bool CoreAudioContextBackend::OpenDevices(std::vector<AudioDevice>& devices, long&, std::string&) {
+    captureDevice_ = OpenDefault(kAudioHardwarePropertyDefaultInputDevice, AudioDirection::Capture, devices)
+                         ? devices.size() - 1
+                         : kNoDevice;
+    renderDevice_ = OpenDefault(kAudioHardwarePropertyDefaultOutputDevice, AudioDirection::Render, devices)
+                        ? devices.size() - 1
+                        : kNoDevice;
+    return true;
+}
+
+bool CoreAudioContextBackend::OpenDefault(AudioObjectPropertySelector selector, AudioDirection direction,
+                                          std::vector<AudioDevice>& devices) {
+    AudioObjectPropertyAddress address = GlobalAddress(selector);
+    AudioObjectID deviceId = kAudioObjectUnknown;
+    UInt32 dataSize = sizeof(deviceId);
+    if (AudioObjectGetPropertyData(kAudioObjectSystemObject, &address, 0, nullptr, &dataSize, &deviceId) != noErr ||
+        deviceId == kAudioObjectUnknown) {
+        return false;
+    }
+
+    AudioDevice device;
+    device.id = StringProperty(deviceId, kAudioDevicePropertyDeviceUID);
+    device.name = StringProperty(deviceId, kAudioObjectPropertyName);
+    if (device.name.empty()) {
+        device.name = direction == AudioDirection::Capture ? "Default input device" : "Default output device";
+    }
+    device.direction = direction;
+    devices.push_back(device);
+    return true;
+}
+
+bool CoreAudioContextBackend::ReadSessions(std::vector<AudioSession>& sessions, long& errorCode,
+                                           std::string& errorMessage) {
+    AudioObjectPropertyAddress address = GlobalAddress(kAudioHardwarePropertyProcessObjectList);
+    UInt32 dataSize = 0;
+    OSStatus status = AudioObjectGetPropertyDataSize(kAudioObjectSystemObject, &address, 0, nullptr, &dataSize);
+    if (status != noErr) {
+        errorCode = status;
+        errorMessage = "Failed to get process list size";
+        return false;
+    }
+
+    nextObjects_.resize(dataSize / sizeof(AudioObjectID));
+    if (!nextObjects_.empty()) {
+        status = AudioObjectGetPropertyData(kAudioObjectSystemObject, &address, 0, nullptr, &dataSize,
+                                            nextObjects_.data());
+        if (status != noErr) {
+            errorCode = status;
+            errorMessage = "Failed to get process list";
+            return false;
+        }
+        // The list may have shrunk between the two calls
+        nextObjects_.resize(dataSize / sizeof(AudioObjectID));
+    }
+
+    // CoreAudio gives each new process object a new ID and keeps the list in
+    // order, so the PID of an object still at the same position is carried
+    // over instead of read again
+    nextIds_.resize(nextObjects_.size());
+    for (size_t i = 0; i < nextObjects_.size(); i++) {
+        if (i < processObjects_.size() && processObjects_[i] == nextObjects_[i]) {
+            nextIds_[i] = processIds_[i];
+            continue;
+        }
+        AudioObjectPropertyAddress pidAddress = GlobalAddress(kAudioProcessPropertyPID);
+        pid_t processId = 0;
+        UInt32 pidSize = sizeof(processId);
+        if (AudioObjectGetPropertyData(nextObjects_[i], &pidAddress, 0, nullptr, &pidSize, &processId) != noErr) {
+            processId = 0;
+        }
+        nextIds_[i] = processId;
+    }
+    processObjects_.swap(nextObjects_);
+    processIds_.swap(nextIds_);
+
+    for (size_t i = 0; i < processObjects_.size(); i++) {
+        if (processIds_[i] <= 0) continue;
+
+        AudioSession session;
+        session.processId = static_cast<uint32_t>(processIds_[i]);
+        session.isActive = true;
+        session.isMuted = false;
+        if (captureDevice_ != kNoDevice && FlagProperty(processObjects_[i], kAudioProcessPropertyIsRunningInput)) {
+            session.deviceIndex = captureDevice_;
+            sessions.push_back(session);
+        }
+        if (renderDevice_ != kNoDevice && FlagProperty(processObjects_[i], kAudioProcessPropertyIsRunningOutput)) {
+            session.deviceIndex = renderDevice_;
+            sessions.push_back(session);
+        }
+    }
+    return true;
+}
+
+std::string CoreAudioContextBackend::ResolveProcessPath(uint32_t processId) {
+    char path[PROC_PIDPATHINFO_MAXSIZE];
+    if (proc_pidpath(static_cast<int>(processId), path, sizeof(path)) <= 0) {
+        return "Unknown";
+    }
+    return path;
+}
+
+std::unique_ptr<ContextBackend> CreateAudioContextBackend() {
+    return std::unique_ptr<ContextBackend>(new CoreAudioContextBackend());
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <CoreAudio/CoreAudio.h>
+#include <sys/types.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../common/AudioContext.h"
+
+// ContextBackend over CoreAudio's process objects (macOS 14.2 and later).
+// The devices are the default input and output device, and each process
+// object that is running input or output has a session on the matching one,
+// since CoreAudio reports IO per process rather than per device. The process
+// object list and the PIDs read for it go into buffers kept between queries;
+// a hardware listener moves the topology version when a device comes or goes
+// or a default changes.
+class CoreAudioContextBackend : public ContextBackend {
+public:
+    CoreAudioContextBackend();
+    ~CoreAudioContextBackend() override;
+
+    uint64_t TopologyVersion() override;
+    bool OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) override;
+    bool ReadSessions(std::vector<AudioSession>& sessions, long& errorCode, std::string& errorMessage) override;
+    std::string ResolveProcessPath(uint32_t processId) override;
+
+private:
+    static OSStatus OnHardwareChanged(AudioObjectID objectId, UInt32 addressCount,
+                                      const AudioObjectPropertyAddress* addresses, void* clientData);
+
+    bool OpenDefault(AudioObjectPropertySelector selector, AudioDirection direction,
+                     std::vector<AudioDevice>& devices);
+
+    static const size_t kNoDevice = static_cast<size_t>(-1);
+
+    std::atomic<uint64_t> version_;
+    size_t captureDevice_;  // Index of the opened input device, or kNoDevice
+    size_t renderDevice_;
+    std::vector<AudioObjectID> processObjects_;
+    std::vector<pid_t> processIds_;  // Parallel to processObjects_
+    std::vector<AudioObjectID> nextObjects_;
+    std::vector<pid_t> nextIds_;
+};
+
+std::unique_ptr<ContextBackend> CreateAudioContextBackend();
@@ -6,6 +6,10 @@ NS_ASSUME_NONNULL_BEGIN
 
 static const NSInteger INFO_ERROR_CODE = 1;
 
+// userInfo key on the info message sent after the listener moved to a new
+// default input: milliseconds from the change to the listener being re-armed
+static NSString * const MicrophoneUsageMonitorRearmMsKey = @"rearmMs";
+
 @interface MicrophoneUsageMonitor : NSObject
 
 - (void)startMonitoring:(void (^)(BOOL microphoneActive, NSError * _Nullable error))completion;
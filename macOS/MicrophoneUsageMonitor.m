@@ -2,11 +2,26 @@
 
 static NSString * const errorDomain = @"com.MicrophoneUsageMonitor";
 
+// After the default input changes, the new device is often not published
+// yet (unplug, Bluetooth reconnect), so re-arming retries briefly instead of
+// waiting a fixed time
+static const double kRearmRetryDelay = 0.05;
+static const NSUInteger kMaxRearmAttempts = 40;
+
+// Tags each monitor's listenerQueue with the monitor, so it can tell when it
+// is already running there
+static void *kListenerQueueKey = &kListenerQueueKey;
+
 @interface MicrophoneUsageMonitor ()
 
 @property (nonatomic, assign) AudioDeviceID micDeviceID;
 @property (nonatomic, copy) void (^callback)(UInt32 inNumberAddresses, const AudioObjectPropertyAddress *inAddresses);
 @property (nonatomic, copy) void (^storedCompletion)(BOOL microphoneActive, NSError * _Nullable error);
+@property (nonatomic, copy) void (^defaultDeviceCallback)(UInt32 inNumberAddresses, const AudioObjectPropertyAddress *inAddresses);
+@property (nonatomic, strong) dispatch_queue_t listenerQueue;
+// Only read or written on listenerQueue, so stopping is ordered against
+// every queued callback and re-arm
+@property (nonatomic, assign) BOOL monitoring;
 
 - (AudioDeviceID)getDefaultInputDeviceIDWithError:(NSError **) error;
 
@@ -32,16 +47,68 @@ static AudioObjectPropertyAddress defaultInputDeviceAddress = (AudioObjectProper
 
 @implementation MicrophoneUsageMonitor {}
 
-- (void)restartMonitoring {
-  [self cleanup];
+- (instancetype)init {
+  self = [super init];
+  if (self) {
+    // Serial, so a device change never overlaps a state callback
+    _listenerQueue = dispatch_queue_create("com.MicrophoneUsageMonitor.listener", DISPATCH_QUEUE_SERIAL);
+    dispatch_queue_set_specific(_listenerQueue, kListenerQueueKey, (__bridge void *)self, NULL);
+  }
+  return self;
+}
+
+// Runs block on listenerQueue and waits for it, or runs it right away when
+// already there (e.g. dealloc after the last reference went in a callback)
+- (void)performOnListenerQueue:(dispatch_block_t)block {
+  if (dispatch_get_specific(kListenerQueueKey) == (__bridge void *)self) {
+    block();
+  } else {
+    dispatch_sync(self.listenerQueue, block);
+  }
+}
+
+// Moves the running-state listener to the new default input as soon as it
+// is published. Nothing is torn down if the default did not actually change.
+- (void)rearmMonitoringAttempt:(NSUInteger)attempt detectedAt:(CFAbsoluteTime)detectedAt {
+  if (!self.monitoring) return;
+
+  NSError *error = nil;
+  AudioDeviceID newDeviceID = [self getDefaultInputDeviceIDWithError:&error];
+
+  if (error || newDeviceID == kAudioObjectUnknown) {
+    if (attempt < kMaxRearmAttempts) {
+      __weak typeof(self) weakSelf = self;
+      dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(kRearmRetryDelay * NSEC_PER_SEC)),
+                     self.listenerQueue, ^{
+        [weakSelf rearmMonitoringAttempt:attempt + 1 detectedAt:detectedAt];
+      });
+      return;
+    }
+    self.storedCompletion(NO, error ?: [self makeErrorWithCode:kAudioHardwareBadDeviceError
+                                                       message:@"No default input device"]);
+    return;
+  }
+
+  if (newDeviceID == self.micDeviceID && self.callback) return;
 
-  self.storedCompletion(NO, [self makeInfoErrorWithMessage: @"Waiting to restart monitoring..."]);
-  dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(3.0 * NSEC_PER_SEC)),
-                 dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-       self.storedCompletion(NO, [self makeInfoErrorWithMessage: @"✅ Restarting monitoring"]);
-       [self startMonitoringInternal:self.storedCompletion];
-   });
+  [self cleanup];
+  [self startMonitoringInternal:self.storedCompletion];
+
+  double rearmMs = (CFAbsoluteTimeGetCurrent() - detectedAt) * 1000.0;
+  NSString *message = [NSString stringWithFormat:@"✅ Re-armed monitoring on micDeviceID: %u in %.1f ms",
+                                                 self.micDeviceID, rearmMs];
+  self.storedCompletion(NO, [NSError errorWithDomain:errorDomain
+                                                code:INFO_ERROR_CODE
+                                            userInfo:@{NSLocalizedDescriptionKey: message,
+                                                       MicrophoneUsageMonitorRearmMsKey: @(rearmMs)}]);
+
+  // The new device may already be in use
+  UInt32 isRunning = 0;
+  UInt32 size = sizeof(UInt32);
+  if (AudioObjectGetPropertyData(self.micDeviceID, &micPropertyAddress, 0, NULL, &size, &isRunning) == noErr) {
+    self.storedCompletion((BOOL)isRunning, nil);
   }
+}
 
 -(void)startMonitoringInternal:(void (^)(BOOL microphoneActive, NSError * _Nullable error))completion {
 
@@ -57,7 +124,7 @@ static AudioObjectPropertyAddress defaultInputDeviceAddress = (AudioObjectProper
 
   OSStatus addStatus = AudioObjectAddPropertyListenerBlock(self.micDeviceID,
                                     &micPropertyAddress,
-                                    dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                                    self.listenerQueue,
                                     self.callback);
 
   if (addStatus != noErr) {
@@ -68,6 +135,9 @@ static AudioObjectPropertyAddress defaultInputDeviceAddress = (AudioObjectProper
 
 - (void)startMonitoring:(void (^)(BOOL microphoneActive, NSError * _Nullable error))completion {
   self.storedCompletion = completion;
+  [self performOnListenerQueue:^{
+    self.monitoring = YES;
+  }];
 
   NSError *error = nil;
   self.micDeviceID = [self getDefaultInputDeviceIDWithError:&error];
@@ -77,12 +147,14 @@ static AudioObjectPropertyAddress defaultInputDeviceAddress = (AudioObjectProper
     return;
   }
 
+  self.defaultDeviceCallback = [self createMicrophoneCallback];
   OSStatus microphoneAddressStatus = AudioObjectAddPropertyListenerBlock(kAudioObjectSystemObject,
                                                          &defaultInputDeviceAddress,
-                                                         dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
-                                                         [self createMicrophoneCallback]);
+                                                         self.listenerQueue,
+                                                         self.defaultDeviceCallback);
 
   if (microphoneAddressStatus != noErr) {
+    self.defaultDeviceCallback = nil;
     completion(NO, [self makeErrorWithCode:microphoneAddressStatus message:@"Error in AudioObjectAddPropertyListenerBlock"]);
     return;
   }
@@ -138,7 +210,7 @@ static AudioObjectPropertyAddress defaultInputDeviceAddress = (AudioObjectProper
     __strong typeof(weakSelf) strongSelf = weakSelf;
     if (!strongSelf) return;
 
-    [strongSelf restartMonitoring];
+    [strongSelf rearmMonitoringAttempt:0 detectedAt:CFAbsoluteTimeGetCurrent()];
   };
 }
 
@@ -191,13 +263,30 @@ static AudioObjectPropertyAddress defaultInputDeviceAddress = (AudioObjectProper
     self.storedCompletion(NO, [self makeInfoErrorWithMessage: message]);
     AudioObjectRemovePropertyListenerBlock(self.micDeviceID,
                                          &micPropertyAddress,
-                                         dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                                         self.listenerQueue,
                                          self.callback);
     self.callback = nil;
   }
 }
 
 - (void)stopMonitoring {
+  // Unretained: this also runs from dealloc, and the block is done before
+  // performOnListenerQueue returns
+  __unsafe_unretained typeof(self) unsafeSelf = self;
+  [self performOnListenerQueue:^{
+    [unsafeSelf stopMonitoringOnListenerQueue];
+  }];
+}
+
+- (void)stopMonitoringOnListenerQueue {
+  self.monitoring = NO;
+  if (self.defaultDeviceCallback) {
+    AudioObjectRemovePropertyListenerBlock(kAudioObjectSystemObject,
+                                         &defaultInputDeviceAddress,
+                                         self.listenerQueue,
+                                         self.defaultDeviceCallback);
+    self.defaultDeviceCallback = nil;
+  }
   [self cleanup];
 }
 
@@ -2,10 +2,22 @@
 #import <Foundation/Foundation.h>
 #import "AudioProcessMonitor.h"
 #import "MicrophoneUsageMonitor.h"
+#include "CoreAudioContextBackend.h"
 #include <napi.h>
-
-static MicrophoneUsageMonitor *monitor = nil;
-static Napi::ThreadSafeFunction ts_fn;
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../common/AddonInstance.h"
+#include "../common/AsyncSnapshot.h"
+#include "../common/AudioContextBinding.h"
+#include "../common/ColumnarResult.h"
+#include "../common/LevelMeterBinding.h"
+#include "../common/MonitorHubBinding.h"
+#include "../common/NativeStatsBinding.h"
+#include "../common/ProcessFilterBinding.h"
+#include "../common/ResultMarshal.h"
+#include "../common/SharedResource.h"
+#include "../common/WatchAudioProcesses.h"
 
 // Takes the output of BrowserWindow.getNativeWindowHandle
 // (which is a NSView* to the contentView of the window),
@@ -19,177 +31,393 @@ void MakeKeyAndOrderFront(const Napi::CallbackInfo &info) {
   [[contentView window] makeKeyAndOrderFront:nil];
 }
 
-// Gets a list of processes that are accessing input (microphone) - original interface
-Napi::Value GetRunningInputAudioProcesses(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-
-  NSError *error = nil;
-  NSArray<NSString *> *processes = [AudioProcessMonitor getRunningInputAudioProcesses:&error];
+// Plain C++ copy of an AudioProcessResult, so it can be produced on a worker
+// thread and marshaled later without holding on to Objective-C objects
+struct MicrophoneSnapshot {
+  std::vector<std::string> processes;
+  std::string errorMessage;
+  std::string errorDomain;
+  long errorCode;
+  bool success;
+
+  MicrophoneSnapshot() : errorCode(0), success(true) {}
+};
+
+static std::vector<std::string> TakeInputProcessList() {
+  std::vector<std::string> processes;
+  bool succeeded = false;
+  StatsCallScope call(StatsCall::RunningInputProcesses, &succeeded);
+  @autoreleasepool {
+    NSError *error = nil;
+    NSArray<NSString *> *running = [AudioProcessMonitor getRunningInputAudioProcesses:&error];
+    succeeded = error == nil;
+    for (NSString *process in running) {
+      processes.push_back([process UTF8String]);
+    }
+  }
+  return processes;
+}
 
-  Napi::Array result = Napi::Array::New(env);
-  for (NSUInteger i = 0; i < [processes count]; i++) {
-    NSString *process = [processes objectAtIndex:i];
-    result.Set(i, Napi::String::New(env, [process UTF8String]));
+static MicrophoneSnapshot TakeMicrophoneSnapshot() {
+  MicrophoneSnapshot snapshot;
+  StatsCallScope call(StatsCall::MicrophoneProcesses, &snapshot.success);
+  @autoreleasepool {
+    struct AudioProcessResult result = [AudioProcessMonitor getProcessesAccessingMicrophoneWithResult];
+    snapshot.success = result.success;
+    if (!result.success) {
+      snapshot.errorMessage = [result.error.localizedDescription UTF8String];
+      snapshot.errorDomain = [result.error.domain UTF8String];
+      snapshot.errorCode = result.error.code;
+    } else {
+      for (NSString *process in result.processes) {
+        snapshot.processes.push_back([process UTF8String]);
+      }
+    }
   }
+  return snapshot;
+}
 
-  return result;
+// CoreAudio only hands back bundle IDs of the default input device's
+// clients, so a filter runs after the query: PID filters never match, and
+// device filters match the name getAudioSnapshot() reports
+static void FilterBundleIDs(const ProcessFilter* filter, std::vector<std::string>& processes) {
+  if (!filter) return;
+  StatsStageScope stage(PipelineStage::Filter);
+  processes.erase(std::remove_if(processes.begin(), processes.end(),
+                                 [filter](const std::string& bundleID) {
+                                   return !filter->MatchesSession(0, "Default input device", AudioDirection::Capture) ||
+                                          !filter->MatchesPath(bundleID);
+                                 }),
+                  processes.end());
 }
 
-// Gets processes accessing microphone with structured result
-Napi::Value GetProcessesAccessingMicrophoneWithResult(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
+static std::vector<std::string> TakeInputProcessList(const ProcessFilter* filter) {
+  std::vector<std::string> processes = TakeInputProcessList();
+  FilterBundleIDs(filter, processes);
+  return processes;
+}
+
+static MicrophoneSnapshot TakeMicrophoneSnapshot(const ProcessFilter* filter) {
+  MicrophoneSnapshot snapshot = TakeMicrophoneSnapshot();
+  FilterBundleIDs(filter, snapshot.processes);
+  return snapshot;
+}
+
+// CoreAudio only reports which bundles use the default input device, so each
+// record is a capture-only bundle ID without a PID
+static ProcessAudioSnapshot TakeAudioSnapshot(const ProcessFilter* filter) {
+  ProcessAudioSnapshot snapshot;
+  StatsCallScope call(StatsCall::AudioSnapshot, &snapshot.success);
+  MicrophoneSnapshot microphone = TakeMicrophoneSnapshot();
+  if (!microphone.success) {
+    snapshot.success = false;
+    snapshot.errorCode = microphone.errorCode;
+    snapshot.errorMessage = microphone.errorMessage;
+    return snapshot;
+  }
+  FilterBundleIDs(filter, microphone.processes);
+
+  for (size_t i = 0; i < microphone.processes.size(); i++) {
+    const std::string& bundleID = microphone.processes[i];
+    ProcessDeviceUse use;
+    use.deviceId = "default";
+    use.deviceName = "Default input device";
+    use.direction = AudioDirection::Capture;
+    use.isActive = true;
+    use.isMuted = false;
+    use.firstActiveSession = i;
+    use.firstAudibleSession = i;
+
+    ProcessAudioRecord record;
+    record.processId = 0;
+    record.path = bundleID;
+    record.capture = true;
+    record.render = false;
+    record.isActive = true;
+    record.isMuted = false;
+    record.devices.push_back(use);
+    snapshot.processes.push_back(record);
+  }
+  return snapshot;
+}
 
-  struct AudioProcessResult result = [AudioProcessMonitor getProcessesAccessingMicrophoneWithResult];
+static ProcessAudioSnapshot TakeAudioSnapshot() {
+  return TakeAudioSnapshot(nullptr);
+}
 
-  // Create a JavaScript object to represent the AudioProcessResult
+// Create a JavaScript object to represent the AudioProcessResult
+static Napi::Value MicrophoneSnapshotToObject(Napi::Env env, const MicrophoneSnapshot& snapshot) {
   Napi::Object resultObj = Napi::Object::New(env);
-  if (!result.success) {
+  if (!snapshot.success) {
     // Set error information
     resultObj.Set("success", Napi::Boolean::New(env, false));
-    resultObj.Set("error", Napi::String::New(env, [result.error.localizedDescription UTF8String]));
-    resultObj.Set("code", Napi::Number::New(env, result.error.code));
-    resultObj.Set("domain", Napi::String::New(env, [result.error.domain UTF8String]));
+    resultObj.Set("error", Napi::String::New(env, snapshot.errorMessage));
+    resultObj.Set("code", Napi::Number::New(env, snapshot.errorCode));
+    resultObj.Set("domain", Napi::String::New(env, snapshot.errorDomain));
     resultObj.Set("processes", Napi::Array::New(env));
   } else {
     // Set success information
     resultObj.Set("success", Napi::Boolean::New(env, true));
     resultObj.Set("error", env.Null());
-
-    // Convert processes array
-    Napi::Array processesArray = Napi::Array::New(env);
-    for (NSUInteger i = 0; i < [result.processes count]; i++) {
-        NSString *process = [result.processes objectAtIndex:i];
-        processesArray.Set(i, Napi::String::New(env, [process UTF8String]));
-    }
-    resultObj.Set("processes", processesArray);
+    resultObj.Set("processes", ProcessListToArray(env, snapshot.processes));
   }
 
   return resultObj;
 }
 
-// Start monitoring microphone usage
-Napi::Value StartMonitoringMic(const Napi::CallbackInfo& info) {
-  Napi::Env env = info.Env();
-  Napi::HandleScope scope(env);
+// Gets a list of processes that are accessing input (microphone) - original interface.
+// Every enumeration call takes { filter }; see ProcessFilterBinding.h.
+Napi::Value GetRunningInputAudioProcesses(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
 
-  if (info.Length() < 1 || !info[0].IsFunction()) {
-    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
-    return env.Null();
+  std::vector<std::string> processes = TakeInputProcessList(filter.get());
+  StatsStageScope marshal(PipelineStage::Marshal);
+  return ProcessListToArray(info.Env(), processes);
+}
+
+// Gets processes accessing microphone with structured result
+Napi::Value GetProcessesAccessingMicrophoneWithResult(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+
+  MicrophoneSnapshot snapshot = TakeMicrophoneSnapshot(filter.get());
+  StatsStageScope marshal(PipelineStage::Marshal);
+  return MicrophoneSnapshotToObject(info.Env(), snapshot);
+}
+
+// Capture processes for AudioProcessWatcher; render detection is Windows-only
+static bool GetWatchedProcesses(WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage) {
+  MicrophoneSnapshot microphone;
+  StatsCallScope call(StatsCall::WatchPoll, &microphone.success);
+  microphone = TakeMicrophoneSnapshot();
+  if (!microphone.success) {
+    errorCode = microphone.errorCode;
+    errorMessage = microphone.errorMessage;
+    return false;
   }
 
-  @try {
-    ts_fn = Napi::ThreadSafeFunction::New(
-      env,
-      info[0].As<Napi::Function>(),
-      "MicListener",
-      0,
-      1,
-      []( Napi::Env ) {
-        // clean up any resources allocated and passed to the callback 
-        // In our case the micState bool is deallocated in the callback 
-      }
-    );
-
-    // Create and start the monitor
-    monitor = [[MicrophoneUsageMonitor alloc] init];
-    [monitor startMonitoring:^(BOOL microphoneActive, NSError *error) {
-      // Define a struct to hold both the boolean and error
-      struct CallbackData {
-        bool micActive;
-        NSError* error;
-
-        CallbackData(bool active, NSError* err) : micActive(active), error([err retain]) {}
-        ~CallbackData() {
-          if (error) {
-            [error release];
-          }
-        }
-      };
+  for (const std::string& bundleID : microphone.processes) {
+    WatchedProcess process;
+    process.processId = 0;
+    process.processName = bundleID;
+    snapshot.capture.push_back(process);
+  }
+  return true;
+}
 
-      auto callback = [](Napi::Env env, Napi::Function js_callback, void* data) {
+// Watches capture processes, calling back with {added, removed} batches only
+// when something changed
+Napi::Value WatchAudioProcesses(const Napi::CallbackInfo& info) {
+  return StartAudioProcessWatch(info, GetWatchedProcesses);
+}
 
-        if (!data) {
-          NSLog(@"🎤 Error: data is null");
-          return;
+// MonitorSource backed by a MicrophoneUsageMonitor. CoreAudio reports the
+// default input device only, so every device ID maps to the same listener.
+class MicrophoneUsageMonitorSource : public MonitorSource {
+public:
+  MicrophoneUsageMonitorSource() : monitor_(nil) {}
+  ~MicrophoneUsageMonitorSource() override { Stop(); }
+
+  // Start errors are delivered through the sink, as startMonitoringMic always did
+  bool Start(const std::string& deviceId, EventSink sink, MonitorEvent& error) override {
+    std::string device = deviceId;  // Copied into the block; references are not
+    @try {
+      monitor_ = [[MicrophoneUsageMonitor alloc] init];
+      [monitor_ startMonitoring:^(BOOL microphoneActive, NSError *error) {
+        MonitorEvent event;
+        event.deviceId = device;
+        event.deviceName = "Default input device";
+        event.active = microphoneActive;
+        if (error != nil) {
+          NSString* errorDesc = [error localizedDescription];
+          event.hasError = true;
+          event.errorCode = static_cast<long>(error.code);
+          event.errorDomain = error.domain != nil ? [error.domain UTF8String] : "";
+          event.errorMessage = errorDesc != nil ? [errorDesc UTF8String] : "Unknown error occurred";
+          NSNumber* rearmMs = error.userInfo[MicrophoneUsageMonitorRearmMsKey];
+          if (rearmMs != nil) event.rearmMs = [rearmMs doubleValue];
         }
+        sink(event);
+      }];
+      return true;
+    } @catch (NSException *exception) {
+      error.deviceId = deviceId;
+      error.hasError = true;
+      error.errorDomain = "com.MicrophoneUsageMonitor";
+      error.errorMessage = "Exception occurred while starting monitoring";
+      Stop();
+      return false;
+    }
+  }
 
-        // Cast the void* back to our CallbackData struct
-        CallbackData* cbData = static_cast<CallbackData*>(data);
+  void Stop() override {
+    if (monitor_) {
+      [monitor_ stopMonitoring];
+      [monitor_ release];
+      monitor_ = nil;
+    }
+  }
 
-        if (!cbData) {
-          NSLog(@"🎤 Error: cbData is null after cast");
-          return;
-        }
+private:
+  MicrophoneUsageMonitor *monitor_;  // Owned; this file is built without ARC
+};
+
+// One CoreAudio listener shared by every subscriber in every env, and
+// removed once the last env using it exits
+static SharedResource<MonitorHub> microphoneHub([]() {
+  return new MonitorHub([]() {
+    return std::unique_ptr<MonitorSource>(new MicrophoneUsageMonitorSource());
+  });
+});
+
+// Per-env state; see AddonInstance.h
+struct MacAddon : public AddonInstance {
+  // Promise-returning variants. Each scan runs on the libuv worker pool, and
+  // concurrent callers in this env share whichever scan is already in flight.
+  AsyncSnapshot<std::vector<std::string>> inputProcessesSnapshot;
+  AsyncSnapshot<MicrophoneSnapshot> microphoneSnapshot;
+  AsyncSnapshot<ProcessAudioSnapshot> audioSnapshot;
+
+  // Subscriptions made through startMonitoringMic, all removed by stopMonitoringMic
+  std::vector<std::shared_ptr<HubSubscription>> legacySubscriptions;
+
+  // Columnar render results are always empty, but keep the version protocol
+  StringTable renderStringTable;
+
+  MacAddon()
+    : AddonInstance(microphoneHub.Acquire()),
+      inputProcessesSnapshot("GetRunningInputAudioProcesses", TakeInputProcessList, ProcessListToArray),
+      microphoneSnapshot("GetProcessesAccessingMicrophoneWithResult", TakeMicrophoneSnapshot,
+                         MicrophoneSnapshotToObject),
+      audioSnapshot("GetAudioSnapshot", TakeAudioSnapshot, ProcessAudioSnapshotToObject) {}
+
+  static MacAddon& Of(Napi::Env env) {
+    return static_cast<MacAddon&>(AddonInstance::Of(env));
+  }
+};
 
-        if (cbData->error != nil) {
-          NSString* errorDesc = [cbData->error localizedDescription];
-          const char* errorStr = nil;
-
-          if (errorDesc != nil) {
-            errorStr = [errorDesc UTF8String];
-          }
-
-          Napi::Error err;
-          if (errorStr != nil) {
-            err = Napi::Error::New(env, errorStr);
-          } else {
-            err = Napi::Error::New(env, "Unknown error occurred");
-          }
-          err.Set("code", Napi::Number::New(env, cbData->error.code));
-          err.Set("domain", Napi::String::New(env, [cbData->error.domain UTF8String]));
-
-          js_callback.Call({ Napi::Boolean::New(env, cbData->micActive), err.Value() });
-        } else {
-          js_callback.Call({Napi::Boolean::New(env, cbData->micActive), env.Null()});
-        }
+// Promise variants; they take the same { filter } as the calls above
+Napi::Value GetRunningInputAudioProcessesAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return MacAddon::Of(info.Env()).inputProcessesSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetProcessesAccessingMicrophoneWithResultAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return MacAddon::Of(info.Env()).microphoneSnapshot.Request(info.Env(), filter);
+}
+
+// Microphone bundle IDs as getAudioSnapshot() records
+Napi::Value GetAudioSnapshot(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
 
-        // Clean up
-        delete cbData;
-      };
+  ProcessAudioSnapshot snapshot = TakeAudioSnapshot(filter.get());
+  StatsStageScope marshal(PipelineStage::Marshal);
+  return ProcessAudioSnapshotToObject(info.Env(), snapshot);
+}
+
+Napi::Value GetAudioSnapshotAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return MacAddon::Of(info.Env()).audioSnapshot.Request(info.Env(), filter);
+}
 
-      // Create and pass the data to BlockingCall
-      CallbackData* data = new CallbackData{static_cast<bool>(microphoneActive), error};
+// Streams input levels from a WAV file; see LevelMeterBinding.h. Device
+// capture is not implemented on macOS yet.
+Napi::Value StartInputLevelMeter(const Napi::CallbackInfo& info) {
+  return StartLevelMeter(info, nullptr);
+}
 
-      ts_fn.BlockingCall(data, callback);
-    }];
+// Long-lived session context; see AudioContextBinding.h. Unlike the
+// bundle-ID calls it reports PIDs and paths, of processes doing IO on the
+// default input and output devices.
+Napi::Value CreateMacAudioContext(const Napi::CallbackInfo& info) {
+  return CreateAudioContext(info, CreateAudioContextBackend);
+}
 
-    return Napi::Boolean::New(env, true);
-  } @catch (NSException *exception) {
-    Napi::Error::New(env, "Exception occurred while starting monitoring").ThrowAsJavaScriptException();
+// Subscribes to microphone state changes; see MonitorHubBinding.h
+Napi::Value SubscribeMicrophone(const Napi::CallbackInfo& info) {
+  return SubscribeToHub(info);
+}
+
+// Start monitoring microphone usage. Each call adds a subscriber to the
+// shared listener instead of replacing the previous one.
+Napi::Value StartMonitoringMic(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::HandleScope scope(env);
+
+  if (info.Length() < 1 || !info[0].IsFunction()) {
+    Napi::TypeError::New(env, "Expected a callback function").ThrowAsJavaScriptException();
     return env.Null();
   }
+
+  std::shared_ptr<HubSubscription> subscription =
+      AddHubSubscription(env, MacAddon::Of(env), "default", MonitorFilter(), kDefaultQueueSize,
+                         info[0].As<Napi::Function>());
+  if (!subscription) return env.Null();
+
+  MacAddon::Of(env).legacySubscriptions.push_back(subscription);
+  return Napi::Boolean::New(env, true);
 }
 
 // Stop monitoring microphone usage
 Napi::Value StopMonitoringMic(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
+  MacAddon& addon = MacAddon::Of(env);
 
-  if (monitor) {
-    [monitor stopMonitoring];
-    monitor = nil;
-  }
-
-  if (ts_fn) {
-    ts_fn.Release();
+  for (auto& subscription : addon.legacySubscriptions) {
+    subscription->Unsubscribe();
   }
+  addon.legacySubscriptions.clear();
 
   return env.Undefined();
 }
 
+// Empty render result, so both shapes match Windows. Local to this file:
+// common/AudioResults.h would clash with the Objective-C AudioProcessResult.
+struct EmptyRenderProcessInfo {
+  std::string processName;
+  uint32_t processId;
+  std::string deviceName;
+  bool isActive;
+};
+
+struct EmptyRenderProcessResult {
+  std::vector<EmptyRenderProcessInfo> processes;
+  long errorCode;
+  std::string errorMessage;
+  bool success;
+
+  EmptyRenderProcessResult() : errorCode(0), success(true) {}
+};
+
 // No-op implementation for getRenderProcessesWithResult (Windows-only feature)
 Napi::Value GetRenderProcessesWithResult(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  // Return same structure as Windows version for consistency
-  Napi::Object resultObj = Napi::Object::New(env);
-  resultObj.Set("success", Napi::Boolean::New(env, true));
-  resultObj.Set("error", env.Null());
-  resultObj.Set("processes", Napi::Array::New(env));
+  EmptyRenderProcessResult result;
+  uint32_t knownVersion = 0;
+  if (ParseColumnarOptions(info, knownVersion)) {
+    return RenderProcessResultToColumns(env, result, MacAddon::Of(env).renderStringTable, knownVersion);
+  }
+  return RenderProcessResultToObject(env, result);
+}
 
-  return resultObj;
+// No-op implementation for getRenderProcessesWithResultAsync (Windows-only feature)
+Napi::Value GetRenderProcessesWithResultAsync(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+  deferred.Resolve(GetRenderProcessesWithResult(info));
+  return deferred.Promise();
 }
 
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  AddonInstance::Install(env, new MacAddon());
+
   exports.Set(Napi::String::New(env, "makeKeyAndOrderFront"),
               Napi::Function::New(env, MakeKeyAndOrderFront));
 
@@ -205,9 +433,51 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set(Napi::String::New(env, "stopMonitoringMic"),
               Napi::Function::New(env, StopMonitoringMic));
 
+  exports.Set(Napi::String::New(env, "startLevelMeter"),
+              Napi::Function::New(env, StartInputLevelMeter));
+
+  exports.Set(Napi::String::New(env, "measureLevel"),
+              Napi::Function::New(env, MeasureLevel));
+
+  exports.Set(Napi::String::New(env, "subscribeMicrophone"),
+              Napi::Function::New(env, SubscribeMicrophone));
+
   exports.Set(Napi::String::New(env, "getProcessesAccessingSpeakersWithResult"),
               Napi::Function::New(env, GetRenderProcessesWithResult));
 
+  exports.Set(Napi::String::New(env, "watchAudioProcesses"),
+              Napi::Function::New(env, WatchAudioProcesses));
+
+  exports.Set(Napi::String::New(env, "getRunningInputAudioProcessesAsync"),
+              Napi::Function::New(env, GetRunningInputAudioProcessesAsync));
+
+  exports.Set(Napi::String::New(env, "getProcessesAccessingMicrophoneWithResultAsync"),
+              Napi::Function::New(env, GetProcessesAccessingMicrophoneWithResultAsync));
+
+  exports.Set(Napi::String::New(env, "getProcessesAccessingSpeakersWithResultAsync"),
+              Napi::Function::New(env, GetRenderProcessesWithResultAsync));
+
+  exports.Set(Napi::String::New(env, "getAudioSnapshot"),
+              Napi::Function::New(env, GetAudioSnapshot));
+
+  exports.Set(Napi::String::New(env, "getAudioSnapshotAsync"),
+              Napi::Function::New(env, GetAudioSnapshotAsync));
+
+  exports.Set(Napi::String::New(env, "getStats"),
+              Napi::Function::New(env, GetStats));
+
+  exports.Set(Napi::String::New(env, "resetStats"),
+              Napi::Function::New(env, ResetStats));
+
+  exports.Set(Napi::String::New(env, "getInstanceStats"),
+              Napi::Function::New(env, GetInstanceStats));
+
+  exports.Set(Napi::String::New(env, "createProcessFilter"),
+              Napi::Function::New(env, CreateProcessFilter));
+
+  exports.Set(Napi::String::New(env, "createAudioContext"),
+              Napi::Function::New(env, CreateMacAudioContext));
+
   return exports;
 }
 
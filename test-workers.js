@@ -0,0 +1,122 @@
+/**
+ * Stress test for loading the addon in several worker_threads at once.
+ *
+ * Every worker loads its own instance of the addon and hammers it with
+ * sync, async, watch and subscribe calls while the main thread does the
+ * same. Half of the workers are terminated with a watch and a subscription
+ * still open, so their env cleanup hooks have to tear them down. Afterwards
+ * the main thread checks that only its own instance is left and that the
+ * shared microphone hub has no listeners or subscribers.
+ *
+ * Usage: node test-workers.js [--workers N] [--duration-ms MS]
+ */
+
+const { Worker, isMainThread, parentPort, workerData } = require('worker_threads');
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+// Windows only monitors the default device
+const deviceId = process.platform === 'linux' ? '*' : 'default';
+
+async function hammer(utils, durationMs, leaveOpen) {
+  const deadline = Date.now() + durationMs;
+  let rounds = 0;
+
+  while (Date.now() < deadline) {
+    utils.getRunningInputAudioProcesses();
+    utils.getProcessesAccessingMicrophoneWithResult();
+    utils.getProcessesAccessingSpeakersWithResult({ columnar: true });
+    await Promise.all([
+      utils.getRunningInputAudioProcessesAsync(),
+      utils.getProcessesAccessingMicrophoneWithResultAsync(),
+      utils.getProcessesAccessingSpeakersWithResultAsync(),
+    ]);
+
+    const watch = utils.watchAudioProcesses({ intervalMs: 20 }, () => {});
+    const subscription = utils.subscribeMicrophone({ deviceId }, () => {});
+    await sleep(10);
+    subscription.unsubscribe();
+    watch.stop();
+    rounds++;
+  }
+
+  if (leaveOpen) {
+    // Left for the env cleanup hook
+    utils.watchAudioProcesses({ intervalMs: 20 }, () => {});
+    utils.subscribeMicrophone({ deviceId }, () => {});
+  }
+  return rounds;
+}
+
+if (!isMainThread) {
+  const utils = require('./index.js');
+  hammer(utils, workerData.durationMs, workerData.leaveOpen).then((rounds) => {
+    parentPort.postMessage({ rounds, stats: utils.getInstanceStats() });
+    if (workerData.leaveOpen) {
+      // Keep the loop alive until the main thread terminates this worker
+      setInterval(() => {}, 1000);
+    }
+  });
+} else {
+  const args = {};
+  const argv = process.argv.slice(2);
+  for (let i = 0; i < argv.length; i += 2) {
+    args[argv[i].replace(/^--/, '')] = Number(argv[i + 1]);
+  }
+  const workerCount = args.workers || 8;
+  const durationMs = args['duration-ms'] || 3000;
+
+  const utils = require('./index.js');
+
+  async function run() {
+    console.log(`Running ${workerCount} workers for ${durationMs} ms on ${process.platform}`);
+    let failed = false;
+
+    const workers = Array.from({ length: workerCount }, (_, index) => {
+      const leaveOpen = index % 2 === 1;
+      const worker = new Worker(__filename, { workerData: { durationMs, leaveOpen } });
+      const exited = new Promise((done) => worker.once('exit', done));
+      return new Promise((resolve, reject) => {
+        worker.once('error', reject);
+        worker.once('message', async (message) => {
+          const expectedHandles = leaveOpen ? 2 : 0;
+          if (message.stats.openHandles !== expectedHandles) {
+            console.error(`  worker ${index}: ${message.stats.openHandles} open handles, expected ${expectedHandles}`);
+            failed = true;
+          }
+          if (leaveOpen) {
+            await worker.terminate();
+          }
+          await exited;
+          resolve(message.rounds);
+        });
+      });
+    });
+
+    const mainRounds = hammer(utils, durationMs, false);
+    const rounds = await Promise.all(workers);
+    console.log('Rounds per worker:', rounds, 'main:', await mainRounds);
+
+    // Instance data of exited workers is freed during their teardown
+    await sleep(200);
+    const stats = utils.getInstanceStats();
+    console.log('Main thread instance stats:', stats);
+
+    if (stats.instances !== 1) {
+      console.error(`✗ ${stats.instances} addon instances alive, expected 1`);
+      failed = true;
+    }
+    if (stats.openHandles !== 0 || stats.hubListeners !== 0 || stats.hubSubscribers !== 0) {
+      console.error('✗ Handles or hub listeners survived their env');
+      failed = true;
+    }
+
+    console.log(failed ? '✗ Worker stress test failed' : '✓ Worker stress test passed');
+    process.exit(failed ? 1 : 0);
+  }
+
+  run().catch((error) => {
+    console.error('Test failed:', error);
+    process.exit(1);
+  });
+}
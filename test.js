@@ -5,6 +5,10 @@ const utils = require('./index.js');
 async function runTests() {
     console.log('Running on platform:', process.platform);
     try {
+        // The native module loads on first use; prewarm() loads it and warms the backend off the JS thread
+        console.log('\nTesting prewarm:');
+        console.log('Warm-up:', await utils.prewarm());
+
         // Test original getRunningInputAudioProcesses (returns array)
         console.log('\nTesting getRunningInputAudioProcesses (original):');
         const processes = utils.getRunningInputAudioProcesses();
@@ -37,7 +41,7 @@ async function runTests() {
             console.log('✓ Success - Render processes:', renderResult.processes);
             console.log('  Process count:', renderResult.processes.length);
 
-            if (process.platform === 'win32' && renderResult.processes.length > 0) {
+            if ((process.platform === 'win32' || process.platform === 'linux') && renderResult.processes.length > 0) {
                 console.log('Sample render process structure:');
                 console.log('  processName:', renderResult.processes[0].processName);
                 console.log('  processId:', renderResult.processes[0].processId);
@@ -50,6 +54,29 @@ async function runTests() {
             console.error('  Error domain:', renderResult.domain);
         }
 
+        // Test the single-pass snapshot; one record per process
+        console.log('\nTesting getAudioSnapshot:');
+        const snapshot = utils.getAudioSnapshot();
+        console.log('Result:', JSON.stringify(snapshot, null, 2));
+        if (snapshot.success) {
+            console.log('✓ Success - process records:', snapshot.processes.length);
+        } else {
+            console.error('✗ Error getting audio snapshot:', snapshot.error);
+        }
+
+        // Test native filter pushdown; a compiled filter can be reused
+        console.log('\nTesting createProcessFilter:');
+        const filter = utils.createProcessFilter({ direction: 'capture', names: ['*'] });
+        const filtered = utils.getAudioSnapshot({ filter });
+        console.log('Filtered snapshot records:', filtered.processes.length);
+        console.log('Inline spec result:', utils.getProcessesAccessingSpeakersWithResult({ filter: { processIds: [process.pid] } }));
+        // Requests with different filters run concurrently without sharing a scan
+        const [unfilteredAsync, unusedPidAsync] = await Promise.all([
+            utils.getProcessesAccessingSpeakersWithResultAsync(),
+            utils.getProcessesAccessingSpeakersWithResultAsync({ filter: { processIds: [0xfffffffe] } }),
+        ]);
+        console.log('Async filter:', unusedPidAsync.processes.length === 0 ? 'Applied ✓' : `Ignored (${unusedPidAsync.processes.length} processes)`, '- unfiltered processes:', unfilteredAsync.processes.length);
+
         // Test platform-specific functions
         if (process.platform === 'darwin') {
             console.log('\nTesting Mac-specific functions:');
@@ -62,11 +89,147 @@ async function runTests() {
             console.log('getRunningInputAudioProcesses available:', !!utils.getRunningInputAudioProcesses);
             console.log('getProcessesAccessingMicrophoneWithResult available:', !!utils.getProcessesAccessingMicrophoneWithResult);
             console.log('getProcessesAccessingSpeakersWithResult available:', !!utils.getProcessesAccessingSpeakersWithResult);
+        } else if (process.platform === 'linux') {
+            console.log('\nTesting Linux-specific functions:');
+            console.log('getRunningInputAudioProcesses available:', !!utils.getRunningInputAudioProcesses);
+            console.log('getProcessesAccessingMicrophoneWithResult available:', !!utils.getProcessesAccessingMicrophoneWithResult);
+            console.log('getProcessesAccessingSpeakersWithResult available:', !!utils.getProcessesAccessingSpeakersWithResult);
+            console.log('Capture devices:', utils.getCaptureDevices());
+            console.log('Audio backend:', utils.setAudioBackend());
+            try {
+                console.log('Sound server streams:', utils.getAudioStreams());
+            } catch (error) {
+                console.log('No sound server:', error.message);
+            }
+            console.log('Scan threads in use:', utils.setScanThreads(0));
+            console.log('Application of this process:', utils.getProcessApplication(process.pid));
+            const attributed = utils.getProcessesAccessingSpeakersWithResult({ attribute: true });
+            console.log('Attributed render processes:', attributed.processes.map((p) => [p.processName, p.application]));
+            const usagePath = require('path').join(require('os').tmpdir(), `usage-test-${process.pid}.log`);
+            const usageLog = utils.startUsageLog({ path: usagePath, intervalMs: 100 });
+            await new Promise((resolve) => setTimeout(resolve, 300));
+            const ownedBytes = require('fs').statSync(usagePath).size;
+            try {
+                utils.startUsageLog({ path: usagePath, intervalMs: 100 }).stop();
+                console.log('Second usage log writer: Unexpectedly started');
+            } catch (error) {
+                const intact = require('fs').statSync(usagePath).size >= ownedBytes;
+                console.log('Second usage log writer:', error.code === 16 && intact ? 'Rejected, log intact ✓' : `Unexpected (${error.code}, intact ${intact})`);
+            }
+            usageLog.stop();
+            console.log('Usage log:', usageLog.stats(), utils.queryUsage({ path: usagePath }));
+            require('fs').rmSync(usagePath, { force: true });
         } else {
             console.log('node-mac-utils Unsupported platform:', process.platform);
             console.log('getProcessesAccessingSpeakersWithResult (no-op):', renderResult.success && renderResult.processes.length === 0 ? 'Returns success with empty processes ✓' : 'Unexpected data');
         }
 
+        // The context keeps its devices open between queries on every platform
+        const audioContext = utils.createAudioContext();
+        console.log('\nAudio context query:', audioContext.query());
+        audioContext.query();
+        console.log('Audio context stats after two queries:', audioContext.stats());
+        audioContext.close();
+
+        // Test Promise-returning variants; concurrent callers share one scan
+        console.log('\nTesting async variants:');
+        const asyncStart = process.hrtime.bigint();
+        const asyncResults = await Promise.all(
+            Array.from({ length: 10 }, () => utils.getProcessesAccessingMicrophoneWithResultAsync())
+        );
+        const asyncMs = Number(process.hrtime.bigint() - asyncStart) / 1e6;
+        console.log('10 concurrent microphone requests settled in', asyncMs.toFixed(2), 'ms');
+        console.log('All results agree:', asyncResults.every((r) => JSON.stringify(r) === JSON.stringify(asyncResults[0])));
+        console.log('getRunningInputAudioProcessesAsync:', await utils.getRunningInputAudioProcessesAsync());
+        console.log('getProcessesAccessingSpeakersWithResultAsync:', await utils.getProcessesAccessingSpeakersWithResultAsync());
+
+        // Test delta watcher; the first batch reports everything as added
+        console.log('\nTesting watchAudioProcesses:');
+        const deltas = [];
+        const watch = utils.watchAudioProcesses({ intervalMs: 250 }, (delta, error) => {
+            if (error) {
+                console.error('Watch error:', error.message);
+            } else {
+                deltas.push(delta);
+            }
+        });
+        await new Promise((resolve) => setTimeout(resolve, 1000));
+        watch.stop();
+        console.log('Delta batches received:', deltas.length);
+        deltas.forEach((delta) => console.log('  ', JSON.stringify(delta)));
+
+        // Test level metering on a half-scale 440 Hz sine: about -6 dBFS peak, -9 dBFS RMS
+        console.log('\nTesting measureLevel and startLevelMeter:');
+        const sine = Int16Array.from({ length: 48000 }, (_, i) => Math.round(16384 * Math.sin(2 * Math.PI * 440 * i / 48000)));
+        console.log('measureLevel:', utils.measureLevel(sine));
+        const wav = Buffer.alloc(44 + sine.byteLength);
+        wav.write('RIFF', 0);
+        wav.writeUInt32LE(36 + sine.byteLength, 4);
+        wav.write('WAVEfmt ', 8);
+        wav.writeUInt32LE(16, 16);
+        wav.writeUInt16LE(1, 20);
+        wav.writeUInt16LE(1, 22);
+        wav.writeUInt32LE(48000, 24);
+        wav.writeUInt32LE(96000, 28);
+        wav.writeUInt16LE(2, 32);
+        wav.writeUInt16LE(16, 34);
+        wav.write('data', 36);
+        wav.writeUInt32LE(sine.byteLength, 40);
+        Buffer.from(sine.buffer).copy(wav, 44);
+        const wavPath = require('path').join(require('os').tmpdir(), `level-test-${process.pid}.wav`);
+        require('fs').writeFileSync(wavPath, wav);
+        const levels = [];
+        await new Promise((resolve) => {
+            const meter = utils.startLevelMeter({ file: wavPath, realtime: false, rateHz: 20 }, (readings, error, ended) => {
+                if (error) console.error('Level meter error:', error.message);
+                levels.push(...readings);
+                if (ended) {
+                    console.log('Level meter stats:', meter.stats());
+                    resolve();
+                }
+            });
+        });
+        require('fs').rmSync(wavPath, { force: true });
+        console.log('Level readings:', levels.length, 'first:', levels[0]);
+
+        // Test two subscribers sharing one microphone listener
+        console.log('\nTesting subscribeMicrophone:');
+        const received = [0, 0];
+        const subscriptions = [0, 1].map((index) =>
+            utils.subscribeMicrophone({ changesOnly: index === 1 }, (active, error, deviceId, deviceName) => {
+                received[index]++;
+                console.log(`  subscriber ${index}:`, deviceId, deviceName, active, error ? error.message : '');
+            })
+        );
+        await new Promise((resolve) => setTimeout(resolve, 1000));
+        console.log('Queue stats:', subscriptions.map((subscription) => subscription.stats()));
+        subscriptions.forEach((subscription) => subscription.unsubscribe());
+        console.log('Events received per subscriber:', received);
+
+        // Every call above is timed natively; print the ones that ran
+        console.log('\nTesting getStats:');
+        const stats = utils.getStats();
+        console.log('Stats enabled:', stats.enabled);
+        for (const [name, call] of Object.entries(stats.calls)) {
+            if (call.calls === 0) continue;
+            console.log(`  ${name}: ${call.calls} calls, ${call.errors} errors, ` +
+                `p50 ${call.latency.p50Ms.toFixed(3)} ms, p99 ${call.latency.p99Ms.toFixed(3)} ms, max ${call.latency.maxMs.toFixed(3)} ms`);
+        }
+        for (const [name, stage] of Object.entries(stats.stages)) {
+            if (stage.count === 0) continue;
+            console.log(`  stage ${name}: ${stage.count} samples, mean ${stage.meanMs.toFixed(3)} ms`);
+        }
+        utils.resetStats();
+        const cleared = utils.getStats();
+        console.log('Cleared by resetStats:', Object.values(cleared.calls).every((call) => call.calls === 0));
+
+        // Per-env addon state; watches and subscriptions above are all closed
+        console.log('\nInstance stats:', utils.getInstanceStats());
+
+        if (utils.getResolverCacheStats) {
+            console.log('\nResolver cache stats:', utils.getResolverCacheStats());
+        }
+
         // Compare both methods
         console.log('\nComparing both methods:');
         console.log('Original method returns:', Array.isArray(processes) ? 'Array' : typeof processes);
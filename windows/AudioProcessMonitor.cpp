@@ -11,17 +11,36 @@
 #include <string>
 #include <vector>
 #include "AudioProcessMonitor.h"
+#include "../common/NativeStats.h"
+#include "../common/ProcessPathCache.h"
 #include <Audioclient.h>
+#include <atomic>
+#include <chrono>
 #include <unordered_set>
 #include <functiondiscoverykeys_devpkey.h>
 
 #pragma comment(lib, "Ole32.lib")
 
-// Function to get process executable path from PID
+// Function to get process executable path from PID. Paths are cached by PID
+// and creation time, so long-lived processes are only queried once.
 static std::string GetProcessExecutablePath(DWORD processID) {
+    StatsStageScope resolvePath(PipelineStage::ResolvePath);
     HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, processID);
     if (!hProcess) return "Unknown";
 
+    ProcessPathCache& cache = SharedProcessPathCache();
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    bool haveStartTime = GetProcessTimes(hProcess, &creationTime, &exitTime, &kernelTime, &userTime) != FALSE;
+    uint64_t startTime = 0;
+    if (haveStartTime) {
+        startTime = (static_cast<uint64_t>(creationTime.dwHighDateTime) << 32) | creationTime.dwLowDateTime;
+        ProcessPathCache::PathRef cached = cache.Find(processID, startTime);
+        if (cached) {
+            CloseHandle(hProcess);
+            return *cached;
+        }
+    }
+
     WCHAR path[MAX_PATH];
     DWORD size = MAX_PATH;
     
@@ -34,6 +53,9 @@ static std::string GetProcessExecutablePath(DWORD processID) {
         if (!result.empty() && result.back() == 0) {
             result.pop_back();
         }
+        if (haveStartTime) {
+            cache.Insert(processID, startTime, result);
+        }
         return result;
     }
 
@@ -41,10 +63,39 @@ static std::string GetProcessExecutablePath(DWORD processID) {
     return "Unknown";
 }
 
-// New function with structured result
-AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
+static std::string WideToUtf8(const wchar_t* text) {
+    int size = WideCharToMultiByte(CP_UTF8, 0, text, -1, nullptr, 0, nullptr, nullptr);
+    if (size <= 1) return std::string();
+    std::string result(size, 0);
+    WideCharToMultiByte(CP_UTF8, 0, text, -1, &result[0], size, nullptr, nullptr);
+    result.pop_back();
+    return result;
+}
+
+static std::string DeviceFriendlyName(IMMDevice* pDevice) {
+    std::string deviceName = "Unknown Device";
+    IPropertyStore* pProps = nullptr;
+    if (SUCCEEDED(pDevice->OpenPropertyStore(STGM_READ, &pProps))) {
+        PROPVARIANT varName;
+        PropVariantInit(&varName);
+        if (SUCCEEDED(pProps->GetValue(PKEY_Device_FriendlyName, &varName)) && varName.vt == VT_LPWSTR) {
+            deviceName = WideToUtf8(varName.pwszVal);
+        }
+        PropVariantClear(&varName);
+        pProps->Release();
+    }
+    return deviceName;
+}
+
+// New function with structured result. A filter is checked on PID and
+// device before each path lookup, and on the path before it is returned.
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult(const ProcessFilter* filter) {
     AudioProcessResult result;
+    StatsCallScope call(StatsCall::MicrophoneProcesses, &result.success);
     std::unordered_set<std::string> seen;  // Track unique strings
+    if (filter && !filter->MatchesDirection(AudioDirection::Capture)) return result;
+
+    StatsStageScope backendInit(PipelineStage::BackendInit);
     HRESULT hr = CoInitialize(nullptr);
 
     if (FAILED(hr)) {
@@ -67,6 +118,9 @@ AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
         CoUninitialize();
         return result;
     }
+    backendInit.End();
+
+    StatsStageScope enumerateDevices(PipelineStage::EnumerateDevices);
 
     // Get default capture (microphone) device
     hr = pEnumerator->GetDefaultAudioEndpoint(eCapture, eMultimedia, &pDevice);
@@ -79,6 +133,8 @@ AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
         return result;
     }
 
+    std::string deviceName = filter ? DeviceFriendlyName(pDevice) : std::string();
+
     bool isPeakValueActive = false;
     IAudioMeterInformation* pMeter = nullptr;
 
@@ -110,7 +166,10 @@ AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
         return result;
     }
 
+    enumerateDevices.End();
+
     // Get session manager
+    StatsStageScope walkSessions(PipelineStage::WalkSessions);
     hr = pDevice->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr, (void**)&pSessionManager);
     if (FAILED(hr)) {
         result.errorCode = hr;
@@ -152,11 +211,12 @@ AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
             AudioSessionState state;
             pSessionControl2->GetState(&state);
 
-            if (processID != 0 && state == AudioSessionStateActive) {
+            if (processID != 0 && state == AudioSessionStateActive &&
+                (!filter || filter->MatchesSession(processID, deviceName, AudioDirection::Capture))) {
                 std::string processPath = GetProcessExecutablePath(processID);
                 
                 // Only insert if not already seen
-                if (seen.insert(processPath).second) {
+                if ((!filter || filter->MatchesPath(processPath)) && seen.insert(processPath).second) {
                     result.processes.push_back(processPath);
                 }
             }
@@ -175,9 +235,21 @@ AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
     return result;
 }
 
-std::vector<std::string> GetAudioInputProcesses() {
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult() {
+    return GetProcessesAccessingMicrophoneWithResult(nullptr);
+}
+
+std::vector<std::string> GetAudioInputProcesses(const ProcessFilter* filter) {
     std::vector<std::string> results;
+    bool succeeded = false;
+    StatsCallScope call(StatsCall::RunningInputProcesses, &succeeded);
     std::unordered_set<std::string> seen;  // Track unique strings
+    if (filter && !filter->MatchesDirection(AudioDirection::Capture)) {
+        succeeded = true;
+        return results;
+    }
+
+    StatsStageScope backendInit(PipelineStage::BackendInit);
     HRESULT hr = CoInitialize(nullptr);
 
     if (FAILED(hr)) {
@@ -193,6 +265,9 @@ std::vector<std::string> GetAudioInputProcesses() {
     if (FAILED(hr)) {
         return results;
     }
+    backendInit.End();
+
+    StatsStageScope enumerateDevices(PipelineStage::EnumerateDevices);
 
     // Get default capture (microphone) device
     hr = pEnumerator->GetDefaultAudioEndpoint(eCapture, eMultimedia, &pDevice);
@@ -201,6 +276,8 @@ std::vector<std::string> GetAudioInputProcesses() {
         return results;
     }
 
+    std::string deviceName = filter ? DeviceFriendlyName(pDevice) : std::string();
+
     bool isActive = false;
     IAudioMeterInformation* pMeter = nullptr;
 
@@ -217,10 +294,13 @@ std::vector<std::string> GetAudioInputProcesses() {
         pDevice->Release();
         pEnumerator->Release();
         CoUninitialize();
+        succeeded = true;
         return results;
     }
+    enumerateDevices.End();
 
     // Get session manager
+    StatsStageScope walkSessions(PipelineStage::WalkSessions);
     hr = pDevice->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr, (void**)&pSessionManager);
     if (FAILED(hr)) {
         std::cerr << "Failed to activate IAudioSessionManager2. HRESULT: " << std::hex << hr << std::endl;
@@ -258,11 +338,12 @@ std::vector<std::string> GetAudioInputProcesses() {
             AudioSessionState state;
             pSessionControl2->GetState(&state);
 
-            if (processID != 0 && state == AudioSessionStateActive) {
+            if (processID != 0 && state == AudioSessionStateActive &&
+                (!filter || filter->MatchesSession(processID, deviceName, AudioDirection::Capture))) {
                 std::string processPath = GetProcessExecutablePath(processID);
 
                 // Only insert if not already seen
-                if (seen.insert(processPath).second) {
+                if ((!filter || filter->MatchesPath(processPath)) && seen.insert(processPath).second) {
                     results.push_back(processPath);
                 }
             }
@@ -278,12 +359,21 @@ std::vector<std::string> GetAudioInputProcesses() {
     pEnumerator->Release();
     CoUninitialize();
 
+    succeeded = true;
     return results;
 }
 
+std::vector<std::string> GetAudioInputProcesses() {
+    return GetAudioInputProcesses(nullptr);
+}
+
 // Speaker/render process detection - separate from microphone monitoring
-RenderProcessResult GetRenderProcessesWithResult() {
+RenderProcessResult GetRenderProcessesWithResult(const ProcessFilter* filter) {
     RenderProcessResult result;
+    StatsCallScope call(StatsCall::SpeakerProcesses, &result.success);
+    if (filter && !filter->MatchesDirection(AudioDirection::Render)) return result;
+
+    StatsStageScope backendInit(PipelineStage::BackendInit);
     HRESULT hr = CoInitialize(nullptr);
 
     if (FAILED(hr)) {
@@ -304,8 +394,10 @@ RenderProcessResult GetRenderProcessesWithResult() {
         CoUninitialize();
         return result;
     }
+    backendInit.End();
 
     // Get ALL active render (speaker) devices
+    StatsStageScope enumerateDevices(PipelineStage::EnumerateDevices);
     hr = pEnumerator->EnumAudioEndpoints(eRender, DEVICE_STATE_ACTIVE, &pCollection);
     if (FAILED(hr)) {
         result.errorCode = hr;
@@ -318,8 +410,10 @@ RenderProcessResult GetRenderProcessesWithResult() {
 
     UINT deviceCount = 0;
     pCollection->GetCount(&deviceCount);
+    enumerateDevices.End();
 
     // Check each active render device
+    StatsStageScope walkSessions(PipelineStage::WalkSessions);
     for (UINT deviceIndex = 0; deviceIndex < deviceCount; deviceIndex++) {
         IMMDevice* pDevice = nullptr;
         hr = pCollection->Item(deviceIndex, &pDevice);
@@ -384,7 +478,8 @@ RenderProcessResult GetRenderProcessesWithResult() {
                             pVolume->Release();
                         }
 
-                        if (processId != 0 && isActiveSession) {
+                        if (processId != 0 && isActiveSession &&
+                            (!filter || filter->MatchesSession(processId, deviceName, AudioDirection::Render))) {
                             RenderProcessInfo info;
                             info.processId = processId;
                             info.processName = GetProcessExecutablePath(processId);
@@ -397,7 +492,9 @@ RenderProcessResult GetRenderProcessesWithResult() {
 
                             info.deviceName = deviceName;
                             info.isActive = true;
-                            result.processes.push_back(info);
+                            if (!filter || filter->MatchesPath(info.processName)) {
+                                result.processes.push_back(info);
+                            }
                         }
 
                         pSessionControl2->Release();
@@ -418,4 +515,524 @@ RenderProcessResult GetRenderProcessesWithResult() {
     CoUninitialize();
 
     return result;
-}
\ No newline at end of file
+}
+
+RenderProcessResult GetRenderProcessesWithResult() {
+    return GetRenderProcessesWithResult(nullptr);
+}
+
+// Capture sessions only report paths, so capture entries have no PID or device
+bool GetWatchedProcesses(WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage) {
+    bool succeeded = false;
+    StatsCallScope call(StatsCall::WatchPoll, &succeeded);
+
+    AudioProcessResult captureResult = GetProcessesAccessingMicrophoneWithResult();
+    if (!captureResult.success) {
+        errorCode = captureResult.errorCode;
+        errorMessage = captureResult.errorMessage;
+        return false;
+    }
+
+    RenderProcessResult renderResult = GetRenderProcessesWithResult();
+    if (!renderResult.success) {
+        errorCode = renderResult.errorCode;
+        errorMessage = renderResult.errorMessage;
+        return false;
+    }
+
+    for (const std::string& path : captureResult.processes) {
+        WatchedProcess process;
+        process.processId = 0;
+        process.processName = path;
+        snapshot.capture.push_back(process);
+    }
+
+    for (const RenderProcessInfo& info : renderResult.processes) {
+        WatchedProcess process;
+        process.processId = info.processId;
+        process.processName = info.processName;
+        process.deviceName = info.deviceName;
+        snapshot.render.push_back(process);
+    }
+
+    succeeded = true;
+    return true;
+}
+
+bool ProbeCaptureDevices(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                         long& errorCode, std::string& errorMessage) {
+    bool succeeded = false;
+    StatsCallScope call(StatsCall::MonitorProbe, &succeeded);
+
+    if (deviceId != "default") {
+        errorCode = E_INVALIDARG;
+        errorMessage = "Unknown capture device: " + deviceId;
+        return false;
+    }
+
+    AudioProcessResult result = GetProcessesAccessingMicrophoneWithResult();
+    if (!result.success) {
+        errorCode = result.errorCode;
+        errorMessage = result.errorMessage;
+        return false;
+    }
+
+    devices.push_back(DeviceActivity{"default", "Default capture device", !result.processes.empty()});
+    succeeded = true;
+    return true;
+}
+
+namespace {
+
+// Endpoints come and go rarely; the meter list is rebuilt this often, or
+// after any meter call fails
+const std::chrono::seconds kMeterRefreshInterval(5);
+
+class EndpointActivityMeters {
+public:
+    EndpointActivityMeters() : comInitialized_(false), enumerator_(nullptr) {}
+
+    ~EndpointActivityMeters() {
+        ReleaseMeters();
+        if (enumerator_) enumerator_->Release();
+        if (comInitialized_) CoUninitialize();
+    }
+
+    bool Sample(ActivitySample& sample, long& errorCode, std::string& errorMessage) {
+        if (enumerator_ == nullptr || std::chrono::steady_clock::now() - refreshedAt_ > kMeterRefreshInterval) {
+            if (!Refresh(errorCode, errorMessage)) return false;
+        }
+
+        for (const Meter& meter : meters_) {
+            float peak = 0.0f;
+            if (FAILED(meter.meter->GetPeakValue(&peak))) {
+                // Endpoint removed; the next sample rebuilds the list
+                refreshedAt_ = std::chrono::steady_clock::time_point();
+                errorCode = E_FAIL;
+                errorMessage = "Failed to read endpoint peak meter";
+                return false;
+            }
+            if (peak > 0.0f) {
+                sample.signature += meter.key;
+            }
+        }
+        sample.active = true;
+        return true;
+    }
+
+private:
+    struct Meter {
+        std::string key;
+        IAudioMeterInformation* meter;
+    };
+
+    bool Refresh(long& errorCode, std::string& errorMessage) {
+        ReleaseMeters();
+
+        if (!comInitialized_) {
+            HRESULT hr = CoInitialize(nullptr);
+            if (FAILED(hr)) {
+                errorCode = hr;
+                errorMessage = "Failed to initialize COM";
+                return false;
+            }
+            comInitialized_ = true;
+        }
+
+        if (enumerator_ == nullptr) {
+            HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                          __uuidof(IMMDeviceEnumerator), (void**)&enumerator_);
+            if (FAILED(hr)) {
+                enumerator_ = nullptr;
+                errorCode = hr;
+                errorMessage = "Failed to create device enumerator";
+                return false;
+            }
+        }
+
+        const EDataFlow flows[] = {eCapture, eRender};
+        for (EDataFlow flow : flows) {
+            IMMDeviceCollection* pCollection = nullptr;
+            HRESULT hr = enumerator_->EnumAudioEndpoints(flow, DEVICE_STATE_ACTIVE, &pCollection);
+            if (FAILED(hr)) {
+                errorCode = hr;
+                errorMessage = "Failed to enumerate audio endpoints";
+                return false;
+            }
+
+            UINT deviceCount = 0;
+            pCollection->GetCount(&deviceCount);
+            for (UINT deviceIndex = 0; deviceIndex < deviceCount; deviceIndex++) {
+                IMMDevice* pDevice = nullptr;
+                if (FAILED(pCollection->Item(deviceIndex, &pDevice))) continue;
+
+                IAudioMeterInformation* pMeter = nullptr;
+                hr = pDevice->Activate(__uuidof(IAudioMeterInformation), CLSCTX_ALL, nullptr, (void**)&pMeter);
+                pDevice->Release();
+                if (FAILED(hr)) continue;
+
+                std::string key = (flow == eCapture ? "c" : "r") + std::to_string(deviceIndex) + ";";
+                meters_.push_back(Meter{key, pMeter});
+            }
+            pCollection->Release();
+        }
+
+        refreshedAt_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void ReleaseMeters() {
+        for (Meter& meter : meters_) {
+            meter.meter->Release();
+        }
+        meters_.clear();
+    }
+
+    bool comInitialized_;
+    IMMDeviceEnumerator* enumerator_;
+    std::vector<Meter> meters_;
+    std::chrono::steady_clock::time_point refreshedAt_;
+};
+
+}  // namespace
+
+bool ProbeAudioActivity(ActivitySample& sample, long& errorCode, std::string& errorMessage) {
+    // COM is initialized once per polling thread and the meters stay open
+    // between ticks; both are released when the thread exits
+    thread_local EndpointActivityMeters meters;
+    return meters.Sample(sample, errorCode, errorMessage);
+}
+
+namespace {
+
+// Appends every session the manager currently lists. Returns false when the
+// endpoint can no longer be queried, e.g. because it was unplugged.
+bool AppendSessions(IAudioSessionManager2* pSessionManager, size_t deviceIndex, std::vector<AudioSession>& sessions) {
+    IAudioSessionEnumerator* pSessionEnum = nullptr;
+    if (FAILED(pSessionManager->GetSessionEnumerator(&pSessionEnum))) {
+        return false;
+    }
+
+    int sessionCount = 0;
+    pSessionEnum->GetCount(&sessionCount);
+
+    for (int i = 0; i < sessionCount; i++) {
+        IAudioSessionControl* pSessionControl = nullptr;
+        if (FAILED(pSessionEnum->GetSession(i, &pSessionControl))) continue;
+
+        IAudioSessionControl2* pSessionControl2 = nullptr;
+        if (SUCCEEDED(pSessionControl->QueryInterface(__uuidof(IAudioSessionControl2), (void**)&pSessionControl2))) {
+            DWORD processId = 0;
+            pSessionControl2->GetProcessId(&processId);
+
+            AudioSessionState state = AudioSessionStateInactive;
+            pSessionControl2->GetState(&state);
+
+            BOOL isMuted = FALSE;
+            ISimpleAudioVolume* pVolume = nullptr;
+            if (SUCCEEDED(pSessionControl->QueryInterface(__uuidof(ISimpleAudioVolume), (void**)&pVolume))) {
+                pVolume->GetMute(&isMuted);
+                pVolume->Release();
+            }
+
+            AudioSession session;
+            session.processId = processId;
+            session.deviceIndex = deviceIndex;
+            session.isActive = state == AudioSessionStateActive;
+            session.isMuted = isMuted != FALSE;
+            sessions.push_back(session);
+
+            pSessionControl2->Release();
+        }
+        pSessionControl->Release();
+    }
+    pSessionEnum->Release();
+    return true;
+}
+
+// Every session on every active endpoint in both directions, under one COM
+// initialization and one device enumerator
+class EndpointSessionBackend : public AudioBackend {
+public:
+    bool Enumerate(std::vector<AudioDevice>& devices, std::vector<AudioSession>& sessions,
+                   long& errorCode, std::string& errorMessage) override {
+        StatsStageScope backendInit(PipelineStage::BackendInit);
+        HRESULT hr = CoInitialize(nullptr);
+        if (FAILED(hr)) {
+            errorCode = hr;
+            errorMessage = "Failed to initialize COM";
+            return false;
+        }
+
+        IMMDeviceEnumerator* pEnumerator = nullptr;
+        hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL, __uuidof(IMMDeviceEnumerator), (void**)&pEnumerator);
+        if (FAILED(hr)) {
+            errorCode = hr;
+            errorMessage = "Failed to create device enumerator";
+            CoUninitialize();
+            return false;
+        }
+        backendInit.End();
+
+        const EDataFlow flows[] = {eCapture, eRender};
+        for (EDataFlow flow : flows) {
+            StatsStageScope enumerateDevices(PipelineStage::EnumerateDevices);
+            IMMDeviceCollection* pCollection = nullptr;
+            hr = pEnumerator->EnumAudioEndpoints(flow, DEVICE_STATE_ACTIVE, &pCollection);
+            if (FAILED(hr)) {
+                errorCode = hr;
+                errorMessage = "Failed to enumerate audio endpoints";
+                pEnumerator->Release();
+                CoUninitialize();
+                return false;
+            }
+
+            UINT deviceCount = 0;
+            pCollection->GetCount(&deviceCount);
+            enumerateDevices.End();
+
+            StatsStageScope walkSessions(PipelineStage::WalkSessions);
+            for (UINT deviceIndex = 0; deviceIndex < deviceCount; deviceIndex++) {
+                IMMDevice* pDevice = nullptr;
+                if (FAILED(pCollection->Item(deviceIndex, &pDevice))) continue;
+
+                AudioDevice device;
+                LPWSTR deviceId = nullptr;
+                if (SUCCEEDED(pDevice->GetId(&deviceId))) {
+                    device.id = WideToUtf8(deviceId);
+                    CoTaskMemFree(deviceId);
+                }
+                device.name = DeviceFriendlyName(pDevice);
+                device.direction = flow == eCapture ? AudioDirection::Capture : AudioDirection::Render;
+                devices.push_back(device);
+                WalkSessions(pDevice, devices.size() - 1, sessions);
+
+                pDevice->Release();
+            }
+            pCollection->Release();
+        }
+
+        pEnumerator->Release();
+        CoUninitialize();
+        return true;
+    }
+
+    std::string ResolveProcessPath(uint32_t processId) override {
+        return GetProcessExecutablePath(processId);
+    }
+
+private:
+    static void WalkSessions(IMMDevice* pDevice, size_t deviceIndex, std::vector<AudioSession>& sessions) {
+        IAudioSessionManager2* pSessionManager = nullptr;
+        if (FAILED(pDevice->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr, (void**)&pSessionManager))) {
+            return;
+        }
+        AppendSessions(pSessionManager, deviceIndex, sessions);
+        pSessionManager->Release();
+    }
+};
+
+// Counts endpoint arrivals, removals and state changes. The audio service
+// calls it on its own threads, so it only bumps an atomic.
+class EndpointTopologyListener : public IMMNotificationClient {
+public:
+    EndpointTopologyListener() : refs_(1), version_(0) {}
+
+    uint64_t Version() const { return version_.load(); }
+    void Bump() { version_++; }
+
+    ULONG STDMETHODCALLTYPE AddRef() override {
+        return InterlockedIncrement(&refs_);
+    }
+
+    ULONG STDMETHODCALLTYPE Release() override {
+        ULONG refs = InterlockedDecrement(&refs_);
+        if (refs == 0) delete this;
+        return refs;
+    }
+
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObject) override {
+        if (riid == __uuidof(IUnknown) || riid == __uuidof(IMMNotificationClient)) {
+            *ppvObject = static_cast<IMMNotificationClient*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppvObject = nullptr;
+        return E_NOINTERFACE;
+    }
+
+    HRESULT STDMETHODCALLTYPE OnDeviceStateChanged(LPCWSTR, DWORD) override { Bump(); return S_OK; }
+    HRESULT STDMETHODCALLTYPE OnDeviceAdded(LPCWSTR) override { Bump(); return S_OK; }
+    HRESULT STDMETHODCALLTYPE OnDeviceRemoved(LPCWSTR) override { Bump(); return S_OK; }
+
+    // Neither changes the set of active endpoints; property changes are
+    // mostly volume and format updates
+    HRESULT STDMETHODCALLTYPE OnDefaultDeviceChanged(EDataFlow, ERole, LPCWSTR) override { return S_OK; }
+    HRESULT STDMETHODCALLTYPE OnPropertyValueChanged(LPCWSTR, const PROPERTYKEY) override { return S_OK; }
+
+private:
+    LONG refs_;
+    std::atomic<uint64_t> version_;
+};
+
+// Keeps COM, the device enumerator and a session manager per active endpoint
+// open between queries, all on the thread that owns the AudioContext. Only
+// the session enumerators, which are snapshots, are taken per read.
+class EndpointContextBackend : public ContextBackend {
+public:
+    EndpointContextBackend()
+        : comInitialized_(false), comReady_(false), enumerator_(nullptr), listener_(new EndpointTopologyListener()),
+          registered_(false) {}
+
+    ~EndpointContextBackend() override {
+        ReleaseManagers();
+        if (registered_) enumerator_->UnregisterEndpointNotificationCallback(listener_);
+        listener_->Release();
+        if (enumerator_) enumerator_->Release();
+        if (comInitialized_) CoUninitialize();
+    }
+
+    uint64_t TopologyVersion() override {
+        return listener_->Version();
+    }
+
+    bool OpenDevices(std::vector<AudioDevice>& devices, long& errorCode, std::string& errorMessage) override {
+        ReleaseManagers();
+        if (!Initialize(errorCode, errorMessage)) return false;
+
+        const EDataFlow flows[] = {eCapture, eRender};
+        for (EDataFlow flow : flows) {
+            IMMDeviceCollection* pCollection = nullptr;
+            HRESULT hr = enumerator_->EnumAudioEndpoints(flow, DEVICE_STATE_ACTIVE, &pCollection);
+            if (FAILED(hr)) {
+                ReleaseManagers();
+                errorCode = hr;
+                errorMessage = "Failed to enumerate audio endpoints";
+                return false;
+            }
+
+            UINT deviceCount = 0;
+            pCollection->GetCount(&deviceCount);
+            for (UINT deviceIndex = 0; deviceIndex < deviceCount; deviceIndex++) {
+                IMMDevice* pDevice = nullptr;
+                if (FAILED(pCollection->Item(deviceIndex, &pDevice))) continue;
+
+                AudioDevice device;
+                LPWSTR deviceId = nullptr;
+                if (SUCCEEDED(pDevice->GetId(&deviceId))) {
+                    device.id = WideToUtf8(deviceId);
+                    CoTaskMemFree(deviceId);
+                }
+                device.name = DeviceFriendlyName(pDevice);
+                device.direction = flow == eCapture ? AudioDirection::Capture : AudioDirection::Render;
+                devices.push_back(device);
+
+                // As in the one-shot walk, an endpoint without a session
+                // manager is still listed, just without sessions
+                IAudioSessionManager2* pSessionManager = nullptr;
+                if (FAILED(pDevice->Activate(__uuidof(IAudioSessionManager2), CLSCTX_ALL, nullptr,
+                                             (void**)&pSessionManager))) {
+                    pSessionManager = nullptr;
+                }
+                managers_.push_back(pSessionManager);
+
+                pDevice->Release();
+            }
+            pCollection->Release();
+        }
+        return true;
+    }
+
+    bool ReadSessions(std::vector<AudioSession>& sessions, long&, std::string&) override {
+        for (size_t deviceIndex = 0; deviceIndex < managers_.size(); deviceIndex++) {
+            if (managers_[deviceIndex] == nullptr) continue;
+            if (!AppendSessions(managers_[deviceIndex], deviceIndex, sessions)) {
+                // The endpoint went away after it was opened, possibly before
+                // its removal was reported; reopen and read again
+                listener_->Bump();
+            }
+        }
+        return true;
+    }
+
+    std::string ResolveProcessPath(uint32_t processId) override {
+        return GetProcessExecutablePath(processId);
+    }
+
+private:
+    bool Initialize(long& errorCode, std::string& errorMessage) {
+        if (!comReady_) {
+            HRESULT hr = CoInitialize(nullptr);
+            // The JS thread may already be in the multithreaded apartment,
+            // which serves the enumerator just as well
+            if (FAILED(hr) && hr != RPC_E_CHANGED_MODE) {
+                errorCode = hr;
+                errorMessage = "Failed to initialize COM";
+                return false;
+            }
+            comInitialized_ = SUCCEEDED(hr);
+            comReady_ = true;
+        }
+
+        if (enumerator_ == nullptr) {
+            HRESULT hr = CoCreateInstance(__uuidof(MMDeviceEnumerator), nullptr, CLSCTX_ALL,
+                                          __uuidof(IMMDeviceEnumerator), (void**)&enumerator_);
+            if (FAILED(hr)) {
+                enumerator_ = nullptr;
+                errorCode = hr;
+                errorMessage = "Failed to create device enumerator";
+                return false;
+            }
+        }
+
+        // Without the listener a hot-plug is only noticed once an opened
+        // endpoint fails a read, so this is not fatal
+        if (!registered_) {
+            registered_ = SUCCEEDED(enumerator_->RegisterEndpointNotificationCallback(listener_));
+        }
+        return true;
+    }
+
+    void ReleaseManagers() {
+        for (IAudioSessionManager2* pSessionManager : managers_) {
+            if (pSessionManager) pSessionManager->Release();
+        }
+        managers_.clear();
+    }
+
+    bool comInitialized_;  // Owes a CoUninitialize()
+    bool comReady_;
+    IMMDeviceEnumerator* enumerator_;
+    EndpointTopologyListener* listener_;
+    bool registered_;
+    std::vector<IAudioSessionManager2*> managers_;  // Parallel to the opened devices
+};
+
+}  // namespace
+
+ProcessAudioSnapshot GetAudioSnapshot(const ProcessFilter* filter) {
+    ProcessAudioSnapshot result;
+    StatsCallScope call(StatsCall::AudioSnapshot, &result.success);
+
+    // The backend reports its own stages, including ResolvePath inside
+    // GetProcessExecutablePath, so no pipeline observer is passed
+    EndpointSessionBackend backend;
+    result = CollectProcessAudioSnapshot(backend, nullptr, filter);
+    return result;
+}
+
+ProcessAudioSnapshot GetAudioSnapshot() {
+    return GetAudioSnapshot(nullptr);
+}
+
+BackendWarmup PrewarmAudioBackend() {
+    BackendWarmup warmup;
+    warmup.backend = "wasapi";
+    EndpointSessionBackend backend;
+    WarmAudioBackend(backend, warmup);
+    return warmup;
+}
+
+std::unique_ptr<ContextBackend> CreateAudioContextBackend() {
+    return std::unique_ptr<ContextBackend>(new EndpointContextBackend());
+}
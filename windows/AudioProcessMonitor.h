@@ -1,6 +1,14 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
+#include "../common/AudioContext.h"
+#include "../common/AudioProcessWatcher.h"
+#include "../common/BackendWarmup.h"
+#include "../common/PollingMonitorSource.h"
+#include "../common/ProcessFilter.h"
+#include "../common/ProcessAudioSnapshot.h"
+#include "../common/TieredProbeScheduler.h"
 
 struct AudioProcessResult {
     std::vector<std::string> processes;
@@ -28,11 +36,49 @@ struct RenderProcessResult {
     RenderProcessResult() : errorCode(S_OK), success(true) {}
 };
 
+// The enumeration calls below take an optional filter, checked on PID and
+// device before each path lookup; see ProcessFilter.h
+
 // Original function returning vector (restored)
 std::vector<std::string> GetAudioInputProcesses();
+std::vector<std::string> GetAudioInputProcesses(const ProcessFilter* filter);
 
 // New function with structured result
 AudioProcessResult GetProcessesAccessingMicrophoneWithResult();
+AudioProcessResult GetProcessesAccessingMicrophoneWithResult(const ProcessFilter* filter);
 
 // Speaker/render process detection
-RenderProcessResult GetRenderProcessesWithResult();
\ No newline at end of file
+RenderProcessResult GetRenderProcessesWithResult();
+RenderProcessResult GetRenderProcessesWithResult(const ProcessFilter* filter);
+
+// Capture and render use of every process across all active endpoints, with
+// one COM initialization and each PID resolved once
+ProcessAudioSnapshot GetAudioSnapshot();
+ProcessAudioSnapshot GetAudioSnapshot(const ProcessFilter* filter);
+
+// Walks every endpoint's sessions once and resolves their paths, so the
+// first enumeration call finds the audio stack's DLLs and service connection
+// loaded and the resolver cache filled; see BackendWarmup.h. COM itself is
+// initialized per call, so that part is not carried over. Blocks, so run it
+// off the JS thread.
+BackendWarmup PrewarmAudioBackend();
+
+// ContextBackend for createAudioContext(). COM, the device enumerator and
+// each endpoint's session manager stay open on the calling thread between
+// queries; an endpoint notification callback moves the topology version.
+std::unique_ptr<ContextBackend> CreateAudioContextBackend();
+
+// Capture and render processes for AudioProcessWatcher
+bool GetWatchedProcesses(WatchedSnapshot& snapshot, long& errorCode, std::string& errorMessage);
+
+// Cheap first tier for TieredProbeScheduler: peak meters of the active
+// endpoints, kept open per polling thread. The signature lists endpoints
+// carrying signal. A silent stream leaves no trace in the meters, so the
+// sample is always marked active and silent streams are only picked up by
+// the scheduler's periodic refresh.
+bool ProbeAudioActivity(ActivitySample& sample, long& errorCode, std::string& errorMessage);
+
+// Whether any process is using the microphone, for PollingMonitorSource.
+// Only the "default" device is supported.
+bool ProbeCaptureDevices(const std::string& deviceId, std::vector<DeviceActivity>& devices,
+                         long& errorCode, std::string& errorMessage);
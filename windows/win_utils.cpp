@@ -1,20 +1,74 @@
 #include <napi.h>
 #include <windows.h>
 #include "AudioProcessMonitor.h"
+#include "../common/AddonInstance.h"
+#include "../common/AsyncSnapshot.h"
+#include "../common/AudioContextBinding.h"
+#include "../common/ColumnarResult.h"
+#include "../common/LevelMeterBinding.h"
+#include "../common/MonitorHubBinding.h"
+#include "../common/NativeStatsBinding.h"
+#include "../common/PollingMonitorSource.h"
+#include "../common/ProcessFilterBinding.h"
+#include "../common/ProcessPathCache.h"
+#include "../common/ResultMarshal.h"
+#include "../common/SharedResource.h"
+#include "../common/WatchAudioProcesses.h"
 
-// Gets a list of processes that are accessing input (microphone) - original interface
+// One polling listener per device, shared by every subscriber in every env,
+// and stopped once the last env using it exits
+static SharedResource<MonitorHub> microphoneHub([]() {
+  return new MonitorHub([]() {
+    std::unique_ptr<PollingMonitorSource> source(new PollingMonitorSource(
+      ProbeCaptureDevices, "WindowsMicrophoneMonitor", std::chrono::milliseconds(250)));
+    // The capture probe itself only reports use while the default
+    // endpoint's meter shows signal, so gating on the meters loses nothing
+    source->UseScheduler(std::unique_ptr<TieredProbeScheduler>(new TieredProbeScheduler(ProbeAudioActivity)));
+    return std::unique_ptr<MonitorSource>(source.release());
+  });
+});
+
+// Per-env state; see AddonInstance.h
+struct WindowsAddon : public AddonInstance {
+  // Promise-returning variants. Each scan runs on the libuv worker pool, and
+  // concurrent callers in this env share whichever scan is already in flight.
+  AsyncSnapshot<std::vector<std::string>> inputProcessesSnapshot;
+  AsyncSnapshot<AudioProcessResult> microphoneSnapshot;
+  AsyncSnapshot<RenderProcessResult> renderSnapshot;
+  AsyncSnapshot<ProcessAudioSnapshot> audioSnapshot;
+  AsyncSnapshot<BackendWarmup> warmup;
+
+  // Names referenced by columnar render results
+  StringTable renderStringTable;
+
+  WindowsAddon()
+    : AddonInstance(microphoneHub.Acquire()),
+      inputProcessesSnapshot("GetRunningInputAudioProcesses", GetAudioInputProcesses, ProcessListToArray),
+      microphoneSnapshot("GetProcessesAccessingMicrophoneWithResult", GetProcessesAccessingMicrophoneWithResult,
+                         AudioProcessResultToObject<AudioProcessResult>),
+      renderSnapshot("GetRenderProcessesWithResult", GetRenderProcessesWithResult,
+                     RenderProcessResultToObject<RenderProcessResult>),
+      audioSnapshot("GetAudioSnapshot", GetAudioSnapshot, ProcessAudioSnapshotToObject),
+      warmup("PrewarmAudioBackend", [](const ProcessFilter*) { return PrewarmAudioBackend(); },
+             BackendWarmupToObject) {}
+
+  static WindowsAddon& Of(Napi::Env env) {
+    return static_cast<WindowsAddon&>(AddonInstance::Of(env));
+  }
+};
+
+// Gets a list of processes that are accessing input (microphone) - original interface.
+// Every enumeration call takes { filter }; see ProcessFilterBinding.h.
 Napi::Value GetRunningInputAudioProcesses(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  try {
-    std::vector<std::string> processes = GetAudioInputProcesses();
-
-    Napi::Array result = Napi::Array::New(env);
-    for (size_t i = 0; i < processes.size(); i++) {
-      result.Set(i, Napi::String::New(env, processes[i]));
-    }
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
 
-    return result;
+  try {
+    std::vector<std::string> processes = GetAudioInputProcesses(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    return ProcessListToArray(env, processes);
   } catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
@@ -25,84 +79,154 @@ Napi::Value GetRunningInputAudioProcesses(const Napi::CallbackInfo& info) {
 Napi::Value GetProcessesAccessingMicrophoneWithResult(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
-  try {
-    AudioProcessResult result = GetProcessesAccessingMicrophoneWithResult();
-
-    // Create a JavaScript object to represent the AudioProcessResult
-    Napi::Object resultObj = Napi::Object::New(env);
-    if (!result.success) {
-      // Set error information
-      resultObj.Set("success", Napi::Boolean::New(env, false));
-      resultObj.Set("error", Napi::String::New(env, result.errorMessage));
-      resultObj.Set("code", Napi::Number::New(env, result.errorCode));
-      resultObj.Set("domain", Napi::String::New(env, "AudioProcessMonitor"));
-      resultObj.Set("processes", Napi::Array::New(env));
-    } else {
-      // Set success information
-      resultObj.Set("success", Napi::Boolean::New(env, true));
-      resultObj.Set("error", env.Null());
-
-      // Convert processes array
-      Napi::Array processesArray = Napi::Array::New(env);
-      for (size_t i = 0; i < result.processes.size(); i++) {
-        processesArray.Set(i, Napi::String::New(env, result.processes[i]));
-      }
-      resultObj.Set("processes", processesArray);
-    }
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
 
-    return resultObj;
+  try {
+    AudioProcessResult result = GetProcessesAccessingMicrophoneWithResult(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    return AudioProcessResultToObject(env, result);
   } catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
 }
 
-// Gets a list of processes that are using speakers/render devices
+// Gets a list of processes that are using speakers/render devices.
+// Pass { columnar: true, stringTableVersion } to get typed-array columns.
 Napi::Value GetRenderProcessesWithResult(const Napi::CallbackInfo& info) {
   Napi::Env env = info.Env();
 
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
+
   try {
-    RenderProcessResult result = GetRenderProcessesWithResult();
-
-    // Create a JavaScript object to represent the RenderProcessResult
-    Napi::Object resultObj = Napi::Object::New(env);
-    if (!result.success) {
-      // Set error information
-      resultObj.Set("success", Napi::Boolean::New(env, false));
-      resultObj.Set("error", Napi::String::New(env, result.errorMessage));
-      resultObj.Set("code", Napi::Number::New(env, result.errorCode));
-      resultObj.Set("domain", Napi::String::New(env, "RenderProcessMonitor"));
-      resultObj.Set("processes", Napi::Array::New(env));
-    } else {
-      // Set success information
-      resultObj.Set("success", Napi::Boolean::New(env, true));
-      resultObj.Set("error", env.Null());
-
-      // Convert processes array
-      Napi::Array processesArray = Napi::Array::New(env);
-      for (size_t i = 0; i < result.processes.size(); i++) {
-        Napi::Object processObj = Napi::Object::New(env);
-        processObj.Set("processName", Napi::String::New(env, result.processes[i].processName));
-        processObj.Set("processId", Napi::Number::New(env, result.processes[i].processId));
-        processObj.Set("deviceName", Napi::String::New(env, result.processes[i].deviceName));
-        processObj.Set("isActive", Napi::Boolean::New(env, result.processes[i].isActive));
-        processesArray.Set(i, processObj);
-      }
-      resultObj.Set("processes", processesArray);
+    uint32_t knownVersion = 0;
+    bool columnar = ParseColumnarOptions(info, knownVersion);
+
+    RenderProcessResult result = GetRenderProcessesWithResult(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    if (columnar) {
+      return RenderProcessResultToColumns(env, result, WindowsAddon::Of(env).renderStringTable, knownVersion);
     }
+    return RenderProcessResultToObject(env, result);
+  } catch (const std::exception& e) {
+    Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
+    return env.Null();
+  }
+}
+
+// Capture and render use of every process, grouped per PID, from one pass
+// over the endpoints
+Napi::Value GetAudioSnapshot(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return env.Null();
 
-    return resultObj;
+  try {
+    ProcessAudioSnapshot result = GetAudioSnapshot(filter.get());
+    StatsStageScope marshal(PipelineStage::Marshal);
+    return ProcessAudioSnapshotToObject(env, result);
   } catch (const std::exception& e) {
     Napi::Error::New(env, e.what()).ThrowAsJavaScriptException();
     return env.Null();
   }
 }
 
+// Promise variants of the calls above. They take the same { filter }, which
+// is checked before the promise is made; requests with different filters
+// never share a scan (see AsyncSnapshot.h).
+Napi::Value GetRunningInputAudioProcessesAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return WindowsAddon::Of(info.Env()).inputProcessesSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetProcessesAccessingMicrophoneWithResultAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return WindowsAddon::Of(info.Env()).microphoneSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetRenderProcessesWithResultAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return WindowsAddon::Of(info.Env()).renderSnapshot.Request(info.Env(), filter);
+}
+
+Napi::Value GetAudioSnapshotAsync(const Napi::CallbackInfo& info) {
+  std::shared_ptr<const ProcessFilter> filter;
+  if (!ProcessFilterOption(info, filter)) return info.Env().Null();
+  return WindowsAddon::Of(info.Env()).audioSnapshot.Request(info.Env(), filter);
+}
+
+// prewarm(): walks the endpoints and fills the resolver cache on the libuv
+// worker pool. Concurrent calls share one warm-up.
+Napi::Value Prewarm(const Napi::CallbackInfo& info) {
+  return WindowsAddon::Of(info.Env()).warmup.Request(info.Env());
+}
+
+// Returns hit/miss/eviction counters for the PID-to-path resolver cache
+Napi::Value GetResolverCacheStats(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  ProcessPathCacheStats stats = SharedProcessPathCache().Stats();
+
+  Napi::Object statsObj = Napi::Object::New(env);
+  statsObj.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+  statsObj.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+  statsObj.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+  statsObj.Set("size", Napi::Number::New(env, static_cast<double>(stats.size)));
+  statsObj.Set("capacity", Napi::Number::New(env, static_cast<double>(stats.capacity)));
+  statsObj.Set("internedPaths", Napi::Number::New(env, static_cast<double>(stats.internedPaths)));
+  return statsObj;
+}
+
+// Sets the maximum number of cached PIDs, evicting least recently used ones
+Napi::Value SetResolverCacheCapacity(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+
+  if (info.Length() < 1 || !info[0].IsNumber() || info[0].As<Napi::Number>().Int64Value() < 1) {
+    Napi::TypeError::New(env, "Expected a positive capacity").ThrowAsJavaScriptException();
+    return env.Null();
+  }
+
+  SharedProcessPathCache().SetCapacity(static_cast<size_t>(info[0].As<Napi::Number>().Int64Value()));
+  return env.Undefined();
+}
+
+// Watches capture and render processes, calling back with {added, removed}
+// batches only when something changed
+Napi::Value WatchAudioProcesses(const Napi::CallbackInfo& info) {
+  return StartAudioProcessWatch(info, GetWatchedProcesses, ProbeAudioActivity);
+}
+
+// Streams input levels from a WAV file; see LevelMeterBinding.h. Device
+// capture is not implemented on Windows yet.
+Napi::Value StartInputLevelMeter(const Napi::CallbackInfo& info) {
+  return StartLevelMeter(info, nullptr);
+}
+
+// Long-lived session context; see AudioContextBinding.h. It runs on the JS
+// thread, which it initializes COM on, and re-reads the endpoint list only
+// after an endpoint notification or a failed read.
+Napi::Value CreateWindowsAudioContext(const Napi::CallbackInfo& info) {
+  return CreateAudioContext(info, CreateAudioContextBackend);
+}
+
+// Subscribes to microphone state changes; see MonitorHubBinding.h
+Napi::Value SubscribeMicrophone(const Napi::CallbackInfo& info) {
+  return SubscribeToHub(info);
+}
+
 // Initialize the module exports
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
+  AddonInstance::Install(env, new WindowsAddon());
+
   Napi::Value (*originalAudioProcessesFunc)(const Napi::CallbackInfo&) = GetRunningInputAudioProcesses;
   Napi::Value (*microphoneAccessFunc)(const Napi::CallbackInfo&) = GetProcessesAccessingMicrophoneWithResult;
   Napi::Value (*renderProcessesFunc)(const Napi::CallbackInfo&) = GetRenderProcessesWithResult;
+  Napi::Value (*audioSnapshotFunc)(const Napi::CallbackInfo&) = GetAudioSnapshot;
 
   exports.Set("getRunningInputAudioProcesses",
               Napi::Function::New(env, originalAudioProcessesFunc));
@@ -111,6 +235,42 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("getProcessesAccessingSpeakersWithResult",
               Napi::Function::New(env, renderProcessesFunc));
 
+  exports.Set("getRunningInputAudioProcessesAsync",
+              Napi::Function::New(env, GetRunningInputAudioProcessesAsync));
+  exports.Set("getProcessesAccessingMicrophoneWithResultAsync",
+              Napi::Function::New(env, GetProcessesAccessingMicrophoneWithResultAsync));
+  exports.Set("getProcessesAccessingSpeakersWithResultAsync",
+              Napi::Function::New(env, GetRenderProcessesWithResultAsync));
+  exports.Set("getAudioSnapshot",
+              Napi::Function::New(env, audioSnapshotFunc));
+  exports.Set("getAudioSnapshotAsync",
+              Napi::Function::New(env, GetAudioSnapshotAsync));
+
+  exports.Set("watchAudioProcesses",
+              Napi::Function::New(env, WatchAudioProcesses));
+  exports.Set("startLevelMeter",
+              Napi::Function::New(env, StartInputLevelMeter));
+  exports.Set("measureLevel",
+              Napi::Function::New(env, MeasureLevel));
+  exports.Set("subscribeMicrophone",
+              Napi::Function::New(env, SubscribeMicrophone));
+  exports.Set("getResolverCacheStats",
+              Napi::Function::New(env, GetResolverCacheStats));
+  exports.Set("setResolverCacheCapacity",
+              Napi::Function::New(env, SetResolverCacheCapacity));
+  exports.Set("getStats",
+              Napi::Function::New(env, GetStats));
+  exports.Set("resetStats",
+              Napi::Function::New(env, ResetStats));
+  exports.Set("getInstanceStats",
+              Napi::Function::New(env, GetInstanceStats));
+  exports.Set("createProcessFilter",
+              Napi::Function::New(env, CreateProcessFilter));
+  exports.Set("prewarm",
+              Napi::Function::New(env, Prewarm));
+  exports.Set("createAudioContext",
+              Napi::Function::New(env, CreateWindowsAudioContext));
+
   return exports;
 }
 